@@ -0,0 +1,51 @@
+#version 330 core
+
+// Voxel::PackedData, see Shared/Voxel.h
+layout(location = 0) in uint aPosition;
+layout(location = 1) in uint aColor;
+layout(location = 2) in uint aOcclusion;
+
+// Per-instance
+layout(location = 4) in mat4 aModelMatrix;
+layout(location = 8) in vec3 aTint;
+
+flat out vec4 gColor;
+flat out int gEnabledFaces;
+flat out int gOcclusion;
+flat out mat4 gModelMatrix;
+
+uniform mat4 uProjMatrix;
+uniform mat4 uViewMatrix;
+
+vec3 UnpackPosition()
+{
+   uvec3 halves = uvec3(aPosition, aPosition >> 10, aPosition >> 20) & 0x3ffu;
+   return vec3(halves) / 2.0 - 256.0;
+}
+
+vec3 UnpackColor()
+{
+   return vec3(uvec3(aColor, aColor >> 8, aColor >> 16) & 0xffu);
+}
+
+// Expand 2-bit occlusion levels back out to the 4-bit neighbor counts Voxel.geom reads.
+int UnpackOcclusion()
+{
+   int occlusion = 0;
+   for (int corner = 0; corner < 8; ++corner)
+   {
+      int level = int(aOcclusion >> uint(14 - 2 * corner)) & 0x3;
+      occlusion |= (level * 2) << (28 - 4 * corner);
+   }
+   return occlusion;
+}
+
+void main()
+{
+   gl_Position = uProjMatrix * uViewMatrix * aModelMatrix * vec4(UnpackPosition(), 1);
+
+   gColor = vec4(aTint * UnpackColor() / (255.0 * 250.0), 1);
+   gEnabledFaces = int(aColor >> 24) & 0x3f;
+   gOcclusion = UnpackOcclusion();
+   gModelMatrix = aModelMatrix;
+}
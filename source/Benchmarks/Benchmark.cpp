@@ -0,0 +1,323 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <RGBNetworking/JSONSerializer.h>
+#include <RGBText/Format.h>
+
+#include "Benchmark.h"
+
+namespace CubeWorld
+{
+
+namespace Benchmark
+{
+
+namespace
+{
+
+std::vector<Result> gResults;
+
+// Linearly interpolated, on already sorted values.
+double Quantile(const std::vector<double>& sorted, double p)
+{
+   if (sorted.empty())
+   {
+      return 0;
+   }
+
+   const double position = p * double(sorted.size() - 1);
+   const size_t index = size_t(position);
+   if (index + 1 >= sorted.size())
+   {
+      return sorted.back();
+   }
+
+   return sorted[index] + (sorted[index + 1] - sorted[index]) * (position - double(index));
+}
+
+// Nanoseconds in whatever unit keeps them readable.
+std::string FormatDuration(double ns)
+{
+   if (ns >= 1e9) { return FormatString("{s:.3f}s", ns / 1e9); }
+   if (ns >= 1e6) { return FormatString("{ms:.3f}ms", ns / 1e6); }
+   if (ns >= 1e3) { return FormatString("{us:.3f}us", ns / 1e3); }
+   return FormatString("{ns:.2f}ns", ns);
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+Options& GetOptions()
+{
+   static Options options;
+   return options;
+}
+
+const Engine::Clock& GetClock()
+{
+   static Engine::TSCClock clock;
+   return clock;
+}
+
+///
+///
+///
+BindingProperty Result::Serialize() const
+{
+   BindingProperty result;
+   result["name"] = name;
+   result["iterations"] = iterations;
+   result["mean"] = mean;
+   result["median"] = median;
+   result["stddev"] = stddev;
+   result["min"] = min;
+   result["max"] = max;
+   result["medianLow"] = medianLow;
+   result["medianHigh"] = medianHigh;
+   result["outliers"] = outliers;
+
+   BindingProperty& values = result["samples"].SetArray();
+   for (double sample : samples)
+   {
+      values.PushBack(sample);
+   }
+
+   return result;
+}
+
+Result Result::Deserialize(const BindingProperty& data)
+{
+   Result result;
+   result.name = data["name"].GetStringValue();
+   result.iterations = data["iterations"].GetUint64Value();
+   result.mean = data["mean"].GetDoubleValue();
+   result.median = data["median"].GetDoubleValue();
+   result.stddev = data["stddev"].GetDoubleValue();
+   result.min = data["min"].GetDoubleValue();
+   result.max = data["max"].GetDoubleValue();
+   result.medianLow = data["medianLow"].GetDoubleValue();
+   result.medianHigh = data["medianHigh"].GetDoubleValue();
+   result.outliers = data["outliers"].GetUintValue();
+
+   for (const BindingProperty& sample : data["samples"])
+   {
+      result.samples.push_back(sample.GetDoubleValue());
+   }
+
+   return result;
+}
+
+///
+///
+///
+Result Analyze(const std::string& name, uint64_t iterations, std::vector<double> samples, uint32_t resamples)
+{
+   Result result;
+   result.name = name;
+   result.iterations = iterations;
+   result.samples = std::move(samples);
+   if (result.samples.empty())
+   {
+      return result;
+   }
+
+   std::vector<double> sorted = result.samples;
+   std::sort(sorted.begin(), sorted.end());
+   const size_t n = sorted.size();
+
+   result.min = sorted.front();
+   result.max = sorted.back();
+   result.median = Quantile(sorted, 0.5);
+
+   double sum = 0;
+   for (double sample : sorted)
+   {
+      sum += sample;
+   }
+   result.mean = sum / double(n);
+
+   double squares = 0;
+   for (double sample : sorted)
+   {
+      squares += (sample - result.mean) * (sample - result.mean);
+   }
+   result.stddev = n > 1 ? std::sqrt(squares / double(n - 1)) : 0;
+
+   const double q1 = Quantile(sorted, 0.25);
+   const double q3 = Quantile(sorted, 0.75);
+   const double fence = 1.5 * (q3 - q1);
+   for (double sample : sorted)
+   {
+      if (sample < q1 - fence || sample > q3 + fence)
+      {
+         ++result.outliers;
+      }
+   }
+
+   // Timings are skewed, with a long tail of interruptions, so the interval comes
+   // from resampling instead of assuming they're normal.
+   std::mt19937 random(0x5eed);
+   std::uniform_int_distribution<size_t> pick(0, n - 1);
+   std::vector<double> medians(std::max(resamples, 1u));
+   std::vector<double> resample(n);
+   for (double& median : medians)
+   {
+      for (double& sample : resample)
+      {
+         sample = sorted[pick(random)];
+      }
+      std::sort(resample.begin(), resample.end());
+      median = Quantile(resample, 0.5);
+   }
+   std::sort(medians.begin(), medians.end());
+   result.medianLow = Quantile(medians, 0.025);
+   result.medianHigh = Quantile(medians, 0.975);
+
+   return result;
+}
+
+///
+///
+///
+const std::vector<Result>& GetResults()
+{
+   return gResults;
+}
+
+const Result& AddResult(Result result)
+{
+   gResults.push_back(std::move(result));
+   return gResults.back();
+}
+
+///
+///
+///
+BindingProperty Serialize(const std::vector<Result>& results)
+{
+   BindingProperty result;
+   BindingProperty& benchmarks = result["benchmarks"].SetArray();
+   for (const Result& benchmark : results)
+   {
+      benchmarks.PushBack(benchmark.Serialize());
+   }
+   return result;
+}
+
+Maybe<void> WriteJSON(const std::string& path, const std::vector<Result>& results)
+{
+   return JSONSerializer::SerializeFile(path, Serialize(results));
+}
+
+Maybe<std::vector<Result>> ReadJSON(const std::string& path)
+{
+   Maybe<BindingProperty> data = JSONSerializer::DeserializeFile(path);
+   if (!data)
+   {
+      return data.Failure().WithContext("Failed reading benchmark results");
+   }
+
+   const BindingProperty& benchmarks = (*data)["benchmarks"];
+   if (!benchmarks.IsArray())
+   {
+      return Failure{"{path} has no list of benchmarks", path};
+   }
+
+   std::vector<Result> results;
+   for (const BindingProperty& benchmark : benchmarks)
+   {
+      results.push_back(Result::Deserialize(benchmark));
+   }
+   return results;
+}
+
+///
+///
+///
+std::vector<Comparison> Compare(const std::vector<Result>& baseline, const std::vector<Result>& current, double threshold)
+{
+   std::vector<Comparison> comparisons;
+   for (const Result& result : current)
+   {
+      Comparison comparison;
+      comparison.name = result.name;
+      comparison.current = result.median;
+
+      auto before = std::find_if(baseline.begin(), baseline.end(), [&](const Result& r) { return r.name == result.name; });
+      if (before != baseline.end() && before->median > 0)
+      {
+         comparison.baseline = before->median;
+         comparison.ratio = result.median / before->median;
+         comparison.verdict = Comparison::Same;
+         if (comparison.ratio > 1 + threshold && result.medianLow > before->medianHigh)
+         {
+            comparison.verdict = Comparison::Slower;
+         }
+         else if (comparison.ratio < 1 - threshold && result.medianHigh < before->medianLow)
+         {
+            comparison.verdict = Comparison::Faster;
+         }
+      }
+
+      comparisons.push_back(comparison);
+   }
+
+   return comparisons;
+}
+
+///
+///
+///
+std::string ToText(const std::vector<Result>& results)
+{
+   std::string text;
+   for (const Result& result : results)
+   {
+      text += FormatString("{name}: median {median} [{low}, {high}] | mean {mean} +- {stddev} | {iterations} x {samples}{outliers}\n",
+         result.name,
+         FormatDuration(result.median),
+         FormatDuration(result.medianLow),
+         FormatDuration(result.medianHigh),
+         FormatDuration(result.mean),
+         FormatDuration(result.stddev),
+         result.iterations,
+         result.samples.size(),
+         result.outliers > 0 ? FormatString(" ({outliers} outliers)", result.outliers) : std::string{}
+      );
+   }
+   return text;
+}
+
+std::string ToText(const std::vector<Comparison>& comparisons)
+{
+   std::string text;
+   for (const Comparison& comparison : comparisons)
+   {
+      switch (comparison.verdict)
+      {
+      case Comparison::New:
+         text += FormatString("{name}: {current} (new)\n", comparison.name, FormatDuration(comparison.current));
+         break;
+      default:
+         text += FormatString("{name}: {baseline} -> {current} ({sign}{change:.1f}%%){verdict}\n",
+            comparison.name,
+            FormatDuration(comparison.baseline),
+            FormatDuration(comparison.current),
+            comparison.ratio >= 1 ? "+" : "",
+            (comparison.ratio - 1) * 100,
+            comparison.verdict == Comparison::Slower ? " SLOWER" : comparison.verdict == Comparison::Faster ? " faster" : ""
+         );
+         break;
+      }
+   }
+   return text;
+}
+
+}; // namespace Benchmark
+
+}; // namespace CubeWorld
@@ -0,0 +1,179 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Engine/Core/Clock.h>
+#include <RGBBinding/BindingProperty.h>
+#include <RGBDesignPatterns/Maybe.h>
+
+#include "../Tests/catch.h"
+
+namespace CubeWorld
+{
+
+namespace Benchmark
+{
+
+//
+// How hard to look at each benchmark. Set from the command line, see Main.cpp.
+//
+struct Options
+{
+   // Number of timed samples.
+   uint32_t samples = 50;
+   // Each sample runs enough iterations to take at least this long, so clock reads
+   // and the loop itself are lost in the noise.
+   double sampleSeconds = 0.002;
+   // Spent running the benchmark before any samples are kept, to warm up caches,
+   // branch predictors and CPU clocks.
+   double warmupSeconds = 0.05;
+   // Resamples used for the confidence interval of the median.
+   uint32_t resamples = 1000;
+};
+
+Options& GetOptions();
+
+//
+// One benchmark's samples, and what they say. Times are nanoseconds per iteration.
+//
+struct Result
+{
+   std::string name;
+   uint64_t iterations = 0; // Per sample
+   std::vector<double> samples;
+
+   double mean = 0;
+   double median = 0;
+   double stddev = 0;
+   double min = 0;
+   double max = 0;
+
+   // 95% bootstrap confidence interval of the median.
+   double medianLow = 0;
+   double medianHigh = 0;
+
+   // Samples outside of 1.5 interquartile ranges from the middle half.
+   uint32_t outliers = 0;
+
+   BindingProperty Serialize() const;
+   static Result Deserialize(const BindingProperty& data);
+};
+
+//
+// Works out the statistics for a set of samples. Resampling is seeded, so the same
+// samples always give the same interval.
+//
+Result Analyze(const std::string& name, uint64_t iterations, std::vector<double> samples, uint32_t resamples);
+
+//
+// Everything that has been run so far, in order.
+//
+const std::vector<Result>& GetResults();
+const Result& AddResult(Result result);
+
+// Machine readable results, for tooling and to compare against later.
+BindingProperty Serialize(const std::vector<Result>& results);
+Maybe<void> WriteJSON(const std::string& path, const std::vector<Result>& results);
+Maybe<std::vector<Result>> ReadJSON(const std::string& path);
+
+//
+// How a benchmark moved between two runs. It only counts as faster or slower if
+// the median moved by more than the threshold and the confidence intervals don't
+// overlap, so noise on either side doesn't fail a build.
+//
+struct Comparison
+{
+   enum Verdict { Same, Faster, Slower, New };
+
+   std::string name;
+   Verdict verdict = New;
+   double baseline = 0; // Median, in ns
+   double current = 0;
+   // current / baseline
+   double ratio = 1;
+};
+
+std::vector<Comparison> Compare(const std::vector<Result>& baseline, const std::vector<Result>& current, double threshold);
+
+// One line per benchmark, for the console.
+std::string ToText(const std::vector<Result>& results);
+std::string ToText(const std::vector<Comparison>& comparisons);
+
+//
+// Makes the optimizer believe value is used, so the work that produced it can't be
+// thrown away.
+//
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+   static volatile const void* sink;
+   sink = &value;
+#else
+   asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// The clock samples are timed with.
+const Engine::Clock& GetClock();
+
+//
+// Times fn, which does one iteration of whatever's being measured, and records the
+// result. fn can return something to be passed to DoNotOptimize.
+//
+template <typename Fn>
+const Result& Run(const std::string& name, Fn&& fn)
+{
+   const Options& options = GetOptions();
+   const Engine::Clock& clock = GetClock();
+
+   auto runBatch = [&](uint64_t iterations) {
+      const uint64_t start = clock.NowNanoseconds();
+      for (uint64_t i = 0; i < iterations; ++i)
+      {
+         if constexpr (std::is_void_v<decltype(fn())>)
+         {
+            fn();
+         }
+         else
+         {
+            DoNotOptimize(fn());
+         }
+      }
+      return double(clock.NowNanoseconds() - start);
+   };
+
+   // Double up until a batch takes long enough to time, warming up on the way.
+   const double sampleNanoseconds = options.sampleSeconds * 1e9;
+   const uint64_t warmupEnd = clock.NowNanoseconds() + uint64_t(options.warmupSeconds * 1e9);
+   uint64_t iterations = 1;
+   double elapsed = runBatch(iterations);
+   while (elapsed < sampleNanoseconds || clock.NowNanoseconds() < warmupEnd)
+   {
+      if (elapsed < sampleNanoseconds)
+      {
+         iterations *= 2;
+      }
+      elapsed = runBatch(iterations);
+   }
+   iterations = std::max(uint64_t(1), uint64_t(double(iterations) * sampleNanoseconds / std::max(elapsed, 1.0)));
+
+   std::vector<double> samples;
+   samples.reserve(options.samples);
+   for (uint32_t i = 0; i < options.samples; ++i)
+   {
+      samples.push_back(runBatch(iterations) / double(iterations));
+   }
+
+   return AddResult(Analyze(name, iterations, std::move(samples), options.resamples));
+}
+
+}; // namespace Benchmark
+
+}; // namespace CubeWorld
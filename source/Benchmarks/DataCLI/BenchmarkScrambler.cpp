@@ -0,0 +1,38 @@
+// By Thomas Steinke
+
+#include "../Benchmark.h"
+
+#include <random>
+
+#include <DataCLI/Scrambler.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("Scrambler", "[Scrambler]") {
+   std::mt19937 random(0xbe7c);
+   Scrambler scrambler;
+
+   // data1.db is mostly small blobs, with a few big ones.
+   for (size_t size : { size_t(256), size_t(16 * 1024), size_t(1024 * 1024) })
+   {
+      std::string blob(size, '\0');
+      for (char& c : blob)
+      {
+         c = char(random());
+      }
+
+      // Running over the same buffer again and again just shuffles it some more.
+      Benchmark::Run("Scrambler::Unscramble " + std::to_string(size) + " bytes", [&] {
+         scrambler.Unscramble(&blob[0], blob.size());
+         Benchmark::DoNotOptimize(blob.data());
+      });
+
+      Benchmark::Run("Scrambler::Scramble " + std::to_string(size) + " bytes", [&] {
+         scrambler.Scramble(&blob[0], blob.size());
+         Benchmark::DoNotOptimize(blob.data());
+      });
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,23 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <Engine/Core/Clock.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("Clocks", "[Clock]") {
+   Engine::SteadyClock steady;
+   Engine::TSCClock tsc;
+
+   Benchmark::Run("SteadyClock::NowNanoseconds", [&] {
+      return steady.NowNanoseconds();
+   });
+
+   Benchmark::Run("TSCClock::NowNanoseconds", [&] {
+      return tsc.NowNanoseconds();
+   });
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,70 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <Engine/Entity/EntityManager.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+struct BenchmarkVelocity : public Engine::Component<BenchmarkVelocity>
+{
+   BenchmarkVelocity(glm::vec3 velocity = glm::vec3(0)) : velocity(velocity) {}
+
+   glm::vec3 velocity;
+};
+
+struct BenchmarkTag : public Engine::Component<BenchmarkTag>
+{
+};
+
+}; // anonymous namespace
+
+TEST_CASE("EntityManager iteration", "[EntityManager]") {
+   Engine::EventManager events;
+   Engine::EntityManager entities(events);
+
+   // Every entity has a transform, half of them move, and a tenth are tagged, so
+   // the iterators have to skip over some.
+   const int kEntities = 10000;
+   for (int i = 0; i < kEntities; ++i)
+   {
+      Engine::Entity entity = entities.Create(float(i), 0, 0);
+      if (i % 2 == 0)
+      {
+         entity.Add<BenchmarkVelocity>(glm::vec3(1, 0, 0));
+      }
+      if (i % 10 == 0)
+      {
+         entity.Add<BenchmarkTag>();
+      }
+   }
+
+   Benchmark::Run("EntityManager::Each<Transform> over 10000 entities", [&] {
+      float sum = 0;
+      entities.Each<Engine::Transform>([&](Engine::Transform& transform) {
+         sum += transform.GetLocalPosition().x;
+      });
+      return sum;
+   });
+
+   Benchmark::Run("EntityManager::Each<Transform, Velocity> over 10000 entities", [&] {
+      entities.Each<Engine::Transform, BenchmarkVelocity>([&](Engine::Transform& transform, BenchmarkVelocity& velocity) {
+         transform.SetLocalPosition(transform.GetLocalPosition() + velocity.velocity * 0.01f);
+      });
+   });
+
+   Benchmark::Run("EntityManager::EntitiesWithComponents<Tag> over 10000 entities", [&] {
+      size_t count = 0;
+      for (Engine::Entity entity : entities.EntitiesWithComponents<BenchmarkTag>())
+      {
+         count += entity.Has<BenchmarkVelocity>() ? 1 : 0;
+      }
+      return count;
+   });
+}
+
+}; // namespace CubeWorld
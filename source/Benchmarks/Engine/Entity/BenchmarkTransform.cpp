@@ -0,0 +1,43 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <Engine/Entity/EntityManager.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("Transform matrices", "[Transform]") {
+   Engine::EventManager events;
+   Engine::EntityManager entities(events);
+
+   Engine::Entity root = entities.Create(1, 2, 3);
+   Engine::Entity parent = root;
+   std::vector<Engine::Entity> chain{root};
+   for (int i = 1; i < 8; ++i)
+   {
+      Engine::Entity child = entities.Create(0, 1, 0);
+      child.Get<Engine::Transform>()->SetParent(parent);
+      child.Get<Engine::Transform>()->SetYaw(0.1f * i);
+      chain.push_back(child);
+      parent = child;
+   }
+
+   Engine::Transform& top = *root.Get<Engine::Transform>();
+   Engine::Transform& bottom = *chain.back().Get<Engine::Transform>();
+
+   Benchmark::Run("Transform::GetMatrix without a parent", [&] {
+      return top.GetMatrix();
+   });
+
+   // Like a hand at the end of a skeleton.
+   Benchmark::Run("Transform::GetMatrix 8 levels deep", [&] {
+      return bottom.GetMatrix();
+   });
+
+   Benchmark::Run("Transform::GetAbsolutePosition 8 levels deep", [&] {
+      return bottom.GetAbsolutePosition();
+   });
+}
+
+}; // namespace CubeWorld
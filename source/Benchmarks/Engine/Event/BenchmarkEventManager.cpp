@@ -0,0 +1,61 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <Engine/Event/EventManager.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+struct BenchmarkEvent : public Engine::Event<BenchmarkEvent>
+{
+   explicit BenchmarkEvent(int value) : value(value) {}
+
+   int value;
+};
+
+struct BenchmarkReceiver : public Engine::Receiver<BenchmarkReceiver>
+{
+   void Receive(const BenchmarkEvent& event) { total += event.value; }
+
+   int64_t total = 0;
+};
+
+}; // anonymous namespace
+
+TEST_CASE("EventManager emit", "[EventManager]") {
+   Engine::EventManager events;
+
+   Benchmark::Run("EventManager::Emit with no receivers", [&] {
+      events.Emit<BenchmarkEvent>(1);
+   });
+
+   BenchmarkReceiver receiver;
+   events.Subscribe<BenchmarkEvent>(receiver);
+   Benchmark::Run("EventManager::Emit to 1 receiver", [&] {
+      events.Emit<BenchmarkEvent>(1);
+   });
+
+   std::vector<BenchmarkReceiver> receivers(16);
+   for (BenchmarkReceiver& other : receivers)
+   {
+      events.Subscribe<BenchmarkEvent>(other);
+   }
+   Benchmark::Run("EventManager::Emit to 17 receivers", [&] {
+      events.Emit<BenchmarkEvent>(1);
+   });
+
+   // Events emitted from a child manager go up to the parent first.
+   Engine::EventManager child;
+   child.SetParent(&events);
+   Benchmark::Run("EventManager::Emit from a child to 17 receivers", [&] {
+      child.Emit<BenchmarkEvent>(1);
+   });
+
+   CHECK(receiver.total > 0);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,148 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <memory>
+#include <random>
+#include <glm/glm.hpp>
+
+#include <Engine/Graphics/InstanceBatcher.h>
+#include <Engine/Graphics/RenderQueue.h>
+
+namespace CubeWorld
+{
+
+using Engine::Graphics::DrawCommand;
+using Engine::Graphics::InstanceBatcher;
+using Engine::Graphics::Program;
+using Engine::Graphics::RenderBackend;
+using Engine::Graphics::RenderKey;
+using Engine::Graphics::RenderQueue;
+using Engine::Graphics::UniformHandle;
+using Engine::Graphics::UniformWrite;
+using Engine::Graphics::VertexLayout;
+
+namespace
+{
+
+//
+// Throws every command away, so only the queue itself is measured.
+//
+class NullBackend : public RenderBackend
+{
+public:
+   void BindProgram(Program&) override {}
+   void BindVertices(Program&, const DrawCommand&) override {}
+   void SetUniform(Program&, const UniformWrite&, const void*) override {}
+   void Draw(const DrawCommand&) override {}
+   void Finish() override {}
+};
+
+struct Instance
+{
+   glm::mat4 model;
+   glm::vec3 tint;
+};
+
+}; // anonymous namespace
+
+TEST_CASE("RenderQueue", "[RenderQueue]") {
+   constexpr size_t kDraws = 10000;
+
+   // Nothing is ever bound, so these don't need real GL objects.
+   std::vector<std::unique_ptr<Program>> programs;
+   for (size_t i = 0; i < 8; ++i)
+   {
+      programs.push_back(std::make_unique<Program>(0));
+   }
+   VertexLayout layout;
+   UniformHandle<glm::mat4> model{0};
+
+   std::mt19937 random(1234);
+   std::vector<uint64_t> keys(kDraws);
+   for (uint64_t& key : keys)
+   {
+      key = RenderKey::Make(0, random() % 8, random() % 256, random() & 0xffffff);
+   }
+
+   RenderQueue queue;
+   NullBackend backend;
+   Benchmark::Run("RenderQueue record, sort and submit 10000 draws", [&] {
+      for (size_t i = 0; i < kDraws; ++i)
+      {
+         DrawCommand command;
+         command.program = programs[(keys[i] >> 44) & 0x7].get();
+         command.layout = &layout;
+         command.buffers[0] = GLuint(keys[i] >> 24) & 0xff;
+         command.first = GLint(i);
+
+         queue.Uniform(model, glm::mat4(1));
+         queue.Draw(keys[i], command);
+      }
+      queue.Submit(backend);
+   });
+}
+
+TEST_CASE("Instancing", "[RenderQueue] [InstanceBatcher]") {
+   // 200 entities sharing 4 models of 12 parts each, like a crowd of enemies.
+   constexpr uint32_t kEntities = 200;
+   constexpr uint32_t kModels = 4;
+   constexpr uint32_t kParts = 12;
+
+   Program program(0);
+   VertexLayout layout;
+   UniformHandle<glm::mat4> model{0};
+   UniformHandle<glm::vec3> tint{1};
+   NullBackend backend;
+   RenderQueue queue;
+
+   Benchmark::Run("RenderQueue one draw per part per entity", [&] {
+      for (uint32_t entity = 0; entity < kEntities; ++entity)
+      {
+         for (uint32_t part = 0; part < kParts; ++part)
+         {
+            DrawCommand command;
+            command.program = &program;
+            command.layout = &layout;
+            command.buffers[0] = entity % kModels + 1;
+            command.first = GLint(part * 100);
+            command.count = 100;
+
+            queue.Uniform(model, glm::mat4(float(entity)));
+            queue.Uniform(tint, glm::vec3(255));
+            queue.Draw(RenderKey::Make(0, 0, command.buffers[0], entity), command);
+         }
+      }
+      queue.Submit(backend);
+   });
+
+   InstanceBatcher<uint64_t, Instance> batcher;
+   Benchmark::Run("InstanceBatcher one instanced draw per part per model", [&] {
+      batcher.Clear();
+      for (uint32_t entity = 0; entity < kEntities; ++entity)
+      {
+         for (uint32_t part = 0; part < kParts; ++part)
+         {
+            uint64_t key = (uint64_t(entity % kModels) << 32) | part;
+            batcher.Add(key, Instance{glm::mat4(float(entity)), glm::vec3(255)});
+         }
+      }
+      batcher.Build();
+
+      for (const auto& batch : batcher.GetBatches())
+      {
+         DrawCommand command;
+         command.program = &program;
+         command.layout = &layout;
+         command.buffers[0] = GLuint(batch.key >> 32) + 1;
+         command.first = GLint((batch.key & 0xffffffff) * 100);
+         command.count = 100;
+         command.instances = GLsizei(batch.count);
+         command.baseInstance = batch.first;
+         queue.Draw(RenderKey::Make(0, 0, command.buffers[0], 0), command);
+      }
+      queue.Submit(backend);
+   });
+}
+
+}; // namespace CubeWorld
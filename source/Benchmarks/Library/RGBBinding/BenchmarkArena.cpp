@@ -0,0 +1,33 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <RGBBinding/Arena.h>
+#include <RGBBinding/BindingPropertyReader.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("Arena", "[Arena]") {
+   // Long enough that none of the strings fit inside a property.
+   std::string json = "{\"name\": \"a skeleton with a long name\", \"bones\": [";
+   for (size_t i = 0; i < 2000; ++i)
+   {
+      json += i > 0 ? ", " : "";
+      json += "{\"name\": \"bone number " + std::to_string(i) + " of the skeleton\", "
+              "\"position\": [" + std::to_string(i) + ", 2.5, -3], "
+              "\"parent\": \"the parent of bone number " + std::to_string(i) + "\"}";
+   }
+   json += "]}";
+
+   Benchmark::Run("Parsing and freeing 2000 bones on the heap", [&] {
+      return BindingPropertyReader{}.Read(json).GetSize();
+   });
+
+   Benchmark::Run("Parsing and freeing 2000 bones in an Arena", [&] {
+      RGBBinding::Arena arena;
+      return BindingPropertyReader{&arena}.Read(json).GetSize();
+   });
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,83 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <RGBBinding/BindingProperty.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("BindingProperty lookups", "[BindingProperty]") {
+   // About the size of a skeleton's bone table, and of a typical component.
+   BindingProperty large;
+   for (int i = 0; i < 200; ++i)
+   {
+      large["bone" + std::to_string(i)] = i;
+   }
+
+   BindingProperty small;
+   small["position"] = glm::vec3(1, 2, 3);
+   small["scale"] = glm::vec3(1);
+   small["name"] = "torso";
+   small["hidden"] = false;
+
+   const BindingProperty& constLarge = large;
+   const BindingProperty& constSmall = small;
+
+   Benchmark::Run("BindingProperty[string] on 4 keys", [&] {
+      return constSmall["name"].GetStringValue().size();
+   });
+
+   const std::string boneName = "bone150";
+   Benchmark::Run("BindingProperty[string] on 200 keys", [&] {
+      return constLarge[boneName].GetIntValue();
+   });
+
+   static const BindingProperty::Key kBone{"bone150"};
+   Benchmark::Run("BindingProperty[Key] on 200 keys", [&] {
+      return constLarge[kBone].GetIntValue();
+   });
+
+   Benchmark::Run("BindingProperty::Has on a missing key", [&] {
+      return constLarge.Has("missing");
+   });
+
+   BindingProperty array;
+   array.SetArray();
+   for (int i = 0; i < 1000; ++i)
+   {
+      array.PushBack(i);
+   }
+   const BindingProperty& constArray = array;
+   Benchmark::Run("Iterating a BindingProperty of 1000 ints", [&] {
+      int64_t sum = 0;
+      for (const BindingProperty& value : constArray)
+      {
+         sum += value.GetIntValue();
+      }
+      return sum;
+   });
+}
+
+TEST_CASE("Building BindingProperty objects", "[BindingProperty]") {
+   // Past a handful of keys, objects build an index as they go.
+   for (size_t count : { size_t(8), size_t(1000) })
+   {
+      std::vector<std::string> keys;
+      for (size_t i = 0; i < count; ++i)
+      {
+         keys.push_back("key" + std::to_string(i));
+      }
+
+      Benchmark::Run("Building a BindingProperty with " + std::to_string(count) + " keys", [&] {
+         BindingProperty object;
+         for (size_t i = 0; i < keys.size(); ++i)
+         {
+            object[keys[i]] = uint32_t(i);
+         }
+         return object.GetSize();
+      });
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,44 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <RGBBinding/Arena.h>
+#include <RGBBinding/BindingPropertyConsumer.h>
+#include <RGBBinding/BindingPropertyMeta.h>
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBNetworking/YAMLSerializer.h>
+#include <Shared/Components/Skeleton.h>
+#include <Shared/Helpers/Asset.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("BindingPropertyConsumer", "[BindingPropertyConsumer]") {
+   // Skeletons are streamed straight into the component when they're loaded.
+   DiskFileSystem fs;
+   Maybe<std::string> contents = fs.ReadEntireFile(Asset::Skeleton("character.yaml"));
+   REQUIRE(contents);
+   const std::string& yaml = *contents;
+
+   Benchmark::Run("Parsing the character skeleton, then deserializing it", [&] {
+      Skeleton skeleton;
+      Binding::deserialize(skeleton, *YAMLSerializer::Deserialize(yaml));
+      return skeleton.stances.size();
+   });
+
+   Benchmark::Run("Parsing the character skeleton into an Arena, then deserializing it", [&] {
+      RGBBinding::Arena arena;
+      Skeleton skeleton;
+      Binding::deserialize(skeleton, *YAMLSerializer::Deserialize(yaml, &arena));
+      return skeleton.stances.size();
+   });
+
+   Benchmark::Run("Streaming the character skeleton into a Skeleton", [&] {
+      Skeleton skeleton;
+      BindingPropertyConsumer consumer(skeleton);
+      YAMLSerializer::Read(yaml, consumer);
+      return skeleton.stances.size();
+   });
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,52 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <RGBLogger/Logger.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+using Logger::LogManager;
+
+//
+// Throws everything away, to measure just the cost of logging.
+//
+class NullLogger : public Logger::Logger
+{
+public:
+   NullLogger() { LogManager::Instance().RegisterLogger(this); }
+   ~NullLogger() { LogManager::Instance().DeregisterLogger(this); }
+
+   NO_REGISTER_HOOKS
+
+   void Log(const char*, Color) override {}
+};
+
+}; // anonymous namespace
+
+TEST_CASE("Logging", "[Logger]") {
+   NullLogger logger;
+   LogManager& manager = LogManager::Instance();
+
+   int frame = 0;
+   Benchmark::Run("LOG_INFO", [&] {
+      LOG_INFO("Frame {frame} took {ms}ms, {name}", ++frame, 16.6, "update");
+   });
+
+   // Big enough that the logging thread keeps up.
+   Logger::AsyncOptions options;
+   options.bufferSize = 1024 * 1024;
+   manager.StartAsync(options);
+
+   Benchmark::Run("LOG_INFO with async logging", [&] {
+      LOG_INFO("Frame {frame} took {ms}ms, {name}", ++frame, 16.6, "update");
+   });
+
+   manager.StopAsync();
+}
+
+}; // namespace CubeWorld
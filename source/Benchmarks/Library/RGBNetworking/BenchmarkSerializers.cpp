@@ -0,0 +1,162 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <RGBBinding/Arena.h>
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBNetworking/BinarySerializer.h>
+#include <RGBNetworking/JSONSerializer.h>
+#include <RGBNetworking/YAMLSerializer.h>
+#include <RGBText/Format.h>
+#include <Shared/Helpers/Asset.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+std::string ReadAsset(const std::string& path)
+{
+   DiskFileSystem fs;
+   Maybe<std::string> contents = fs.ReadEntireFile(path);
+   REQUIRE(contents);
+   return std::move(*contents);
+}
+
+// Every YAML file the game loads.
+std::vector<std::string> ReadYAMLAssets()
+{
+   DiskFileSystem fs;
+   std::vector<std::string> files;
+   for (const std::string& dir : {Asset::Skeleton(""), Asset::Animation(""), Asset::Path("Particles"), Asset::Path("Scenes")})
+   {
+      Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(dir, false, true);
+      REQUIRE(entries);
+      for (const FileSystem::FileEntry& entry : *entries)
+      {
+         if (entry.name.size() > 5 && entry.name.compare(entry.name.size() - 5, 5, ".yaml") == 0)
+         {
+            files.push_back(ReadAsset(Paths::Join(dir, entry.name)));
+         }
+      }
+   }
+   REQUIRE(!files.empty());
+   return files;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("YAML and JSON loaders", "[YAMLSerializer] [JSONSerializer]") {
+   const std::string skeleton = ReadAsset(Asset::Skeleton("character.yaml"));
+   const std::string animation = ReadAsset(Asset::Animation("character/run.yaml"));
+   const std::string model = ReadAsset(Asset::Model("character.json"));
+
+   Benchmark::Run("YAMLSerializer::Deserialize character skeleton", [&] {
+      Maybe<BindingProperty> result = YAMLSerializer::Deserialize(skeleton);
+      return bool(result);
+   });
+
+   // What the asset loaders do, with everything freed at once afterwards.
+   Benchmark::Run("YAMLSerializer::Deserialize character skeleton into an Arena", [&] {
+      RGBBinding::Arena arena;
+      Maybe<BindingProperty> result = YAMLSerializer::Deserialize(skeleton, &arena);
+      return bool(result);
+   });
+
+   Benchmark::Run("YAMLSerializer::Deserialize run animation", [&] {
+      Maybe<BindingProperty> result = YAMLSerializer::Deserialize(animation);
+      return bool(result);
+   });
+
+   Benchmark::Run("JSONSerializer::Deserialize character model", [&] {
+      Maybe<BindingProperty> result = JSONSerializer::Deserialize(model);
+      return bool(result);
+   });
+
+   Maybe<BindingProperty> parsed = JSONSerializer::Deserialize(model);
+   REQUIRE(parsed);
+   Benchmark::Run("JSONSerializer::Serialize character model", [&] {
+      return JSONSerializer::Serialize(*parsed)->size();
+   });
+   Benchmark::Run("YAMLSerializer::Serialize character model", [&] {
+      return YAMLSerializer::Serialize(*parsed)->size();
+   });
+}
+
+TEST_CASE("Every YAML asset in each format", "[YAMLSerializer] [JSONSerializer] [BinarySerializer]") {
+   const std::vector<std::string> yaml = ReadYAMLAssets();
+   std::vector<std::string> json;
+   std::vector<std::string> binary;
+   for (const std::string& document : yaml)
+   {
+      Maybe<BindingProperty> data = YAMLSerializer::Deserialize(document);
+      REQUIRE(data);
+      json.push_back(*JSONSerializer::Serialize(*data));
+      binary.push_back(*BinarySerializer::Serialize(*data));
+   }
+
+   Benchmark::Run("YAMLSerializer::Deserialize every YAML asset", [&] {
+      size_t size = 0;
+      for (const std::string& document : yaml)
+      {
+         size += YAMLSerializer::Deserialize(document)->GetSize();
+      }
+      return size;
+   });
+
+   Benchmark::Run("YAMLSerializer::Deserialize every YAML asset into an Arena", [&] {
+      RGBBinding::Arena arena;
+      size_t size = 0;
+      for (const std::string& document : yaml)
+      {
+         size += YAMLSerializer::Deserialize(document, &arena)->GetSize();
+      }
+      return size;
+   });
+
+   Benchmark::Run("JSONSerializer::Deserialize every YAML asset", [&] {
+      size_t size = 0;
+      for (const std::string& document : json)
+      {
+         size += JSONSerializer::Deserialize(document)->GetSize();
+      }
+      return size;
+   });
+
+   Benchmark::Run("BinarySerializer::Deserialize every YAML asset", [&] {
+      size_t size = 0;
+      for (const std::string& document : binary)
+      {
+         size += BinarySerializer::Deserialize(document)->GetSize();
+      }
+      return size;
+   });
+
+   Benchmark::Run("BinarySerializer::Deserialize every YAML asset into an Arena", [&] {
+      RGBBinding::Arena arena;
+      size_t size = 0;
+      for (const std::string& document : binary)
+      {
+         size += BinarySerializer::Deserialize(document, &arena)->GetSize();
+      }
+      return size;
+   });
+}
+
+TEST_CASE("YAML numbers", "[YAMLSerializer]") {
+   // Animations are mostly long lists of vectors.
+   std::string numbers = "[";
+   for (int i = 0; i < 10000; ++i)
+   {
+      numbers += FormatString("{}[{}, {}.5, -{}.125]", i > 0 ? ", " : "", i, i, i);
+   }
+   numbers += "]";
+
+   Benchmark::Run("YAMLSerializer::Deserialize 10000 vec3s", [&] {
+      return YAMLSerializer::Deserialize(numbers)->GetSize();
+   });
+}
+
+}; // namespace CubeWorld
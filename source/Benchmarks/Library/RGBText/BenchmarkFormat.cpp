@@ -0,0 +1,41 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <iterator>
+
+#include <RGBText/Format.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("Formatting", "[Format]") {
+   // The kind of line the debug overlay and logs put out every frame.
+   int i = 0;
+
+   Benchmark::Run("FormatString", [&] {
+      return FormatString("{name}: {value}ms", "Render system", ++i * 0.001).size();
+   });
+
+   char buffer[64];
+   Benchmark::Run("FormatToN into a buffer", [&] {
+      return FormatToN(buffer, sizeof(buffer), "{name}: {value}ms", "Render system", ++i * 0.001).size;
+   });
+
+   std::string reused;
+   Benchmark::Run("FormatTo into a reused string", [&] {
+      reused.clear();
+      FormatTo(std::back_inserter(reused), "{name}: {value}ms", "Render system", ++i * 0.001);
+      return reused.size();
+   });
+
+   Benchmark::Run("FormatString with an integer", [&] {
+      return FormatString("Element {num}", ++i).size();
+   });
+
+   Benchmark::Run("FormatToN with an integer", [&] {
+      return FormatToN(buffer, sizeof(buffer), "Element {num}", ++i).size;
+   });
+}
+
+}; // namespace CubeWorld
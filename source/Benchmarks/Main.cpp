@@ -0,0 +1,88 @@
+#define CATCH_CONFIG_RUNNER
+#include "../Tests/catch.h"
+
+#include <cstdio>
+
+#include <Shared/Helpers/Asset.h>
+
+#include "Benchmark.h"
+
+int main(int argc, char* argv[])
+{
+   using namespace CubeWorld;
+   using namespace Catch::clara;
+
+   Asset::SetAssetRootDefault();
+
+   Benchmark::Options& options = Benchmark::GetOptions();
+   std::string jsonPath;
+   std::string baselinePath;
+   double threshold = 0.1;
+
+   Catch::Session session;
+   session.cli(session.cli()
+      | Opt(jsonPath, "path")["--json"]("write every result to this file, as JSON")
+      | Opt(baselinePath, "path")["--baseline"]("compare against results written with --json, failing on regressions")
+      | Opt(threshold, "fraction")["--threshold"]("how much slower the median has to get to count as a regression (default 0.1)")
+      | Opt(options.samples, "count")["--samples"]("timed samples per benchmark (default 50)")
+      | Opt(options.sampleSeconds, "seconds")["--sample-time"]("shortest time each sample runs for (default 0.002)")
+      | Opt(options.warmupSeconds, "seconds")["--warmup"]("time spent on each benchmark before sampling (default 0.05)")
+   );
+
+   for (int i = 0; i < argc; ++i)
+   {
+      if (strcmp("--ansi", argv[i]) == 0)
+      {
+         Catch::Colour::ansi(true);
+
+         // Hide this argument from the Catch library
+         argv[i][0] = '\0';
+      }
+   }
+
+   if (int result = session.applyCommandLine(argc, argv); result != 0)
+   {
+      return result;
+   }
+
+   if (int result = session.run(); result != 0)
+   {
+      return result;
+   }
+
+   const std::vector<Benchmark::Result>& results = Benchmark::GetResults();
+   printf("%s", Benchmark::ToText(results).c_str());
+
+   if (!jsonPath.empty())
+   {
+      if (Maybe<void> written = Benchmark::WriteJSON(jsonPath, results); !written)
+      {
+         printf("Failed to write results: %s\n", written.Failure().GetMessage().c_str());
+         return 1;
+      }
+   }
+
+   if (!baselinePath.empty())
+   {
+      Maybe<std::vector<Benchmark::Result>> baseline = Benchmark::ReadJSON(baselinePath);
+      if (!baseline)
+      {
+         printf("Failed to read baseline: %s\n", baseline.Failure().GetMessage().c_str());
+         return 1;
+      }
+
+      std::vector<Benchmark::Comparison> comparisons = Benchmark::Compare(*baseline, results, threshold);
+      printf("\nCompared to %s:\n%s", baselinePath.c_str(), Benchmark::ToText(comparisons).c_str());
+
+      int regressions = 0;
+      for (const Benchmark::Comparison& comparison : comparisons)
+      {
+         regressions += comparison.verdict == Benchmark::Comparison::Slower ? 1 : 0;
+      }
+      return regressions;
+   }
+
+   return 0;
+}
+
+// Benchmarks go in their own files, like tests do.
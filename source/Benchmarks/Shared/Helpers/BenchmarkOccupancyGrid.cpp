@@ -0,0 +1,103 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+#include "../../../Tests/Helpers/VoxModels.h"
+
+#include <glm/glm.hpp>
+
+#include <Shared/Helpers/OccupancyGrid.h>
+#include <Shared/Helpers/VoxReader.h>
+
+namespace CubeWorld
+{
+
+using Test::ReadAllVoxModels;
+using Voxel::OccupancyGrid;
+using Voxel::VoxReader;
+
+namespace
+{
+
+struct GridModel {
+   uint32_t width, height, length;
+   std::vector<glm::uvec3> voxels;
+};
+
+// Every model in every .vox file in Assets/Models.
+std::vector<GridModel> ReadAllModels()
+{
+   std::vector<GridModel> result;
+   for (const auto& [_, contents] : ReadAllVoxModels())
+   {
+      Maybe<VoxReader::Scene> scene = VoxReader::Parse(contents.data(), contents.size());
+      REQUIRE(scene);
+
+      for (const VoxReader::Model& model : scene->models)
+      {
+         GridModel& grid = result.emplace_back();
+         grid.width = model.width;
+         grid.height = model.height;
+         grid.length = model.length;
+         for (uint32_t i = 0; i < model.voxels.size; ++i)
+         {
+            uint32_t info = model.voxels[i];
+            grid.voxels.emplace_back(info & 0xff, (info >> 16) & 0xff, (info >> 8) & 0xff);
+         }
+      }
+   }
+
+   REQUIRE(!result.empty());
+   return result;
+}
+
+// What VoxFormat::Build does with the grid: fill it, then ask about every voxel.
+uint64_t CountExposed(const GridModel& model)
+{
+   OccupancyGrid grid(model.width, model.height, model.length);
+   for (const glm::uvec3& voxel : model.voxels)
+   {
+      grid.Set(voxel.x, voxel.y, voxel.z);
+   }
+   grid.ComputeFaces();
+
+   uint64_t exposed = 0;
+   for (const glm::uvec3& voxel : model.voxels)
+   {
+      exposed += grid.GetExposedFaces(voxel.x, voxel.y, voxel.z) != 0;
+   }
+   return exposed;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("OccupancyGrid", "[OccupancyGrid]") {
+   const std::vector<GridModel> models = ReadAllModels();
+
+   Benchmark::Run("OccupancyGrid faces for every model in Assets/Models", [&] {
+      uint64_t exposed = 0;
+      for (const GridModel& model : models)
+      {
+         exposed += CountExposed(model);
+      }
+      return exposed;
+   });
+
+   // A solid 126^3 block, the largest model MagicaVoxel makes by default.
+   GridModel block{126, 126, 126, {}};
+   for (uint32_t y = 0; y < 126; ++y)
+   {
+      for (uint32_t z = 0; z < 126; ++z)
+      {
+         for (uint32_t x = 0; x < 126; ++x)
+         {
+            block.voxels.emplace_back(x, y, z);
+         }
+      }
+   }
+
+   Benchmark::Run("OccupancyGrid faces for a solid 126^3 block", [&] {
+      return CountExposed(block);
+   });
+}
+
+}; // namespace CubeWorld
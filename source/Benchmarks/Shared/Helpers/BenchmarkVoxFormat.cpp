@@ -0,0 +1,55 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <RGBFileSystem/FileSystem.h>
+#include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxBake.h>
+#include <Shared/Helpers/VoxFormat.h>
+
+namespace CubeWorld
+{
+
+using Voxel::VoxFormat;
+using Voxel::VoxModel;
+using Voxel::VoxModelData;
+namespace VoxBake = Voxel::VoxBake;
+
+TEST_CASE("VoxFormat loading", "[VoxFormat]") {
+   // Everything short of uploading to the GPU, on the model with the most parts.
+   DiskFileSystem fs;
+   Maybe<std::string> contents = fs.ReadEntireFile(Asset::Model("character.vox"));
+   REQUIRE(contents);
+   const std::string& file = *contents;
+
+   Benchmark::Run("VoxFormat::ParseScene character.vox", [&] {
+      Maybe<std::unique_ptr<VoxModelData>> data = VoxFormat::ParseScene(file.data(), file.size());
+      return bool(data);
+   });
+
+   Maybe<std::unique_ptr<VoxModelData>> data = VoxFormat::ParseScene(file.data(), file.size());
+   REQUIRE(data);
+   const VoxModelData& scene = *data.Result();
+
+   Benchmark::Run("VoxFormat::Build character.vox", [&] {
+      Maybe<std::unique_ptr<VoxModel>> model = VoxFormat::Build(scene);
+      return model ? model.Result()->voxels.size() : 0;
+   });
+
+   Benchmark::Run("VoxFormat::Merge character.vox", [&] {
+      Maybe<std::unique_ptr<Voxel::ModelData>> model = VoxFormat::Merge(scene, false);
+      return bool(model);
+   });
+
+   // The fast path, once a model has been baked.
+   const uint64_t hash = VoxBake::Hash(file.data(), file.size());
+   Maybe<std::unique_ptr<VoxModel>> model = VoxFormat::Build(scene);
+   REQUIRE(model);
+   const std::string bake = VoxBake::Write(*model.Result(), hash);
+   Benchmark::Run("VoxBake::Read character.vox", [&] {
+      Maybe<std::unique_ptr<VoxModel>> baked = VoxBake::Read(bake.data(), bake.size(), hash);
+      return baked ? baked.Result()->voxels.size() : 0;
+   });
+}
+
+}; // namespace CubeWorld
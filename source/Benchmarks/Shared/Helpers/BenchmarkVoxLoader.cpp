@@ -0,0 +1,99 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+#include "../../../Tests/Helpers/VoxModels.h"
+
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBFileSystem/Paths.h>
+#include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxFormat.h>
+#include <Shared/Helpers/VoxLoader.h>
+#include <Shared/Helpers/VoxReader.h>
+
+namespace CubeWorld
+{
+
+using Test::ListAllVoxModels;
+using Voxel::VoxFormat;
+using Voxel::VoxLoader;
+using Voxel::VoxModel;
+using Voxel::VoxModelData;
+using Voxel::VoxReader;
+
+TEST_CASE("Loading every model", "[VoxLoader] [VoxReader] [VoxFormat]") {
+   DiskFileSystem fs;
+   const std::vector<std::string> paths = ListAllVoxModels();
+   std::vector<std::string> files;
+   for (const std::string& path : paths)
+   {
+      Maybe<std::string> contents = fs.ReadEntireFile(path);
+      REQUIRE(contents);
+      files.push_back(std::move(*contents));
+   }
+
+   Benchmark::Run("VoxReader::Parse every model in Assets/Models", [&] {
+      size_t models = 0;
+      for (const std::string& file : files)
+      {
+         Maybe<VoxReader::Scene> scene = VoxReader::Parse(file.data(), file.size());
+         models += scene ? scene->models.size() : 0;
+      }
+      return models;
+   });
+
+   Benchmark::Run("VoxFormat::ParseScene and Build every model in Assets/Models", [&] {
+      size_t voxels = 0;
+      for (const std::string& file : files)
+      {
+         Maybe<std::unique_ptr<VoxModelData>> data = VoxFormat::ParseScene(file.data(), file.size());
+         Maybe<std::unique_ptr<VoxModel>> model = VoxFormat::Build(*data.Result());
+         voxels += model.Result()->voxels.size();
+      }
+      return voxels;
+   });
+
+   Benchmark::Run("VoxLoader every model in Assets/Models on one thread", [&] {
+      VoxLoader loader(1);
+      for (const std::string& path : paths)
+      {
+         loader.Load(path);
+      }
+   });
+
+   Benchmark::Run("VoxLoader every model in Assets/Models on every core", [&] {
+      VoxLoader loader;
+      std::vector<VoxLoader::Handle> handles;
+      for (const std::string& path : paths)
+      {
+         handles.push_back(loader.Request(path));
+      }
+      for (const VoxLoader::Handle& handle : handles)
+      {
+         handle.Get();
+      }
+      loader.Finalize();
+   });
+
+   // Once everything has been baked, loading maps the bakes instead of parsing.
+   const std::string cache = Asset::Path("Cache", "Benchmarks");
+   REQUIRE(fs.MakeDirectory(cache));
+   {
+      VoxLoader loader;
+      loader.SetCacheDirectory(cache);
+      for (const std::string& path : paths)
+      {
+         REQUIRE(loader.Load(path));
+      }
+   }
+
+   Benchmark::Run("VoxLoader every baked model in Assets/Models on one thread", [&] {
+      VoxLoader loader(1);
+      loader.SetCacheDirectory(cache);
+      for (const std::string& path : paths)
+      {
+         loader.Load(path);
+      }
+   });
+}
+
+}; // namespace CubeWorld
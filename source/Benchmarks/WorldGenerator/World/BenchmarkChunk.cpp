@@ -0,0 +1,49 @@
+// By Thomas Steinke
+
+#include "../../Benchmark.h"
+
+#include <WorldGenerator/World/Chunk.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("Chunk access", "[Chunk]") {
+   Chunk chunk(ChunkCoords{});
+   const Chunk& constChunk = chunk;
+
+   // Every Get takes the chunk's lock, which is most of the cost.
+   Benchmark::Run("Chunk::Get one block", [&] {
+      return constChunk.Get(17, 23, 42).color.r;
+   });
+
+   Benchmark::Run("Chunk::Get a 128 block column", [&] {
+      float sum = 0;
+      for (uint32_t x = 0; x < kChunkSize; ++x)
+      {
+         sum += constChunk.Get(x, 10, 64).color.a;
+      }
+      return sum;
+   });
+
+   Benchmark::Run("Chunk::Get writing a 128x128 layer", [&] {
+      for (uint32_t z = 0; z < kChunkSize; ++z)
+      {
+         for (uint32_t x = 0; x < kChunkSize; ++x)
+         {
+            chunk.Get(x, 0, z).color = glm::vec4(1);
+         }
+      }
+   });
+
+   // What generators do when they own the chunk outright.
+   Benchmark::Run("Chunk::data writing a 128x128 layer", [&] {
+      std::vector<Block>& blocks = chunk.data();
+      for (size_t i = 0; i < kChunkSize * kChunkSize; ++i)
+      {
+         blocks[i].color = glm::vec4(1);
+      }
+      Benchmark::DoNotOptimize(blocks.data());
+   });
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,104 @@
+// By Thomas Steinke
+
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBText/StringHelper.h>
+#include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxLoader.h>
+
+#include "Console.h"
+#include "BakeModelsCommand.h"
+
+namespace CubeWorld
+{
+
+Maybe<std::string> BakeModelsCommand::Run(int argc, char** argv)
+{
+   int argi = 0;
+   mDestination = Asset::Path("Cache", "Models");
+
+   // Parse options...
+   while (argi < argc && std::string(argv[argi]) == "--output")
+   {
+      if (argi + 1 >= argc)
+      {
+         return Failure{"--output needs a directory"};
+      }
+      mDestination = argv[argi + 1];
+      argi += 2;
+   }
+
+   if (argc - argi < 1)
+   {
+      return Failure{"Usage: bake-models [--output directory] source..."};
+   }
+
+   for (; argi < argc; ++argi)
+   {
+      if (Maybe<void> result = CollectSources(argv[argi]); !result)
+      {
+         return result.Failure();
+      }
+   }
+
+   // Loading through VoxLoader bakes exactly what a lazy bake at runtime would.
+   Voxel::VoxLoader loader;
+   loader.SetCacheDirectory(mDestination);
+
+   std::vector<Voxel::VoxLoader::Handle> handles;
+   for (const std::string& source : mSources)
+   {
+      handles.push_back(loader.Request(source));
+   }
+
+   size_t failed = 0;
+   for (const Voxel::VoxLoader::Handle& handle : handles)
+   {
+      Maybe<Voxel::VoxModel*> model = handle.Get();
+      if (!model)
+      {
+         Console::Log(model.Failure().GetMessage());
+         ++failed;
+      }
+   }
+
+   if (failed > 0)
+   {
+      return Failure{"Failed to bake {failed} of {total} models", failed, mSources.size()};
+   }
+
+   return FormatString("Baked {count} models into {path}", mSources.size(), mDestination);
+}
+
+Maybe<void> BakeModelsCommand::CollectSources(const std::string& path)
+{
+   DiskFileSystem fs;
+   auto [maybeIsDirectory, isDirectory] = fs.IsDirectory(path);
+   if (!maybeIsDirectory)
+   {
+      return maybeIsDirectory.Failure().WithContext("Failed to check {path}", path);
+   }
+
+   if (!isDirectory)
+   {
+      mSources.push_back(path);
+      return Success;
+   }
+
+   Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(path, false, false);
+   if (!entries)
+   {
+      return entries.Failure().WithContext("Failed to list {path}", path);
+   }
+
+   for (const FileSystem::FileEntry& entry : *entries)
+   {
+      if (StringHelper::EndsWith(entry.name, ".vox"))
+      {
+         mSources.push_back(Paths::Join(path, entry.name));
+      }
+   }
+   return Success;
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,31 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <RGBDesignPatterns/Maybe.h>
+
+namespace CubeWorld
+{
+
+//
+// Bakes .vox models ahead of time, into the same cache VoxLoader fills in lazily.
+//
+class BakeModelsCommand {
+public:
+   BakeModelsCommand() {};
+
+   Maybe<std::string> Run(int argc, char** argv);
+
+private:
+   // Expands directories into the .vox files directly inside them.
+   Maybe<void> CollectSources(const std::string& path);
+
+private:
+   std::string mDestination;
+   std::vector<std::string> mSources;
+};
+
+}; // namespace CubeWorld
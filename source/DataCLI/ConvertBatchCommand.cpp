@@ -0,0 +1,458 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+#include <Engine/Core/FileSystemProvider.h>
+#include <RGBDesignPatterns/Hash.h>
+#include <RGBDesignPatterns/ThreadPool.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBText/StringHelper.h>
+
+#include "Console.h"
+#include "ConvertBatchCommand.h"
+#include "ConvertDocumentCommand.h"
+#include "ConvertModelCommand.h"
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Time spent in each stage, summed across workers.
+struct StageTimes {
+   std::atomic<int64_t> hash{0};
+   std::atomic<int64_t> convert{0};
+
+   static void Add(std::atomic<int64_t>& stage, Clock::time_point start)
+   {
+      stage += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+   }
+};
+
+double Seconds(Clock::time_point start, Clock::time_point end)
+{
+   return std::chrono::duration<double>(end - start).count();
+}
+
+double Seconds(int64_t microseconds)
+{
+   return double(microseconds) / 1000000;
+}
+
+uint64_t HashContents(const std::string& contents)
+{
+   return Fnv1a(contents.data(), contents.size());
+}
+
+// Matches * against any run of characters and ? against any single one.
+bool MatchWildcard(const char* pattern, const char* name)
+{
+   const char* star = nullptr;
+   const char* resume = nullptr;
+   while (*name)
+   {
+      if (*pattern == '*')
+      {
+         star = pattern++;
+         resume = name;
+      }
+      else if (*pattern == '?' || *pattern == *name)
+      {
+         ++pattern;
+         ++name;
+      }
+      else if (star)
+      {
+         // Let the last * swallow one more character and try again.
+         pattern = star + 1;
+         name = ++resume;
+      }
+      else
+      {
+         return false;
+      }
+   }
+
+   while (*pattern == '*')
+   {
+      ++pattern;
+   }
+   return *pattern == '\0';
+}
+
+bool IsModel(const std::string& path)
+{
+   return ConvertModelCommand::Handles(path);
+}
+
+bool IsDocument(const std::string& path)
+{
+   return ConvertDocumentCommand::Handles(path);
+}
+
+}; // anonymous namespace
+
+Maybe<std::string> ConvertBatchCommand::Run(int argc, char** argv)
+{
+   int argi = 0;
+
+   // Parse options...
+   while (argi < argc && argv[argi][0] == '-')
+   {
+      std::string option = argv[argi++];
+      if (option == "--force")
+      {
+         mOptions.force = true;
+         continue;
+      }
+
+      if (argi >= argc)
+      {
+         return Failure{"{option} needs a value", option};
+      }
+
+      if (option == "--threads")
+      {
+         mOptions.numThreads = size_t(std::stoul(argv[argi++]));
+      }
+      else if (option == "--manifest")
+      {
+         mOptions.manifest = argv[argi++];
+      }
+      else if (option == "--to")
+      {
+         mOptions.extension = argv[argi++];
+         if (!mOptions.extension.empty() && mOptions.extension[0] == '.')
+         {
+            mOptions.extension.erase(0, 1);
+         }
+      }
+      else if (option == "--out")
+      {
+         mOptions.outputDirectory = argv[argi++];
+      }
+      else if (option == "--cache")
+      {
+         mOptions.cache = argv[argi++];
+      }
+      else
+      {
+         return Failure{"Unrecognized option {option}", option};
+      }
+   }
+
+   if (mOptions.manifest.empty() == (argi == argc) || (argi < argc && mOptions.extension.empty()))
+   {
+      return Failure{"Usage: convert-batch [--threads N] [--force] [--cache file] --manifest file\n"
+                     "       convert-batch [--threads N] [--force] [--cache file] --to ext [--out directory] pattern..."};
+   }
+
+   // Resolved here so the workers all share it, rather than racing to create it.
+   FileSystem& fs = *Engine::FileSystemProvider::Instance().get();
+
+   const Clock::time_point start = Clock::now();
+
+   if (!mOptions.manifest.empty())
+   {
+      if (Maybe<void> result = ReadManifest(fs); !result)
+      {
+         return result.Failure();
+      }
+   }
+
+   for (; argi < argc; ++argi)
+   {
+      if (Maybe<void> result = ExpandPattern(fs, argv[argi]); !result)
+      {
+         return result.Failure();
+      }
+   }
+
+   std::set<std::string> directories;
+   for (const Job& job : mJobs)
+   {
+      bool sameKind = (IsModel(job.source) && IsModel(job.destination)) ||
+                      (IsDocument(job.source) && IsDocument(job.destination));
+      if (!sameKind)
+      {
+         return Failure{"Can't convert {source} to {destination}", job.source, job.destination};
+      }
+
+      if (job.destination.find('/') != std::string::npos)
+      {
+         directories.insert(Paths::GetDirectory(job.destination));
+      }
+   }
+
+   for (const std::string& directory : directories)
+   {
+      if (Maybe<void> result = fs.MakeDirectory(directory); !result)
+      {
+         return result.Failure().WithContext("Failed to make directory {path}", directory);
+      }
+   }
+
+   if (Maybe<void> result = ReadCache(fs); !result)
+   {
+      LOG_WARNING("Ignoring conversion cache {path}: {message}", mOptions.cache, result.Failure().GetMessage());
+      mCache.clear();
+   }
+
+   const Clock::time_point scanned = Clock::now();
+
+   enum class Status { Converted, Skipped, Failed };
+   struct Result {
+      Status status = Status::Failed;
+      CacheEntry entry{};
+      Failure failure;
+   };
+
+   StageTimes times;
+   std::vector<Result> results(mJobs.size());
+   {
+      size_t numThreads = mOptions.numThreads > 0 ? mOptions.numThreads : std::thread::hardware_concurrency();
+      ThreadPool pool(numThreads);
+
+      for (size_t i = 0; i < mJobs.size(); ++i)
+      {
+         pool.Submit([&, i] {
+            const Job& job = mJobs[i];
+            Result& result = results[i];
+
+            Clock::time_point hashStart = Clock::now();
+            Maybe<std::string> source = fs.ReadEntireFile(job.source);
+            if (!source)
+            {
+               result.failure = source.Failure().WithContext("Failed to read {path}", job.source);
+               StageTimes::Add(times.hash, hashStart);
+               return;
+            }
+            result.entry.sourceHash = HashContents(*source);
+
+            if (auto it = mCache.find(job.destination); !mOptions.force && it != mCache.end() && it->second.sourceHash == result.entry.sourceHash)
+            {
+               // Only trust the cache if the destination is still exactly what we wrote.
+               Maybe<std::string> destination = fs.ReadEntireFile(job.destination);
+               if (destination && HashContents(*destination) == it->second.destinationHash)
+               {
+                  result.status = Status::Skipped;
+                  result.entry = it->second;
+                  StageTimes::Add(times.hash, hashStart);
+                  return;
+               }
+            }
+            StageTimes::Add(times.hash, hashStart);
+
+            Clock::time_point convertStart = Clock::now();
+            Maybe<void> converted = IsModel(job.source) ?
+               ConvertModelCommand::Convert(job.source, job.destination) :
+               ConvertDocumentCommand::Convert(fs, job.source, job.destination);
+            StageTimes::Add(times.convert, convertStart);
+            if (!converted)
+            {
+               result.failure = converted.Failure();
+               return;
+            }
+
+            hashStart = Clock::now();
+            Maybe<std::string> destination = fs.ReadEntireFile(job.destination);
+            StageTimes::Add(times.hash, hashStart);
+            if (!destination)
+            {
+               result.failure = destination.Failure().WithContext("Failed to read back {path}", job.destination);
+               return;
+            }
+
+            result.entry.destinationHash = HashContents(*destination);
+            result.status = Status::Converted;
+         });
+      }
+   }
+
+   const Clock::time_point converted = Clock::now();
+
+   size_t numConverted = 0, numSkipped = 0, numFailed = 0;
+   for (size_t i = 0; i < mJobs.size(); ++i)
+   {
+      const Result& result = results[i];
+      switch (result.status)
+      {
+      case Status::Converted:
+         ++numConverted;
+         mCache[mJobs[i].destination] = result.entry;
+         break;
+      case Status::Skipped:
+         ++numSkipped;
+         break;
+      case Status::Failed:
+         ++numFailed;
+         mCache.erase(mJobs[i].destination);
+         Console::Log(result.failure.GetMessage());
+         break;
+      }
+   }
+
+   const Clock::time_point tallied = Clock::now();
+   if (Maybe<void> result = WriteCache(fs); !result)
+   {
+      LOG_WARNING("Failed to save conversion cache {path}: {message}", mOptions.cache, result.Failure().GetMessage());
+   }
+
+   const Clock::time_point end = Clock::now();
+
+   Console::Log("Scan:      {time}s", Seconds(start, scanned));
+   Console::Log("Hash:      {time}s (across all workers)", Seconds(times.hash));
+   Console::Log("Convert:   {time}s (across all workers)", Seconds(times.convert));
+   Console::Log("Tally:     {time}s", Seconds(converted, tallied));
+   Console::Log("Save:      {time}s", Seconds(tallied, end));
+   Console::Log("Total:     {time}s", Seconds(start, end));
+
+   if (numFailed > 0)
+   {
+      return Failure{"Failed to convert {failed} of {total} files", numFailed, mJobs.size()};
+   }
+
+   return FormatString("Converted {converted} files, skipped {skipped} up to date", numConverted, numSkipped);
+}
+
+Maybe<void> ConvertBatchCommand::ReadManifest(FileSystem& fs)
+{
+   Maybe<std::string> contents = fs.ReadEntireFile(mOptions.manifest);
+   if (!contents)
+   {
+      return contents.Failure().WithContext("Failed to read manifest {path}", mOptions.manifest);
+   }
+
+   // Relative paths are relative to the manifest, not to wherever the command runs.
+   std::string base = mOptions.manifest.find('/') != std::string::npos ? Paths::GetDirectory(mOptions.manifest) : "";
+   auto resolve = [&](const std::string& path) {
+      return base.empty() || Paths::IsAbsolute(path) ? path : Paths::Join(base, path);
+   };
+
+   std::istringstream lines(*contents);
+   std::string line;
+   for (size_t lineNumber = 1; std::getline(lines, line); ++lineNumber)
+   {
+      std::istringstream words(line);
+      std::string source, destination, extra;
+      if (!(words >> source) || source[0] == '#')
+      {
+         continue;
+      }
+
+      if (!(words >> destination) || (words >> extra))
+      {
+         return Failure{"{path}:{line}: Expected \"source destination\"", mOptions.manifest, lineNumber};
+      }
+
+      mJobs.push_back(Job{resolve(source), resolve(destination)});
+   }
+
+   return Success;
+}
+
+Maybe<void> ConvertBatchCommand::ExpandPattern(FileSystem& fs, const std::string& pattern)
+{
+   std::string directory = pattern.find('/') != std::string::npos ? Paths::GetDirectory(pattern) : "";
+   std::string filePattern = Paths::GetFilename(pattern);
+   std::string outputDirectory = mOptions.outputDirectory.empty() ? directory : mOptions.outputDirectory;
+
+   auto destinationFor = [&](const std::string& filename) {
+      std::string name = Paths::GetBasename(filename) + "." + mOptions.extension;
+      return outputDirectory.empty() ? name : Paths::Join(outputDirectory, name);
+   };
+
+   if (filePattern.find_first_of("*?") == std::string::npos)
+   {
+      mJobs.push_back(Job{pattern, destinationFor(filePattern)});
+      return Success;
+   }
+
+   Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(directory.empty() ? "." : directory, false, false);
+   if (!entries)
+   {
+      return entries.Failure().WithContext("Failed to list {path}", directory);
+   }
+
+   std::vector<std::string> matches;
+   for (const FileSystem::FileEntry& entry : *entries)
+   {
+      std::string name = Paths::GetFilename(entry.name);
+      if (MatchWildcard(filePattern.c_str(), name.c_str()))
+      {
+         matches.push_back(name);
+      }
+   }
+
+   if (matches.empty())
+   {
+      return Failure{"No files match {pattern}", pattern};
+   }
+
+   std::sort(matches.begin(), matches.end());
+   for (const std::string& match : matches)
+   {
+      mJobs.push_back(Job{directory.empty() ? match : Paths::Join(directory, match), destinationFor(match)});
+   }
+
+   return Success;
+}
+
+Maybe<void> ConvertBatchCommand::ReadCache(FileSystem& fs)
+{
+   auto [_1, exists] = fs.Exists(mOptions.cache);
+   if (!exists)
+   {
+      return Success;
+   }
+
+   Maybe<std::string> contents = fs.ReadEntireFile(mOptions.cache);
+   if (!contents)
+   {
+      return contents.Failure();
+   }
+
+   // Each line is "sourceHash destinationHash destination", with hashes in hex.
+   std::istringstream lines(*contents);
+   std::string line;
+   while (std::getline(lines, line))
+   {
+      std::istringstream words(line);
+      CacheEntry entry;
+      std::string destination;
+      if (!(words >> std::hex >> entry.sourceHash >> entry.destinationHash) || !std::getline(words >> std::ws, destination))
+      {
+         return Failure{"Malformed line \"{line}\"", line};
+      }
+
+      mCache[destination] = entry;
+   }
+
+   return Success;
+}
+
+Maybe<void> ConvertBatchCommand::WriteCache(FileSystem& fs)
+{
+   // Sorted, so the file doesn't churn between runs.
+   std::vector<std::pair<std::string, CacheEntry>> entries(mCache.begin(), mCache.end());
+   std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+   std::ostringstream out;
+   out << std::hex << std::setfill('0');
+   for (const auto& [destination, entry] : entries)
+   {
+      out << std::setw(16) << entry.sourceHash << ' ' << std::setw(16) << entry.destinationHash << ' ' << destination << '\n';
+   }
+
+   return fs.WriteFile(mOptions.cache, out.str());
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,71 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <RGBFileSystem/FileSystem.h>
+
+namespace CubeWorld
+{
+
+//
+// Runs convert-model and convert-document over many files at once. Jobs come either
+// from a manifest of "source destination" lines, or from wildcard patterns plus the
+// extension to convert to. Every job shares one file system and runs on a pool of
+// workers.
+//
+// Each run records a hash of every source and destination it wrote in a cache file,
+// so the next run can skip outputs whose source hasn't changed and whose destination
+// hasn't been touched since.
+//
+class ConvertBatchCommand {
+public:
+   struct Options {
+      // Workers for converting. 0 means one per core.
+      size_t numThreads = 0;
+
+      // Convert everything, even outputs that are up to date.
+      bool force = false;
+
+      std::string manifest;
+      std::string extension;
+      std::string outputDirectory;
+      std::string cache = ".convert-cache";
+   };
+
+   ConvertBatchCommand() {};
+
+   Maybe<std::string> Run(int argc, char** argv);
+
+private:
+   struct Job {
+      std::string source;
+      std::string destination;
+   };
+
+   struct CacheEntry {
+      uint64_t sourceHash;
+      uint64_t destinationHash;
+   };
+
+   Maybe<void> ReadManifest(FileSystem& fs);
+
+   // Wildcards (* and ?) are only allowed in the filename, not in directories.
+   Maybe<void> ExpandPattern(FileSystem& fs, const std::string& pattern);
+
+   Maybe<void> ReadCache(FileSystem& fs);
+   Maybe<void> WriteCache(FileSystem& fs);
+
+private:
+   Options mOptions;
+
+   std::vector<Job> mJobs;
+
+   // Keyed by destination.
+   std::unordered_map<std::string, CacheEntry> mCache;
+};
+
+}; // namespace CubeWorld
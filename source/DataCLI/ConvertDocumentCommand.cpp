@@ -2,6 +2,7 @@
 
 #include <RGBBinding/BindingProperty.h>
 #include <RGBLogger/Logger.h>
+#include <RGBNetworking/BinarySerializer.h>
 #include <RGBNetworking/JSONSerializer.h>
 #include <RGBNetworking/YAMLSerializer.h>
 #include <RGBText/StringHelper.h>
@@ -24,37 +25,76 @@ Maybe<std::string> ConvertDocumentCommand::Run(int argc, char** argv)
    mSource = argv[argi++];
    mDestination = argv[argi++];
 
-   Maybe<BindingProperty> data;
-   if (StringHelper::EndsWith(mSource, ".json"))
+   DiskFileSystem fs;
+   if (Maybe<void> result = Convert(fs, mSource, mDestination); !result)
    {
-      data = JSONSerializer::DeserializeFile(mSource);
+      return result.Failure();
    }
-   else if (StringHelper::EndsWith(mSource, ".yaml"))
+
+   return mDestination;
+}
+
+namespace
+{
+
+Maybe<BindingProperty> ReadDocument(FileSystem& fs, const std::string& path)
+{
+   if (StringHelper::EndsWith(path, ".json"))
    {
-      data = YAMLSerializer::DeserializeFile(mSource);
+      return JSONSerializer::DeserializeFile(fs, path);
    }
-
-   if (!data)
+   else if (StringHelper::EndsWith(path, ".yaml"))
+   {
+      return YAMLSerializer::DeserializeFile(fs, path);
+   }
+   else if (StringHelper::EndsWith(path, ".bpb"))
    {
-      return data.Failure().WithContext("Failed to load source file {path}", mSource);
+      return BinarySerializer::DeserializeFile(fs, path);
    }
 
-   Maybe<void> result;
-   if (StringHelper::EndsWith(mDestination, ".json"))
+   return Failure{"Unrecognized document format"};
+}
+
+Maybe<void> WriteDocument(FileSystem& fs, const std::string& path, const BindingProperty& data)
+{
+   if (StringHelper::EndsWith(path, ".json"))
    {
-      result = JSONSerializer::SerializeFile(mDestination, *data);
+      return JSONSerializer::SerializeFile(fs, path, data);
    }
-   else if (StringHelper::EndsWith(mDestination, ".yaml"))
+   else if (StringHelper::EndsWith(path, ".yaml"))
    {
-      result = YAMLSerializer::SerializeFile(mDestination, *data);
+      return YAMLSerializer::SerializeFile(fs, path, data);
    }
+   else if (StringHelper::EndsWith(path, ".bpb"))
+   {
+      return BinarySerializer::SerializeFile(fs, path, data);
+   }
+
+   return Failure{"Unrecognized document format"};
+}
+
+}; // anonymous namespace
+
+bool ConvertDocumentCommand::Handles(const std::string& path)
+{
+   return StringHelper::EndsWith(path, ".json") || StringHelper::EndsWith(path, ".yaml") || StringHelper::EndsWith(path, ".bpb");
+}
 
+Maybe<void> ConvertDocumentCommand::Convert(FileSystem& fs, const std::string& source, const std::string& destination)
+{
+   Maybe<BindingProperty> data = ReadDocument(fs, source);
+   if (!data)
+   {
+      return data.Failure().WithContext("Failed to load source file {path}", source);
+   }
+
+   Maybe<void> result = WriteDocument(fs, destination, *data);
    if (!result)
    {
-      return result.Failure().WithContext("Failed to write destination file {path}", mDestination);
+      return result.Failure().WithContext("Failed to write destination file {path}", destination);
    }
 
-   return mDestination;
+   return Success;
 }
 
 }; // namespace CubeWorld
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include <RGBFileSystem/FileSystem.h>
 #include <RGBFileSystem/Paths.h>
 
 namespace CubeWorld
@@ -20,6 +21,12 @@ public:
 
    Maybe<std::string> Run(int argc, char** argv);
 
+   // Whether Convert can read or write path, based on its extension.
+   static bool Handles(const std::string& path);
+
+   // Converts one document. Safe to call from several threads at once.
+   static Maybe<void> Convert(FileSystem& fs, const std::string& source, const std::string& destination);
+
 private:
    Options mOptions;
 
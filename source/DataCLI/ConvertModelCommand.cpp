@@ -29,37 +29,67 @@ Maybe<std::string> ConvertModelCommand::Run(int argc, char** argv)
    mSource = argv[argi++];
    mDestination = argv[argi++];
 
-   Maybe<std::unique_ptr<Voxel::ModelData>> maybeModel;
-   if (StringHelper::EndsWith(mSource, ".cub"))
+   if (Maybe<void> result = Convert(mSource, mDestination); !result)
    {
-      maybeModel = Voxel::CubeFormat::Read(mSource, false);
+      return result.Failure();
    }
-   else if (StringHelper::EndsWith(mSource, ".vox"))
+
+   return mDestination;
+}
+
+namespace
+{
+
+Maybe<std::unique_ptr<Voxel::ModelData>> ReadModel(const std::string& path)
+{
+   if (StringHelper::EndsWith(path, ".cub"))
    {
-      maybeModel = Voxel::VoxFormat::Read(mSource, false);
+      return Voxel::CubeFormat::Read(path, false);
    }
-
-   if (!maybeModel)
+   else if (StringHelper::EndsWith(path, ".vox"))
    {
-      return maybeModel.Failure().WithContext("Failed to load source file {path}", mSource);
+      return Voxel::VoxFormat::Read(path, false);
    }
 
-   Maybe<void> result;
-   if (StringHelper::EndsWith(mDestination, ".cub"))
+   return Failure{"Unrecognized model format"};
+}
+
+Maybe<void> WriteModel(const std::string& path, const Voxel::ModelData& model)
+{
+   if (StringHelper::EndsWith(path, ".cub"))
    {
-      result = Voxel::CubeFormat::Write(mDestination, *(maybeModel->get()));
+      return Voxel::CubeFormat::Write(path, model);
    }
-   else if (StringHelper::EndsWith(mDestination, ".vox"))
+   else if (StringHelper::EndsWith(path, ".vox"))
    {
-      result = Voxel::VoxFormat::Write(mDestination, *(maybeModel->get()));
+      return Voxel::VoxFormat::Write(path, model);
    }
 
+   return Failure{"Unrecognized model format"};
+}
+
+}; // anonymous namespace
+
+bool ConvertModelCommand::Handles(const std::string& path)
+{
+   return StringHelper::EndsWith(path, ".cub") || StringHelper::EndsWith(path, ".vox");
+}
+
+Maybe<void> ConvertModelCommand::Convert(const std::string& source, const std::string& destination)
+{
+   Maybe<std::unique_ptr<Voxel::ModelData>> maybeModel = ReadModel(source);
+   if (!maybeModel)
+   {
+      return maybeModel.Failure().WithContext("Failed to load source file {path}", source);
+   }
+
+   Maybe<void> result = WriteModel(destination, *(maybeModel->get()));
    if (!result)
    {
-      return result.Failure().WithContext("Failed to write destination file {path}", mDestination);
+      return result.Failure().WithContext("Failed to write destination file {path}", destination);
    }
 
-   return mDestination;
+   return Success;
 }
 
 }; // namespace CubeWorld
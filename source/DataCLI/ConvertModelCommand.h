@@ -20,6 +20,12 @@ public:
 
    Maybe<std::string> Run(int argc, char** argv);
 
+   // Whether Convert can read or write path, based on its extension.
+   static bool Handles(const std::string& path);
+
+   // Converts one model. Safe to call from several threads at once.
+   static Maybe<void> Convert(const std::string& source, const std::string& destination);
+
 private:
    Options mOptions;
 
@@ -20,6 +20,11 @@ struct Database::Statements {
    // SELECT key, value FROM blobs WHERE key=?
    //
    sqlite3_stmt* selectBlob;
+
+   //
+   // SELECT rowid, key, length(value) FROM blobs
+   //
+   sqlite3_stmt* listBlobInfo;
 };
 
 Failure SqliteFailure(int rc, const std::string& action)
@@ -72,6 +77,12 @@ Maybe<void> Database::PrepareStatements(sqlite3* db, Statements* stmts)
       return SqliteFailure(rc, "prepare select blob query");
    }
 
+   const char kSelectAllBlobInfo[] = "SELECT rowid, key, length(value) FROM blobs";
+   if (int rc = sqlite3_prepare_v3(db, kSelectAllBlobInfo, -1, flags, &stmts->listBlobInfo, nullptr); rc != SQLITE_OK)
+   {
+      return SqliteFailure(rc, "prepare select all blob info query");
+   }
+
    return Success;
 }
 
@@ -105,4 +116,55 @@ Maybe<void> Database::EnumerateBlobs(const BlobCallback& callback)
    return Success;
 }
 
+Maybe<void> Database::EnumerateBlobInfo(const BlobInfoCallback& callback)
+{
+   int rc = sqlite3_step(mStatements->listBlobInfo);
+   CUBEWORLD_SCOPE_EXIT([&] { sqlite3_reset(mStatements->listBlobInfo); })
+
+   while (rc == SQLITE_ROW)
+   {
+      BlobInfo info;
+      info.rowid = sqlite3_column_int64(mStatements->listBlobInfo, 0);
+      info.key = std::string((char*)sqlite3_column_text(mStatements->listBlobInfo, 1));
+      info.size = size_t(sqlite3_column_int64(mStatements->listBlobInfo, 2));
+
+      Maybe<void> result = callback(info);
+      if (!result)
+      {
+         return result.Failure().WithContext("Failed during enumeration");
+      }
+
+      rc = sqlite3_step(mStatements->listBlobInfo);
+   }
+
+   if (rc != SQLITE_DONE)
+   {
+      return SqliteFailure(rc, "step mListBlobInfo");
+   }
+
+   return Success;
+}
+
+Maybe<void> Database::ReadBlob(const BlobInfo& info, void* data)
+{
+   sqlite3_blob* blob;
+   if (int rc = sqlite3_blob_open(mDatabase, "main", "blobs", "value", info.rowid, 0, &blob); rc != SQLITE_OK)
+   {
+      return SqliteFailure(rc, "open blob " + info.key);
+   }
+   CUBEWORLD_SCOPE_EXIT([&] { sqlite3_blob_close(blob); })
+
+   if (size_t(sqlite3_blob_bytes(blob)) != info.size)
+   {
+      return Failure{"Blob {key} is {size} bytes, expected {expected}", info.key, sqlite3_blob_bytes(blob), info.size};
+   }
+
+   if (int rc = sqlite3_blob_read(blob, data, int(info.size), 0); rc != SQLITE_OK)
+   {
+      return SqliteFailure(rc, "read blob " + info.key);
+   }
+
+   return Success;
+}
+
 }; // namespace CubeWorld
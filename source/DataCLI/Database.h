@@ -22,12 +22,22 @@ public:
       std::vector<uint8_t> value;
    };
 
+   //
+   // Where a blob lives, without its value. Read the value with ReadBlob.
+   //
+   struct BlobInfo {
+      int64_t rowid;
+      std::string key;
+      size_t size;
+   };
+
    //
    // Callback to be performed on a blob entry.
    //
    // Return value is a Maybe<void>. Pass Success to continue execution.
    //
    using BlobCallback = std::function<Maybe<void>(const Blob&)>;
+   using BlobInfoCallback = std::function<Maybe<void>(const BlobInfo&)>;
 
 private:
    //
@@ -42,6 +52,18 @@ public:
 
    Maybe<void> EnumerateBlobs(const BlobCallback& callback);
 
+   //
+   // Like EnumerateBlobs, but never loads any values, so memory use doesn't depend on
+   // how big they are.
+   //
+   Maybe<void> EnumerateBlobInfo(const BlobInfoCallback& callback);
+
+   //
+   // Reads a blob's value straight into data, which must have room for info.size bytes.
+   // Safe to call from inside EnumerateBlobInfo's callback.
+   //
+   Maybe<void> ReadBlob(const BlobInfo& info, void* data);
+
 private:
    static Maybe<void> PrepareStatements(sqlite3* db, Statements* stmts);
 
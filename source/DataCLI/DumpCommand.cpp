@@ -1,8 +1,13 @@
 // By Thomas Steinke
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <sqlite3.h>
 
 #include <RGBDesignPatterns/Scope.h>
+#include <RGBDesignPatterns/ThreadPool.h>
 #include <RGBFileSystem/FileSystem.h>
 #include <RGBFileSystem/Paths.h>
 
@@ -14,14 +19,79 @@
 namespace CubeWorld
 {
 
+namespace
+{
+
+//
+// Caps how many blobs, and how many bytes of them, are in memory at once. A single
+// blob bigger than the whole budget is still let through on its own.
+//
+class InFlightLimit {
+public:
+   InFlightLimit(size_t maxBytes, size_t maxBlobs) : mMaxBytes(maxBytes), mMaxBlobs(maxBlobs) {}
+
+   void Acquire(size_t bytes)
+   {
+      std::unique_lock<std::mutex> lock{mMutex};
+      mCondition.wait(lock, [&] {
+         return mBlobs == 0 || (mBlobs < mMaxBlobs && mBytes + bytes <= mMaxBytes);
+      });
+      mBytes += bytes;
+      ++mBlobs;
+   }
+
+   void Release(size_t bytes)
+   {
+      {
+         std::unique_lock<std::mutex> lock{mMutex};
+         mBytes -= bytes;
+         --mBlobs;
+      }
+      mCondition.notify_all();
+   }
+
+private:
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+
+   size_t mMaxBytes;
+   size_t mMaxBlobs;
+   size_t mBytes = 0;
+   size_t mBlobs = 0;
+};
+
+double Megabytes(size_t bytes)
+{
+   return double(bytes) / (1024 * 1024);
+}
+
+}; // anonymous namespace
+
 Maybe<std::string> DumpCommand::Run(int argc, char** argv)
 {
    int argi = 0;
+
    // Parse options...
+   while (argi + 1 < argc && argv[argi][0] == '-')
+   {
+      std::string option = argv[argi++];
+      if (option == "--threads")
+      {
+         mOptions.numThreads = size_t(std::stoul(argv[argi++]));
+      }
+      else if (option == "--memory")
+      {
+         mOptions.maxBytesInFlight = size_t(std::stoul(argv[argi++])) * 1024 * 1024;
+      }
+      else
+      {
+         return Failure{"Unrecognized option {option}", option};
+      }
+   }
 
    if (argc - argi < 2)
    {
-      return Failure{"Usage: dump [opts] filename destination"};
+      return Failure{"Usage: dump [--threads N] [--memory MB] filename destination"};
    }
 
    mFilename = argv[argi++];
@@ -41,33 +111,95 @@ Maybe<std::string> DumpCommand::Run(int argc, char** argv)
 
    std::unique_ptr<Database> database = std::move(*maybeDb);
 
-   DiskFileSystem fs{};
-   database->EnumerateBlobs([&](const Database::Blob& blob) -> Maybe<void> {
-      std::string path = Paths::Join(mDestination, blob.key);
-      Maybe<FileSystem::FileHandle> maybeHandle = fs.OpenFileWrite(path);
-      if (!maybeHandle)
-      {
-         return maybeHandle.Failure().WithContext("Failed opening {path} for writing", path);
-      }
+   const auto start = std::chrono::steady_clock::now();
+   auto lastProgress = start;
 
-      FileSystem::FileHandle handle = *maybeHandle;
-      CUBEWORLD_SCOPE_EXIT([&]() { fs.CloseFile(handle); })
+   std::atomic<size_t> blobsWritten{0};
+   std::atomic<size_t> bytesWritten{0};
 
-      Scrambler scrambler{};
+   // The first write to fail, which stops any more blobs from being read.
+   std::mutex failureMutex;
+   std::atomic<bool> failed{false};
+   Failure failure;
 
-      scrambler.Unscramble((char*)&blob.value[0], sizeof(uint8_t) * blob.value.size());
+   size_t numThreads = mOptions.numThreads > 0 ? mOptions.numThreads : std::thread::hardware_concurrency();
+   InFlightLimit limit(mOptions.maxBytesInFlight, 2 * std::max<size_t>(numThreads, 1));
 
-      if (Maybe<void> write = fs.WriteFile(handle, (void*)&blob.value[0], sizeof(uint8_t) * blob.value.size()); !write)
+   {
+      // Declared last, so everything it touches outlives the workers.
+      DiskFileSystem fs{};
+      ThreadPool pool(numThreads);
+
+      Maybe<void> enumerated = database->EnumerateBlobInfo([&](const Database::BlobInfo& info) -> Maybe<void> {
+         if (failed)
+         {
+            return Failure{"Stopped after a failed write"};
+         }
+
+         // Reading happens here, since the database connection belongs to this thread.
+         limit.Acquire(info.size);
+         std::string data(info.size, '\0');
+         if (Maybe<void> read = database->ReadBlob(info, &data[0]); !read)
+         {
+            limit.Release(info.size);
+            return read.Failure();
+         }
+
+         std::string path = Paths::Join(mDestination, info.key);
+         pool.Submit([&, path = std::move(path), data = std::move(data)]() mutable {
+            Scrambler scrambler{};
+            scrambler.Unscramble(&data[0], data.size());
+
+            Maybe<void> write = fs.WriteFile(path, data);
+            limit.Release(data.size());
+            if (!write)
+            {
+               std::unique_lock<std::mutex> lock{failureMutex};
+               if (!failed)
+               {
+                  failure = write.Failure().WithContext("Failed writing {path}", path);
+                  failed = true;
+               }
+               return;
+            }
+
+            ++blobsWritten;
+            bytesWritten += data.size();
+         });
+
+         auto now = std::chrono::steady_clock::now();
+         if (now - lastProgress >= std::chrono::seconds(1))
+         {
+            lastProgress = now;
+            LOG_ALWAYS("Exported {count} blobs ({size} MB)", size_t(blobsWritten), Megabytes(bytesWritten));
+         }
+
+         return Success;
+      });
+
+      if (!enumerated)
       {
-         return write.Failure();
+         std::unique_lock<std::mutex> lock{failureMutex};
+         if (!failed)
+         {
+            failure = enumerated.Failure();
+            failed = true;
+         }
       }
+   }
 
-      LOG_ALWAYS("Exported {key}", blob.key);
-
-      return Success;
-   });
+   if (failed)
+   {
+      return failure;
+   }
 
-   return std::string("Done.");
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   return FormatString("Done. Exported {count} blobs ({size} MB) in {time}s, {rate} MB/s.",
+      size_t(blobsWritten),
+      Megabytes(bytesWritten),
+      seconds,
+      seconds > 0 ? Megabytes(bytesWritten) / seconds : 0.0
+   );
 }
 
 }; // namespace CubeWorld
@@ -10,10 +10,19 @@
 namespace CubeWorld
 {
 
+//
+// Dumps every blob in a database to its own file, unscrambled. Blobs are read one at a
+// time and handed to a pool of workers to unscramble and write, with a cap on how much
+// is held in memory at once, so databases of any size dump in bounded memory.
+//
 class DumpCommand {
 public:
    struct Options {
+      // Workers for unscrambling and writing. 0 means one per core.
+      size_t numThreads = 0;
 
+      // Stop reading new blobs while this much is waiting to be written.
+      size_t maxBytesInFlight = 64 * 1024 * 1024;
    };
 
    DumpCommand() {};
@@ -12,7 +12,9 @@
 #include <RGBLogger/DebugLogger.h>
 #include <RGBLogger/StdoutLogger.h>
 
+#include "BakeModelsCommand.h"
 #include "Console.h"
+#include "ConvertBatchCommand.h"
 #include "ConvertModelCommand.h"
 #include "ConvertDocumentCommand.h"
 #include "Database.h"
@@ -28,7 +30,9 @@ int main(int argc, char **argv)
    if (argc < 2)
    {
       Console::Log("Usage: datacli COMMAND\n");
-      Console::Log("Commands:      convert-model\n");
+      Console::Log("Commands:      bake-models\n");
+      Console::Log("               convert-batch\n");
+      Console::Log("               convert-model\n");
       Console::Log("               convert-document\n");
       Console::Log("               dump");
       return 1;
@@ -36,7 +40,17 @@ int main(int argc, char **argv)
 
    Maybe<std::string> result;
    std::string command = argv[1];
-   if (command == "convert-model")
+   if (command == "bake-models")
+   {
+      BakeModelsCommand cmd{};
+      result = cmd.Run(argc - 2, argv + 2);
+   }
+   else if (command == "convert-batch")
+   {
+      ConvertBatchCommand cmd{};
+      result = cmd.Run(argc - 2, argv + 2);
+   }
+   else if (command == "convert-model")
    {
       ConvertModelCommand cmd{};
       result = cmd.Run(argc - 2, argv + 2);
@@ -1,11 +1,17 @@
 // By Thomas Steinke
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "Scrambler.h"
 
 namespace CubeWorld
 {
 
-const uint32_t Scrambler::offsets[] = {
+const uint32_t Scrambler::offsets[kNumOffsets] = {
    0x1092, 0x254F, 0x348, 0x14B40, 0x241A, 0x2676, 0x7F, 0x9, 0x250B,
    0x18A, 0x7B, 0x12E2, 0x7EBC, 0x5F23, 0x981, 0x11, 0x85BA, 0x0A566,
    0x1093, 0x0E, 0x2D266, 0x7C3, 0x0C16, 0x76D, 0x15D41, 0x12CD,
@@ -15,33 +21,91 @@ const uint32_t Scrambler::offsets[] = {
 
 void Scrambler::Scramble(char* data, size_t size)
 {
-   for (size_t i = 0; i < size; i++)
+   if (size == 0)
    {
-      data[i] = (char)(-1 - data[i]);
+      return;
    }
 
+   Invert(data, size);
+
+   uint32_t reduced[kNumOffsets];
+   ReduceOffsets(size, reduced);
+
+   size_t k = 0;
    for (size_t currOff = 0; currOff < size; currOff++)
    {
-      size_t offset = (currOff + offsets[currOff % 44]) % size;
+      size_t offset = currOff + reduced[k];
+      if (offset >= size)
+      {
+         offset -= size;
+      }
 
       char temp = data[currOff];
       data[currOff] = data[offset];
       data[offset] = temp;
+
+      k = (k + 1 == kNumOffsets) ? 0 : k + 1;
    }
 }
 
 void Scrambler::Unscramble(char* data, size_t size)
 {
-   for (int currOff = int(size) - 1; currOff >= 0; --currOff)
+   if (size == 0)
+   {
+      return;
+   }
+
+   uint32_t reduced[kNumOffsets];
+   ReduceOffsets(size, reduced);
+
+   // Undo the swaps in reverse order.
+   size_t k = (size - 1) % kNumOffsets;
+   for (size_t currOff = size; currOff-- > 0;)
    {
-      size_t offset = (currOff + offsets[currOff % 44]) % size;
+      size_t offset = currOff + reduced[k];
+      if (offset >= size)
+      {
+         offset -= size;
+      }
 
       char temp = data[currOff];
       data[currOff] = data[offset];
       data[offset] = temp;
+
+      k = (k == 0) ? kNumOffsets - 1 : k - 1;
+   }
+
+   Invert(data, size);
+}
+
+void Scrambler::ReduceOffsets(size_t size, uint32_t reduced[kNumOffsets])
+{
+   for (size_t i = 0; i < kNumOffsets; i++)
+   {
+      reduced[i] = uint32_t(offsets[i] % size);
+   }
+}
+
+void Scrambler::Invert(char* data, size_t size)
+{
+   // -1 - x is just ~x.
+   size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+   const __m128i ones = _mm_set1_epi8(-1);
+   for (; i + 16 <= size; i += 16)
+   {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(block, ones));
+   }
+#elif defined(__ARM_NEON)
+   for (; i + 16 <= size; i += 16)
+   {
+      uint8_t* block = reinterpret_cast<uint8_t*>(data + i);
+      vst1q_u8(block, vmvnq_u8(vld1q_u8(block)));
    }
+#endif
 
-   for (size_t i = 0; i < size; i++)
+   for (; i < size; i++)
    {
       data[i] = (char)(-1 - data[i]);
    }
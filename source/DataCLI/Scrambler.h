@@ -11,6 +11,11 @@
 namespace CubeWorld
 {
 
+//
+// Scrambling inverts every byte and then shuffles them with a chain of swaps. Each
+// swap depends on the ones before it, so the shuffle stays a scalar loop, but it's
+// kept free of division; the inversion runs 16 bytes at a time where SIMD is available.
+//
 class Scrambler {
 public:
    Scrambler() {};
@@ -20,7 +25,12 @@ public:
    void Unscramble(char* data, size_t size);
 
 private:
-   const static uint32_t offsets[];
+   static constexpr size_t kNumOffsets = 44;
+   const static uint32_t offsets[kNumOffsets];
+
+   // offsets, each taken modulo size, so the swap loops never have to divide.
+   static void ReduceOffsets(size_t size, uint32_t reduced[kNumOffsets]);
+   static void Invert(char* data, size_t size);
 };
 
 }; // namespace CubeWorld
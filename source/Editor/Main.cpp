@@ -16,11 +16,13 @@
 #include <RGBLogger/DebugLogger.h>
 #include <RGBSettings/SettingsProvider.h>
 
+#include <Engine/Core/FrameAllocator.h>
 #include <Engine/Core/Input.h>
 #include <Engine/Core/Timer.h>
 #include <Engine/Core/Window.h>
 #include <Shared/DebugHelper.h>
 #include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxLoader.h>
 #include <Shared/UI/Swapper.h>
 
 #include "AnimationStation/Editor.h"
@@ -57,6 +59,9 @@ int main(int argc, char** argv)
    Logger::StdoutLogger::Instance();
    Logger::DebugLogger::Instance();
 
+   // Bake models as they're loaded, so later runs can skip parsing them.
+   Voxel::VoxLoader::Instance().SetCacheDirectory(Asset::Path("Cache", "Models"));
+
    // Set up settings location
    SettingsProvider::Instance().SetLocalPath("Editor");
 
@@ -240,6 +245,9 @@ int main(int argc, char** argv)
          glm::tvec2<double> pos = window.GetRawMousePosition();
          windowContent.GetCurrent()->Emit<MouseMoveEvent>(pos.x, pos.y);
 
+         // Buffer any models that finished loading in the background.
+         Voxel::VoxLoader::Instance().Finalize();
+
          // Render game state
          {
             windowContentRender.Reset();
@@ -260,6 +268,7 @@ int main(int argc, char** argv)
          // Swap buffers
          {
             window.SwapBuffers();
+            Engine::FrameAllocator::Reset();
             glfwPollEvents();
          }
       }
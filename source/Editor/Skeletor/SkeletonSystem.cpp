@@ -144,15 +144,15 @@ void SkeletonSystem::Update(Engine::EntityManager& entities, Engine::EventManage
 
    entities.Each<Skeleton, VoxModel>([&](Engine::Entity, Skeleton& skeleton, VoxModel& model) {
       size_t nBones = skeleton.bones.size();
-      if (skeleton.bones.size() != model.mParts.size())
+      if (skeleton.bones.size() != model.mTransforms.size())
       {
          LOG_WARNING("Attached model and skeleton have a different amount of parts. Something may look strange");
-         nBones = std::min(skeleton.bones.size(), model.mParts.size());
+         nBones = std::min(skeleton.bones.size(), model.mTransforms.size());
       }
 
       for (size_t b = 0; b < nBones; ++b)
       {
-         model.mParts[b].transform = skeleton.bones[b].matrix;
+         model.mTransforms[b] = skeleton.bones[b].matrix;
       }
    });
 }
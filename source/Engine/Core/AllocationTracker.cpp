@@ -0,0 +1,171 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+
+#include "AllocationTracker.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace
+{
+
+// Innermost scope on this thread, or nullptr.
+thread_local AllocationTracker::Site* tCurrentSite = nullptr;
+
+// Allocations made outside of any scope. These are plain atomics rather than a Site so
+// that they're usable before static initializers have run.
+std::atomic<uint64_t> gUnscopedCount{0};
+std::atomic<uint64_t> gUnscopedBytes{0};
+
+struct AllocationRegistry
+{
+   std::mutex mutex;
+   std::deque<AllocationTracker::Site> sites;
+
+   // Lifetime totals, parallel to sites, plus one for unscoped allocations.
+   std::vector<AllocationTracker::Report> totals{AllocationTracker::Report{"(unscoped)", 0, 0}};
+};
+
+AllocationRegistry& GetAllocationRegistry()
+{
+   static AllocationRegistry registry;
+   return registry;
+}
+
+void SortAllocationReports(std::vector<AllocationTracker::Report>& reports)
+{
+   reports.erase(std::remove_if(reports.begin(), reports.end(), [](const AllocationTracker::Report& report) {
+      return report.count == 0;
+   }), reports.end());
+   std::sort(reports.begin(), reports.end(), [](const AllocationTracker::Report& a, const AllocationTracker::Report& b) {
+      return a.count > b.count;
+   });
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+AllocationTracker::Site* AllocationTracker::GetSite(const std::string& name)
+{
+   AllocationRegistry& registry = GetAllocationRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+   for (Site& site : registry.sites)
+   {
+      if (site.name == name)
+      {
+         return &site;
+      }
+   }
+
+   registry.sites.emplace_back();
+   registry.sites.back().name = name;
+   registry.totals.push_back(Report{name, 0, 0});
+   return &registry.sites.back();
+}
+
+///
+///
+///
+std::vector<AllocationTracker::Report> AllocationTracker::EndFrame()
+{
+   AllocationRegistry& registry = GetAllocationRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+
+   std::vector<Report> reports;
+   reports.reserve(registry.sites.size() + 1);
+   reports.push_back(Report{"(unscoped)", gUnscopedCount.exchange(0), gUnscopedBytes.exchange(0)});
+   for (Site& site : registry.sites)
+   {
+      reports.push_back(Report{site.name, site.count.exchange(0), site.bytes.exchange(0)});
+   }
+
+   for (size_t i = 0; i < reports.size(); ++i)
+   {
+      registry.totals[i].count += reports[i].count;
+      registry.totals[i].bytes += reports[i].bytes;
+   }
+
+   SortAllocationReports(reports);
+   return reports;
+}
+
+///
+///
+///
+std::vector<AllocationTracker::Report> AllocationTracker::GetTotals()
+{
+   AllocationRegistry& registry = GetAllocationRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+
+   std::vector<Report> totals = registry.totals;
+   SortAllocationReports(totals);
+   return totals;
+}
+
+///
+///
+///
+AllocationTracker::Scope::Scope(Site* site)
+   : mPrevious(tCurrentSite)
+{
+   tCurrentSite = site;
+}
+
+AllocationTracker::Scope::~Scope()
+{
+   tCurrentSite = mPrevious;
+}
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
+
+#if CUBEWORLD_TRACK_ALLOCATIONS
+
+namespace
+{
+
+void* TrackedAllocate(size_t size)
+{
+   using CubeWorld::Engine::tCurrentSite;
+   if (tCurrentSite != nullptr)
+   {
+      tCurrentSite->count.fetch_add(1, std::memory_order_relaxed);
+      tCurrentSite->bytes.fetch_add(size, std::memory_order_relaxed);
+   }
+   else
+   {
+      CubeWorld::Engine::gUnscopedCount.fetch_add(1, std::memory_order_relaxed);
+      CubeWorld::Engine::gUnscopedBytes.fetch_add(size, std::memory_order_relaxed);
+   }
+
+   void* result = malloc(size == 0 ? 1 : size);
+   if (result == nullptr)
+   {
+      throw std::bad_alloc();
+   }
+   return result;
+}
+
+}; // anonymous namespace
+
+// The nothrow and aligned variants aren't replaced. The standard nothrow versions
+// forward to these, and nothing in the engine uses over-aligned types.
+void* operator new(size_t size) { return TrackedAllocate(size); }
+void* operator new[](size_t size) { return TrackedAllocate(size); }
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+#endif
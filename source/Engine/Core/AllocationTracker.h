@@ -0,0 +1,82 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// When enabled, global operator new/delete are replaced with versions that count every
+// heap allocation against the innermost ALLOCATION_SCOPE on the current thread. Off by
+// default, since it puts an atomic increment on every allocation.
+//
+#ifndef CUBEWORLD_TRACK_ALLOCATIONS
+#define CUBEWORLD_TRACK_ALLOCATIONS 0
+#endif
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+class AllocationTracker
+{
+public:
+   // A named place in the code that allocations get attributed to.
+   // Sites are never freed, so pointers to them can be cached.
+   struct Site
+   {
+      std::string name;
+      std::atomic<uint64_t> count{0};
+      std::atomic<uint64_t> bytes{0};
+   };
+
+   struct Report
+   {
+      std::string name;
+      uint64_t count;
+      uint64_t bytes;
+   };
+
+public:
+   // Find or create the site with this name.
+   static Site* GetSite(const std::string& name);
+
+   // Close out a frame: returns the allocations made since the last call, by site, busiest first.
+   // Sites with no allocations are left out.
+   static std::vector<Report> EndFrame();
+
+   // Lifetime totals, by site, busiest first.
+   static std::vector<Report> GetTotals();
+
+   //
+   // Attributes allocations on this thread to a site, for as long as it's alive.
+   //
+   class Scope
+   {
+   public:
+      Scope(Site* site);
+      ~Scope();
+
+   private:
+      Site* mPrevious;
+   };
+};
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
+
+#if CUBEWORLD_TRACK_ALLOCATIONS
+#define ALLOCATION_SCOPE_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_SCOPE_CONCAT(a, b) ALLOCATION_SCOPE_CONCAT_INNER(a, b)
+#define ALLOCATION_SCOPE(name) \
+   static ::CubeWorld::Engine::AllocationTracker::Site* ALLOCATION_SCOPE_CONCAT(_allocationSite, __LINE__) = \
+      ::CubeWorld::Engine::AllocationTracker::GetSite(name); \
+   ::CubeWorld::Engine::AllocationTracker::Scope ALLOCATION_SCOPE_CONCAT(_allocationScope, __LINE__){ALLOCATION_SCOPE_CONCAT(_allocationSite, __LINE__)}
+#else
+#define ALLOCATION_SCOPE(name)
+#endif
@@ -0,0 +1,130 @@
+// By Thomas Steinke
+
+#include <chrono>
+
+#if defined(_M_X64)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#include "Clock.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace
+{
+
+const Clock* gDefaultClock = nullptr;
+
+uint64_t SteadyNanoseconds()
+{
+   return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t ReadTimestampCounter()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+   return __rdtsc();
+#else
+   return 0;
+#endif
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+const Clock& Clock::Default()
+{
+   static SteadyClock steady;
+   return gDefaultClock != nullptr ? *gDefaultClock : steady;
+}
+
+void Clock::SetDefault(const Clock* clock)
+{
+   gDefaultClock = clock;
+}
+
+///
+///
+///
+uint64_t SteadyClock::NowNanoseconds() const
+{
+   return SteadyNanoseconds();
+}
+
+///
+///
+///
+TSCClock::TSCClock(double calibrationSeconds)
+{
+   if (!IsSupported())
+   {
+      return;
+   }
+
+   const uint64_t calibration = uint64_t(calibrationSeconds * 1e9);
+   const uint64_t startNanoseconds = SteadyNanoseconds();
+   const uint64_t startTicks = ReadTimestampCounter();
+
+   uint64_t nanoseconds;
+   do
+   {
+      nanoseconds = SteadyNanoseconds();
+   }
+   while (nanoseconds - startNanoseconds < calibration);
+   const uint64_t ticks = ReadTimestampCounter();
+
+   mTicksPerNanosecond = double(ticks - startTicks) / double(nanoseconds - startNanoseconds);
+   mStartTicks = ticks;
+   mStartNanoseconds = nanoseconds;
+}
+
+uint64_t TSCClock::NowNanoseconds() const
+{
+   if (mTicksPerNanosecond <= 0)
+   {
+      return SteadyNanoseconds();
+   }
+
+   // Another core's counter can be a hair behind the one that calibrated.
+   const int64_t ticks = int64_t(ReadTimestampCounter() - mStartTicks);
+   return ticks <= 0 ? mStartNanoseconds : mStartNanoseconds + uint64_t(double(ticks) / mTicksPerNanosecond);
+}
+
+bool TSCClock::IsSupported()
+{
+   // Only an invariant counter ticks at a fixed rate through frequency changes and sleep states.
+#if defined(_M_X64)
+   int info[4];
+   __cpuid(info, 0x80000000);
+   if (unsigned(info[0]) < 0x80000007)
+   {
+      return false;
+   }
+
+   __cpuid(info, 0x80000007);
+   return (info[3] & (1 << 8)) != 0;
+#elif defined(__x86_64__)
+   unsigned int eax, ebx, ecx, edx;
+   if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+   {
+      return false;
+   }
+
+   return (edx & (1 << 8)) != 0;
+#else
+   return false;
+#endif
+}
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -0,0 +1,89 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+//
+// Where timers get the time from. Everything is monotonic and none of it needs GLFW, so
+// it works the same on worker threads and in headless runs. Tests can pass a FakeClock
+// to control time exactly.
+//
+class Clock
+{
+public:
+   virtual ~Clock() {}
+
+   // Nanoseconds since some arbitrary starting point. Never goes backwards.
+   virtual uint64_t NowNanoseconds() const = 0;
+
+   // The same, in seconds.
+   double Now() const { return double(NowNanoseconds()) * 1e-9; }
+
+   // A SteadyClock, unless something else was set. Not thread safe to change, so do it at startup.
+   static const Clock& Default();
+   static void SetDefault(const Clock* clock);
+};
+
+//
+// std::chrono::steady_clock, which has nanosecond ticks on every platform we build for,
+// though Windows only updates it every 100ns.
+//
+class SteadyClock : public Clock
+{
+public:
+   uint64_t NowNanoseconds() const override;
+};
+
+//
+// Reads the CPU's timestamp counter, which is cheaper than asking the OS and counts at a
+// fixed rate on anything made in the last decade. The rate is measured against
+// steady_clock when the clock is made, which takes calibrationSeconds. Falls back to
+// steady_clock on CPUs without one.
+//
+class TSCClock : public Clock
+{
+public:
+   explicit TSCClock(double calibrationSeconds = 0.01);
+
+   uint64_t NowNanoseconds() const override;
+
+   // Timestamp ticks per nanosecond, as measured.
+   double GetTicksPerNanosecond() const { return mTicksPerNanosecond; }
+
+   static bool IsSupported();
+
+private:
+   uint64_t mStartTicks = 0;
+   uint64_t mStartNanoseconds = 0;
+   double mTicksPerNanosecond = 0;
+};
+
+//
+// Only moves when it's told to.
+//
+class FakeClock : public Clock
+{
+public:
+   explicit FakeClock(uint64_t nanoseconds = 0) : mNanoseconds(nanoseconds) {}
+
+   uint64_t NowNanoseconds() const override { return mNanoseconds.load(std::memory_order_relaxed); }
+
+   void Set(uint64_t nanoseconds) { mNanoseconds.store(nanoseconds, std::memory_order_relaxed); }
+   void Advance(uint64_t nanoseconds) { mNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed); }
+   void AdvanceSeconds(double seconds) { Advance(uint64_t(seconds * 1e9)); }
+
+private:
+   std::atomic<uint64_t> mNanoseconds;
+};
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -66,6 +66,11 @@ public:
       return get()->ReadEntireFile(path);
    }
 
+   Maybe<std::unique_ptr<MappedFile>> MapFile(const std::string& path) override
+   {
+      return get()->MapFile(path);
+   }
+
    Maybe<FileHandle> OpenFileWrite(const std::string& path) override
    {
       return get()->OpenFileWrite(path);
@@ -81,6 +86,11 @@ public:
       return get()->WriteFile(path, data);
    }
 
+   Maybe<void> Rename(const std::string& from, const std::string& to) override
+   {
+      return get()->Rename(from, to);
+   }
+
    Maybe<void> SeekFile(FileHandle handle, Seek method, int64_t dist) override
    {
       return get()->SeekFile(handle, method, dist);
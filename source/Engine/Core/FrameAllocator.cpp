@@ -0,0 +1,92 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "FrameAllocator.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+///
+///
+///
+LinearArena::LinearArena(size_t blockSize)
+   : mBlockSize(blockSize)
+   , mOffset(0)
+   , mUsedInPreviousBlocks(0)
+   , mCapacity(0)
+   , mHighWaterMark(0)
+{}
+
+LinearArena::~LinearArena() = default;
+
+///
+///
+///
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+   assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+   if (!mBlocks.empty())
+   {
+      uintptr_t base = reinterpret_cast<uintptr_t>(mBlocks.back().get());
+      size_t aligned = ((base + mOffset + alignment - 1) & ~(alignment - 1)) - base;
+      if (aligned + size <= mBlockSizes.back())
+      {
+         mOffset = aligned + size;
+         return mBlocks.back().get() + aligned;
+      }
+
+      mUsedInPreviousBlocks += mOffset;
+   }
+
+   // Start a new block, leaving room to align within it.
+   size_t blockSize = std::max(mBlockSize, size + alignment);
+   mBlocks.push_back(std::make_unique<char[]>(blockSize));
+   mBlockSizes.push_back(blockSize);
+   mCapacity += blockSize;
+
+   uintptr_t base = reinterpret_cast<uintptr_t>(mBlocks.back().get());
+   size_t aligned = ((base + alignment - 1) & ~(alignment - 1)) - base;
+   mOffset = aligned + size;
+   return mBlocks.back().get() + aligned;
+}
+
+///
+///
+///
+void LinearArena::Reset()
+{
+   mHighWaterMark = std::max(mHighWaterMark, GetBytesUsed());
+   if (mBlocks.size() > 1)
+   {
+      // Replace the chain with one block that fits everything, so the next frame won't overflow.
+      mBlockSize = std::max(mBlockSize, mCapacity);
+      mBlocks.clear();
+      mBlockSizes.clear();
+      mBlocks.push_back(std::make_unique<char[]>(mBlockSize));
+      mBlockSizes.push_back(mBlockSize);
+      mCapacity = mBlockSize;
+   }
+
+   mOffset = 0;
+   mUsedInPreviousBlocks = 0;
+}
+
+///
+///
+///
+LinearArena& FrameAllocator::Get()
+{
+   static thread_local LinearArena arena;
+   return arena;
+}
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -0,0 +1,112 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+//
+// LinearArena hands out memory by bumping a pointer through large blocks, and frees
+// everything at once on Reset(). Individual deallocations are no-ops.
+//
+// When an arena overflows its block, it chains a new one. On the next Reset() those
+// get coalesced into a single block big enough for the whole high-water mark, so a
+// steady-state frame costs no mallocs at all.
+//
+class LinearArena
+{
+public:
+   explicit LinearArena(size_t blockSize = 64 * 1024);
+   ~LinearArena();
+
+   LinearArena(const LinearArena&) = delete;
+   LinearArena& operator=(const LinearArena&) = delete;
+
+   void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+   template<typename T>
+   T* Allocate(size_t count)
+   {
+      return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+   }
+
+   // Invalidates everything handed out since the last reset.
+   void Reset();
+
+   size_t GetBytesUsed() const { return mUsedInPreviousBlocks + mOffset; }
+   size_t GetCapacity() const { return mCapacity; }
+   size_t GetHighWaterMark() const { return mHighWaterMark; }
+
+private:
+   size_t mBlockSize;
+
+   // mBlocks.back() is the one currently being allocated from.
+   std::vector<std::unique_ptr<char[]>> mBlocks;
+   std::vector<size_t> mBlockSizes;
+   size_t mOffset;
+   size_t mUsedInPreviousBlocks;
+   size_t mCapacity;
+   size_t mHighWaterMark;
+};
+
+//
+// Every thread gets its own frame arena. The main thread's is reset once per frame by
+// the main loop; worker threads should call Reset() whenever they finish a job.
+//
+// Anything allocated from it must not outlive the frame (or job), so it's meant for
+// scratch buffers in hot paths, e.g. FrameVector<glm::mat4> bones(FrameAllocator::Get());
+//
+class FrameAllocator
+{
+public:
+   // The calling thread's arena.
+   static LinearArena& Get();
+
+   // Reset the calling thread's arena.
+   static void Reset() { Get().Reset(); }
+};
+
+//
+// STL-compatible adapter, for putting containers on an arena.
+//
+template<typename T>
+class ArenaAllocator
+{
+public:
+   using value_type = T;
+
+   ArenaAllocator(LinearArena& arena) : mArena(&arena) {}
+
+   template<typename U>
+   ArenaAllocator(const ArenaAllocator<U>& other) : mArena(other.GetArena()) {}
+
+   T* allocate(size_t n) { return mArena->Allocate<T>(n); }
+   void deallocate(T*, size_t) {}
+
+   LinearArena* GetArena() const { return mArena; }
+
+   template<typename U>
+   bool operator==(const ArenaAllocator<U>& other) const { return mArena == other.GetArena(); }
+   template<typename U>
+   bool operator!=(const ArenaAllocator<U>& other) const { return mArena != other.GetArena(); }
+
+private:
+   LinearArena* mArena;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -0,0 +1,159 @@
+// By Thomas Steinke
+
+#include <cstring>
+
+#include "HeadlessInput.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+HeadlessInput::HeadlessInput(uint32_t width, uint32_t height)
+   : mWidth(width)
+   , mHeight(height)
+{
+   Reset();
+}
+
+HeadlessInput::~HeadlessInput() = default;
+
+void HeadlessInput::Reset()
+{
+   Input::Reset();
+   mMouseLocked = false;
+   mMousePosition = {0, 0};
+   mMouseMovement = {0, 0};
+   mMouseMoved = {0, 0};
+   mLastMouseScroll = {0, 0};
+   mMouseScroll = {0, 0};
+   memset(mKeyPressed, 0, sizeof(mKeyPressed));
+   memset(mMousePressed, 0, sizeof(mMousePressed));
+   memset(mMouseDragging, 0, sizeof(mMouseDragging));
+}
+
+void HeadlessInput::Update()
+{
+   mMouseMovement = mMouseMoved;
+   mMouseMoved = {0, 0};
+
+   mLastMouseScroll = mMouseScroll;
+   mMouseScroll = {0, 0};
+}
+
+void HeadlessInput::SetMousePosition(glm::tvec2<double> pos)
+{
+   MoveMouse(pos - mMousePosition);
+}
+
+void HeadlessInput::MoveMouse(glm::tvec2<double> amount)
+{
+   mMouseMoved += amount;
+   if (mMouseLocked)
+   {
+      // Same as a real window: the cursor stays put, only the movement is reported.
+      return;
+   }
+
+   mMousePosition += amount;
+   for (int button = GLFW_MOUSE_BUTTON_1; button <= GLFW_MOUSE_BUTTON_LAST; ++button)
+   {
+      if (mMousePressed[button])
+      {
+         mMouseDragging[button] = true;
+      }
+   }
+}
+
+void HeadlessInput::MouseDown(int button)
+{
+   if (!IsValidButton(button))
+   {
+      return;
+   }
+
+   mMousePressed[button] = true;
+   if (mMouseDownCallback)
+   {
+      glm::tvec2<double> pos = GetMousePosition();
+      mMouseDownCallback(button, pos.x, pos.y);
+   }
+}
+
+void HeadlessInput::MouseUp(int button)
+{
+   if (!IsValidButton(button))
+   {
+      return;
+   }
+
+   glm::tvec2<double> pos = GetMousePosition();
+   mMousePressed[button] = false;
+   if (mMouseUpCallback)
+   {
+      mMouseUpCallback(button, pos.x, pos.y);
+   }
+
+   if (!mMouseDragging[button] && mMouseClickCallback)
+   {
+      mMouseClickCallback(button, pos.x, pos.y);
+   }
+   mMouseDragging[button] = false;
+}
+
+void HeadlessInput::Scroll(glm::tvec2<double> amount)
+{
+   mMouseScroll += amount;
+}
+
+void HeadlessInput::KeyDown(int key, int mods)
+{
+   if (!IsValidKey(key))
+   {
+      return;
+   }
+
+   mKeyPressed[key] = true;
+   TriggerKeyCallbacks(key, GLFW_PRESS, mods);
+}
+
+void HeadlessInput::KeyUp(int key, int mods)
+{
+   if (!IsValidKey(key))
+   {
+      return;
+   }
+
+   mKeyPressed[key] = false;
+   TriggerKeyCallbacks(key, GLFW_RELEASE, mods);
+}
+
+void HeadlessInput::KeyRepeat(int key, int mods)
+{
+   if (!IsValidKey(key))
+   {
+      return;
+   }
+
+   TriggerKeyCallbacks(key, GLFW_REPEAT, mods);
+}
+
+void HeadlessInput::Type(unsigned int codePoint)
+{
+   TriggerCharCallbacks(codePoint);
+}
+
+glm::tvec2<double> HeadlessInput::GetMousePosition() const
+{
+   return mMousePosition / glm::tvec2<double>(GetWidth(), GetHeight());
+}
+
+glm::tvec2<double> HeadlessInput::CorrectYCoordinate(glm::tvec2<double> position) const
+{
+   return glm::tvec2<double>{position.x, GetHeight() - position.y};
+}
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -0,0 +1,91 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include "Bounded.h"
+#include "Input.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+//
+// HeadlessInput is an Input that isn't backed by any device. It exists so that states and
+// systems can run without a GLFW window (e.g. simulation soak tests on machines without a
+// GPU), and so that input can be driven programmatically instead of by a user.
+//
+// It also acts as the Bounded "screen" for anything that needs an aspect ratio.
+//
+class HeadlessInput : public Input, public Bounded
+{
+public:
+   HeadlessInput(uint32_t width = 1920, uint32_t height = 1080);
+   virtual ~HeadlessInput();
+
+public:
+   //
+   // Functions for setting input state.
+   //
+   void SetMousePosition(glm::tvec2<double> pos);
+   void MoveMouse(glm::tvec2<double> amount);
+   void MouseDown(int button);
+   void MouseUp(int button);
+   void Scroll(glm::tvec2<double> amount);
+
+   void KeyDown(int key, int mods = 0);
+   void KeyUp(int key, int mods = 0);
+   void KeyRepeat(int key, int mods = 0);
+   void Type(unsigned int codePoint);
+
+public:
+   // Implement Bounded
+   uint32_t GetX() const override { return 0; }
+   uint32_t GetY() const override { return 0; }
+   uint32_t GetWidth() const override { return mWidth; }
+   uint32_t GetHeight() const override { return mHeight; }
+
+public:
+   //
+   // Overrides from Input base class.
+   //
+   void Reset() override;
+   void Update() override;
+   bool IsKeyDown(int key) const override { return IsValidKey(key) && mKeyPressed[key]; }
+   bool IsMouseDown(int button) const override { return IsValidButton(button) && mMousePressed[button]; }
+   bool IsDragging(int button) const override { return IsValidButton(button) && mMouseDragging[button]; }
+   glm::tvec2<double> GetRawMousePosition() const override { return mMousePosition; }
+   glm::tvec2<double> GetMousePosition() const override;
+   glm::tvec2<double> CorrectYCoordinate(glm::tvec2<double> position) const override;
+   glm::tvec2<double> GetMouseMovement() const override { return mMouseMovement; }
+   glm::tvec2<double> GetMouseScroll() const override { return mLastMouseScroll; }
+   void SetMouseLock(bool locked) override { mMouseLocked = locked; }
+   bool IsMouseLocked() const override { return mMouseLocked; }
+
+private:
+   // Codes outside of GLFW's range (e.g. GLFW_KEY_UNKNOWN) are ignored rather than tracked.
+   static bool IsValidKey(int key) { return key >= 0 && key <= GLFW_KEY_LAST; }
+   static bool IsValidButton(int button) { return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST; }
+
+private:
+   uint32_t mWidth;
+   uint32_t mHeight;
+
+   bool mMouseLocked = false;
+
+   glm::tvec2<double> mMousePosition;
+   glm::tvec2<double> mMouseMovement;
+   glm::tvec2<double> mMouseMoved; // Accumulated between updates.
+
+   glm::tvec2<double> mLastMouseScroll;
+   glm::tvec2<double> mMouseScroll; // Accumulated between updates.
+
+   bool mKeyPressed[GLFW_KEY_LAST + 1];
+   bool mMousePressed[GLFW_MOUSE_BUTTON_LAST + 1];
+   bool mMouseDragging[GLFW_MOUSE_BUTTON_LAST + 1];
+};
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
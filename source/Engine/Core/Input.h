@@ -220,7 +220,7 @@ protected:
 
 private:
    // The "key-ring" for callbacks, indexed by key.
-   KeyCallbackLink* mKeyCallbacks[GLFW_KEY_LAST] = {nullptr};
+   KeyCallbackLink* mKeyCallbacks[GLFW_KEY_LAST + 1] = {nullptr};
    KeyCallbackLink* mKeyCallback = nullptr;
    CharCallbackLink* mCharCallback = nullptr;
    
@@ -0,0 +1,379 @@
+// By Thomas Steinke
+
+#include <cstring>
+
+#include "FileSystemProvider.h"
+#include "InputRecording.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace
+{
+
+constexpr char kMagic[4] = {'C', 'W', 'I', 'R'};
+constexpr uint32_t kVersion = 2;
+
+// Per-frame flags, for skipping data that's usually zero.
+constexpr uint8_t kHasMouseMovement = 0x01;
+constexpr uint8_t kHasMouseScroll = 0x02;
+
+// The fewest bytes a frame or event can take up, for checking counts against what's
+// actually left before allocating for them.
+constexpr size_t kMinFrameSize = sizeof(double) + sizeof(uint8_t) + 1;
+constexpr size_t kMinEventSize = sizeof(uint8_t) + sizeof(uint8_t) + 1;
+
+template <typename T>
+void Append(std::string& out, const T& value)
+{
+   out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendVarint(std::string& out, uint32_t value)
+{
+   while (value >= 0x80)
+   {
+      out.push_back(char(uint8_t(value) | 0x80));
+      value >>= 7;
+   }
+   out.push_back(char(value));
+}
+
+//
+// Bounds-checked cursor over a serialized recording.
+//
+class Reader
+{
+public:
+   Reader(const std::string& data) : mData(data), mOffset(0) {}
+
+   template <typename T>
+   bool Read(T& value)
+   {
+      if (mData.size() - mOffset < sizeof(T))
+      {
+         return false;
+      }
+
+      memcpy(&value, mData.data() + mOffset, sizeof(T));
+      mOffset += sizeof(T);
+      return true;
+   }
+
+   bool ReadVarint(uint32_t& value)
+   {
+      value = 0;
+      for (uint32_t shift = 0; shift < 35; shift += 7)
+      {
+         uint8_t byte;
+         if (!Read(byte))
+         {
+            return false;
+         }
+
+         value |= uint32_t(byte & 0x7f) << shift;
+         if ((byte & 0x80) == 0)
+         {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   bool AtEnd() const { return mOffset == mData.size(); }
+   size_t Remaining() const { return mData.size() - mOffset; }
+
+private:
+   const std::string& mData;
+   size_t mOffset;
+};
+
+}; // anonymous namespace
+
+///
+///
+///
+std::string InputRecording::Serialize() const
+{
+   std::string out;
+   out.reserve(sizeof(kMagic) + sizeof(uint32_t) * 2 + frames.size() * 10);
+
+   out.append(kMagic, sizeof(kMagic));
+   Append(out, kVersion);
+   Append(out, uint32_t(frames.size()));
+
+   for (const Frame& frame : frames)
+   {
+      uint8_t flags = 0;
+      if (frame.mouseMovement != glm::tvec2<double>(0)) { flags |= kHasMouseMovement; }
+      if (frame.mouseScroll != glm::tvec2<double>(0)) { flags |= kHasMouseScroll; }
+
+      Append(out, frame.dt);
+      Append(out, flags);
+      if (flags & kHasMouseMovement)
+      {
+         Append(out, frame.mouseMovement.x);
+         Append(out, frame.mouseMovement.y);
+      }
+      if (flags & kHasMouseScroll)
+      {
+         Append(out, frame.mouseScroll.x);
+         Append(out, frame.mouseScroll.y);
+      }
+
+      AppendVarint(out, uint32_t(frame.events.size()));
+      for (const Event& event : frame.events)
+      {
+         Append(out, uint8_t(event.type));
+         Append(out, event.mods);
+         AppendVarint(out, event.code);
+      }
+   }
+
+   return out;
+}
+
+///
+///
+///
+Maybe<InputRecording> InputRecording::Deserialize(const std::string& data)
+{
+   Reader reader(data);
+
+   char magic[sizeof(kMagic)];
+   uint32_t version;
+   if (!reader.Read(magic) || memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+   {
+      return Failure{"Not an input recording"};
+   }
+   if (!reader.Read(version) || version != kVersion)
+   {
+      return Failure{"Unsupported input recording version %1", version};
+   }
+
+   InputRecording recording;
+   uint32_t numFrames;
+   if (!reader.Read(numFrames))
+   {
+      return Failure{"Truncated header"};
+   }
+
+   if (numFrames > reader.Remaining() / kMinFrameSize)
+   {
+      return Failure{"%1 frames can't fit in the %2 bytes left", numFrames, uint32_t(reader.Remaining())};
+   }
+
+   recording.frames.reserve(numFrames);
+   for (uint32_t i = 0; i < numFrames; ++i)
+   {
+      Frame frame;
+      uint8_t flags;
+      if (!reader.Read(frame.dt) || !reader.Read(flags))
+      {
+         return Failure{"Truncated frame %1", i};
+      }
+
+      if ((flags & kHasMouseMovement) && !(reader.Read(frame.mouseMovement.x) && reader.Read(frame.mouseMovement.y)))
+      {
+         return Failure{"Truncated mouse movement in frame %1", i};
+      }
+      if ((flags & kHasMouseScroll) && !(reader.Read(frame.mouseScroll.x) && reader.Read(frame.mouseScroll.y)))
+      {
+         return Failure{"Truncated mouse scroll in frame %1", i};
+      }
+
+      uint32_t numEvents;
+      if (!reader.ReadVarint(numEvents))
+      {
+         return Failure{"Truncated event count in frame %1", i};
+      }
+
+      if (numEvents > reader.Remaining() / kMinEventSize)
+      {
+         return Failure{"%1 events in frame %2 can't fit in the %3 bytes left", numEvents, i, uint32_t(reader.Remaining())};
+      }
+
+      frame.events.resize(numEvents);
+      for (Event& event : frame.events)
+      {
+         uint8_t type;
+         if (!reader.Read(type) || !reader.Read(event.mods) || !reader.ReadVarint(event.code))
+         {
+            return Failure{"Truncated event in frame %1", i};
+         }
+         if (type > uint8_t(EventType::MouseUp))
+         {
+            return Failure{"Unknown event type %1 in frame %2", type, i};
+         }
+         event.type = EventType(type);
+
+         // Key and mouse codes index fixed size arrays on playback.
+         bool isKey = event.type == EventType::KeyDown || event.type == EventType::KeyUp || event.type == EventType::KeyRepeat;
+         bool isMouse = event.type == EventType::MouseDown || event.type == EventType::MouseUp;
+         if (isKey && event.code > uint32_t(GLFW_KEY_LAST))
+         {
+            return Failure{"Invalid key %1 in frame %2", event.code, i};
+         }
+         if (isMouse && event.code > uint32_t(GLFW_MOUSE_BUTTON_LAST))
+         {
+            return Failure{"Invalid mouse button %1 in frame %2", event.code, i};
+         }
+      }
+
+      recording.frames.push_back(std::move(frame));
+   }
+
+   if (!reader.AtEnd())
+   {
+      return Failure{"Unexpected data after %1 frames", numFrames};
+   }
+
+   return recording;
+}
+
+///
+///
+///
+Maybe<void> InputRecording::Save(const std::string& path) const
+{
+   if (Maybe<void> result = FileSystemProvider::Instance().WriteFile(path, Serialize()); !result)
+   {
+      return result.Failure().WithContext("Failed writing input recording");
+   }
+
+   return Success;
+}
+
+///
+///
+///
+Maybe<InputRecording> InputRecording::Load(const std::string& path)
+{
+   Maybe<std::string> data = FileSystemProvider::Instance().ReadEntireFile(path);
+   if (!data)
+   {
+      return data.Failure().WithContext("Failed reading input recording");
+   }
+
+   Maybe<InputRecording> recording = Deserialize(*data);
+   if (!recording)
+   {
+      return recording.Failure().WithContext("Failed parsing {path}", path);
+   }
+
+   return recording;
+}
+
+///
+///
+///
+InputRecorder::InputRecorder(Input& input)
+   : mInput(input)
+{
+   for (int button = 0; button < GLFW_MOUSE_BUTTON_LAST; ++button)
+   {
+      mMousePressed[button] = input.IsMouseDown(button);
+   }
+
+   mKeyCallback = input.OnKey([this](int key, int action, int mods) {
+      if (key == GLFW_KEY_UNKNOWN)
+      {
+         // Nothing could replay it, so it isn't worth recording.
+         return;
+      }
+
+      InputRecording::EventType type = InputRecording::EventType::KeyRepeat;
+      if (action == GLFW_PRESS) { type = InputRecording::EventType::KeyDown; }
+      else if (action == GLFW_RELEASE) { type = InputRecording::EventType::KeyUp; }
+
+      mPending.push_back(InputRecording::Event{type, uint8_t(mods), uint32_t(key)});
+   });
+
+   mCharCallback = input.OnCharacter([this](unsigned int codePoint) {
+      mPending.push_back(InputRecording::Event{InputRecording::EventType::Character, 0, codePoint});
+   });
+}
+
+///
+///
+///
+void InputRecorder::RecordFrame(double dt)
+{
+   InputRecording::Frame frame;
+   frame.dt = dt;
+   frame.mouseMovement = mInput.GetMouseMovement();
+   frame.mouseScroll = mInput.GetMouseScroll();
+   frame.events = std::move(mPending);
+   mPending.clear();
+
+   // Mouse buttons are polled rather than hooked, since Input only has one slot for each
+   // mouse callback and those belong to the game.
+   for (int button = 0; button < GLFW_MOUSE_BUTTON_LAST; ++button)
+   {
+      bool pressed = mInput.IsMouseDown(button);
+      if (pressed != mMousePressed[button])
+      {
+         InputRecording::EventType type = pressed ? InputRecording::EventType::MouseDown : InputRecording::EventType::MouseUp;
+         frame.events.push_back(InputRecording::Event{type, 0, uint32_t(button)});
+         mMousePressed[button] = pressed;
+      }
+   }
+
+   mRecording.frames.push_back(std::move(frame));
+}
+
+///
+///
+///
+InputPlayer::InputPlayer(InputRecording&& recording)
+   : mRecording(std::move(recording))
+{}
+
+///
+///
+///
+double InputPlayer::PlayFrame(HeadlessInput& input)
+{
+   if (IsDone())
+   {
+      return 0;
+   }
+
+   const InputRecording::Frame& frame = mRecording.frames[mFrame++];
+   for (const InputRecording::Event& event : frame.events)
+   {
+      switch (event.type)
+      {
+      case InputRecording::EventType::KeyDown:
+         input.KeyDown(int(event.code), event.mods);
+         break;
+      case InputRecording::EventType::KeyUp:
+         input.KeyUp(int(event.code), event.mods);
+         break;
+      case InputRecording::EventType::KeyRepeat:
+         input.KeyRepeat(int(event.code), event.mods);
+         break;
+      case InputRecording::EventType::Character:
+         input.Type(event.code);
+         break;
+      case InputRecording::EventType::MouseDown:
+         input.MouseDown(int(event.code));
+         break;
+      case InputRecording::EventType::MouseUp:
+         input.MouseUp(int(event.code));
+         break;
+      }
+   }
+
+   input.MoveMouse(frame.mouseMovement);
+   input.Scroll(frame.mouseScroll);
+
+   return frame.dt;
+}
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
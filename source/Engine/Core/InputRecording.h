@@ -0,0 +1,117 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <RGBDesignPatterns/Maybe.h>
+
+#include "HeadlessInput.h"
+#include "Input.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+//
+// A recorded play session: every frame's timestep and input. Replaying one through a
+// HeadlessInput reproduces the same simulation, which makes frame times comparable between builds.
+//
+struct InputRecording
+{
+   enum class EventType : uint8_t
+   {
+      KeyDown,
+      KeyUp,
+      KeyRepeat,
+      Character,
+      MouseDown,
+      MouseUp,
+   };
+
+   struct Event
+   {
+      EventType type;
+      uint8_t mods; // Key events only
+      uint32_t code; // Key code, mouse button or unicode code point
+   };
+
+   struct Frame
+   {
+      double dt = 0;
+      glm::tvec2<double> mouseMovement{0, 0};
+      glm::tvec2<double> mouseScroll{0, 0};
+      std::vector<Event> events;
+   };
+
+   std::vector<Frame> frames;
+
+public:
+   //
+   // Binary encoding. Frames are variable length, so that a frame without
+   // any input costs 10 bytes.
+   //
+   std::string Serialize() const;
+   static Maybe<InputRecording> Deserialize(const std::string& data);
+
+   Maybe<void> Save(const std::string& path) const;
+   static Maybe<InputRecording> Load(const std::string& path);
+};
+
+//
+// Captures input from a live Input (usually the Window) into an InputRecording.
+//
+class InputRecorder
+{
+public:
+   InputRecorder(Input& input);
+
+   //
+   // Close out a frame. Call once per frame after the input has been updated,
+   // with the timestep that is about to be simulated.
+   //
+   void RecordFrame(double dt);
+
+   const InputRecording& GetRecording() const { return mRecording; }
+
+private:
+   Input& mInput;
+   InputRecording mRecording;
+
+   // Events that arrived since the last frame was recorded.
+   std::vector<InputRecording::Event> mPending;
+   bool mMousePressed[GLFW_MOUSE_BUTTON_LAST];
+
+   std::unique_ptr<Input::KeyCallbackLink> mKeyCallback;
+   std::unique_ptr<Input::CharCallbackLink> mCharCallback;
+};
+
+//
+// Feeds an InputRecording back through a HeadlessInput, one frame at a time.
+//
+class InputPlayer
+{
+public:
+   InputPlayer(InputRecording&& recording);
+
+   bool IsDone() const { return mFrame >= mRecording.frames.size(); }
+   size_t GetFrameCount() const { return mRecording.frames.size(); }
+
+   //
+   // Apply the next frame's input and return its timestep.
+   // Call before input.Update(), the same way the window receives events before updating.
+   //
+   double PlayFrame(HeadlessInput& input);
+
+private:
+   InputRecording mRecording;
+   size_t mFrame = 0;
+};
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -0,0 +1,381 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <mutex>
+
+#include <RGBNetworking/JSONSerializer.h>
+#include <RGBText/Format.h>
+#include <RGBText/Numbers.h>
+
+#include "Clock.h"
+#include "Metrics.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace
+{
+
+std::atomic<uint32_t> gNextMetricsShard{0};
+
+// Threads are spread over the shards in the order they first record something.
+size_t GetMetricsShard()
+{
+   thread_local size_t shard = gNextMetricsShard.fetch_add(1, std::memory_order_relaxed) % Metrics::kShards;
+   return shard;
+}
+
+template <typename T>
+struct NamedMetric
+{
+   std::string name;
+   T metric;
+};
+
+struct MetricsRegistry
+{
+   std::mutex mutex;
+   std::deque<NamedMetric<Metrics::Counter>> counters;
+   std::deque<NamedMetric<Metrics::Gauge>> gauges;
+   std::deque<NamedMetric<Metrics::Histogram>> histograms;
+};
+
+MetricsRegistry& GetMetricsRegistry()
+{
+   static MetricsRegistry registry;
+   return registry;
+}
+
+template <typename T>
+T* FindOrCreateMetric(std::deque<NamedMetric<T>>& metrics, const std::string& name)
+{
+   for (NamedMetric<T>& metric : metrics)
+   {
+      if (metric.name == name)
+      {
+         return &metric.metric;
+      }
+   }
+
+   metrics.emplace_back();
+   metrics.back().name = name;
+   return &metrics.back().metric;
+}
+
+// The smallest number of significant bits that holds value.
+uint32_t MetricsBitWidth(uint64_t value)
+{
+   uint32_t bits = 0;
+   for (uint32_t step = 32; step > 0; step /= 2)
+   {
+      if (value >> step)
+      {
+         value >>= step;
+         bits += step;
+      }
+   }
+   return bits + uint32_t(value);
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+void Metrics::Counter::Add(int64_t amount)
+{
+   mShards[GetMetricsShard()].value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+int64_t Metrics::Counter::Total() const
+{
+   int64_t total = 0;
+   for (const Shard& shard : mShards)
+   {
+      total += shard.value.load(std::memory_order_relaxed);
+   }
+   return total;
+}
+
+///
+///
+///
+Metrics::Histogram::Histogram()
+   : mShards(new Shard[kShards])
+{
+   for (size_t i = 0; i < kShards; ++i)
+   {
+      for (std::atomic<uint64_t>& bucket : mShards[i].buckets)
+      {
+         bucket.store(0, std::memory_order_relaxed);
+      }
+   }
+}
+
+void Metrics::Histogram::Record(uint64_t value)
+{
+   Shard& shard = mShards[GetMetricsShard()];
+   shard.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+   shard.count.fetch_add(1, std::memory_order_relaxed);
+   shard.sum.fetch_add(value, std::memory_order_relaxed);
+
+   uint64_t min = shard.min.load(std::memory_order_relaxed);
+   while (value < min && !shard.min.compare_exchange_weak(min, value, std::memory_order_relaxed)) {}
+   uint64_t max = shard.max.load(std::memory_order_relaxed);
+   while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+uint32_t Metrics::Histogram::BucketIndex(uint64_t value)
+{
+   const uint64_t kLargest = (uint64_t(1) << kMaxBits) - 1;
+   value = std::min(value, kLargest);
+
+   const uint32_t bits = MetricsBitWidth(value);
+   if (bits <= kSubBucketBits + 1)
+   {
+      return uint32_t(value);
+   }
+
+   // Keep the top kSubBucketBits + 1 bits, which start at kSubBuckets.
+   const uint32_t shift = bits - kSubBucketBits - 1;
+   return shift * kSubBuckets + uint32_t(value >> shift);
+}
+
+uint64_t Metrics::Histogram::BucketLow(uint32_t index)
+{
+   if (index < 2 * kSubBuckets)
+   {
+      return index;
+   }
+
+   const uint32_t shift = index / kSubBuckets - 1;
+   return uint64_t(index - shift * kSubBuckets) << shift;
+}
+
+uint64_t Metrics::Histogram::BucketHigh(uint32_t index)
+{
+   if (index < 2 * kSubBuckets)
+   {
+      return index + 1;
+   }
+
+   const uint32_t shift = index / kSubBuckets - 1;
+   return BucketLow(index) + (uint64_t(1) << shift);
+}
+
+///
+///
+///
+uint64_t Metrics::HistogramSnapshot::Percentile(double p) const
+{
+   if (count == 0)
+   {
+      return 0;
+   }
+
+   const uint64_t rank = std::clamp(uint64_t(std::ceil(p * double(count))), uint64_t(1), count);
+   uint64_t seen = 0;
+   for (uint32_t i = 0; i < buckets.size(); ++i)
+   {
+      seen += buckets[i];
+      if (seen >= rank)
+      {
+         // The middle of the bucket is never more than half a step off.
+         const uint64_t low = Histogram::BucketLow(i);
+         const uint64_t middle = low + (Histogram::BucketHigh(i) - low - 1) / 2;
+         return std::clamp(middle, min, max);
+      }
+   }
+
+   return max;
+}
+
+///
+///
+///
+Metrics::Snapshot Metrics::Snapshot::Since(const Snapshot& earlier) const
+{
+   // Metrics only ever get added, so the earlier ones line up with the start of these.
+   Snapshot result = *this;
+   for (size_t i = 0; i < std::min(counters.size(), earlier.counters.size()); ++i)
+   {
+      result.counters[i].second -= earlier.counters[i].second;
+   }
+
+   for (size_t i = 0; i < std::min(histograms.size(), earlier.histograms.size()); ++i)
+   {
+      HistogramSnapshot& histogram = result.histograms[i].second;
+      const HistogramSnapshot& before = earlier.histograms[i].second;
+      histogram.count -= before.count;
+      histogram.sum -= before.sum;
+      for (size_t b = 0; b < histogram.buckets.size(); ++b)
+      {
+         histogram.buckets[b] -= before.buckets[b];
+      }
+   }
+
+   return result;
+}
+
+std::vector<std::string> Metrics::Snapshot::ToLines() const
+{
+   std::vector<std::string> lines;
+   for (const auto& [name, value] : counters)
+   {
+      lines.push_back(FormatString("{name}: {value}", name, value));
+   }
+
+   for (const auto& [name, value] : gauges)
+   {
+      lines.push_back(FormatString("{name}: {value}", name, Numbers::Format(value)));
+   }
+
+   for (const auto& [name, histogram] : histograms)
+   {
+      lines.push_back(FormatString("{name}: p50 {p50:.2f}ms | p90 {p90:.2f}ms | p99 {p99:.2f}ms | max {max:.2f}ms ({count})",
+         name,
+         double(histogram.Percentile(0.5)) / 1e6,
+         double(histogram.Percentile(0.9)) / 1e6,
+         double(histogram.Percentile(0.99)) / 1e6,
+         double(histogram.max) / 1e6,
+         histogram.count
+      ));
+   }
+
+   return lines;
+}
+
+std::string Metrics::Snapshot::ToText() const
+{
+   std::string text;
+   for (const std::string& line : ToLines())
+   {
+      text += line;
+      text += '\n';
+   }
+   return text;
+}
+
+BindingProperty Metrics::Snapshot::Serialize() const
+{
+   BindingProperty result;
+   result["time"] = time;
+
+   BindingProperty& counterValues = result["counters"].SetObject();
+   for (const auto& [name, value] : counters)
+   {
+      counterValues[name] = value;
+   }
+
+   BindingProperty& gaugeValues = result["gauges"].SetObject();
+   for (const auto& [name, value] : gauges)
+   {
+      gaugeValues[name] = value;
+   }
+
+   BindingProperty& histogramValues = result["histograms"].SetObject();
+   for (const auto& [name, histogram] : histograms)
+   {
+      BindingProperty& values = histogramValues[name];
+      values["count"] = histogram.count;
+      values["mean"] = histogram.Mean();
+      values["min"] = histogram.min;
+      values["max"] = histogram.max;
+      values["p50"] = histogram.Percentile(0.5);
+      values["p90"] = histogram.Percentile(0.9);
+      values["p99"] = histogram.Percentile(0.99);
+      values["p999"] = histogram.Percentile(0.999);
+   }
+
+   return result;
+}
+
+Maybe<void> Metrics::Snapshot::WriteJSON(const std::string& path) const
+{
+   return JSONSerializer::SerializeFile(path, Serialize());
+}
+
+///
+///
+///
+Metrics::Counter* Metrics::GetCounter(const std::string& name)
+{
+   MetricsRegistry& registry = GetMetricsRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+   return FindOrCreateMetric(registry.counters, name);
+}
+
+Metrics::Gauge* Metrics::GetGauge(const std::string& name)
+{
+   MetricsRegistry& registry = GetMetricsRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+   return FindOrCreateMetric(registry.gauges, name);
+}
+
+Metrics::Histogram* Metrics::GetHistogram(const std::string& name)
+{
+   MetricsRegistry& registry = GetMetricsRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+   return FindOrCreateMetric(registry.histograms, name);
+}
+
+///
+///
+///
+Metrics::Snapshot Metrics::TakeSnapshot()
+{
+   MetricsRegistry& registry = GetMetricsRegistry();
+   std::unique_lock<std::mutex> lock{registry.mutex};
+
+   Snapshot snapshot;
+   snapshot.time = Clock::Default().Now();
+
+   snapshot.counters.reserve(registry.counters.size());
+   for (const NamedMetric<Counter>& counter : registry.counters)
+   {
+      snapshot.counters.emplace_back(counter.name, counter.metric.Total());
+   }
+
+   snapshot.gauges.reserve(registry.gauges.size());
+   for (const NamedMetric<Gauge>& gauge : registry.gauges)
+   {
+      snapshot.gauges.emplace_back(gauge.name, gauge.metric.Get());
+   }
+
+   snapshot.histograms.reserve(registry.histograms.size());
+   for (const NamedMetric<Histogram>& histogram : registry.histograms)
+   {
+      HistogramSnapshot result;
+      result.buckets.resize(Histogram::kBuckets, 0);
+      result.min = UINT64_MAX;
+      for (size_t i = 0; i < kShards; ++i)
+      {
+         const Histogram::Shard& shard = histogram.metric.mShards[i];
+         result.count += shard.count.load(std::memory_order_relaxed);
+         result.sum += shard.sum.load(std::memory_order_relaxed);
+         result.min = std::min(result.min, shard.min.load(std::memory_order_relaxed));
+         result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+         for (uint32_t b = 0; b < Histogram::kBuckets; ++b)
+         {
+            result.buckets[b] += shard.buckets[b].load(std::memory_order_relaxed);
+         }
+      }
+
+      if (result.count == 0)
+      {
+         result.min = 0;
+      }
+      snapshot.histograms.emplace_back(histogram.name, std::move(result));
+   }
+
+   return snapshot;
+}
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -0,0 +1,162 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <RGBBinding/BindingProperty.h>
+#include <RGBDesignPatterns/Maybe.h>
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+//
+// Counters, gauges and latency histograms that any thread can update without taking a
+// lock. Each thread writes into one of a handful of shards, which only get added up when
+// a snapshot is taken, so worker threads don't fight over the same cache lines.
+//
+// Metrics are never freed, so pointers to them can be cached. The METRIC_* macros do that
+// per call site.
+//
+class Metrics
+{
+public:
+   static constexpr size_t kShards = 8;
+
+   class Counter
+   {
+   public:
+      void Add(int64_t amount = 1);
+      int64_t Total() const;
+
+   private:
+      struct alignas(64) Shard
+      {
+         std::atomic<int64_t> value{0};
+      };
+
+      Shard mShards[kShards];
+   };
+
+   class Gauge
+   {
+   public:
+      void Set(double value) { mValue.store(value, std::memory_order_relaxed); }
+      double Get() const { return mValue.load(std::memory_order_relaxed); }
+
+   private:
+      std::atomic<double> mValue{0};
+   };
+
+   //
+   // Log-linear buckets in the style of HdrHistogram: values below 32 get a bucket each,
+   // and every power of two above that is split into 16 even steps, so anything recorded
+   // is known to within 1/16th. Values are integers, and durations are nanoseconds.
+   //
+   class Histogram
+   {
+   public:
+      static constexpr uint32_t kSubBucketBits = 4;
+      static constexpr uint32_t kSubBuckets = 1 << kSubBucketBits;
+      // Values past this are recorded as the largest one, which is over three days in nanoseconds.
+      static constexpr uint32_t kMaxBits = 48;
+      static constexpr uint32_t kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+   public:
+      Histogram();
+
+      void Record(uint64_t value);
+      void RecordSeconds(double seconds) { Record(seconds <= 0 ? 0 : uint64_t(seconds * 1e9)); }
+
+      // The range of values [low, high) that ends up in a bucket.
+      static uint32_t BucketIndex(uint64_t value);
+      static uint64_t BucketLow(uint32_t index);
+      static uint64_t BucketHigh(uint32_t index);
+
+   private:
+      friend class Metrics;
+
+      struct alignas(64) Shard
+      {
+         std::atomic<uint64_t> count{0};
+         std::atomic<uint64_t> sum{0};
+         std::atomic<uint64_t> min{UINT64_MAX};
+         std::atomic<uint64_t> max{0};
+         std::atomic<uint64_t> buckets[kBuckets];
+      };
+
+      std::unique_ptr<Shard[]> mShards;
+   };
+
+   //
+   // What a histogram held at one point. Percentiles come from the buckets, so they're
+   // as precise as those, except that they never fall outside of [min, max].
+   //
+   struct HistogramSnapshot
+   {
+      uint64_t count = 0;
+      uint64_t sum = 0;
+      uint64_t min = 0;
+      uint64_t max = 0;
+      std::vector<uint64_t> buckets;
+
+      double Mean() const { return count == 0 ? 0 : double(sum) / double(count); }
+      // p is from 0 to 1.
+      uint64_t Percentile(double p) const;
+   };
+
+   struct Snapshot
+   {
+      // Seconds on Clock::Default() when this was taken.
+      double time = 0;
+
+      std::vector<std::pair<std::string, int64_t>> counters;
+      std::vector<std::pair<std::string, double>> gauges;
+      std::vector<std::pair<std::string, HistogramSnapshot>> histograms;
+
+      //
+      // What changed since an earlier snapshot, for reporting on intervals. Counters and
+      // histograms only hold what was added in between, while gauges keep their value.
+      // The min and max of an interval aren't known, so they're left as the overall ones.
+      //
+      Snapshot Since(const Snapshot& earlier) const;
+
+      // One line per metric, with histograms as nanoseconds shown in milliseconds.
+      std::vector<std::string> ToLines() const;
+      std::string ToText() const;
+
+      // For dumping with any of the serializers, e.g. JSONSerializer.
+      BindingProperty Serialize() const;
+      Maybe<void> WriteJSON(const std::string& path) const;
+   };
+
+public:
+   // Find or create the metric with this name.
+   static Counter* GetCounter(const std::string& name);
+   static Gauge* GetGauge(const std::string& name);
+   static Histogram* GetHistogram(const std::string& name);
+
+   // Adds up every metric as it is right now, in the order they were created.
+   static Snapshot TakeSnapshot();
+};
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
+
+#define METRIC_CONCAT_INNER(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_INNER(a, b)
+#define METRIC_SITE(Type, name) \
+   static ::CubeWorld::Engine::Metrics::Type* METRIC_CONCAT(_metric, __LINE__) = \
+      ::CubeWorld::Engine::Metrics::Get##Type(name)
+
+#define METRIC_COUNT(name, amount) do { METRIC_SITE(Counter, name); METRIC_CONCAT(_metric, __LINE__)->Add(amount); } while (0)
+#define METRIC_GAUGE(name, value) do { METRIC_SITE(Gauge, name); METRIC_CONCAT(_metric, __LINE__)->Set(double(value)); } while (0)
+#define METRIC_SECONDS(name, seconds) do { METRIC_SITE(Histogram, name); METRIC_CONCAT(_metric, __LINE__)->RecordSeconds(seconds); } while (0)
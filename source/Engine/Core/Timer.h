@@ -2,11 +2,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <type_traits>
 
-#include <GL/includes.h>
+#include "Clock.h"
 
 namespace CubeWorld
 {
@@ -17,19 +19,21 @@ namespace Engine
 template<uint32_t N = 1>
 class Timer {
 public:
-   Timer(double gate = 0)
-      : mPaused(false)
+   // clock is held by pointer, so it must outlive the timer.
+   Timer(double gate = 0, const Clock& clock = Clock::Default())
+      : mClock(&clock)
+      , mPaused(false)
       , mGate(gate)
       , mCurrentSample(0)
       , mRolling(0)
    {
-      mLast = glfwGetTime();
+      mLast = Now();
       memset(mSamples, 0, sizeof(mSamples));
    }
 
    double Elapsed()
    {
-      double current = glfwGetTime();
+      double current = Now();
       if (current - mLast < mGate)
       {
          // Nothing to report
@@ -52,13 +56,20 @@ public:
       return mRolling / N;
    }
 
-   void Reset() { mLast = glfwGetTime(); }
+   void Reset() { mLast = Now(); }
 
    void Pause() { mPaused = true; }
    void Unpause() { mPaused = false; }
    bool IsPaused() { return mPaused; }
 
 private:
+   // Seconds on a monotonic clock. Deliberately not glfwGetTime, so that
+   // timers keep working in headless runs where GLFW is never initialized.
+   double Now() const { return mClock->Now(); }
+
+private:
+   const Clock* mClock;
+
    bool mPaused;
 
    // Timer gate - don't return time elapsed unless it's greater than this.
@@ -70,6 +81,86 @@ private:
    double mSamples[N];
 };
 
+//
+// Keeps the last N samples around, for when the spread matters as much as the average,
+// like telling a steady 16ms frame apart from one that's usually 8ms with the odd 100ms.
+//
+template<uint32_t N>
+class WindowTimer {
+public:
+   static_assert(N > 0, "WindowTimer needs room for at least one sample");
+
+   // clock is held by pointer, so it must outlive the timer.
+   WindowTimer(const Clock& clock = Clock::Default())
+      : mClock(&clock)
+      , mCurrentSample(0)
+      , mCount(0)
+   {
+      mLast = mClock->Now();
+      memset(mSamples, 0, sizeof(mSamples));
+   }
+
+   // Records the time since the last call or Reset().
+   double Elapsed()
+   {
+      double current = mClock->Now();
+      double dt = current - mLast;
+      mLast = current;
+
+      Record(dt);
+      return dt;
+   }
+
+   // For durations that were measured some other way.
+   void Record(double seconds)
+   {
+      mSamples[mCurrentSample] = seconds;
+      mCurrentSample = (mCurrentSample + 1) % N;
+      mCount = std::min(mCount + 1, size_t(N));
+   }
+
+   void Reset() { mLast = mClock->Now(); }
+   void Clear() { mCurrentSample = 0; mCount = 0; }
+
+   size_t Count() const { return mCount; }
+
+   double Min() const { return mCount == 0 ? 0 : *std::min_element(mSamples, mSamples + mCount); }
+   double Max() const { return mCount == 0 ? 0 : *std::max_element(mSamples, mSamples + mCount); }
+
+   double Average() const
+   {
+      double sum = 0;
+      for (size_t i = 0; i < mCount; ++i)
+      {
+         sum += mSamples[i];
+      }
+      return mCount == 0 ? 0 : sum / mCount;
+   }
+
+   // The smallest sample that at least p of them are no bigger than, with p from 0 to 1.
+   double Percentile(double p) const
+   {
+      if (mCount == 0)
+      {
+         return 0;
+      }
+
+      double sorted[N];
+      std::copy(mSamples, mSamples + mCount, sorted);
+      size_t rank = std::clamp(size_t(std::ceil(p * mCount)), size_t(1), mCount);
+      std::nth_element(sorted, sorted + rank - 1, sorted + mCount);
+      return sorted[rank - 1];
+   }
+
+private:
+   const Clock* mClock;
+   double mLast;
+
+   size_t mCurrentSample;
+   size_t mCount;
+   double mSamples[N];
+};
+
 }; // namespace Engine
 
 }; // namespace CubeWorld
@@ -0,0 +1,111 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace Graphics
+{
+
+//
+// InstanceBatcher groups per-instance data by key (usually "which mesh"), so that each
+// group can be drawn with one instanced call. After Build, every batch's instances are
+// contiguous in GetInstances(), in the order they were added, ready to be uploaded as a
+// single instance buffer.
+//
+// Usage, per frame:
+//    batcher.Clear();
+//    batcher.Add(key, instance);
+//    ...
+//    batcher.Build();
+//    upload(batcher.GetInstances());
+//    for (const Batch& batch : batcher.GetBatches()) { draw(batch); }
+//
+// Nothing here touches GL, so batching can be tested and benchmarked on its own.
+//
+template<typename Key, typename Instance, typename Hash = std::hash<Key>>
+class InstanceBatcher
+{
+public:
+   struct Batch
+   {
+      Key key;
+
+      // Range of this batch in GetInstances().
+      uint32_t first;
+      uint32_t count;
+   };
+
+public:
+   void Add(const Key& key, const Instance& instance)
+   {
+      auto it = mLookup.find(key);
+      uint32_t batch;
+      if (it == mLookup.end())
+      {
+         batch = uint32_t(mBatches.size());
+         mLookup.emplace(key, batch);
+         mBatches.push_back(Batch{key, 0, 0});
+      }
+      else
+      {
+         batch = it->second;
+      }
+
+      ++mBatches[batch].count;
+      mPending.push_back(std::make_pair(batch, instance));
+   }
+
+   // Lay out the instances added since the last Clear, one batch after another.
+   void Build()
+   {
+      uint32_t offset = 0;
+      mCursors.resize(mBatches.size());
+      for (size_t i = 0; i < mBatches.size(); ++i)
+      {
+         mBatches[i].first = offset;
+         mCursors[i] = offset;
+         offset += mBatches[i].count;
+      }
+
+      mInstances.resize(offset);
+      for (const auto& [batch, instance] : mPending)
+      {
+         mInstances[mCursors[batch]++] = instance;
+      }
+   }
+
+   void Clear()
+   {
+      mLookup.clear();
+      mBatches.clear();
+      mPending.clear();
+      mInstances.clear();
+   }
+
+   const std::vector<Batch>& GetBatches() const { return mBatches; }
+   const std::vector<Instance>& GetInstances() const { return mInstances; }
+
+private:
+   std::unordered_map<Key, uint32_t, Hash> mLookup;
+   std::vector<Batch> mBatches;
+   std::vector<std::pair<uint32_t, Instance>> mPending;
+   std::vector<uint32_t> mCursors;
+   std::vector<Instance> mInstances;
+};
+
+}; // namespace Graphics
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -39,7 +39,8 @@ ParticleSystem::ParticleSystem(
    const std::string& textureDir
 ) : ParticleSystem()
 {
-   Maybe<BindingProperty> data = YAMLSerializer::DeserializeFile(path);
+   RGBBinding::Arena arena;
+   Maybe<BindingProperty> data = YAMLSerializer::DeserializeFile(path, &arena);
    assert(data.Succeeded());
    if (!data)
    {
@@ -1,5 +1,6 @@
 // By Thomas Steinke
 
+#include <algorithm>
 #include <GL/includes.h>
 #include <glm/ext.hpp>
 #include <regex>
@@ -186,22 +187,9 @@ Maybe<std::unique_ptr<Program>> Program::LoadComputeSource(
     }
     computeShader.Result()->Attach(program->id);
 
-    // Link the program
-    glLinkProgram(program->id);
-
-    // Check the program
-    GLint result = GL_FALSE;
-    int infoLogLength;
-    glGetProgramiv(program->id, GL_LINK_STATUS, &result);
-    glGetProgramiv(program->id, GL_INFO_LOG_LENGTH, &infoLogLength);
-    if (infoLogLength > 0) {
-        char* error = new char[size_t(infoLogLength) + 1];
-        CUBEWORLD_SCOPE_EXIT([&] { delete[] error; });
-        glGetProgramInfoLog(program->id, infoLogLength, nullptr, error);
-
-        if (error[0] != '\0') {
-            return Failure(error).WithContext("Failed linking program");
-        }
+    if (Maybe<void> result = program->Link(); !result)
+    {
+        return result.Failure();
     }
 
     return program;
@@ -259,22 +247,9 @@ Maybe<std::unique_ptr<Program>> Program::Load(
       CHECK_GL_ERRORS();
    }
 
-   // Link the program
-   glLinkProgram(program->id);
-
-   // Check the program
-   GLint result = GL_FALSE;
-   int infoLogLength;
-   glGetProgramiv(program->id, GL_LINK_STATUS, &result);
-   glGetProgramiv(program->id, GL_INFO_LOG_LENGTH, &infoLogLength);
-   if (infoLogLength > 0) {
-      char* error = new char[size_t(infoLogLength) + 1];
-      CUBEWORLD_SCOPE_EXIT([&] { delete[] error; });
-      glGetProgramInfoLog(program->id, infoLogLength, nullptr, error);
-
-      if (error[0] != '\0') {
-         return Failure(error).WithContext("Failed linking program");
-      }
+   if (Maybe<void> result = program->Link(); !result)
+   {
+      return result.Failure();
    }
 
    // Shaders will automatically detach and clean up here!
@@ -304,104 +279,104 @@ void Program::Unbind()
    CheckErrors();
    for (auto& entry : attributes)
    {
-      glDisableVertexAttribArray(entry.second);
+      if (entry.second >= 0)
+      {
+         glDisableVertexAttribArray(GLuint(entry.second));
+      }
    }
    glUseProgram(0);
 }
 
 void Program::Uniform1u(const std::string& name, const uint32_t value)
 {
-   glUniform1ui(Uniform(name), value);
+   Set(GetUniform<uint32_t>(name), value);
 }
 
 void Program::Uniform1i(const std::string& name, const int32_t value)
 {
-   glUniform1i(Uniform(name), value);
+   Set(GetUniform<int32_t>(name), value);
 }
 
 void Program::Uniform1ui(const std::string& name, const uint32_t value)
 {
-    glUniform1ui(Uniform(name), value);
+   Set(GetUniform<uint32_t>(name), value);
 }
 
 void Program::Uniform2i(const std::string& name, const int32_t value1, const int32_t value2)
 {
-   glUniform2i(Uniform(name), value1, value2);
+   Set(GetUniform<glm::ivec2>(name), glm::ivec2(value1, value2));
 }
 
 void Program::Uniform3i(const std::string& name, const int32_t value1, const int32_t value2, const int32_t value3)
 {
-   glUniform3i(Uniform(name), value1, value2, value3);
+   Set(GetUniform<glm::ivec3>(name), glm::ivec3(value1, value2, value3));
 }
 
 void Program::Uniform3ui(const std::string& name, const uint32_t value1, const uint32_t value2, const uint32_t value3)
 {
-    glUniform3ui(Uniform(name), value1, value2, value3);
+   Set(GetUniform<glm::uvec3>(name), glm::uvec3(value1, value2, value3));
 }
 
 void Program::Uniform1f(const std::string& name, const float value)
 {
-   glUniform1f(Uniform(name), value);
+   Set(GetUniform<float>(name), value);
 }
 
 void Program::Uniform2f(const std::string& name, const float value1, const float value2)
 {
-   glUniform2f(Uniform(name), value1, value2);
+   Set(GetUniform<glm::vec2>(name), glm::vec2(value1, value2));
 }
 
 void Program::Uniform3f(const std::string& name, const float value1, const float value2, const float value3)
 {
-   glUniform3f(Uniform(name), value1, value2, value3);
+   Set(GetUniform<glm::vec3>(name), glm::vec3(value1, value2, value3));
 }
 
 void Program::Uniform4f(const std::string& name, const float value1, const float value2, const float value3, const float value4)
 {
-   glUniform4f(Uniform(name), value1, value2, value3, value4);
+   Set(GetUniform<glm::vec4>(name), glm::vec4(value1, value2, value3, value4));
 }
 
 void Program::UniformVector3f(const std::string& name, const glm::vec3& vector)
 {
-   glUniform3fv(Uniform(name), 1, glm::value_ptr(vector));
+   Set(GetUniform<glm::vec3>(name), vector);
 }
 
 void Program::UniformVector4f(const std::string& name, const glm::vec4& vector)
 {
-   glUniform4fv(Uniform(name), 1, glm::value_ptr(vector));
+   Set(GetUniform<glm::vec4>(name), vector);
 }
 
 void Program::UniformMatrix4f(const std::string& name, const glm::mat4& matrix)
 {
-   glUniformMatrix4fv(Uniform(name), 1, GL_FALSE, glm::value_ptr(matrix));
+   Set(GetUniform<glm::mat4>(name), matrix);
 }
 
-GLuint Program::Attrib(const std::string& name)
+void Program::InvalidateUniformCache()
 {
-   size_t oldCursor = attributeCursor;
-   while (attributeCursor < attributes.size())
+   for (UniformSlot& slot : uniformSlots)
    {
-      std::pair<std::string, GLuint>& entry = attributes[attributeCursor++];
-      if (entry.first == name)
-      {
-         return entry.second;
-      }
+      slot.cached = false;
    }
+}
 
-   attributeCursor = 0;
-   while (attributeCursor < oldCursor)
+GLenum Program::GetUniformType(const std::string& name)
+{
+   uint32_t index = FindUniform(name);
+   return index == UniformHandle<void>::kInvalid ? GL_NONE : uniformSlots[index].type;
+}
+
+GLuint Program::Attrib(const std::string& name)
+{
+   auto it = attributes.find(name);
+   if (it != attributes.end())
    {
-      std::pair<std::string, GLuint>& entry = attributes[attributeCursor++];
-      if (entry.first == name)
-      {
-         return entry.second;
-      }
+      return GLuint(it->second);
    }
 
-   attributeCursor = 0;
+   // Not active at link time, but ask anyway in case it was added under a different name.
    GLint location = glGetAttribLocation(id, name.c_str());
-   if (location >= 0)
-   {
-      attributes.push_back(std::make_pair(name, (GLuint)location));
-   }
+   attributes.emplace(name, location);
 
    CheckErrors();
    return GLuint(location);
@@ -409,38 +384,117 @@ GLuint Program::Attrib(const std::string& name)
 
 GLint Program::Uniform(const std::string& name)
 {
-   size_t oldCursor = uniformCursor;
-   while (uniformCursor < uniforms.size())
+   uint32_t index = FindUniform(name);
+   return index == UniformHandle<void>::kInvalid ? -1 : uniformSlots[index].location;
+}
+
+uint32_t Program::FindUniform(const std::string& name)
+{
+   auto it = uniformIndices.find(name);
+   if (it != uniformIndices.end())
    {
-      std::pair<std::string, GLint>& entry = uniforms[uniformCursor++];
-      if (entry.first == name)
-      {
-         return entry.second;
+      return it->second;
+   }
+
+   // Array elements other than the first aren't listed as active uniforms, so they
+   // get looked up (once) on demand.
+   uint32_t index = UniformHandle<void>::kInvalid;
+   GLint location = glGetUniformLocation(id, name.c_str());
+   if (location >= 0)
+   {
+      index = uint32_t(uniformSlots.size());
+      uniformSlots.push_back(UniformSlot{location, GL_NONE});
+   }
+   uniformIndices.emplace(name, index);
+
+   CheckErrors();
+   return index;
+}
+
+Maybe<void> Program::Link()
+{
+   glLinkProgram(id);
+
+   // Check the program
+   GLint result = GL_FALSE;
+   int infoLogLength;
+   glGetProgramiv(id, GL_LINK_STATUS, &result);
+   glGetProgramiv(id, GL_INFO_LOG_LENGTH, &infoLogLength);
+   if (infoLogLength > 0) {
+      char* error = new char[size_t(infoLogLength) + 1];
+      CUBEWORLD_SCOPE_EXIT([&] { delete[] error; });
+      glGetProgramInfoLog(id, infoLogLength, nullptr, error);
+
+      if (error[0] != '\0') {
+         return Failure(error).WithContext("Failed linking program");
       }
    }
 
-   uniformCursor = 0;
-   while (uniformCursor < oldCursor)
+   ResolveLocations();
+   return Success;
+}
+
+void Program::ResolveLocations()
+{
+   attributes.clear();
+   uniformSlots.clear();
+   uniformIndices.clear();
+
+   GLint maxUniformLength = 0, maxAttributeLength = 0;
+   glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformLength);
+   glGetProgramiv(id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxAttributeLength);
+   std::vector<GLchar> buffer(size_t(std::max({maxUniformLength, maxAttributeLength, 1})));
+
+   GLint numUniforms = 0;
+   glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &numUniforms);
+   uniformSlots.reserve(size_t(numUniforms));
+   for (GLint i = 0; i < numUniforms; ++i)
    {
-      std::pair<std::string, GLint>& entry = uniforms[uniformCursor++];
-      if (entry.first == name)
+      GLsizei length = 0;
+      GLint size = 0;
+      GLenum type = GL_NONE;
+      glGetActiveUniform(id, GLuint(i), GLsizei(buffer.size()), &length, &size, &type, buffer.data());
+
+      std::string name(buffer.data(), size_t(length));
+      GLint location = glGetUniformLocation(id, name.c_str());
+      if (location < 0)
+      {
+         // Members of uniform blocks don't have locations.
+         continue;
+      }
+
+      uint32_t index = uint32_t(uniformSlots.size());
+      uniformSlots.push_back(UniformSlot{location, type});
+      uniformIndices.emplace(name, index);
+
+      // Arrays are reported as "name[0]", but are usually set as "name".
+      if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
       {
-         return entry.second;
+         uniformIndices.emplace(name.substr(0, name.size() - 3), index);
       }
    }
 
-   uniformCursor = 0;
-   GLint location = glGetUniformLocation(id, name.c_str());
-   if (location >= 0)
+   GLint numAttributes = 0;
+   glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &numAttributes);
+   for (GLint i = 0; i < numAttributes; ++i)
    {
-      uniforms.push_back(std::make_pair(name, location));
+      GLsizei length = 0;
+      GLint size = 0;
+      GLenum type = GL_NONE;
+      glGetActiveAttrib(id, GLuint(i), GLsizei(buffer.size()), &length, &size, &type, buffer.data());
+
+      std::string name(buffer.data(), size_t(length));
+      GLint location = glGetAttribLocation(id, name.c_str());
+      if (location >= 0)
+      {
+         // Built-ins like gl_VertexID are active, but have no location.
+         attributes.emplace(name, location);
+      }
    }
 
    CheckErrors();
-   return GLint(location);
 }
 
-
 }; // namespace Graphics
 
 }; // namespace Engine
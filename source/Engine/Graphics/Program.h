@@ -2,13 +2,16 @@
 
 #pragma once
 
+#include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <GL/includes.h>
 #include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 #include <RGBDesignPatterns/Maybe.h>
 #include <RGBDesignPatterns/Scope.h>
@@ -22,6 +25,20 @@ namespace Engine
 namespace Graphics
 {
 
+//
+// A uniform location, resolved once and then used to set values without any string lookups.
+// The type is checked at compile time against the setters Program provides.
+//
+template<typename T>
+struct UniformHandle
+{
+    static constexpr uint32_t kInvalid = ~0u;
+
+    uint32_t index = kInvalid;
+
+    bool IsValid() const { return index != kInvalid; }
+};
+
 class Program
 {
 public:
@@ -61,6 +78,47 @@ public:
 #define BIND_PROGRAM_IN_SCOPE(program) program->Bind();\
    CUBEWORLD_SCOPE_EXIT([&] { program->Unbind(); });
 
+    //
+    // Look up a uniform once, e.g. at configure time, for use with Set() every frame.
+    // Returns an invalid handle if the uniform doesn't exist or was optimized away;
+    // setting it is then a no-op, same as glUniform with location -1.
+    //
+    template<typename T>
+    UniformHandle<T> GetUniform(const std::string& name)
+    {
+        return UniformHandle<T>{FindUniform(name)};
+    }
+
+    //
+    // Set a uniform. Program remembers the last value it set for every uniform, and skips
+    // the driver call when it hasn't changed. That means anything setting uniforms on this
+    // program directly through GL must call InvalidateUniformCache() afterwards.
+    //
+    template<typename T>
+    void Set(UniformHandle<T> handle, const T& value)
+    {
+        static_assert(sizeof(T) <= sizeof(UniformSlot::value), "Uniform type too large to cache");
+        if (!handle.IsValid())
+        {
+            return;
+        }
+
+        UniformSlot& slot = uniformSlots[handle.index];
+        if (slot.cached && memcmp(slot.value, &value, sizeof(T)) == 0)
+        {
+            return;
+        }
+
+        memcpy(slot.value, &value, sizeof(T));
+        slot.cached = true;
+        SetUniformValue(slot.location, value);
+    }
+
+    void InvalidateUniformCache();
+
+    // GL type of an active uniform (e.g. GL_FLOAT_VEC3), or GL_NONE if it isn't one.
+    GLenum GetUniformType(const std::string& name);
+
     // There's so much boilerplate is it really worth defining them all?
     void Uniform1u(const std::string& name, const uint32_t value);
     void Uniform1i(const std::string& name, const int32_t value);
@@ -77,23 +135,24 @@ public:
     void UniformMatrix4f(const std::string& name, const glm::mat4& matrix);
 
     //
-    // Loads the ID for the specified attribute into memory.
-    // Can be used both for preloading all attributes, using the reference later,
-    // or called every time the ID is needed.
-    //
-    // For best performance when preloading, call in the same order you use attributes in.
+    // Gets the location of the specified attribute. Active attributes are all looked up
+    // when the program is linked, so this is just a hash lookup, but hot paths should
+    // still hang on to the result instead of calling it every time.
     //
     GLuint Attrib(const std::string& name);
 
     //
-    // Loads the ID for the specified attribute into memory.
-    // Can be used both for preloading all uniforms, using the reference later,
-    // or called every time the ID is needed.
-    //
-    // For best performance when preloading, call in the same order you use uniforms in.
+    // Gets the location of the specified uniform. Prefer GetUniform() and Set().
     //
     GLint Uniform(const std::string& name);
 
+    //
+    // Query every active uniform and attribute, so later lookups never go to the driver.
+    // Called after linking; public so that the lookup tables can be tested without a
+    // real GL context.
+    //
+    void ResolveLocations();
+
     inline void CheckErrors()
     {
 #if !NDEBUG
@@ -107,22 +166,45 @@ public:
     Program(GLuint program)
         : id(program)
         , attributes{}
-        , uniforms{}
-        , attributeCursor(0)
-        , uniformCursor(0)
+        , uniformSlots{}
+        , uniformIndices{}
     {};
     ~Program();
 
+private:
+    struct UniformSlot
+    {
+        GLint location;
+        GLenum type;
+
+        // Last value set, for skipping redundant driver calls.
+        bool cached = false;
+        alignas(16) uint8_t value[sizeof(glm::mat4)];
+    };
+
+    Maybe<void> Link();
+    uint32_t FindUniform(const std::string& name);
+
+    static void SetUniformValue(GLint location, int32_t value) { glUniform1i(location, value); }
+    static void SetUniformValue(GLint location, uint32_t value) { glUniform1ui(location, value); }
+    static void SetUniformValue(GLint location, float value) { glUniform1f(location, value); }
+    static void SetUniformValue(GLint location, const glm::vec2& value) { glUniform2fv(location, 1, glm::value_ptr(value)); }
+    static void SetUniformValue(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, glm::value_ptr(value)); }
+    static void SetUniformValue(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, glm::value_ptr(value)); }
+    static void SetUniformValue(GLint location, const glm::ivec2& value) { glUniform2iv(location, 1, glm::value_ptr(value)); }
+    static void SetUniformValue(GLint location, const glm::ivec3& value) { glUniform3iv(location, 1, glm::value_ptr(value)); }
+    static void SetUniformValue(GLint location, const glm::uvec3& value) { glUniform3uiv(location, 1, glm::value_ptr(value)); }
+    static void SetUniformValue(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+
 private:
     GLuint id;
 
-    std::vector<std::pair<std::string, GLuint>> attributes;
-    std::vector<std::pair<std::string, GLint>> uniforms;
+    // Locations by name. Names that turned out not to exist are kept too (as -1),
+    // so asking for them again doesn't go back to the driver.
+    std::unordered_map<std::string, GLint> attributes;
 
-private:
-    // Optimizing
-    size_t attributeCursor;
-    size_t uniformCursor;
+    std::vector<UniformSlot> uniformSlots;
+    std::unordered_map<std::string, uint32_t> uniformIndices;
 };
 
 }; // namespace Graphics
@@ -0,0 +1,276 @@
+// By Thomas Steinke
+
+#include <algorithm>
+
+#include "RenderQueue.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace Graphics
+{
+
+// --------------------------------------------------------------------------
+// -                            Render Queue                                -
+// --------------------------------------------------------------------------
+
+void RenderQueue::Draw(uint64_t key, const DrawCommand& command)
+{
+   assert(command.program != nullptr && command.layout != nullptr);
+
+   uint32_t index = uint32_t(mCommands.size());
+   mCommands.push_back(RecordedCommand{command, mPendingUniforms, uint32_t(mUniformWrites.size())});
+   mPendingUniforms = uint32_t(mUniformWrites.size());
+
+   if (!mEntries.empty() && key < mEntries.back().key)
+   {
+      mSorted = false;
+   }
+   mEntries.push_back(Entry{key, index});
+}
+
+//
+// LSD radix sort, one byte at a time. Bytes that are the same for every key (very
+// common for the pass and program fields) are skipped entirely.
+//
+void RenderQueue::Sort()
+{
+   if (mSorted)
+   {
+      return;
+   }
+
+   uint64_t differing = 0;
+   for (const Entry& entry : mEntries)
+   {
+      differing |= entry.key ^ mEntries[0].key;
+   }
+
+   mScratch.resize(mEntries.size());
+   for (uint32_t shift = 0; shift < 64; shift += 8)
+   {
+      if (((differing >> shift) & 0xff) == 0)
+      {
+         continue;
+      }
+
+      size_t counts[256] = {};
+      for (const Entry& entry : mEntries)
+      {
+         ++counts[(entry.key >> shift) & 0xff];
+      }
+
+      size_t offset = 0;
+      for (size_t& count : counts)
+      {
+         size_t next = offset + count;
+         count = offset;
+         offset = next;
+      }
+
+      for (const Entry& entry : mEntries)
+      {
+         mScratch[counts[(entry.key >> shift) & 0xff]++] = entry;
+      }
+      mEntries.swap(mScratch);
+   }
+
+   mSorted = true;
+}
+
+RenderQueue::Stats RenderQueue::Submit(RenderBackend& backend)
+{
+   Sort();
+
+   Stats stats;
+   Program* program = nullptr;
+   const DrawCommand* vertices = nullptr;
+   for (const Entry& entry : mEntries)
+   {
+      const RecordedCommand& recorded = mCommands[entry.command];
+      const DrawCommand& command = recorded.draw;
+
+      if (command.program != program)
+      {
+         program = command.program;
+         vertices = nullptr;
+         backend.BindProgram(*program);
+         ++stats.programBinds;
+
+         for (const auto& [target, write] : mProgramUniforms)
+         {
+            if (target == program)
+            {
+               backend.SetUniform(*program, write, &mUniformData[write.offset]);
+               ++stats.uniformWrites;
+            }
+         }
+      }
+
+      if (vertices == nullptr ||
+          command.layout != vertices->layout ||
+          command.indices != vertices->indices ||
+          memcmp(command.buffers, vertices->buffers, sizeof(command.buffers)) != 0)
+      {
+         vertices = &command;
+         backend.BindVertices(*program, command);
+         ++stats.vertexBinds;
+      }
+
+      for (uint32_t i = recorded.uniformsBegin; i < recorded.uniformsEnd; ++i)
+      {
+         const UniformWrite& write = mUniformWrites[i];
+         backend.SetUniform(*program, write, &mUniformData[write.offset]);
+         ++stats.uniformWrites;
+      }
+
+      backend.Draw(command);
+      ++stats.draws;
+   }
+
+   if (!mEntries.empty())
+   {
+      backend.Finish();
+   }
+
+   Clear();
+   return stats;
+}
+
+void RenderQueue::Clear()
+{
+   mEntries.clear();
+   mCommands.clear();
+   mUniformWrites.clear();
+   mProgramUniforms.clear();
+   mUniformData.clear();
+   mPendingUniforms = 0;
+   mSorted = true;
+}
+
+// --------------------------------------------------------------------------
+// -                          GL Render Backend                             -
+// --------------------------------------------------------------------------
+
+void GLRenderBackend::BindProgram(Program& program)
+{
+   if (mProgram != nullptr)
+   {
+      mProgram->Unbind();
+   }
+
+   mProgram = &program;
+   mProgram->Bind();
+}
+
+void GLRenderBackend::BindVertices(Program&, const DrawCommand& command)
+{
+   GLuint bound = 0;
+   for (const VertexAttribute& attribute : command.layout->attributes)
+   {
+      GLuint buffer = command.buffers[attribute.buffer];
+      if (buffer != bound)
+      {
+         glBindBuffer(GL_ARRAY_BUFFER, buffer);
+         bound = buffer;
+      }
+
+      glEnableVertexAttribArray(attribute.location);
+      if (attribute.integer)
+      {
+         glVertexAttribIPointer(attribute.location, attribute.count, attribute.type, attribute.stride, (const GLvoid*)attribute.offset);
+      }
+      else
+      {
+         glVertexAttribPointer(attribute.location, attribute.count, attribute.type, attribute.normalized, attribute.stride, (const GLvoid*)attribute.offset);
+      }
+
+      // Always set, since the divisor sticks to the location and not the buffer.
+      glVertexAttribDivisor(attribute.location, attribute.divisor);
+   }
+
+   if (command.indices != 0)
+   {
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command.indices);
+   }
+   CHECK_GL_ERRORS();
+}
+
+void GLRenderBackend::SetUniform(Program& program, const UniformWrite& write, const void* data)
+{
+   switch (write.type)
+   {
+   case UniformType::Int:
+      program.Set(UniformHandle<int32_t>{write.index}, *static_cast<const int32_t*>(data));
+      break;
+   case UniformType::UInt:
+      program.Set(UniformHandle<uint32_t>{write.index}, *static_cast<const uint32_t*>(data));
+      break;
+   case UniformType::Float:
+      program.Set(UniformHandle<float>{write.index}, *static_cast<const float*>(data));
+      break;
+   case UniformType::Vec2:
+      program.Set(UniformHandle<glm::vec2>{write.index}, *static_cast<const glm::vec2*>(data));
+      break;
+   case UniformType::Vec3:
+      program.Set(UniformHandle<glm::vec3>{write.index}, *static_cast<const glm::vec3*>(data));
+      break;
+   case UniformType::Vec4:
+      program.Set(UniformHandle<glm::vec4>{write.index}, *static_cast<const glm::vec4*>(data));
+      break;
+   case UniformType::Mat4:
+      program.Set(UniformHandle<glm::mat4>{write.index}, *static_cast<const glm::mat4*>(data));
+      break;
+   }
+}
+
+void GLRenderBackend::Draw(const DrawCommand& command)
+{
+   if (command.indices != 0)
+   {
+      const GLvoid* first = (const GLvoid*)(sizeof(GLuint) * size_t(command.first));
+      if (command.baseInstance != 0)
+      {
+         glDrawElementsInstancedBaseInstance(command.mode, command.count, GL_UNSIGNED_INT, first, command.instances, command.baseInstance);
+      }
+      else if (command.instances > 1)
+      {
+         glDrawElementsInstanced(command.mode, command.count, GL_UNSIGNED_INT, first, command.instances);
+      }
+      else
+      {
+         glDrawElements(command.mode, command.count, GL_UNSIGNED_INT, first);
+      }
+   }
+   else if (command.baseInstance != 0)
+   {
+      glDrawArraysInstancedBaseInstance(command.mode, command.first, command.count, command.instances, command.baseInstance);
+   }
+   else if (command.instances > 1)
+   {
+      glDrawArraysInstanced(command.mode, command.first, command.count, command.instances);
+   }
+   else
+   {
+      glDrawArrays(command.mode, command.first, command.count);
+   }
+   CHECK_GL_ERRORS();
+}
+
+void GLRenderBackend::Finish()
+{
+   if (mProgram != nullptr)
+   {
+      mProgram->Unbind();
+      mProgram = nullptr;
+   }
+}
+
+}; // namespace Graphics
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
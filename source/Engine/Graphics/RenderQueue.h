@@ -0,0 +1,255 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <GL/includes.h>
+#include <glm/glm.hpp>
+
+#include "Program.h"
+
+namespace CubeWorld
+{
+
+namespace Engine
+{
+
+namespace Graphics
+{
+
+//
+// Draws are sorted by a 64-bit key, most significant field first:
+//
+//   | pass (8) | program (12) | material (20) | depth (24) |
+//
+// so that everything in a pass is drawn together, then by program (the most expensive
+// state change), then by whatever else the caller wants batched (usually vertex buffers),
+// and finally front to back.
+//
+struct RenderKey
+{
+   static constexpr uint64_t Make(uint8_t pass, uint32_t program, uint32_t material, uint32_t depth)
+   {
+      return (uint64_t(pass) << 56) |
+             (uint64_t(program & 0xfff) << 44) |
+             (uint64_t(material & 0xfffff) << 24) |
+             uint64_t(depth & 0xffffff);
+   }
+
+   // Map a view-space distance onto the 24 bits of the depth field.
+   // Translucent passes, which want back to front, can use 0xffffff - depth.
+   static uint32_t QuantizeDepth(float distance, float maxDistance)
+   {
+      float normalized = glm::clamp(distance / maxDistance, 0.0f, 1.0f);
+      return uint32_t(normalized * float(0xffffff));
+   }
+};
+
+//
+// How to read one attribute out of a draw's vertex buffers.
+//
+struct VertexAttribute
+{
+   GLuint location;
+   GLint count;
+   GLenum type;
+   GLsizei stride;
+   size_t offset;
+
+   // Which of the draw's buffers this comes from.
+   uint8_t buffer = 0;
+
+   // Integer attributes go through glVertexAttribIPointer.
+   bool integer = false;
+   GLboolean normalized = GL_FALSE;
+
+   // Non-zero for per-instance data, which advances once every divisor instances.
+   GLuint divisor = 0;
+};
+
+struct VertexLayout
+{
+   std::vector<VertexAttribute> attributes;
+};
+
+enum class UniformType : uint8_t
+{
+   Int,
+   UInt,
+   Float,
+   Vec2,
+   Vec3,
+   Vec4,
+   Mat4,
+};
+
+struct UniformWrite
+{
+   uint32_t index; // UniformHandle::index
+   UniformType type;
+   uint32_t offset; // Into the queue's uniform data
+};
+
+struct DrawCommand
+{
+   static constexpr size_t kMaxBuffers = 4;
+
+   Program* program;
+   const VertexLayout* layout;
+   GLuint buffers[kMaxBuffers] = {};
+
+   // If set, this is an indexed draw, with first and count referring to indices.
+   GLuint indices = 0;
+
+   GLenum mode = GL_TRIANGLES;
+   GLint first = 0;
+   GLsizei count = 0;
+   GLsizei instances = 1;
+
+   // Where per-instance attributes start reading from, so that many batches can share
+   // one instance buffer.
+   GLuint baseInstance = 0;
+};
+
+//
+// Where a RenderQueue's commands end up. The queue has already dropped redundant program
+// and vertex buffer changes by the time they get here.
+//
+class RenderBackend
+{
+public:
+   virtual ~RenderBackend() {}
+
+   virtual void BindProgram(Program& program) = 0;
+   virtual void BindVertices(Program& program, const DrawCommand& command) = 0;
+   virtual void SetUniform(Program& program, const UniformWrite& write, const void* data) = 0;
+   virtual void Draw(const DrawCommand& command) = 0;
+
+   // Called once after the last draw.
+   virtual void Finish() = 0;
+};
+
+//
+// Issues everything to the current GL context. Uniform values that haven't changed
+// are filtered by Program::Set.
+//
+class GLRenderBackend : public RenderBackend
+{
+public:
+   void BindProgram(Program& program) override;
+   void BindVertices(Program& program, const DrawCommand& command) override;
+   void SetUniform(Program& program, const UniformWrite& write, const void* data) override;
+   void Draw(const DrawCommand& command) override;
+   void Finish() override;
+
+private:
+   Program* mProgram = nullptr;
+};
+
+//
+// RenderQueue collects draws from a system, sorts them by key and replays them through a
+// backend. Recording and sorting never touch GL, so they can be tested and benchmarked
+// without a context.
+//
+// Usage, per frame:
+//    queue.Uniform(modelMatrix, matrix);  // Applies to the next Draw
+//    queue.Draw(key, command);
+//    ...
+//    queue.Submit(backend);               // Sorts, replays and clears
+//
+class RenderQueue
+{
+public:
+   struct Stats
+   {
+      size_t draws = 0;
+      size_t programBinds = 0;
+      size_t vertexBinds = 0;
+      size_t uniformWrites = 0;
+   };
+
+public:
+   // Set a uniform for the next draw only.
+   template<typename T>
+   void Uniform(UniformHandle<T> handle, const T& value)
+   {
+      if (handle.IsValid())
+      {
+         mUniformWrites.push_back(WriteUniform(handle, value));
+      }
+   }
+
+   // Set a uniform for every draw using program, e.g. the camera matrices.
+   template<typename T>
+   void Uniform(Program& program, UniformHandle<T> handle, const T& value)
+   {
+      if (handle.IsValid())
+      {
+         mProgramUniforms.push_back(std::make_pair(&program, WriteUniform(handle, value)));
+      }
+   }
+
+   void Draw(uint64_t key, const DrawCommand& command);
+
+   size_t GetSize() const { return mCommands.size(); }
+
+   // Sort the recorded draws by key. Stable, so draws with equal keys keep their order.
+   void Sort();
+
+   // Sort (if needed), then replay every draw through backend and clear the queue.
+   Stats Submit(RenderBackend& backend);
+
+   void Clear();
+
+private:
+   template<typename T> static constexpr UniformType GetUniformType();
+
+   template<typename T>
+   UniformWrite WriteUniform(UniformHandle<T> handle, const T& value)
+   {
+      uint32_t offset = uint32_t(mUniformData.size());
+      mUniformData.resize(mUniformData.size() + sizeof(T));
+      memcpy(&mUniformData[offset], &value, sizeof(T));
+      return UniformWrite{handle.index, GetUniformType<T>(), offset};
+   }
+
+   struct Entry
+   {
+      uint64_t key;
+      uint32_t command;
+   };
+
+   struct RecordedCommand
+   {
+      DrawCommand draw;
+      uint32_t uniformsBegin;
+      uint32_t uniformsEnd;
+   };
+
+   std::vector<Entry> mEntries;
+   std::vector<Entry> mScratch;
+   std::vector<RecordedCommand> mCommands;
+   std::vector<UniformWrite> mUniformWrites;
+   std::vector<std::pair<Program*, UniformWrite>> mProgramUniforms;
+   std::vector<uint8_t> mUniformData;
+   uint32_t mPendingUniforms = 0;
+   bool mSorted = true;
+};
+
+template<> constexpr UniformType RenderQueue::GetUniformType<int32_t>() { return UniformType::Int; }
+template<> constexpr UniformType RenderQueue::GetUniformType<uint32_t>() { return UniformType::UInt; }
+template<> constexpr UniformType RenderQueue::GetUniformType<float>() { return UniformType::Float; }
+template<> constexpr UniformType RenderQueue::GetUniformType<glm::vec2>() { return UniformType::Vec2; }
+template<> constexpr UniformType RenderQueue::GetUniformType<glm::vec3>() { return UniformType::Vec3; }
+template<> constexpr UniformType RenderQueue::GetUniformType<glm::vec4>() { return UniformType::Vec4; }
+template<> constexpr UniformType RenderQueue::GetUniformType<glm::mat4>() { return UniformType::Mat4; }
+
+}; // namespace Graphics
+
+}; // namespace Engine
+
+}; // namespace CubeWorld
@@ -10,6 +10,7 @@
 #include <RGBFileSystem/FileSystem.h>
 #include <RGBFileSystem/Paths.h>
 #include <RGBLogger/Logger.h>
+#include <RGBNetworking/BinarySerializer.h>
 #include <RGBNetworking/JSONSerializer.h>
 #include <RGBNetworking/YAMLSerializer.h>
 
@@ -108,7 +109,9 @@ Maybe<std::unique_ptr<Texture>> Texture::Load(const std::string& filename)
 
    BindingProperty metadata;
 
-   // Look for and load any metadata
+   // Look for and load any metadata. A binary copy made by convert-document is only used
+   // when the text it came from isn't around, so that edits to the text are never hidden
+   // by a stale copy.
 #pragma warning(disable : 4101)
    if (auto[_, exists] = DiskFileSystem{}.Exists(filename + ".yaml"); exists)
 #pragma warning(default : 4101)
@@ -137,6 +140,20 @@ Maybe<std::unique_ptr<Texture>> Texture::Load(const std::string& filename)
          metadata = std::move(*maybeMetadata);
       }
    }
+#pragma warning(disable : 4101 4456 6246)
+   else if (auto[_, exists] = DiskFileSystem{}.Exists(filename + ".bpb"); exists)
+#pragma warning(default : 4101 4456 6246)
+   {
+      Maybe<BindingProperty> maybeMetadata = BinarySerializer::DeserializeFile(filename + ".bpb");
+      if (!maybeMetadata)
+      {
+         return maybeMetadata.Failure().WithContext("Failed reading metadata");
+      }
+      else
+      {
+         metadata = std::move(*maybeMetadata);
+      }
+   }
 
    if (metadata["width"] != texture->mWidth)
    {
@@ -87,7 +87,7 @@ public:
     void AttribPointer(GLuint location, GLint count, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
     void AttribIPointer(GLuint location, GLint count, GLenum type, GLsizei stride, const GLvoid* pointer);
 
-    GLuint GetBuffer() { return mBuffer; }
+    GLuint GetBuffer() const { return mBuffer; }
     void BufferData(size_t size, void* data, GLuint type = GL_STATIC_DRAW);
     void CopyFrom(const VBO& other, size_t amount, void* readOffset = nullptr, void* writeOffset = nullptr);
 
@@ -1,5 +1,8 @@
 // By Thomas Steinke
 
+#include <algorithm>
+#include <GL/includes.h>
+
 #include "SystemManager.h"
 
 namespace CubeWorld
@@ -11,7 +14,10 @@ namespace Engine
 void SystemManager::UpdateAll(TIMEDELTA dt)
 {
 #if CUBEWORLD_BENCHMARK_SYSTEMS
-    glFinish();
+    if (mGPUSync)
+    {
+        glFinish();
+    }
 #endif
     assert(mInitialized);
     for (size_t i = 0; i < mSystems.size(); ++i)
@@ -25,11 +31,26 @@ void SystemManager::UpdateAll(TIMEDELTA dt)
         std::pair<std::string, Timer<100>>& benchmark = mBenchmarks[i];
         benchmark.second.Reset();
 #endif
-        mSystems[i]->Update(mEntityManager, mEventManager, dt);
-        CHECK_GL_ERRORS();
+        {
+#if CUBEWORLD_TRACK_ALLOCATIONS
+            AllocationTracker::Scope allocations(mAllocationSites[i]);
+#endif
+            mSystems[i]->Update(mEntityManager, mEventManager, dt);
+        }
+        if (mGPUSync)
+        {
+            CHECK_GL_ERRORS();
 #if CUBEWORLD_BENCHMARK_SYSTEMS
-        glFinish();
-        benchmark.second.Elapsed();
+            glFinish();
+#endif
+        }
+#if CUBEWORLD_BENCHMARK_SYSTEMS
+        double elapsed = benchmark.second.Elapsed();
+
+        BenchmarkTotals& totals = mBenchmarkTotals[i];
+        ++totals.samples;
+        totals.total += elapsed;
+        totals.max = std::max(totals.max, elapsed);
 #endif
     }
 }
@@ -6,6 +6,7 @@
 #include <memory>
 #include <unordered_map>
 
+#include "../Core/AllocationTracker.h"
 #include "../Core/Timer.h"
 #include "../Entity/EntityManager.h"
 #include "../Event/EventManager.h"
@@ -23,6 +24,18 @@ namespace Engine
 
 class SystemManager
 {
+public:
+#if CUBEWORLD_BENCHMARK_SYSTEMS
+   // Lifetime timing totals for one system, e.g. for reporting at the end of a headless run.
+   struct BenchmarkTotals
+   {
+      std::string name;
+      uint64_t samples = 0;
+      double total = 0;
+      double max = 0;
+   };
+#endif
+
 public:
    SystemManager(EntityManager& entityManager, EventManager& eventManager)
       : mInitialized(false)
@@ -44,6 +57,10 @@ public:
       name = name.substr(17);
 
       mBenchmarks.push_back(std::make_pair(std::string(name), Timer<100>()));
+      mBenchmarkTotals.push_back(BenchmarkTotals{name});
+#endif
+#if CUBEWORLD_TRACK_ALLOCATIONS
+      mAllocationSites.push_back(AllocationTracker::GetSite(typeid(S).name()));
 #endif
       return (S*)mSystems.back().get();
    }
@@ -57,19 +74,29 @@ public:
 
 #if CUBEWORLD_BENCHMARK_SYSTEMS
    std::vector<std::pair<std::string, double>> GetBenchmarks();
+   const std::vector<BenchmarkTotals>& GetBenchmarkTotals() const { return mBenchmarkTotals; }
 #endif
 
+   // Whether to synchronize with the GPU (glFinish, and error checks) around each system.
+   // Must be disabled when there is no GL context, i.e. headless runs.
+   void SetGPUSync(bool sync) { mGPUSync = sync; }
+
    // Configure system. Call once after adding all systems.
    void Configure();
 
 private:
    bool mInitialized;
+   bool mGPUSync = true;
    EntityManager& mEntityManager;
    EventManager& mEventManager;
 
    std::vector<std::unique_ptr<BaseSystem>> mSystems;
 #if CUBEWORLD_BENCHMARK_SYSTEMS
    std::vector<std::pair<std::string, Timer<100>>> mBenchmarks;
+   std::vector<BenchmarkTotals> mBenchmarkTotals;
+#endif
+#if CUBEWORLD_TRACK_ALLOCATIONS
+   std::vector<AllocationTracker::Site*> mAllocationSites;
 #endif
 };
 
@@ -2,16 +2,25 @@
 // NotCubeWorld - An attempt to make something that looks like CubeWorld
 //
 
+#include <algorithm>
+
+#include <RGBDesignPatterns/Macros.h>
 #include <RGBLogger/Logger.h>
 #include <RGBLogger/StdoutLogger.h>
 #include <RGBLogger/DebugLogger.h>
+#include <Engine/Core/AllocationTracker.h>
+#include <Engine/Core/FrameAllocator.h>
+#include <Engine/Core/HeadlessInput.h>
 #include <Engine/Core/Input.h>
+#include <Engine/Core/InputRecording.h>
+#include <Engine/Core/Metrics.h>
 #include <Engine/Core/StateManager.h>
 #include <Engine/Core/Timer.h>
 #include <Engine/Core/Window.h>
 #include <Engine/Graphics/Program.h>
 #include <Shared/DebugHelper.h>
 #include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxLoader.h>
 #include <Shared/Imgui/Context.h>
 #include <Shared/Imgui/StateWindow.h>
 
@@ -26,12 +35,112 @@ using namespace Game;
 const double FRAMES_PER_SEC = 60.0;
 const double SEC_PER_FRAME = (1 / FRAMES_PER_SEC);
 
+//
+// Runs the simulation for a fixed number of ticks without creating a window or GL context,
+// then reports how long each system and each tick took. Meant for soak and load testing on
+// machines without a GPU, so only systems that don't render get run.
+//
+// If a recording is provided, its input and timesteps are replayed instead, which makes
+// the results comparable between builds. Every metric is logged at the end, and written
+// to metricsPath as JSON if there is one.
+//
+int RunHeadless(uint32_t ticks, std::unique_ptr<Engine::InputPlayer> player, const std::string& metricsPath)
+{
+   using namespace Engine;
+
+   HeadlessInput input;
+   StateManager& stateManager = StateManager::Instance();
+
+   DynamicState::Options options;
+   options.headless = true;
+   std::unique_ptr<DynamicState> state = std::make_unique<DynamicState>(input, input, options);
+   const SystemManager& systems = state->GetSystems();
+   stateManager.SetState(std::move(state));
+
+   if (player)
+   {
+      ticks = uint32_t(player->GetFrameCount());
+   }
+
+   LOG_INFO("Running headless for %1 ticks", ticks);
+
+   Timer<1> clock;
+   std::vector<double> tickTimes;
+   tickTimes.reserve(ticks);
+   Metrics::Histogram* tickHistogram = Metrics::GetHistogram("Tick time");
+   for (uint32_t tick = 0; tick < ticks; ++tick)
+   {
+      clock.Reset();
+
+      double dt = player ? player->PlayFrame(input) : SEC_PER_FRAME;
+      input.Update();
+      stateManager.Update(dt);
+      FrameAllocator::Reset();
+
+      tickTimes.push_back(clock.Elapsed());
+      tickHistogram->RecordSeconds(tickTimes.back());
+#if CUBEWORLD_TRACK_ALLOCATIONS
+      AllocationTracker::EndFrame();
+#endif
+   }
+
+   stateManager.Shutdown();
+
+#if CUBEWORLD_BENCHMARK_SYSTEMS
+   LOG_INFO("%1 | %2 | %3 | %4", "System", "Avg (ms)", "Max (ms)", "Total (ms)");
+   for (const SystemManager::BenchmarkTotals& system : systems.GetBenchmarkTotals())
+   {
+      double average = system.samples > 0 ? system.total / double(system.samples) : 0.0;
+      LOG_INFO("%1 | %2 | %3 | %4", system.name, average * 1000.0, system.max * 1000.0, system.total * 1000.0);
+   }
+#else
+   CUBEWORLD_UNREFERENCED_VARIABLE(systems);
+#endif
+
+   if (!tickTimes.empty())
+   {
+      std::sort(tickTimes.begin(), tickTimes.end());
+      auto percentile = [&](double p) { return tickTimes[size_t(p * double(tickTimes.size() - 1))] * 1000.0; };
+      LOG_INFO("Tick times (ms): p50 %1 | p90 %2 | p99 %3 | max %4", percentile(0.5), percentile(0.9), percentile(0.99), tickTimes.back() * 1000.0);
+   }
+
+#if CUBEWORLD_TRACK_ALLOCATIONS
+   LOG_INFO("%1 | %2 | %3", "Allocation site", "Allocs/tick", "Bytes/tick");
+   for (const AllocationTracker::Report& site : AllocationTracker::GetTotals())
+   {
+      LOG_INFO("%1 | %2 | %3", site.name, double(site.count) / ticks, double(site.bytes) / ticks);
+   }
+#endif
+
+   const Metrics::Snapshot metrics = Metrics::TakeSnapshot();
+   for (const std::string& line : metrics.ToLines())
+   {
+      LOG_INFO(line);
+   }
+
+   if (!metricsPath.empty())
+   {
+      if (Maybe<void> result = metrics.WriteJSON(metricsPath); !result)
+      {
+         result.Failure().WithContext("Failed writing metrics").Log();
+      }
+   }
+
+   return 0;
+}
+
 int main(int argc, char **argv)
 {
    using namespace Engine;
 
    Asset::SetAssetRootDefault();
 
+   bool headless = false;
+   uint32_t headlessTicks = 600;
+   std::string recordPath;
+   std::string replayPath;
+   std::string metricsPath;
+
    // Parse arguments
    int argi = 0;
    while (argi < argc)
@@ -41,12 +150,59 @@ int main(int argc, char **argv)
       {
          Asset::SetAssetRoot(argv[argi++]);
       }
+      else if (arg == "--headless")
+      {
+         headless = true;
+      }
+      else if (arg == "--ticks")
+      {
+         headlessTicks = uint32_t(std::stoul(argv[argi++]));
+      }
+      else if (arg == "--record")
+      {
+         recordPath = argv[argi++];
+      }
+      else if (arg == "--replay")
+      {
+         // Replays are always headless; they're for comparing builds, not watching.
+         headless = true;
+         replayPath = argv[argi++];
+      }
+      else if (arg == "--metrics")
+      {
+         metricsPath = argv[argi++];
+      }
    }
 
    // Initialize and register loggers to VS debugger and stdout
    Logger::StdoutLogger::Instance();
    Logger::DebugLogger::Instance();
 
+   // Format and write logs on a thread of their own, and get them out if we crash.
+   Logger::LogManager::Instance().StartAsync();
+   Logger::LogManager::Instance().InstallCrashHandler();
+
+   // Bake models as they're loaded, so later runs can skip parsing them.
+   Voxel::VoxLoader::Instance().SetCacheDirectory(Asset::Path("Cache", "Models"));
+
+   if (headless)
+   {
+      std::unique_ptr<InputPlayer> player;
+      if (!replayPath.empty())
+      {
+         Maybe<InputRecording> recording = InputRecording::Load(replayPath);
+         if (!recording)
+         {
+            recording.Failure().Log();
+            return 1;
+         }
+
+         player = std::make_unique<InputPlayer>(std::move(*recording));
+      }
+
+      return RunHeadless(headlessTicks, std::move(player), metricsPath);
+   }
+
    Window::Options windowOptions;
    windowOptions.title = "Not Cube World";
    windowOptions.fullscreen = false;
@@ -62,7 +218,7 @@ int main(int argc, char **argv)
       return 1;
    }
 
-   std::unique_ptr<Engine::State> initialState = std::make_unique<DynamicState>(window);
+   std::unique_ptr<Engine::State> initialState = std::make_unique<DynamicState>(window, window);
    Engine::StateManager& stateManager = Engine::StateManager::Instance();
 
    stateManager.SetState(std::move(initialState));
@@ -80,6 +236,15 @@ int main(int argc, char **argv)
       return FormatString("%.1f", std::round(1.0 / clock.Average()));
    });
 
+#if CUBEWORLD_TRACK_ALLOCATIONS
+   std::vector<AllocationTracker::Report> allocations;
+   auto allocationsMetric = debug.RegisterMetric("Allocations", [&allocations]() -> std::string {
+      uint64_t total = 0;
+      for (const AllocationTracker::Report& site : allocations) { total += site.count; }
+      return allocations.empty() ? "0" : FormatString("%1 (%2: %3)", total, allocations[0].name, allocations[0].count);
+   });
+#endif
+
    // Setup input
    auto _ = window.AddCallback(GLFW_KEY_ESCAPE, [&](int, int, int) {
       window.SetShouldClose(true);
@@ -102,6 +267,13 @@ int main(int argc, char **argv)
       advance = true;
    });
 
+   // Record the session, if asked, so it can be replayed headlessly later.
+   std::unique_ptr<InputRecorder> recorder;
+   if (!recordPath.empty())
+   {
+      recorder = std::make_unique<InputRecorder>(window);
+   }
+
    do {
       double elapsed = clock.Elapsed();
       if (elapsed > 0)
@@ -111,9 +283,16 @@ int main(int argc, char **argv)
 
          double dtActual = std::min(elapsed, SEC_PER_FRAME);
          double dt = (pause && !advance) ? 0 : dtActual / timemod;
+         if (recorder)
+         {
+            recorder->RecordFrame(dt);
+         }
 
          imgui.StartFrame(dtActual);
 
+         // Buffer any models that finished loading in the background.
+         Voxel::VoxLoader::Instance().Finalize();
+
          stateManager.Update(dt);
          ui->Update(dt);
          advance = false;
@@ -131,6 +310,10 @@ int main(int argc, char **argv)
 
          // Swap buffers
          window.SwapBuffers();
+         FrameAllocator::Reset();
+#if CUBEWORLD_TRACK_ALLOCATIONS
+         allocations = AllocationTracker::EndFrame();
+#endif
          glfwPollEvents();
       }
    } // Check if the ESC key was pressed or the window was closed
@@ -138,5 +321,13 @@ int main(int argc, char **argv)
 
    stateManager.Shutdown();
 
+   if (recorder)
+   {
+      if (Maybe<void> result = recorder->GetRecording().Save(recordPath); !result)
+      {
+         result.Failure().Log();
+      }
+   }
+
    return 0;
 }
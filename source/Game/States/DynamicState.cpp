@@ -82,29 +82,44 @@ namespace CubeWorld::Game
 using Entity = Engine::Entity;
 using Transform = Engine::Transform;
 
-DynamicState::DynamicState(Engine::Window& window)
-    : mWorld(mEntities, mEvents)
-    , mWindow(window)
+DynamicState::DynamicState(Engine::Input& input, const Bounded& bounds)
+    : DynamicState(input, bounds, Options{})
+{}
+
+DynamicState::DynamicState(Engine::Input& input, const Bounded& bounds, const Options& options)
+    : mInput(input)
+    , mBounds(bounds)
+    , mOptions(options)
 {
-    mSystems.Add<CameraSystem>(&window);
+    mSystems.Add<CameraSystem>(&input);
     mSystems.Add<AnimationSystem>();
-    mSystems.Add<FlySystem>(&window);
-    mSystems.Add<WalkSystem>(&window);
+    mSystems.Add<FlySystem>(&input);
+    mSystems.Add<WalkSystem>(&input);
     mSystems.Add<WalkAnimationSystem>();
     mSystems.Add<AnimationApplicator>();
     mSystems.Add<FollowerSystem>();
     mSystems.Add<MakeshiftSystem>();
     auto physics = mSystems.Add<BulletPhysics::System>();
-    auto debug = mSystems.Add<BulletPhysics::Debug>(physics, &mCamera);
     mSystems.Add<AnimationEventSystem>(physics);
     mSystems.Add<CombatSystem>();
-    mSystems.Add<Simple3DRenderSystem>(&mCamera);
-    mSystems.Add<VoxelRenderSystem>(&mCamera);
-    mSystems.Add<SimpleParticleSystem>(&mCamera);
-    mSystems.Add<ChunkManagementSystem>(&mWorld);
 
-    // By default, no physics debugging.
-    debug->SetActive(false);
+    if (mOptions.headless)
+    {
+        mSystems.SetGPUSync(false);
+    }
+    else
+    {
+        mWorld = std::make_unique<World>(mEntities, mEvents);
+
+        auto debug = mSystems.Add<BulletPhysics::Debug>(physics, &mCamera);
+        mSystems.Add<Simple3DRenderSystem>(&mCamera);
+        mSystems.Add<VoxelRenderSystem>(&mCamera);
+        mSystems.Add<SimpleParticleSystem>(&mCamera);
+        mSystems.Add<ChunkManagementSystem>(mWorld.get());
+
+        // By default, no physics debugging.
+        debug->SetActive(false);
+    }
 
     mSystems.Configure();
 }
@@ -154,7 +169,7 @@ void DynamicState::InitComponents(
             object.Add<WalkDirector>(entities, props);
             break;
         case SerializedComponent::ArmCamera:
-            handle = object.Add<ArmCamera>(object.Get<Transform>(), props, float(mWindow.GetWidth()) / mWindow.GetHeight());
+            handle = object.Add<ArmCamera>(object.Get<Transform>(), props, float(mBounds.GetWidth()) / mBounds.GetHeight());
             mCamera.Set(handle.get());
             break;
         case SerializedComponent::MouseControlledCamera:
@@ -202,11 +217,11 @@ void DynamicState::Load()
 
 void DynamicState::Initialize()
 {
-    mWindow.SetMouseLock(true);
+    mInput.SetMouseLock(true);
 
     Load();
 
-    mDebugCallback = mWindow.AddCallback(Engine::Window::CtrlKey(GLFW_KEY_R), [&](int, int, int) {
+    mDebugCallback = mInput.AddCallback(Engine::Window::CtrlKey(GLFW_KEY_R), [&](int, int, int) {
         for (auto& [_, entity] : mDynamicEntities)
         {
             mEntities.Destroy(entity.GetID());
@@ -229,17 +244,20 @@ void DynamicState::Unpause()
 
 void DynamicState::Update(TIMEDELTA dt)
 {
-    if (ImGui::Begin("Systems"))
+    if (!mOptions.headless)
     {
-        mSystems.ForAll([&](const std::string& name, Engine::BaseSystem& system) {
-            bool active = system.IsActive();
-            if (ImGui::Checkbox(name.c_str(), &active))
-            {
-                system.SetActive(active);
-            }
-        });
+        if (ImGui::Begin("Systems"))
+        {
+            mSystems.ForAll([&](const std::string& name, Engine::BaseSystem& system) {
+                bool active = system.IsActive();
+                if (ImGui::Checkbox(name.c_str(), &active))
+                {
+                    system.SetActive(active);
+                }
+            });
+        }
+        ImGui::End();
     }
-    ImGui::End();
 
     State::Update(dt);
 }
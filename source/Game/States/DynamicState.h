@@ -20,7 +20,18 @@ namespace Game
 
 class DynamicState : public Engine::State, public Engine::Receiver<DynamicState> {
 public:
-    DynamicState(Engine::Window& window);
+   struct Options
+   {
+      //
+      // Run without a GL context: rendering systems, imgui and GPU-generated world
+      // chunks are all skipped, leaving only the simulation.
+      //
+      bool headless = false;
+   };
+
+public:
+   DynamicState(Engine::Input& input, const Bounded& bounds);
+   DynamicState(Engine::Input& input, const Bounded& bounds, const Options& options);
 
    void Initialize() override;
 
@@ -31,6 +42,8 @@ public:
        const BindingProperty& entity
    );
 
+   const Engine::SystemManager& GetSystems() const { return mSystems; }
+
    void Pause() override;
    void Unpause() override;
    void Update(TIMEDELTA dt) override;
@@ -41,8 +54,11 @@ private:
 
    Engine::Graphics::CameraHandle mCamera;
 
-   World mWorld;
-   Engine::Window& mWindow;
+   // Chunks are generated by compute shaders, so there's no world when running headless.
+   std::unique_ptr<World> mWorld;
+   Engine::Input& mInput;
+   const Bounded& mBounds;
+   Options mOptions;
    std::vector<int32_t> heights;
 };
 
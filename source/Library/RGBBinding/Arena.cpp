@@ -0,0 +1,90 @@
+// By Thomas Steinke
+
+#include <cassert>
+#include <cstdlib>
+
+#include "Arena.h"
+
+namespace CubeWorld
+{
+
+namespace RGBBinding
+{
+
+namespace
+{
+
+Arena*& CurrentArena()
+{
+   thread_local Arena* current = nullptr;
+   return current;
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+Arena::Arena(size_t chunkSize) : mAllocator(chunkSize)
+{}
+
+Arena::~Arena()
+{
+   assert(CurrentArena() != this && "Arena destroyed while it is still current");
+}
+
+void* Arena::Allocate(size_t size)
+{
+   return mAllocator.Malloc(size);
+}
+
+Arena::Scope::Scope(Arena* arena) : mPrevious(CurrentArena())
+{
+   CurrentArena() = arena;
+}
+
+Arena::Scope::~Scope()
+{
+   CurrentArena() = mPrevious;
+}
+
+Arena* Arena::GetCurrent()
+{
+   return CurrentArena();
+}
+
+///
+///
+///
+void* AllocateBlock(size_t size, Arena* arena)
+{
+   void* memory = arena ? arena->Allocate(sizeof(BlockHeader) + size) : std::malloc(sizeof(BlockHeader) + size);
+   if (memory == nullptr)
+   {
+      return nullptr;
+   }
+
+   BlockHeader* header = static_cast<BlockHeader*>(memory);
+   header->arena = arena;
+   header->userData = nullptr;
+   header->size = size;
+   return header + 1;
+}
+
+void FreeBlock(void* block)
+{
+   if (block == nullptr)
+   {
+      return;
+   }
+
+   BlockHeader* header = GetBlockHeader(block);
+   if (header->arena == nullptr)
+   {
+      std::free(header);
+   }
+}
+
+}; // namespace RGBBinding
+
+}; // namespace CubeWorld
@@ -0,0 +1,101 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstddef>
+
+#pragma warning(disable : 4365 6313 6319 6385 6386)
+#include <rapidjson/allocators.h>
+#pragma warning(default : 4365 6313 6319 6385 6386)
+
+namespace CubeWorld
+{
+
+namespace RGBBinding
+{
+
+//
+// Owns the memory behind the strings, arrays and objects of a BindingProperty tree, so
+// parsing a document costs a handful of big allocations instead of one per node, and
+// all of it is released in one shot when the arena goes away.
+//
+// Nothing is handed to an arena unless one is current on the thread (see Scope), and
+// anything that grows an arena-backed node keeps using that arena. Every property that
+// uses the arena's memory must be destroyed before the arena is. Copies made outside of
+// a Scope land on the heap, so they're safe to keep around afterwards.
+//
+class Arena {
+public:
+   static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+public:
+   Arena(size_t chunkSize = CHUNK_SIZE);
+   ~Arena();
+
+   Arena(const Arena&) = delete;
+   Arena& operator=(const Arena&) = delete;
+
+   void* Allocate(size_t size);
+
+   size_t GetCapacity() const { return mAllocator.Capacity(); }
+   size_t GetBytesUsed() const { return mAllocator.Size(); }
+
+public:
+   //
+   // Makes an arena current on this thread for as long as the Scope lives. Passing
+   // nullptr makes new nodes go to the heap again, e.g. to copy something out of a
+   // document that's about to be freed.
+   //
+   class Scope {
+   public:
+      Scope(Arena* arena);
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+   private:
+      Arena* mPrevious;
+   };
+
+   static Arena* GetCurrent();
+
+private:
+   rapidjson::MemoryPoolAllocator<> mAllocator;
+};
+
+//
+// Every block of memory owned by a BindingProperty starts with this header, so it can
+// be freed (or grown) through the same allocator it came from without the node having
+// to spend space remembering where that was.
+//
+struct BlockHeader {
+   // nullptr for blocks on the heap.
+   Arena* arena;
+
+   // Free for whoever owns the block. Objects keep their key index here.
+   void* userData;
+
+   // Usable bytes, not counting the header.
+   size_t size;
+};
+
+// Allocates from the arena if there is one, otherwise from the heap.
+void* AllocateBlock(size_t size, Arena* arena);
+
+// Does nothing for nullptr, or for blocks that belong to an arena.
+void FreeBlock(void* block);
+
+inline BlockHeader* GetBlockHeader(void* block)
+{
+   return static_cast<BlockHeader*>(block) - 1;
+}
+
+inline const BlockHeader* GetBlockHeader(const void* block)
+{
+   return static_cast<const BlockHeader*>(block) - 1;
+}
+
+}; // namespace RGBBinding
+
+}; // namespace CubeWorld
@@ -3,10 +3,11 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <memory>
 
-#include <rapidjson/allocators.h>
+#include "Arena.h"
 
 namespace CubeWorld
 {
@@ -16,19 +17,24 @@ class BindingProperty;
 namespace RGBBinding
 {
 
-// Size: 12 or 16 bytes (32-bit or 64-bit pointer)
+//
+// A growable array that fits in 12 bytes, so it can share a BindingProperty with the
+// property's type flags. The capacity lives in the header of the block the elements
+// are stored in (see Arena.h) rather than in the array itself, and nothing is
+// allocated until the first element is added.
+//
+// Size: 12 bytes (on 64-bit)
+//
+#pragma pack(push, 4)
 template<typename Data>
 class Array {
 public:
    static constexpr size_t INITIAL_SIZE = 4;
 
 public:
-   Array() : mSize(0), mCapacity(0), mData(nullptr)
-   {
-      reserve(INITIAL_SIZE);
-   };
+   Array() : mData(nullptr), mSize(0) {};
 
-   Array(const Array& other) : mSize(0), mCapacity(0), mData(nullptr)
+   Array(const Array& other) : mData(nullptr), mSize(0)
    {
       reserve(other.mSize);
       for (size_t i = 0; i < other.mSize; ++i)
@@ -38,54 +44,36 @@ public:
       mSize = other.mSize;
    }
 
-   Array(Array&& other) noexcept
+   Array(Array&& other) noexcept : mData(other.mData), mSize(other.mSize)
    {
-      mCapacity = other.mCapacity;
-      mSize = other.mSize;
-      mData = other.mData;
       other.mData = nullptr;
-      other.mSize = other.mCapacity = 0;
+      other.mSize = 0;
    }
 
    ~Array()
    {
       clear();
-
-      if (mData)
-      {
-         std::free(mData);
-         mData = nullptr;
-      }
-      mCapacity = 0;
+      FreeBlock(mData);
+      mData = nullptr;
    }
 
    Array& operator=(const Array& other)
    {
-      clear();
-
-      reserve(other.mSize);
-      for (size_t i = 0; i < other.mSize; ++i)
+      if (this != &other)
       {
-         mData[i] = other.mData[i];
+         this->~Array();
+         new (this) Array(other);
       }
-      mSize = other.mSize;
       return *this;
    }
 
-   Array& operator=(Array&& other)
+   Array& operator=(Array&& other) noexcept
    {
-      clear();
-
-      if (mData)
+      if (this != &other)
       {
-         std::free(mData);
+         this->~Array();
+         new (this) Array(std::move(other));
       }
-
-      mCapacity = other.mCapacity;
-      mSize = other.mSize;
-      mData = other.mData;
-      other.mData = nullptr;
-      other.mSize = other.mCapacity = 0;
       return *this;
    }
 
@@ -116,7 +104,22 @@ public:
    }
 
    size_t size() const { return mSize; }
-   size_t capacity() const { return mCapacity; }
+   size_t capacity() const { return mData ? GetBlockHeader(mData)->size / sizeof(Data) : 0; }
+
+   Data* data() { return mData; }
+   const Data* data() const { return mData; }
+
+   // Stored alongside the elements, so there must be some capacity to use it.
+   void* GetUserData() const
+   {
+      return mData ? GetBlockHeader(mData)->userData : nullptr;
+   }
+
+   void SetUserData(void* userData)
+   {
+      assert(mData != nullptr && "Setting user data on an array with no storage");
+      GetBlockHeader(mData)->userData = userData;
+   }
 
    Data& operator[](size_t index)
    {
@@ -132,25 +135,16 @@ public:
 
    void push_back(const Data& data)
    {
-      push_back(BindingProperty(data));
+      push_back(Data(data));
    }
 
    void push_back(Data&& data)
    {
-      if (mSize >= mCapacity)
+      if (mSize >= capacity())
       {
-         if (mCapacity * 2 < INITIAL_SIZE)
-         {
-            reserve(INITIAL_SIZE);
-         }
-         else
-         {
-            reserve(mCapacity * 2);
-         }
-         // idk what to do if it doesn't work; I guess we'll just pray.
+         reserve(std::max(INITIAL_SIZE, capacity() * 2));
       }
-      memset(&mData[mSize], 0, sizeof(Data));
-      mData[mSize] = std::move(data);
+      new (&mData[mSize]) Data(std::move(data));
       mSize++;
    }
 
@@ -162,19 +156,14 @@ public:
 
    void resize(size_t size)
    {
-      if (mSize > size)
+      while (mSize > size)
       {
-         for (size_t i = mSize - 1; i >= size; --i)
-         {
-            mData[i].~Data();
-         }
-         mSize = size;
-         return;
+         mData[--mSize].~Data();
       }
 
-      if (mCapacity < size)
+      if (capacity() < size)
       {
-         reserve(std::max(mCapacity * 2, size));
+         reserve(std::max(capacity() * 2, size));
       }
 
       while (mSize < size)
@@ -185,21 +174,32 @@ public:
 
    void reserve(size_t size)
    {
-      if (mCapacity >= size)
+      if (capacity() >= size)
+      {
+         return;
+      }
+
+      // Growing stays in whichever allocator the elements already came from.
+      Arena* arena = mData ? GetBlockHeader(mData)->arena : Arena::GetCurrent();
+      Data* newData = static_cast<Data*>(AllocateBlock(size * sizeof(Data), arena));
+      if (newData == nullptr)
       {
+         // idk what to do if it doesn't work; I guess we'll just pray.
          return;
       }
 
-      size_t newCapacity = size;
-      void* newData = std::malloc(newCapacity * sizeof(Data));
-      if (newData != nullptr)
+      for (size_t i = 0; i < mSize; ++i)
       {
-         std::memcpy(newData, mData, mCapacity * sizeof(Data));
-         if (mData != nullptr) { std::free(mData); }
-         mData = static_cast<Data*>(newData);
+         new (&newData[i]) Data(std::move(mData[i]));
+         mData[i].~Data();
+      }
 
-         mCapacity = newCapacity;
+      if (mData)
+      {
+         GetBlockHeader(newData)->userData = GetBlockHeader(mData)->userData;
+         FreeBlock(mData);
       }
+      mData = newData;
    }
 
 public:
@@ -260,10 +260,10 @@ public:
    const_iterator end() const { return const_iterator(this, mSize); }
 
 private:
-   size_t mSize;
-   size_t mCapacity;
    Data* mData;
+   uint32_t mSize;
 };
+#pragma pack(pop)
 
 }; // namespace RGBBinding
 
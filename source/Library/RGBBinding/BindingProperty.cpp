@@ -1,5 +1,6 @@
 // By Thomas Steinke
 
+#include <cstring>
 #include <glm/gtc/epsilon.hpp>
 
 #include "BindingProperty.h"
@@ -43,34 +44,39 @@ BindingProperty::BindingProperty(const Type& type)
        kFalseFlag,
        kTrueFlag,
        kNumberAnyFlag,
-       kStringFlag,
+       kShortStringFlag,
        kObjectFlag,
        kArrayFlag,
     };
 
-    flags = defaultFlags[size_t(type)];
-    if (type == Type::String) { data.stringVal.clear(); }
-    else if (type == Type::Object) { new (&data.objectVal) RGBBinding::Array<KeyVal>(); }
+    if (type == Type::String) { SetStringRaw("", 0); }
+    else if (type == Type::Object) { new (&data.objectVal) RGBBinding::ObjectArray<KeyVal>(); }
     else if (type == Type::Array) { new (&data.arrayVal) RGBBinding::Array<BindingProperty>(); }
-    else { data.numVal.i64 = 0; }
+    data.tag.flags = defaultFlags[size_t(type)];
 }
 
 BindingProperty::BindingProperty(const BindingProperty& other) noexcept
-    : flags(other.flags)
 {
-    if (IsNumber()) { data.numVal = other.data.numVal; }
-    else if (IsString()) { new (&data.stringVal) std::string(other.data.stringVal); }
-    else if (IsObject()) { new (&data.objectVal) RGBBinding::Array<KeyVal>(other.data.objectVal); }
-    else if (IsArray()) { new (&data.arrayVal) RGBBinding::Array<BindingProperty>(other.data.arrayVal); }
+    if (other.IsObject()) { new (&data.objectVal) RGBBinding::ObjectArray<KeyVal>(other.data.objectVal); }
+    else if (other.IsArray()) { new (&data.arrayVal) RGBBinding::Array<BindingProperty>(other.data.arrayVal); }
+    else if (other.IsString() && (other.data.tag.flags & kInlineStringFlag) == 0)
+    {
+        SetStringRaw(other.data.longStringVal.chars, other.data.longStringVal.length);
+    }
+    else
+    {
+        // Nothing else owns any memory.
+        data.tag = other.data.tag;
+    }
+    data.tag.flags = other.data.tag.flags;
 }
 
 BindingProperty::BindingProperty(BindingProperty&& other) noexcept
-    : flags(other.flags)
 {
-    if (IsNumber()) { data.numVal = other.data.numVal; }
-    else if (IsString()) { new (&data.stringVal) std::string(std::move(other.data.stringVal)); }
-    else if (IsObject()) { new (&data.objectVal) RGBBinding::Array<KeyVal>(std::move(other.data.objectVal)); }
-    else if (IsArray()) { new (&data.arrayVal) RGBBinding::Array<BindingProperty>(std::move(other.data.arrayVal)); }
+    // Arrays, objects and strings are all happy to be moved bit for bit, as long as
+    // the original then forgets about them.
+    std::memcpy(&data, &other.data, sizeof(Data));
+    other.data.tag.flags = kNullFlag;
 }
 
 BindingProperty::~BindingProperty()
@@ -81,11 +87,14 @@ BindingProperty::~BindingProperty()
     }
     else if (IsString())
     {
-        data.stringVal.~basic_string();
+        if ((data.tag.flags & kInlineStringFlag) == 0)
+        {
+            RGBBinding::FreeBlock(data.longStringVal.chars);
+        }
     }
     else if (IsObject())
     {
-        data.objectVal.~Array();
+        data.objectVal.~ObjectArray();
     }
     else if (IsArray())
     {
@@ -93,82 +102,99 @@ BindingProperty::~BindingProperty()
     }
 }
 
+void BindingProperty::SetStringRaw(const char* s, size_t length)
+{
+    if (length <= ShortString::MaxChars)
+    {
+        std::memcpy(data.shortStringVal.chars, s, length);
+        data.shortStringVal.chars[length] = '\0';
+        data.shortStringVal.chars[ShortString::MaxChars] = char(ShortString::MaxChars - length);
+        data.tag.flags = kShortStringFlag;
+        return;
+    }
+
+    char* chars = static_cast<char*>(RGBBinding::AllocateBlock(length + 1, RGBBinding::Arena::GetCurrent()));
+    std::memcpy(chars, s, length);
+    chars[length] = '\0';
+
+    data.longStringVal.chars = chars;
+    data.longStringVal.length = uint32_t(length);
+    data.tag.flags = kStringFlag;
+}
+
 ///
 ///
 ///
 BindingProperty::BindingProperty(bool value)
 {
     data.numVal.i64 = 0;
-    flags = value ? kTrueFlag : kFalseFlag;
+    data.tag.flags = value ? kTrueFlag : kFalseFlag;
 }
 
 BindingProperty::BindingProperty(int32_t i)
 {
     data.numVal.i64 = i;
-    flags = uint16_t((i >= 0) ? (kNumberIntFlag | kUintFlag | kUint64Flag) : kNumberIntFlag);
+    data.tag.flags = uint16_t((i >= 0) ? (kNumberIntFlag | kUintFlag | kUint64Flag) : kNumberIntFlag);
 }
 
 BindingProperty::BindingProperty(int64_t i64)
 {
     data.numVal.i64 = i64;
-    flags = kNumberInt64Flag;
+    data.tag.flags = kNumberInt64Flag;
     if (i64 >= 0) {
-        flags |= kNumberUint64Flag;
+        data.tag.flags |= kNumberUint64Flag;
         if (!(static_cast<uint64_t>(i64) & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x00000000)))
-            flags |= kUintFlag;
+            data.tag.flags |= kUintFlag;
         if (!(static_cast<uint64_t>(i64) & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x80000000)))
-            flags |= kIntFlag;
+            data.tag.flags |= kIntFlag;
     }
     else if (i64 >= static_cast<int64_t>(RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x80000000)))
-        flags |= kIntFlag;
+        data.tag.flags |= kIntFlag;
 }
 
 BindingProperty::BindingProperty(uint32_t u)
 {
     data.numVal.u64 = u;
-    flags = uint16_t((u & 0x80000000) ? kNumberUintFlag : (kNumberUintFlag | kIntFlag | kInt64Flag));
+    data.tag.flags = uint16_t((u & 0x80000000) ? kNumberUintFlag : (kNumberUintFlag | kIntFlag | kInt64Flag));
 }
 
 BindingProperty::BindingProperty(uint64_t u64)
 {
     data.numVal.u64 = u64;
-    flags = kNumberUint64Flag;
+    data.tag.flags = kNumberUint64Flag;
     if (!(u64 & RAPIDJSON_UINT64_C2(0x80000000, 0x00000000)))
-        flags |= kInt64Flag;
+        data.tag.flags |= kInt64Flag;
     if (!(u64 & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x00000000)))
-        flags |= kUintFlag;
+        data.tag.flags |= kUintFlag;
     if (!(u64 & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x80000000)))
-        flags |= kIntFlag;
+        data.tag.flags |= kIntFlag;
 }
 
 BindingProperty::BindingProperty(double d)
 {
     data.numVal.d = d;
-    flags = kNumberDoubleFlag;
+    data.tag.flags = kNumberDoubleFlag;
 }
 
 BindingProperty::BindingProperty(float f)
 {
     data.numVal.d = f;
-    flags = kNumberDoubleFlag;
+    data.tag.flags = kNumberDoubleFlag;
 }
 
 BindingProperty::BindingProperty(const char* s)
 {
-    new (&data.stringVal) std::string(s);
-    flags = kStringFlag;
+    SetStringRaw(s, std::strlen(s));
 }
 
 BindingProperty::BindingProperty(const std::string& s)
 {
-    new (&data.stringVal) std::string(s);
-    flags = kStringFlag;
+    SetStringRaw(s.data(), s.size());
 }
 
 BindingProperty::BindingProperty(std::string&& s)
 {
-    new (&data.stringVal) std::string(std::move(s));
-    flags = kStringFlag;
+    SetStringRaw(s.data(), s.size());
 }
 
 BindingProperty::BindingProperty(const glm::vec3& vec3) : BindingProperty(Type::Array)
@@ -191,15 +217,18 @@ BindingProperty::BindingProperty(const glm::vec4& vec4) : BindingProperty(Type::
 ///
 BindingProperty& BindingProperty::operator=(const BindingProperty& other)
 {
+    // Copy first, in case other lives inside this property.
+    BindingProperty copy(other);
     this->~BindingProperty();
-    new (this) BindingProperty(other);
+    new (this) BindingProperty(std::move(copy));
     return *this;
 }
 
 BindingProperty& BindingProperty::operator=(BindingProperty&& other) noexcept
 {
+    BindingProperty moved(std::move(other));
     this->~BindingProperty();
-    new (this) BindingProperty(other);
+    new (this) BindingProperty(std::move(moved));
     return *this;
 }
 
@@ -237,6 +266,18 @@ BindingProperty& BindingProperty::operator[](const char* key)
     return this->operator[](std::string{ key });
 }
 
+BindingProperty& BindingProperty::operator[](const Key& key)
+{
+    assert((IsObject() || IsNull()) && "key operator only valid on null or objects");
+    if (IsNull()) { SetObject(); }
+    ObjectIterator it = Find(key);
+    if (it == AsObject().end())
+    {
+        data.objectVal.push_back(KeyVal{ key.GetName(), BindingProperty{} });
+    }
+    return it->value;
+}
+
 const BindingProperty& BindingProperty::operator[](const int& index) const
 {
     assert(index >= 0 && "Negative index is invalid");
@@ -274,6 +315,22 @@ const BindingProperty& BindingProperty::operator[](const char* key) const
     return this->operator[](std::string{ key });
 }
 
+const BindingProperty& BindingProperty::operator[](const Key& key) const
+{
+    assert((IsObject() || IsNull()) && "key operator only valid on null or objects");
+    if (IsNull())
+    {
+        return Null;
+    }
+
+    ConstObjectIterator it = Find(key);
+    if (it != AsObject().end())
+    {
+        return it->value;
+    }
+    return Null;
+}
+
 bool BindingProperty::operator==(const BindingProperty& other) const
 {
     if (IsNumber() && other.IsNumber())
@@ -284,14 +341,14 @@ bool BindingProperty::operator==(const BindingProperty& other) const
         }
     }
 
-    if ((flags & kTypeMask) != (other.flags & kTypeMask))
+    if ((data.tag.flags & kTypeMask) != (other.data.tag.flags & kTypeMask))
     {
         return false;
     }
 
     if (IsDouble()) { return glm::epsilonEqual(data.numVal.d, other.data.numVal.d, DBL_EPSILON); }
     else if (IsNumber()) { return data.numVal.u64 == other.data.numVal.u64; }
-    else if (IsString()) { return data.stringVal == other.data.stringVal; }
+    else if (IsString()) { return GetStringView() == other.GetStringView(); }
     else if (IsObject()) { return data.objectVal == other.data.objectVal; }
     else if (IsArray()) { return data.arrayVal == other.data.arrayVal; }
     return true;
@@ -324,54 +381,68 @@ bool BindingProperty::IsVec4() const
 ///
 const bool BindingProperty::GetBooleanValue(const bool& defaultValue) const
 {
-    return (flags & kBoolFlag) != 0 ? flags == kTrueFlag : defaultValue;
+    return (data.tag.flags & kBoolFlag) != 0 ? data.tag.flags == kTrueFlag : defaultValue;
 }
 
 const int32_t BindingProperty::GetIntValue(const int32_t& defaultValue) const
 {
-    return (flags & kIntFlag) != 0 ? data.numVal.i.i : defaultValue;
+    return (data.tag.flags & kIntFlag) != 0 ? data.numVal.i.i : defaultValue;
 }
 
 const uint32_t BindingProperty::GetUintValue(const uint32_t& defaultValue) const
 {
-    return (flags & kUintFlag) != 0 ? data.numVal.u.u : defaultValue;
+    return (data.tag.flags & kUintFlag) != 0 ? data.numVal.u.u : defaultValue;
 }
 
 const int64_t BindingProperty::GetInt64Value(const int64_t& defaultValue) const
 {
-    return (flags & kInt64Flag) != 0 ? data.numVal.i64 : defaultValue;
+    return (data.tag.flags & kInt64Flag) != 0 ? data.numVal.i64 : defaultValue;
 }
 
 const uint64_t BindingProperty::GetUint64Value(const uint64_t& defaultValue) const
 {
-    return (flags & kUint64Flag) != 0 ? data.numVal.u64 : defaultValue;
+    return (data.tag.flags & kUint64Flag) != 0 ? data.numVal.u64 : defaultValue;
 }
 
 const double BindingProperty::GetDoubleValue(const double& defaultValue) const
 {
-    if ((flags & kNumberFlag) == 0) return defaultValue;
-    if ((flags & kDoubleFlag) != 0) return data.numVal.d;
-    if ((flags & kIntFlag) != 0)    return data.numVal.i.i;
-    if ((flags & kUintFlag) != 0)   return data.numVal.u.u;
-    if ((flags & kInt64Flag) != 0)  return static_cast<double>(data.numVal.i64);
-    if ((flags & kUint64Flag) != 0) return static_cast<double>(data.numVal.u64);
+    if ((data.tag.flags & kNumberFlag) == 0) return defaultValue;
+    if ((data.tag.flags & kDoubleFlag) != 0) return data.numVal.d;
+    if ((data.tag.flags & kIntFlag) != 0)    return data.numVal.i.i;
+    if ((data.tag.flags & kUintFlag) != 0)   return data.numVal.u.u;
+    if ((data.tag.flags & kInt64Flag) != 0)  return static_cast<double>(data.numVal.i64);
+    if ((data.tag.flags & kUint64Flag) != 0) return static_cast<double>(data.numVal.u64);
     return defaultValue;
 }
 
 const float BindingProperty::GetFloatValue(const float& defaultValue) const
 {
-    if ((flags & kNumberFlag) == 0) return defaultValue;
-    if ((flags & kDoubleFlag) != 0) return static_cast<float>(data.numVal.d);
-    if ((flags & kIntFlag) != 0)    return static_cast<float>(data.numVal.i.i);
-    if ((flags & kUintFlag) != 0)   return static_cast<float>(data.numVal.u.u);
-    if ((flags & kInt64Flag) != 0)  return static_cast<float>(data.numVal.i64);
-    if ((flags & kUint64Flag) != 0) return static_cast<float>(data.numVal.u64);
+    if ((data.tag.flags & kNumberFlag) == 0) return defaultValue;
+    if ((data.tag.flags & kDoubleFlag) != 0) return static_cast<float>(data.numVal.d);
+    if ((data.tag.flags & kIntFlag) != 0)    return static_cast<float>(data.numVal.i.i);
+    if ((data.tag.flags & kUintFlag) != 0)   return static_cast<float>(data.numVal.u.u);
+    if ((data.tag.flags & kInt64Flag) != 0)  return static_cast<float>(data.numVal.i64);
+    if ((data.tag.flags & kUint64Flag) != 0) return static_cast<float>(data.numVal.u64);
     return defaultValue;
 }
 
 const std::string BindingProperty::GetStringValue(const std::string& defaultValue) const
 {
-    return flags == uint16_t(kStringFlag) ? data.stringVal : defaultValue;
+    return IsString() ? std::string(GetStringView()) : defaultValue;
+}
+
+std::string_view BindingProperty::GetStringView(std::string_view defaultValue) const
+{
+    if (!IsString())
+    {
+        return defaultValue;
+    }
+
+    if ((data.tag.flags & kInlineStringFlag) != 0)
+    {
+        return std::string_view(data.shortStringVal.chars, data.shortStringVal.GetLength());
+    }
+    return std::string_view(data.longStringVal.chars, data.longStringVal.length);
 }
 
 glm::vec3 BindingProperty::GetVec3(const glm::vec3& defaultValue) const
@@ -427,7 +498,7 @@ BindingProperty& BindingProperty::PushBack(BindingProperty val)
         SetArray();
     }
     assert(IsArray() && "PushBack is only valid on an array");
-    data.arrayVal.push_back(val);
+    data.arrayVal.push_back(std::move(val));
     return data.arrayVal[data.arrayVal.size() - 1];
 }
 
@@ -467,49 +538,46 @@ bool BindingProperty::Has(const std::string& key) const
     }
 
     assert(IsObject() && "Has is only valid on an object");
-    ConstObject me = AsObject();
-    ConstObjectIterator it = me.begin();
-    ConstObjectIterator end = me.end();
-    for (; it != end; ++it)
+    return data.objectVal.find(key) != RGBBinding::ObjectArray<KeyVal>::npos;
+}
+
+bool BindingProperty::Has(const Key& key) const
+{
+    if (IsNull())
     {
-        if (it->key == key)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+
+    assert(IsObject() && "Has is only valid on an object");
+    return data.objectVal.find(key.GetName(), key.GetHash()) != RGBBinding::ObjectArray<KeyVal>::npos;
 }
 
 BindingProperty::ObjectIterator BindingProperty::Find(const std::string& key)
 {
     assert(IsObject() && "Find is only valid on an object");
-    Object me = AsObject();
-    ObjectIterator it = me.begin();
-    ObjectIterator end = me.end();
-    for (; it != end; ++it)
-    {
-        if (it->key == key)
-        {
-            break;
-        }
-    }
-    return it;
+    size_t index = data.objectVal.find(key);
+    return ObjectIterator(this, index == RGBBinding::ObjectArray<KeyVal>::npos ? data.objectVal.size() : index);
+}
+
+BindingProperty::ObjectIterator BindingProperty::Find(const Key& key)
+{
+    assert(IsObject() && "Find is only valid on an object");
+    size_t index = data.objectVal.find(key.GetName(), key.GetHash());
+    return ObjectIterator(this, index == RGBBinding::ObjectArray<KeyVal>::npos ? data.objectVal.size() : index);
 }
 
 BindingProperty::ConstObjectIterator BindingProperty::Find(const std::string& key) const
 {
     assert(IsObject() && "Find is only valid on an object");
-    ConstObject me = AsObject();
-    ConstObjectIterator it = me.begin();
-    ConstObjectIterator end = me.end();
-    for (; it != end; ++it)
-    {
-        if (it->key == key)
-        {
-            break;
-        }
-    }
-    return it;
+    size_t index = data.objectVal.find(key);
+    return ConstObjectIterator(this, index == RGBBinding::ObjectArray<KeyVal>::npos ? data.objectVal.size() : index);
+}
+
+BindingProperty::ConstObjectIterator BindingProperty::Find(const Key& key) const
+{
+    assert(IsObject() && "Find is only valid on an object");
+    size_t index = data.objectVal.find(key.GetName(), key.GetHash());
+    return ConstObjectIterator(this, index == RGBBinding::ObjectArray<KeyVal>::npos ? data.objectVal.size() : index);
 }
 
 BindingProperty& BindingProperty::Set(const std::string& key, const BindingProperty& value)
@@ -539,7 +607,7 @@ BindingProperty::Iterator BindingProperty::begin()
 
 BindingProperty::Iterator BindingProperty::end()
 {
-    switch (flags)
+    switch (data.tag.flags)
     {
     case kArrayFlag:
         return Iterator(this, data.arrayVal.size());
@@ -557,7 +625,7 @@ BindingProperty::ConstIterator BindingProperty::begin() const
 
 BindingProperty::ConstIterator BindingProperty::end() const
 {
-    switch (flags)
+    switch (data.tag.flags)
     {
     case kArrayFlag:
         return ConstIterator(this, data.arrayVal.size());
@@ -575,7 +643,7 @@ BindingProperty::PairIterator BindingProperty::begin_pairs()
 
 BindingProperty::PairIterator BindingProperty::end_pairs()
 {
-    switch (flags)
+    switch (data.tag.flags)
     {
     case kArrayFlag:
         return PairIterator(this, data.arrayVal.size());
@@ -593,7 +661,7 @@ BindingProperty::ConstPairIterator BindingProperty::begin_pairs() const
 
 BindingProperty::ConstPairIterator BindingProperty::end_pairs() const
 {
-    switch (flags)
+    switch (data.tag.flags)
     {
     case kArrayFlag:
         return ConstPairIterator(this, data.arrayVal.size());
@@ -611,7 +679,7 @@ BindingProperty::ObjectIterator BindingProperty::begin_object()
 
 BindingProperty::ObjectIterator BindingProperty::end_object()
 {
-    switch (flags)
+    switch (data.tag.flags)
     {
     case kObjectFlag:
         return ObjectIterator(this, data.objectVal.size());
@@ -627,7 +695,7 @@ BindingProperty::ConstObjectIterator BindingProperty::begin_object() const
 
 BindingProperty::ConstObjectIterator BindingProperty::end_object() const
 {
-    switch (flags)
+    switch (data.tag.flags)
     {
     case kObjectFlag:
         return ConstObjectIterator(this, data.objectVal.size());
@@ -5,6 +5,7 @@
 #include <iterator>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <glm/glm.hpp>
 #include <Meta.h>
 #pragma warning(disable : 4365 6313 6319 6385 6386)
@@ -16,6 +17,7 @@
 
 #include "Array.h"
 #include "BindingPropertyMeta.h"
+#include "ObjectArray.h"
 
 namespace CubeWorld
 {
@@ -45,6 +47,23 @@ public:
     // Forward declarations
     struct KeyVal;
 
+    //
+    // An object key with its hash worked out up front. Reading the same fields out of
+    // many objects (e.g. every frame of a skeleton) can keep a static Key per field,
+    // so large objects skip rehashing on every lookup.
+    //
+    class Key {
+    public:
+        explicit Key(std::string name) : mName(std::move(name)), mHash(RGBBinding::HashKey(mName)) {}
+
+        const std::string& GetName() const { return mName; }
+        size_t GetHash() const { return mHash; }
+
+    private:
+        std::string mName;
+        size_t mHash;
+    };
+
     // Iterator types
     template<typename Property> class IteratorType;
     template<typename Property> class PairIteratorType;
@@ -70,7 +89,7 @@ public:
     typedef ObjectType<const BindingProperty, ConstObjectIterator> ConstObject;
 
 public:
-    BindingProperty() : flags(kNullFlag) { data.numVal.i64 = 0; };
+    BindingProperty() {};
     BindingProperty(const Type& type);
     BindingProperty(const BindingProperty& other) noexcept;
     BindingProperty(BindingProperty&& other) noexcept;
@@ -124,11 +143,13 @@ public:
     BindingProperty& operator[](const size_t& index);
     BindingProperty& operator[](const std::string& key);
     BindingProperty& operator[](const char* key);
+    BindingProperty& operator[](const Key& key);
 
     const BindingProperty& operator[](const int& index) const;
     const BindingProperty& operator[](const size_t& index) const;
     const BindingProperty& operator[](const std::string& key) const;
     const BindingProperty& operator[](const char* key) const;
+    const BindingProperty& operator[](const Key& key) const;
 
     // Comparison
     bool operator==(const BindingProperty& other) const;
@@ -142,18 +163,18 @@ public:
 
 public:
     // Access and reading
-    Type GetType() const { return Type(flags & kTypeMask); }
-    bool IsNull() const { return flags == kNullFlag; }
-    bool IsBool() const { return (flags & kBoolFlag) != 0; }
-    bool IsObject() const { return flags == kObjectFlag; }
-    bool IsArray() const { return flags == kArrayFlag; }
-    bool IsNumber() const { return (flags & kNumberFlag) != 0; }
-    bool IsInt() const { return (flags & kIntFlag) != 0; }
-    bool IsUint() const { return (flags & kUintFlag) != 0; }
-    bool IsInt64() const { return (flags & kInt64Flag) != 0; }
-    bool IsUint64() const { return (flags & kUint64Flag) != 0; }
-    bool IsDouble() const { return (flags & kDoubleFlag) != 0; }
-    bool IsString() const { return flags == kStringFlag; }
+    Type GetType() const { return Type(data.tag.flags & kTypeMask); }
+    bool IsNull() const { return data.tag.flags == kNullFlag; }
+    bool IsBool() const { return (data.tag.flags & kBoolFlag) != 0; }
+    bool IsObject() const { return data.tag.flags == kObjectFlag; }
+    bool IsArray() const { return data.tag.flags == kArrayFlag; }
+    bool IsNumber() const { return (data.tag.flags & kNumberFlag) != 0; }
+    bool IsInt() const { return (data.tag.flags & kIntFlag) != 0; }
+    bool IsUint() const { return (data.tag.flags & kUintFlag) != 0; }
+    bool IsInt64() const { return (data.tag.flags & kInt64Flag) != 0; }
+    bool IsUint64() const { return (data.tag.flags & kUint64Flag) != 0; }
+    bool IsDouble() const { return (data.tag.flags & kDoubleFlag) != 0; }
+    bool IsString() const { return (data.tag.flags & kTypeMask) == kStringFlag; }
     bool IsVec3() const;
     bool IsVec4() const;
 
@@ -165,6 +186,8 @@ public:
     const double GetDoubleValue(const double& defaultValue = 0) const;
     const float GetFloatValue(const float& defaultValue = 0) const;
     const std::string GetStringValue(const std::string& defaultValue = "") const;
+    // Points into the property, so it's only good for as long as the property is.
+    std::string_view GetStringView(std::string_view defaultValue = "") const;
     glm::vec3 GetVec3(const glm::vec3& defaultValue = { 0, 0, 0 }) const;
     glm::vec4 GetVec4(const glm::vec4& defaultValue = { 0, 0, 0, 0 }) const;
 
@@ -199,9 +222,13 @@ public:
     Object AsObject();
     ConstObject AsObject() const;
 
+    // Objects with many keys are indexed, so these stay fast as objects grow.
     bool Has(const std::string& key) const;
+    bool Has(const Key& key) const;
     ObjectIterator Find(const std::string& key);
+    ObjectIterator Find(const Key& key);
     ConstObjectIterator Find(const std::string& key) const;
+    ConstObjectIterator Find(const Key& key) const;
 
     Iterator begin();
     Iterator end();
@@ -309,7 +336,7 @@ public:
     public:
         IteratorType& operator++()
         {
-            switch (mObject->flags)
+            switch (mObject->data.tag.flags)
             {
             case kArrayFlag:
                 if (mIndex < mObject->data.arrayVal.size()) { ++mIndex; }
@@ -335,7 +362,7 @@ public:
 
         Property& operator*() const
         {
-            switch (mObject->flags)
+            switch (mObject->data.tag.flags)
             {
             case kArrayFlag:
                 return mObject->data.arrayVal[mIndex];
@@ -377,7 +404,7 @@ public:
     public:
         PairIteratorType& operator++() // prefix
         {
-            switch (mObject->flags)
+            switch (mObject->data.tag.flags)
             {
             case kArrayFlag:
                 if (mIndex < mObject->data.arrayVal.size()) { ++mIndex; }
@@ -596,20 +623,50 @@ private:
         double d;
     };
 
+    // Strings of up to MaxChars characters are stored inside the property. The last
+    // byte holds how many characters are left unused, which makes it the terminator
+    // when the string is full.
+    // Size: 14 bytes
+    struct ShortString {
+        static constexpr size_t MaxChars = 13;
+
+        size_t GetLength() const { return MaxChars - size_t(chars[MaxChars]); }
+
+        char chars[MaxChars + 1];
+    };
+
+#pragma pack(push, 4)
+    // Anything longer goes in a null-terminated block (see RGBBinding/Arena.h).
+    // Size: 12 bytes (on 64-bit)
+    struct LongString {
+        char* chars;
+        uint32_t length;
+    };
+#pragma pack(pop)
+
+    // Lets the type flags share the last two bytes of the property with the payload.
+    // Size: 16 bytes
+    struct Tag {
+        char payload[14];
+        uint16_t flags;
+    };
+
     union Data {
-#pragma warning(disable : 4582) // '%s': constructor is not implicitly called
-        Data() { numVal.i64 = 0; }
-#pragma warning(default : 4582) // '%s': constructor is not implicitly called
+        Data() : tag() {}
 #pragma warning(disable : 4583) // '%s': destructor is not implicitly called
         ~Data() { /* Handled manually */ }
 #pragma warning(default : 4583) // '%s': destructor is not implicitly called
 
         Number numVal;
-        std::string stringVal;
+        ShortString shortStringVal;
+        LongString longStringVal;
         RGBBinding::Array<BindingProperty> arrayVal;
-        RGBBinding::Array<KeyVal> objectVal;
+        RGBBinding::ObjectArray<KeyVal> objectVal;
+        Tag tag;
     };
 
+    void SetStringRaw(const char* s, size_t length);
+
 private:
     static constexpr uint16_t kBoolFlag = 0x0008;
     static constexpr uint16_t kNumberFlag = 0x0010;
@@ -618,6 +675,7 @@ private:
     static constexpr uint16_t kInt64Flag = 0x0080;
     static constexpr uint16_t kUint64Flag = 0x0100;
     static constexpr uint16_t kDoubleFlag = 0x0200;
+    static constexpr uint16_t kInlineStringFlag = 0x0400;
 
     // Initial flags of different types.
     static constexpr uint16_t kNullFlag = uint16_t(Type::Null);
@@ -630,22 +688,21 @@ private:
     static constexpr uint16_t kNumberDoubleFlag = uint16_t(Type::Number) | kNumberFlag | kDoubleFlag;
     static constexpr uint16_t kNumberAnyFlag = uint16_t(Type::Number) | kNumberFlag | kIntFlag | kInt64Flag | kUintFlag | kUint64Flag | kDoubleFlag;
     static constexpr uint16_t kStringFlag = uint16_t(Type::String);
+    static constexpr uint16_t kShortStringFlag = uint16_t(Type::String) | kInlineStringFlag;
     static constexpr uint16_t kObjectFlag = uint16_t(Type::Object);
     static constexpr uint16_t kArrayFlag = uint16_t(Type::Array);
 
     static constexpr uint16_t       kTypeMask = 0x07;
 
 private:
-    // TODO with some clever union magic this type variable can actually be
-    // included _IN_ the data. See rapidjson's documentation, it's really neat.
-    // Problem is, it requires being intentional about the standard structures,
-    // since std::string and std::vector don't make any guarantees about their
-    // size. Instead of trying to be clever or asserting on their size, I
-    // opted to just widen this object by 2 bytes. Boo hoo.
+    // Like rapidjson's GenericValue, the type flags live in the last two bytes of the
+    // data, which none of the payloads reach. Doubles and 64-bit ints keep all their
+    // bits, so this is a tagged union rather than NaN-boxing.
     Data data;
-    uint16_t flags = kNullFlag;
 };
 
+static_assert(sizeof(BindingProperty) == 16, "BindingProperty should pack its type into its data");
+
 }; // namespace CubeWorld
 
 #include "BindingProperty.inl"
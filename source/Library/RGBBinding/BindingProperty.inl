@@ -76,7 +76,7 @@ Maybe<void> BindingProperty::Write(Handler& handler) const
    ConstArrayIterator it(this, 0), end(this, 0);
 
 #define HANDLE_ERROR(op, error) if (!op) { return Failure{error}; }
-   Type type = Type(flags & kTypeMask);
+   Type type = GetType();
    switch (type)
    {
    case Type::Null:
@@ -92,11 +92,14 @@ Maybe<void> BindingProperty::Write(Handler& handler) const
       else if (IsUint()) { HANDLE_ERROR(handler.Uint(data.numVal.u.u), "Failed to write unsigned int value"); }
       else if (IsInt64()) { HANDLE_ERROR(handler.Int64(data.numVal.i64), "Failed to write 64-bit int value"); }
       else if (IsUint64()) { HANDLE_ERROR(handler.Uint64(data.numVal.u64), "Failed to write unsigned 64-bit int value"); }
-      else { return Failure{"Unhandled number type: {flags}", flags}; }
+      else { return Failure{"Unhandled number type: {flags}", data.tag.flags}; }
       break;
    case Type::String:
-      HANDLE_ERROR(handler.String(data.stringVal.c_str(), (rapidjson::SizeType)data.stringVal.size(), false), "Failed to write string value");
+   {
+      std::string_view string = GetStringView();
+      HANDLE_ERROR(handler.String(string.data(), (rapidjson::SizeType)string.size(), false), "Failed to write string value");
       break;
+   }
    case Type::Object:
       HANDLE_ERROR(handler.StartObject(), "Failed to start object");
       for (const KeyVal& kv : data.objectVal)
@@ -125,7 +128,7 @@ Maybe<void> BindingProperty::Write(Handler& handler) const
       HANDLE_ERROR(handler.EndArray((rapidjson::SizeType)data.arrayVal.size()), "Failed to end array");
       break;
    default:
-      return Failure{"Unhandled type flag: {type}", flags & kTypeMask};
+      return Failure{"Unhandled type flag: {type}", data.tag.flags & kTypeMask};
    }
 
    return Success;
@@ -0,0 +1,278 @@
+// By Thomas Steinke
+
+#include "BindingPropertyConsumer.h"
+
+namespace CubeWorld
+{
+
+const Binding::Sink BindingPropertyConsumer::kComponentSink{Binding::Sink::kValue, &BindingPropertyConsumer::AssignComponent, nullptr, nullptr, nullptr, 0, nullptr};
+const Binding::Sink BindingPropertyConsumer::kSelectSink{Binding::Sink::kObject, nullptr, nullptr, &BindingPropertyConsumer::SelectMember, nullptr, 0, nullptr};
+
+void BindingPropertyConsumer::AssignComponent(void* target, const BindingProperty& value)
+{
+   Frame& frame = *static_cast<Frame*>(target);
+   if (value.IsNumber() && frame.numComponents < frame.slot.sink->numComponents)
+   {
+      frame.components[frame.numComponents++] = value.GetDoubleValue();
+   }
+   else
+   {
+      frame.isVector = false;
+   }
+}
+
+Binding::Slot BindingPropertyConsumer::SelectMember(void* target, std::string_view key)
+{
+   BindingPropertyConsumer& consumer = *static_cast<BindingPropertyConsumer*>(target);
+   if (key != std::string_view(consumer.mKey))
+   {
+      return Binding::Slot{};
+   }
+
+   consumer.mFoundKey = true;
+   return consumer.mSelected;
+}
+
+bool BindingPropertyConsumer::NextSlot(Binding::Slot& slot)
+{
+   if (mFrames.empty())
+   {
+      // There's only one root.
+      if (mStarted) { return false; }
+      mStarted = true;
+      slot = mRoot;
+      return true;
+   }
+
+   Frame& frame = mFrames.back();
+   if (frame.isObject)
+   {
+      if (!frame.hasKey) { return false; }
+      frame.hasKey = false;
+      slot = frame.value;
+   }
+   else if (frame.slot.sink == nullptr)
+   {
+      slot = Binding::Slot{};
+   }
+   else if (frame.slot.sink->kind == Binding::Sink::kVector)
+   {
+      slot = Binding::Slot{&kComponentSink, &frame};
+   }
+   else
+   {
+      slot = frame.slot.sink->element(frame.slot.target);
+   }
+   return true;
+}
+
+bool BindingPropertyConsumer::Scalar(const BindingProperty& value)
+{
+   Binding::Slot slot;
+   if (!NextSlot(slot)) { return false; }
+   if (slot.sink != nullptr && slot.sink->assign != nullptr)
+   {
+      slot.sink->assign(slot.target, value);
+   }
+   return Finish();
+}
+
+bool BindingPropertyConsumer::Start(bool isObject)
+{
+   Binding::Slot slot;
+   if (!NextSlot(slot)) { return false; }
+
+   const Binding::Sink::Kind kind = slot.sink ? slot.sink->kind : Binding::Sink::kObject;
+   const bool streams = slot.sink == nullptr ||
+      (isObject ? kind == Binding::Sink::kObject : kind == Binding::Sink::kArray || kind == Binding::Sink::kVector);
+
+   if (!streams && (kind == Binding::Sink::kValue || kind == Binding::Sink::kVector))
+   {
+      // Read the whole thing, then assign it.
+      mCapture.emplace();
+      mCaptureSlot = slot;
+      mCaptureDepth = 1;
+      return isObject ? mCapture->StartObject() : mCapture->StartArray();
+   }
+
+   Frame frame{};
+   // Objects sent to arrays and the like are skipped.
+   frame.slot = streams ? slot : Binding::Slot{};
+   frame.isObject = isObject;
+   frame.isVector = frame.slot.sink != nullptr && kind == Binding::Sink::kVector;
+   mFrames.push_back(frame);
+   return true;
+}
+
+bool BindingPropertyConsumer::End(bool isObject)
+{
+   if (mCaptureDepth > 0)
+   {
+      if (!(isObject ? mCapture->EndObject() : mCapture->EndArray())) { return false; }
+      if (--mCaptureDepth > 0) { return true; }
+
+      BindingProperty value = mCapture->TakeResult();
+      mCapture.reset();
+      mCaptureSlot.sink->assign(mCaptureSlot.target, value);
+      return Finish();
+   }
+
+   if (mFrames.empty()) { return false; }
+
+   Frame& frame = mFrames.back();
+   if (frame.isObject != isObject || frame.hasKey) { return false; }
+
+   if (frame.slot.sink != nullptr && frame.slot.sink->kind == Binding::Sink::kVector)
+   {
+      if (frame.isVector && frame.numComponents == frame.slot.sink->numComponents)
+      {
+         frame.slot.sink->assignComponents(frame.slot.target, frame.components);
+      }
+      else
+      {
+         frame.slot.sink->assign(frame.slot.target, BindingProperty{});
+      }
+   }
+
+   mFrames.pop_back();
+   return Finish();
+}
+
+bool BindingPropertyConsumer::Finish()
+{
+   if (mFrames.empty())
+   {
+      mDone = true;
+      return true;
+   }
+
+   if (mFoundKey && mFrames.size() == 1)
+   {
+      // Got the selected key, so stop reading.
+      mDone = true;
+      return false;
+   }
+
+   return true;
+}
+
+bool BindingPropertyConsumer::Null()
+{
+   if (mCaptureDepth > 0) { return mCapture->Null(); }
+
+   // Binding::deserialize skips null members, so keep whatever was there.
+   if (!mFrames.empty() && mFrames.back().isObject)
+   {
+      Binding::Slot slot;
+      return NextSlot(slot) && Finish();
+   }
+
+   return Scalar(BindingProperty{});
+}
+
+bool BindingPropertyConsumer::Bool(bool b)
+{
+   if (mCaptureDepth > 0) { return mCapture->Bool(b); }
+   return Scalar(BindingProperty(b));
+}
+
+bool BindingPropertyConsumer::Int(int i)
+{
+   if (mCaptureDepth > 0) { return mCapture->Int(i); }
+   return Scalar(BindingProperty(i));
+}
+
+bool BindingPropertyConsumer::Uint(unsigned i)
+{
+   if (mCaptureDepth > 0) { return mCapture->Uint(i); }
+   return Scalar(BindingProperty(i));
+}
+
+bool BindingPropertyConsumer::Int64(int64_t i)
+{
+   if (mCaptureDepth > 0) { return mCapture->Int64(i); }
+   return Scalar(BindingProperty(i));
+}
+
+bool BindingPropertyConsumer::Uint64(uint64_t i)
+{
+   if (mCaptureDepth > 0) { return mCapture->Uint64(i); }
+   return Scalar(BindingProperty(i));
+}
+
+bool BindingPropertyConsumer::Double(double d)
+{
+   if (mCaptureDepth > 0) { return mCapture->Double(d); }
+   return Scalar(BindingProperty(d));
+}
+
+bool BindingPropertyConsumer::String(const Ch* str, SizeType length, bool copy)
+{
+   if (mCaptureDepth > 0) { return mCapture->String(str, length, copy); }
+
+   Binding::Slot slot;
+   if (!NextSlot(slot)) { return false; }
+   if (slot.sink != nullptr)
+   {
+      if (slot.sink->assignString != nullptr)
+      {
+         slot.sink->assignString(slot.target, {str, length});
+      }
+      else if (slot.sink->assign != nullptr)
+      {
+         slot.sink->assign(slot.target, BindingProperty(std::string(str, length)));
+      }
+   }
+   return Finish();
+}
+
+bool BindingPropertyConsumer::StartObject()
+{
+   if (mCaptureDepth > 0)
+   {
+      ++mCaptureDepth;
+      return mCapture->StartObject();
+   }
+   return Start(true);
+}
+
+bool BindingPropertyConsumer::Key(const Ch* str, SizeType length, bool copy)
+{
+   if (mCaptureDepth > 0) { return mCapture->Key(str, length, copy); }
+
+   if (mFrames.empty()) { return false; }
+   Frame& frame = mFrames.back();
+   if (!frame.isObject || frame.hasKey) { return false; }
+
+   frame.value = frame.slot.sink ? frame.slot.sink->member(frame.slot.target, {str, length}) : Binding::Slot{};
+   frame.hasKey = true;
+   return true;
+}
+
+bool BindingPropertyConsumer::EndObject(SizeType /*memberCount*/)
+{
+   return End(true);
+}
+
+bool BindingPropertyConsumer::StartArray()
+{
+   if (mCaptureDepth > 0)
+   {
+      ++mCaptureDepth;
+      return mCapture->StartArray();
+   }
+   return Start(false);
+}
+
+bool BindingPropertyConsumer::EndArray(SizeType /*elementCount*/)
+{
+   return End(false);
+}
+
+bool BindingPropertyConsumer::CurrentIsObject()
+{
+   if (mCaptureDepth > 0) { return mCapture->CurrentIsObject(); }
+   return !mFrames.empty() && mFrames.back().isObject && !mFrames.back().hasKey;
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,166 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BindingProperty.h"
+#include "BindingPropertyHandler.h"
+#include "BindingPropertyReader.h"
+
+namespace CubeWorld
+{
+
+namespace Binding
+{
+
+struct Sink;
+
+// Somewhere a value can go: the object, and a Sink that knows its type. Values sent to
+// a slot without a sink are skipped.
+struct Slot
+{
+   const Sink* sink = nullptr;
+   void* target = nullptr;
+};
+
+//
+// How to fill in one type from events, as a table of functions so that the consumer
+// itself doesn't have to be a template. GetSink<T> makes one for any type that
+// Binding::deserialize can handle.
+//
+struct Sink
+{
+   enum Kind
+   {
+      // Takes scalars. Objects and arrays are read into a BindingProperty first.
+      kValue,
+      // Takes an object, one member at a time. Other values are skipped.
+      kObject,
+      // Takes an array, one element at a time. Other values are skipped.
+      kArray,
+      // Takes an array of numComponents numbers, like a glm::vec3.
+      kVector,
+   };
+
+   Kind kind;
+
+   // Takes a whole value, for anything the kind doesn't stream.
+   void (*assign)(void* target, const BindingProperty& value);
+   // Optional. Takes a string without making a BindingProperty out of it.
+   void (*assignString)(void* target, std::string_view value);
+   // kObject: where the value for a key goes.
+   Slot (*member)(void* target, std::string_view key);
+   // kArray: where the next element goes.
+   Slot (*element)(void* target);
+   // kVector
+   size_t numComponents;
+   void (*assignComponents)(void* target, const double* components);
+};
+
+template <typename T>
+const Sink* GetSink();
+
+}; // namespace Binding
+
+//
+// Reads a document straight into a registered type, without building a BindingProperty
+// along the way. Members are matched by the names given to meta::registerMembers, just
+// like Binding::deserialize, and keys without a member are skipped without being read.
+//
+// Objects, arrays, maps, vectors, strings, enums and numbers are all filled in place.
+// Anything else, like a member with a setter, is read into a BindingProperty of its own
+// and handed to Binding::deserialize.
+//
+// Feed it with the Read functions on JSONSerializer, YAMLSerializer or BinarySerializer.
+//
+class BindingPropertyConsumer : public BindingPropertyHandler
+{
+public:
+   template <typename T>
+   BindingPropertyConsumer(T& target) : mRoot{Binding::GetSink<T>(), &target}
+   {}
+
+   // Only reads the value of one top-level key, and stops the document as soon as it
+   // has it. Without that key, the target is left alone.
+   template <typename T>
+   BindingPropertyConsumer(T& target, const std::string& key)
+      : mRoot{&kSelectSink, this}
+      , mKey(key)
+      , mSelected{Binding::GetSink<T>(), &target}
+   {}
+
+public:
+   // BindingPropertyHandler implementation
+   bool Null() override;
+   bool Bool(bool b) override;
+   bool Int(int i) override;
+   bool Uint(unsigned i) override;
+   bool Int64(int64_t i) override;
+   bool Uint64(uint64_t i) override;
+   bool Double(double d) override;
+   bool String(const Ch* str, SizeType length, bool copy) override;
+   bool StartObject() override;
+   bool Key(const Ch* str, SizeType length, bool copy) override;
+   bool EndObject(SizeType memberCount = 0) override;
+   bool StartArray() override;
+   bool EndArray(SizeType elementCount = 0) override;
+   bool CurrentIsObject() override;
+   bool IsDone() const override { return mDone; }
+
+private:
+   // An object or array that's being filled in.
+   struct Frame
+   {
+      Binding::Slot slot;
+      bool isObject;
+
+      // Objects: where the value of the last key goes, until it arrives.
+      Binding::Slot value;
+      bool hasKey;
+
+      // kVector: the components seen so far.
+      size_t numComponents;
+      bool isVector;
+      double components[4];
+   };
+
+   // Finds where the next value goes, and moves past it.
+   bool NextSlot(Binding::Slot& slot);
+
+   bool Scalar(const BindingProperty& value);
+   bool Start(bool isObject);
+   bool End(bool isObject);
+
+   // Called after each value, to notice when the document, or the selected key, is done.
+   bool Finish();
+
+   static void AssignComponent(void* frame, const BindingProperty& value);
+   static Binding::Slot SelectMember(void* consumer, std::string_view key);
+   static const Binding::Sink kComponentSink;
+   static const Binding::Sink kSelectSink;
+
+private:
+   Binding::Slot mRoot;
+   bool mStarted = false;
+   bool mDone = false;
+
+   std::vector<Frame> mFrames;
+
+   // Values that can't be streamed are read here first.
+   std::optional<BindingPropertyReader> mCapture;
+   Binding::Slot mCaptureSlot;
+   size_t mCaptureDepth = 0;
+
+   // When only reading one key.
+   std::string mKey;
+   Binding::Slot mSelected;
+   bool mFoundKey = false;
+};
+
+}; // namespace CubeWorld
+
+#include "BindingPropertyConsumer.inl"
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cassert>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "BindingPropertyConsumer.h"
+
+namespace CubeWorld
+{
+
+namespace Binding
+{
+
+// Anything Binding::deserialize understands, one whole value at a time.
+template <typename T, typename = void>
+struct SinkFor
+{
+   static void Assign(void* target, const BindingProperty& value)
+   {
+      deserialize(*static_cast<T*>(target), value);
+   }
+
+   static constexpr Sink kSink{Sink::kValue, &Assign, nullptr, nullptr, nullptr, 0, nullptr};
+};
+
+template <>
+struct SinkFor<std::string>
+{
+   static void Assign(void* target, const BindingProperty& value)
+   {
+      deserialize(*static_cast<std::string*>(target), value);
+   }
+
+   static void AssignString(void* target, std::string_view value)
+   {
+      static_cast<std::string*>(target)->assign(value.data(), value.size());
+   }
+
+   static constexpr Sink kSink{Sink::kValue, &Assign, &AssignString, nullptr, nullptr, 0, nullptr};
+};
+
+template <typename EnumType>
+struct SinkFor<EnumType, std::enable_if_t<!meta::isRegistered<EnumType>() && meta::valuesRegistered<EnumType>()>>
+{
+   static void Assign(void* target, const BindingProperty& value)
+   {
+      deserialize(*static_cast<EnumType*>(target), value);
+   }
+
+   static void AssignString(void* target, std::string_view value)
+   {
+      *static_cast<EnumType*>(target) = meta::getValue<EnumType>(std::string(value));
+   }
+
+   static constexpr Sink kSink{Sink::kValue, &Assign, &AssignString, nullptr, nullptr, 0, nullptr};
+};
+
+// glm::vec3 and glm::vec4. Like GetVec3 and GetVec4, anything but exactly the right
+// amount of numbers gives zero.
+template <typename Vec, size_t N>
+struct VectorSink
+{
+   static void Assign(void* target, const BindingProperty& value)
+   {
+      deserialize(*static_cast<Vec*>(target), value);
+   }
+
+   static void AssignComponents(void* target, const double* components)
+   {
+      Vec& vec = *static_cast<Vec*>(target);
+      for (size_t i = 0; i < N; ++i)
+      {
+         vec[int(i)] = float(components[i]);
+      }
+   }
+
+   static constexpr Sink kSink{Sink::kVector, &Assign, nullptr, nullptr, nullptr, N, &AssignComponents};
+};
+
+template <> struct SinkFor<glm::vec3> : VectorSink<glm::vec3, 3> {};
+template <> struct SinkFor<glm::vec4> : VectorSink<glm::vec4, 4> {};
+
+// Setters only take whole values, so the member is read into a BindingProperty first.
+template <typename Class, size_t I>
+struct SetterSink
+{
+   static void Assign(void* target, const BindingProperty& value)
+   {
+      const auto& member = std::get<I>(meta::getMembers<Class>());
+      member.set(*static_cast<Class*>(target), value.template Get<meta::get_member_type<decltype(member)>>());
+   }
+
+   static constexpr Sink kSink{Sink::kValue, &Assign, nullptr, nullptr, nullptr, 0, nullptr};
+};
+
+template <typename Class>
+struct SinkFor<Class, std::enable_if_t<meta::isRegistered<Class>()>>
+{
+   static constexpr size_t kNumMembers = std::tuple_size_v<std::decay_t<decltype(meta::getMembers<Class>())>>;
+
+   template <size_t I>
+   static Slot MemberSlot(Class& obj)
+   {
+      const auto& member = std::get<I>(meta::getMembers<Class>());
+      if (member.hasSetter())
+      {
+         return Slot{&SetterSink<Class, I>::kSink, &obj};
+      }
+      else if (member.canGetRef())
+      {
+         return Slot{GetSink<meta::get_member_type<decltype(member)>>(), &member.getRef(obj)};
+      }
+
+      assert(false && "can't deserialize member because it's read only");
+      return Slot{};
+   }
+
+   template <size_t... I>
+   static Slot FindMember(Class& obj, std::string_view key, std::index_sequence<I...>)
+   {
+      Slot slot;
+      (void)((key == std::string_view(std::get<I>(meta::getMembers<Class>()).getName()) && (slot = MemberSlot<I>(obj), true)) || ...);
+      return slot;
+   }
+
+   static Slot Member(void* target, std::string_view key)
+   {
+      return FindMember(*static_cast<Class*>(target), key, std::make_index_sequence<kNumMembers>{});
+   }
+
+   static constexpr Sink kSink{Sink::kObject, nullptr, nullptr, &Member, nullptr, 0, nullptr};
+};
+
+// Like Binding::deserialize, these add to whatever is already in the container.
+template <typename T>
+struct SinkFor<std::vector<T>, std::enable_if_t<!std::is_same_v<T, bool>>>
+{
+   static Slot Element(void* target)
+   {
+      return Slot{GetSink<T>(), &static_cast<std::vector<T>*>(target)->emplace_back()};
+   }
+
+   static constexpr Sink kSink{Sink::kArray, nullptr, nullptr, nullptr, &Element, 0, nullptr};
+};
+
+template <typename Map>
+struct MapSink
+{
+   using K = typename Map::key_type;
+   using V = typename Map::mapped_type;
+
+   static Slot Member(void* target, std::string_view key)
+   {
+      Map& map = *static_cast<Map*>(target);
+      std::pair<typename Map::iterator, bool> inserted;
+      if constexpr (std::is_same_v<K, std::string>)
+      {
+         inserted = map.try_emplace(K(key));
+      }
+      else
+      {
+         inserted = map.try_emplace(BindingProperty(std::string(key)).template Get<K>());
+      }
+
+      // Keys that were already there keep their values.
+      return inserted.second ? Slot{GetSink<V>(), &inserted.first->second} : Slot{};
+   }
+
+   static constexpr Sink kSink{Sink::kObject, nullptr, nullptr, &Member, nullptr, 0, nullptr};
+};
+
+template <typename K, typename V>
+struct SinkFor<std::map<K, V>> : MapSink<std::map<K, V>> {};
+template <typename K, typename V>
+struct SinkFor<std::unordered_map<K, V>> : MapSink<std::unordered_map<K, V>> {};
+
+template <typename T>
+const Sink* GetSink()
+{
+   return &SinkFor<T>::kSink;
+}
+
+}; // namespace Binding
+
+}; // namespace CubeWorld
@@ -0,0 +1,45 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <rapidjson/rapidjson.h>
+
+namespace CubeWorld
+{
+
+//
+// Receives a document as a stream of rapidjson-style events. The JSON, YAML and binary
+// serializers can all feed one, so the same handler works with any of them.
+//
+// Returning false from an event stops the document. That's a failure, unless IsDone
+// says the handler got everything it wanted and stopped early on purpose.
+//
+class BindingPropertyHandler
+{
+public:
+   virtual ~BindingPropertyHandler() = default;
+
+   typedef char Ch;
+   typedef rapidjson::SizeType SizeType;
+   virtual bool Null() = 0;
+   virtual bool Bool(bool b) = 0;
+   virtual bool Int(int i) = 0;
+   virtual bool Uint(unsigned i) = 0;
+   virtual bool Int64(int64_t i) = 0;
+   virtual bool Uint64(uint64_t i) = 0;
+   virtual bool Double(double d) = 0;
+   bool RawNumber(const Ch* /*str*/, SizeType /*length*/, bool /*copy*/) { return false; }
+   virtual bool String(const Ch* str, SizeType length, bool copy) = 0;
+   virtual bool StartObject() = 0;
+   virtual bool Key(const Ch* str, SizeType length, bool copy) = 0;
+   virtual bool EndObject(SizeType memberCount = 0) = 0;
+   virtual bool StartArray() = 0;
+   virtual bool EndArray(SizeType elementCount = 0) = 0;
+
+   // YAML doesn't mark which scalars are keys, so its reader asks.
+   virtual bool CurrentIsObject() = 0;
+
+   virtual bool IsDone() const { return false; }
+};
+
+}; // namespace CubeWorld
@@ -5,20 +5,21 @@
 namespace CubeWorld
 {
 
-BindingPropertyReader::BindingPropertyReader()
+BindingPropertyReader::BindingPropertyReader(RGBBinding::Arena* arena) : arena(arena)
 {
    data.SetNull();
    cursor.clear();
    cursor.push_back(&data);
 }
 
-const BindingProperty BindingPropertyReader::Read(const std::string& buffer)
+BindingProperty BindingPropertyReader::Read(const std::string& buffer)
 {
    rapidjson::GenericStringStream<rapidjson::UTF8<>> stream(buffer.c_str());
    rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>> reader;
 
+   RGBBinding::Arena::Scope scope(arena);
    reader.Parse(stream, *this);
-   return data;
+   return TakeResult();
 }
 
 bool BindingPropertyReader::Null()
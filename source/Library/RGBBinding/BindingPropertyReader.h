@@ -4,42 +4,49 @@
 
 #include <stack>
 
+#include "Arena.h"
 #include "BindingProperty.h"
+#include "BindingPropertyHandler.h"
 
 namespace CubeWorld
 {
 
-class BindingPropertyReader
+//
+// Builds a BindingProperty out of rapidjson-style events. Given an arena, Read allocates
+// every string, array and object in the result from it (see RGBBinding/Arena.h), so the
+// arena has to outlive the result. When feeding events by hand, hold an Arena::Scope
+// for the arena instead.
+//
+class BindingPropertyReader : public BindingPropertyHandler
 {
 public:
-   BindingPropertyReader();
+   BindingPropertyReader(RGBBinding::Arena* arena = nullptr);
 
-   const BindingProperty Read(const std::string& buffer);
+   BindingProperty Read(const std::string& buffer);
    const BindingProperty GetResult() const { return data; }
 
+   // Hands over the result without copying it. The reader is left empty.
+   BindingProperty TakeResult() { return std::move(data); }
+
 public:
-   // rapidjson::Handler implementation
-   typedef char Ch;
-   typedef rapidjson::SizeType SizeType;
-   bool Null();
-   bool Bool(bool b);
-   bool Int(int i);
-   bool Uint(unsigned i);
-   bool Int64(int64_t i);
-   bool Uint64(uint64_t i);
-   bool Double(double d);
-   bool RawNumber(const Ch* /*str*/, SizeType /*length*/, bool /*copy*/) { return false; }
-   bool String(const Ch* str, SizeType length, bool copy);
-   bool StartObject();
-   bool Key(const Ch* str, SizeType length, bool copy);
-   bool EndObject(SizeType memberCount = 0);
-   bool StartArray();
-   bool EndArray(SizeType elementCount = 0);
-
-   // Helper functions
-   bool CurrentIsObject();
+   // BindingPropertyHandler implementation
+   bool Null() override;
+   bool Bool(bool b) override;
+   bool Int(int i) override;
+   bool Uint(unsigned i) override;
+   bool Int64(int64_t i) override;
+   bool Uint64(uint64_t i) override;
+   bool Double(double d) override;
+   bool String(const Ch* str, SizeType length, bool copy) override;
+   bool StartObject() override;
+   bool Key(const Ch* str, SizeType length, bool copy) override;
+   bool EndObject(SizeType memberCount = 0) override;
+   bool StartArray() override;
+   bool EndArray(SizeType elementCount = 0) override;
+   bool CurrentIsObject() override;
 
 private:
+   RGBBinding::Arena* arena;
    BindingProperty data;
    std::vector<BindingProperty*> cursor;
 };
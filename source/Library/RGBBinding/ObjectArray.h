@@ -0,0 +1,245 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+#include "Array.h"
+
+namespace CubeWorld
+{
+
+namespace RGBBinding
+{
+
+inline size_t HashKey(std::string_view key)
+{
+   return std::hash<std::string_view>{}(key);
+}
+
+//
+// The key/value pairs of an object, kept in insertion order.
+//
+// Small objects are searched linearly, which beats hashing for a handful of short keys.
+// Once an object reaches INDEX_THRESHOLD entries it also keeps an open-addressed index
+// from key hashes to entries, so lookups in big objects don't degrade into scanning
+// and comparing every key.
+//
+// KV must have a std::string member named key. Duplicate keys are allowed, and the
+// first one inserted is always the one found. The index is kept in the user data of
+// the entries' block, and allocated from the same place as the entries.
+//
+// Size: 12 bytes (on 64-bit), the same as the Array it wraps.
+//
+#pragma pack(push, 4)
+template<typename KV>
+class ObjectArray {
+public:
+   static constexpr size_t INDEX_THRESHOLD = 16;
+   static constexpr size_t npos = size_t(-1);
+
+public:
+   ObjectArray() {};
+
+   ObjectArray(const ObjectArray& other) : mEntries(other.mEntries)
+   {
+      RebuildIndex();
+   }
+
+   ObjectArray(ObjectArray&& other) noexcept : mEntries(std::move(other.mEntries))
+   {}
+
+   ~ObjectArray()
+   {
+      FreeIndex();
+   }
+
+   ObjectArray& operator=(const ObjectArray& other)
+   {
+      if (this != &other)
+      {
+         this->~ObjectArray();
+         new (this) ObjectArray(other);
+      }
+      return *this;
+   }
+
+   ObjectArray& operator=(ObjectArray&& other) noexcept
+   {
+      if (this != &other)
+      {
+         this->~ObjectArray();
+         new (this) ObjectArray(std::move(other));
+      }
+      return *this;
+   }
+
+   bool operator==(const ObjectArray& other) const { return mEntries == other.mEntries; }
+   inline bool operator!=(const ObjectArray& other) const { return !(*this == other); }
+
+   void clear()
+   {
+      mEntries.clear();
+      FreeIndex();
+   }
+
+   size_t size() const { return mEntries.size(); }
+   bool indexed() const { return GetIndex() != nullptr; }
+
+   KV& operator[](size_t index) { return mEntries[index]; }
+   const KV& operator[](size_t index) const { return mEntries[index]; }
+
+   void push_back(KV&& kv)
+   {
+      mEntries.push_back(std::move(kv));
+
+      size_t entry = mEntries.size() - 1;
+      if (GetIndex() && (entry + 1) * 2 <= GetNumSlots())
+      {
+         Insert(uint32_t(entry), HashKey(mEntries[entry].key));
+      }
+      else if (entry + 1 >= INDEX_THRESHOLD)
+      {
+         RebuildIndex();
+      }
+   }
+
+   void pop_back()
+   {
+      mEntries.pop_back();
+
+      // Open addressing can't just drop a slot, and popping from an object is rare.
+      if (GetIndex())
+      {
+         RebuildIndex();
+      }
+   }
+
+   // Returns the index of the first entry with this key, or npos.
+   size_t find(std::string_view key) const
+   {
+      return GetIndex() ? FindIndexed(key, HashKey(key)) : FindLinear(key);
+   }
+
+   // Same as above, for a key that was hashed ahead of time with HashKey.
+   size_t find(std::string_view key, size_t hash) const
+   {
+      return GetIndex() ? FindIndexed(key, hash) : FindLinear(key);
+   }
+
+public:
+   typedef typename Array<KV>::iterator iterator;
+   typedef typename Array<KV>::const_iterator const_iterator;
+
+   iterator begin() { return mEntries.begin(); }
+   iterator end() { return mEntries.end(); }
+   const_iterator begin() const { return mEntries.begin(); }
+   const_iterator end() const { return mEntries.end(); }
+
+private:
+   static constexpr uint32_t EMPTY_SLOT = uint32_t(-1);
+
+   struct Slot {
+      uint32_t hash;
+      uint32_t entry;
+   };
+
+   Slot* GetIndex() const { return static_cast<Slot*>(mEntries.GetUserData()); }
+
+   // Always a power of two.
+   size_t GetNumSlots() const { return GetBlockHeader(GetIndex())->size / sizeof(Slot); }
+
+   void FreeIndex()
+   {
+      if (Slot* index = GetIndex())
+      {
+         FreeBlock(index);
+         mEntries.SetUserData(nullptr);
+      }
+   }
+
+   size_t FindLinear(std::string_view key) const
+   {
+      for (size_t i = 0; i < mEntries.size(); ++i)
+      {
+         if (mEntries[i].key == key)
+         {
+            return i;
+         }
+      }
+      return npos;
+   }
+
+   size_t FindIndexed(std::string_view key, size_t hash) const
+   {
+      const Slot* index = GetIndex();
+      const size_t mask = GetNumSlots() - 1;
+      for (size_t i = hash & mask; ; i = (i + 1) & mask)
+      {
+         const Slot& slot = index[i];
+         if (slot.entry == EMPTY_SLOT)
+         {
+            return npos;
+         }
+
+         if (slot.hash == uint32_t(hash) && mEntries[slot.entry].key == key)
+         {
+            return slot.entry;
+         }
+      }
+   }
+
+   void Insert(uint32_t entry, size_t hash)
+   {
+      Slot* index = GetIndex();
+      const size_t mask = GetNumSlots() - 1;
+
+      size_t i = hash & mask;
+      while (index[i].entry != EMPTY_SLOT)
+      {
+         i = (i + 1) & mask;
+      }
+      index[i] = Slot{uint32_t(hash), entry};
+   }
+
+   void RebuildIndex()
+   {
+      if (mEntries.size() < INDEX_THRESHOLD)
+      {
+         FreeIndex();
+         return;
+      }
+
+      // Keep the table at most half full, so probe runs stay short.
+      size_t numSlots = 2 * INDEX_THRESHOLD;
+      while (numSlots < mEntries.size() * 4)
+      {
+         numSlots *= 2;
+      }
+
+      if (!GetIndex() || GetNumSlots() != numSlots)
+      {
+         FreeIndex();
+         Arena* arena = GetBlockHeader(mEntries.data())->arena;
+         mEntries.SetUserData(AllocateBlock(numSlots * sizeof(Slot), arena));
+      }
+      std::fill_n(GetIndex(), numSlots, Slot{0, EMPTY_SLOT});
+
+      for (size_t i = 0; i < mEntries.size(); ++i)
+      {
+         Insert(uint32_t(i), HashKey(mEntries[i].key));
+      }
+   }
+
+private:
+   // Only indexed once the object has INDEX_THRESHOLD entries.
+   Array<KV> mEntries;
+};
+#pragma pack(pop)
+
+}; // namespace RGBBinding
+
+}; // namespace CubeWorld
@@ -0,0 +1,27 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace CubeWorld
+{
+
+//
+// 64-bit FNV-1a. Quick and stable across runs and platforms, so it's good for keying
+// caches on file contents. Not meant to stand up to anyone crafting collisions.
+//
+inline uint64_t Fnv1a(const void* data, size_t size)
+{
+   const uint8_t* bytes = static_cast<const uint8_t*>(data);
+   uint64_t hash = 0xcbf29ce484222325;
+   for (size_t i = 0; i < size; ++i)
+   {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3;
+   }
+   return hash;
+}
+
+}; // namespace CubeWorld
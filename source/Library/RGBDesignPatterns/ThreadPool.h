@@ -0,0 +1,109 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace CubeWorld
+{
+
+//
+// ThreadPool runs submitted work on a fixed set of worker threads, in the order it was
+// submitted. Destroying the pool finishes everything already queued before joining.
+//
+class ThreadPool {
+public:
+   // Defaults to one thread per core.
+   explicit ThreadPool(size_t numThreads = std::thread::hardware_concurrency())
+   {
+      numThreads = std::max<size_t>(numThreads, 1);
+      mThreads.reserve(numThreads);
+      for (size_t i = 0; i < numThreads; ++i)
+      {
+         mThreads.emplace_back([this] { Run(); });
+      }
+   }
+
+   ~ThreadPool()
+   {
+      {
+         std::unique_lock<std::mutex> lock{mMutex};
+         mExiting = true;
+      }
+      mCondition.notify_all();
+
+      for (std::thread& thread : mThreads)
+      {
+         thread.join();
+      }
+   }
+
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   size_t size() const { return mThreads.size(); }
+
+   //
+   // Queues fn to run on a worker, returning a future for its result.
+   //
+   template<typename F>
+   std::future<std::invoke_result_t<std::decay_t<F>>> Submit(F&& fn)
+   {
+      using Result = std::invoke_result_t<std::decay_t<F>>;
+
+      // std::function needs something copyable, which packaged_task isn't.
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+      std::future<Result> result = task->get_future();
+      {
+         std::unique_lock<std::mutex> lock{mMutex};
+         mTasks.emplace_back([task] { (*task)(); });
+      }
+      mCondition.notify_one();
+      return result;
+   }
+
+private:
+   void Run()
+   {
+      for (;;)
+      {
+         std::function<void()> task;
+         {
+            std::unique_lock<std::mutex> lock{mMutex};
+            mCondition.wait(lock, [&] { return mExiting || !mTasks.empty(); });
+            if (mTasks.empty())
+            {
+               return;
+            }
+
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+         }
+
+         task();
+      }
+   }
+
+private:
+   // Protects mTasks and mExiting.
+   std::mutex mMutex;
+
+   // Signals that a task was queued, or that the pool is shutting down.
+   std::condition_variable mCondition;
+
+   std::deque<std::function<void()>> mTasks;
+   bool mExiting = false;
+
+   std::vector<std::thread> mThreads;
+};
+
+}; // namespace CubeWorld
@@ -5,9 +5,11 @@
 #if CUBEWORLD_PLATFORM_WINDOWS
 #include <Windows.h>
 #else
+#include <cstdio>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
@@ -22,6 +24,57 @@ namespace CubeWorld
 
 using namespace Paths;
 
+namespace
+{
+
+// A "mapped" file that's really just a copy, for when mapping isn't possible.
+class CopiedFile : public FileSystem::MappedFile {
+public:
+   CopiedFile(std::string&& contents) : mContents(std::move(contents)) {}
+
+   const void* data() const override { return mContents.data(); }
+   size_t size() const override { return mContents.size(); }
+
+private:
+   std::string mContents;
+};
+
+class DiskMappedFile : public FileSystem::MappedFile {
+public:
+   DiskMappedFile(void* view, size_t size) : mView(view), mSize(size) {}
+   ~DiskMappedFile()
+   {
+#if CUBEWORLD_PLATFORM_WINDOWS
+      UnmapViewOfFile(mView);
+#else
+      munmap(mView, mSize);
+#endif
+   }
+
+   const void* data() const override { return mView; }
+   size_t size() const override { return mSize; }
+
+private:
+   void* mView;
+   size_t mSize;
+};
+
+}; // anonymous namespace
+
+///
+///
+///
+Maybe<std::unique_ptr<FileSystem::MappedFile>> FileSystem::MapFile(const std::string& path)
+{
+   Maybe<std::string> contents = ReadEntireFile(path);
+   if (!contents)
+   {
+      return contents.Failure();
+   }
+
+   return std::unique_ptr<MappedFile>(std::make_unique<CopiedFile>(std::move(*contents)));
+}
+
 Failure DiskFileSystem::TransformPlatformError(const std::string& message)
 {
 #if CUBEWORLD_PLATFORM_WINDOWS
@@ -392,6 +445,72 @@ Maybe<std::string> DiskFileSystem::ReadEntireFile(const std::string& path)
    return result;
 }
 
+///
+///
+///
+Maybe<std::unique_ptr<FileSystem::MappedFile>> DiskFileSystem::MapFile(const std::string& path)
+{
+   Maybe<FileHandle> maybeHandle = OpenFileRead(path);
+   if (!maybeHandle)
+   {
+      return maybeHandle.Failure();
+   }
+
+   CUBEWORLD_SCOPE_EXIT([&] { CloseFile(*maybeHandle); });
+
+#if defined CUBEWORLD_PLATFORM_WINDOWS
+   LARGE_INTEGER fileSize;
+   if (GetFileSizeEx(*maybeHandle, &fileSize) == 0)
+   {
+      return TransformPlatformError("Failed getting file size");
+   }
+
+   size_t size = size_t(fileSize.QuadPart);
+   if (size == 0)
+   {
+      // Empty files can't be mapped.
+      return std::unique_ptr<MappedFile>(std::make_unique<CopiedFile>(std::string{}));
+   }
+
+   HANDLE mapping = CreateFileMappingW(*maybeHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+   if (mapping == NULL)
+   {
+      return TransformPlatformError("Failed creating file mapping");
+   }
+
+   // The view keeps the mapping alive on its own.
+   void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+   CloseHandle(mapping);
+   if (view == NULL)
+   {
+      return TransformPlatformError("Failed mapping view of file");
+   }
+#elif CUBEWORLD_PLATFORM_MACOSX || CUBEWORLD_PLATFORM_LINUX
+   struct stat status;
+   if (fstat(*maybeHandle, &status) != 0)
+   {
+      return TransformPlatformError("Failed getting file size");
+   }
+
+   size_t size = size_t(status.st_size);
+   if (size == 0)
+   {
+      // Empty files can't be mapped.
+      return std::unique_ptr<MappedFile>(std::make_unique<CopiedFile>(std::string{}));
+   }
+
+   void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, *maybeHandle, 0);
+   if (view == MAP_FAILED)
+   {
+      return TransformPlatformError("Failed mapping file");
+   }
+#else
+#error "Unhandled platform"
+#endif
+
+   return std::unique_ptr<MappedFile>(std::make_unique<DiskMappedFile>(view, size));
+}
+
 ///
 ///
 ///
@@ -464,6 +583,27 @@ Maybe<void> DiskFileSystem::WriteFile(const std::string& path, const std::string
    return WriteFile(*maybeHandle, (uint8_t*)data.c_str(), data.size());
 }
 
+///
+///
+///
+Maybe<void> DiskFileSystem::Rename(const std::string& from, const std::string& to)
+{
+#if defined CUBEWORLD_PLATFORM_WINDOWS
+   if (MoveFileExW(Utf8ToWide(from).c_str(), Utf8ToWide(to).c_str(), MOVEFILE_REPLACE_EXISTING) == 0)
+   {
+      return TransformPlatformError(FormatString("Failed moving {from} to {to}", from, to));
+   }
+#elif CUBEWORLD_PLATFORM_MACOSX || CUBEWORLD_PLATFORM_LINUX
+   if (rename(from.c_str(), to.c_str()) != 0)
+   {
+      return TransformPlatformError(FormatString("Failed moving {from} to {to}", from, to));
+   }
+#else
+#error "Unhandled platform"
+#endif
+   return Success;
+}
+
 ///
 ///
 ///
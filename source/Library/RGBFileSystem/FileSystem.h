@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,17 @@ public:
    using FileHandle = int;
 #endif
 
+   //
+   // Read-only view of a whole file, which stays valid for as long as this is alive.
+   //
+   class MappedFile {
+   public:
+      virtual ~MappedFile() {}
+
+      virtual const void* data() const = 0;
+      virtual size_t size() const = 0;
+   };
+
 public:
    virtual ~FileSystem() {}
 
@@ -67,6 +79,12 @@ public:
    //
    virtual Maybe<std::string> ReadEntireFile(const std::string& path) = 0;
 
+   //
+   // Map a file into memory, read-only. By default this just reads it whole; file
+   // systems that can map files directly override it.
+   //
+   virtual Maybe<std::unique_ptr<MappedFile>> MapFile(const std::string& path);
+
    //
    // Open a file for reading.
    //
@@ -82,6 +100,11 @@ public:
    //
    virtual Maybe<void> WriteFile(const std::string& path, const std::string& data) = 0;
 
+   //
+   // Move a file to a new path, atomically replacing anything already there.
+   //
+   virtual Maybe<void> Rename(const std::string& from, const std::string& to) = 0;
+
    //
    // Seek to a new position within a file
    //
@@ -142,6 +165,11 @@ public:
    //
    Maybe<std::string> ReadEntireFile(const std::string& path) override;
 
+   //
+   // Uses mmap, or MapViewOfFile on Windows.
+   //
+   Maybe<std::unique_ptr<MappedFile>> MapFile(const std::string& path) override;
+
    //
    //
    //
@@ -157,6 +185,11 @@ public:
    //
    Maybe<void> WriteFile(const std::string& path, const std::string& data) override;
 
+   //
+   // Uses rename, or MoveFileEx on Windows.
+   //
+   Maybe<void> Rename(const std::string& from, const std::string& to) override;
+
    //
    //
    //
@@ -0,0 +1,103 @@
+// By Thomas Steinke
+
+#include <cassert>
+#include <cstring>
+
+#include "LogBuffer.h"
+
+namespace CubeWorld
+{
+
+namespace Logger
+{
+
+LogBuffer::LogBuffer(size_t capacity)
+   : mCapacity(64)
+{
+   while (mCapacity < capacity)
+   {
+      mCapacity *= 2;
+   }
+   // Nothing is read before it's written, so skip clearing it.
+   mData.reset(new uint64_t[mCapacity / sizeof(uint64_t)]);
+}
+
+void* LogBuffer::BeginWrite(size_t size)
+{
+   if (size > MaxRecordSize())
+   {
+      return nullptr;
+   }
+
+   const uint64_t total = kHeaderSize + ((size + 7) & ~size_t(7));
+   uint64_t write = mWrite.load(std::memory_order_relaxed);
+   uint64_t offset = write & (mCapacity - 1);
+
+   // Records don't wrap around, so skip the end of the ring if this won't fit there.
+   const uint64_t skip = offset + total > mCapacity ? mCapacity - offset : 0;
+
+   if (write + skip + total - mCachedRead > mCapacity)
+   {
+      // Only check what the reader's done when it looks full, to keep off its cache line.
+      mCachedRead = mRead.load(std::memory_order_acquire);
+      if (write + skip + total - mCachedRead > mCapacity)
+      {
+         return nullptr;
+      }
+   }
+
+   uint8_t* data = reinterpret_cast<uint8_t*>(mData.get());
+   if (skip > 0)
+   {
+      std::memcpy(data + offset, &kSkip, sizeof(kSkip));
+      write += skip;
+      offset = 0;
+   }
+
+   const uint64_t recordSize = size;
+   std::memcpy(data + offset, &recordSize, sizeof(recordSize));
+   mPendingWrite = write + total;
+   return data + offset + kHeaderSize;
+}
+
+void LogBuffer::EndWrite()
+{
+   mWrite.store(mPendingWrite, std::memory_order_release);
+}
+
+const void* LogBuffer::Peek(size_t& size)
+{
+   uint64_t read = mRead.load(std::memory_order_relaxed);
+   const uint64_t write = mWrite.load(std::memory_order_acquire);
+   if (read == write)
+   {
+      return nullptr;
+   }
+
+   const uint8_t* data = reinterpret_cast<const uint8_t*>(mData.get());
+   uint64_t offset = read & (mCapacity - 1);
+
+   uint64_t recordSize;
+   std::memcpy(&recordSize, data + offset, sizeof(recordSize));
+   if (recordSize == kSkip)
+   {
+      // The record is at the start of the ring instead.
+      read += mCapacity - offset;
+      offset = 0;
+      std::memcpy(&recordSize, data, sizeof(recordSize));
+   }
+
+   assert(read != write);
+   size = size_t(recordSize);
+   mPeeked = read + kHeaderSize + ((recordSize + 7) & ~uint64_t(7));
+   return data + offset + kHeaderSize;
+}
+
+void LogBuffer::Pop()
+{
+   mRead.store(mPeeked, std::memory_order_release);
+}
+
+}; // namespace Logger
+
+}; // namespace CubeWorld
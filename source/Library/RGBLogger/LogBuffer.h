@@ -0,0 +1,75 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace CubeWorld
+{
+
+namespace Logger
+{
+
+//
+// A ring of bytes that one thread writes records into and another reads them out of,
+// without any locks. Each record is contiguous: one that won't fit before the end of
+// the ring starts over at the beginning instead.
+//
+class LogBuffer
+{
+public:
+   // Capacity is rounded up to a power of two.
+   explicit LogBuffer(size_t capacity);
+
+   LogBuffer(const LogBuffer&) = delete;
+   LogBuffer& operator=(const LogBuffer&) = delete;
+
+   size_t Capacity() const { return mCapacity; }
+
+   // The largest record that can ever fit.
+   size_t MaxRecordSize() const { return mCapacity / 2 - kHeaderSize; }
+
+   //
+   // Writer side. BeginWrite returns somewhere to put a record of the given size, or
+   // nullptr if there isn't room right now. Nothing is visible to the reader until
+   // EndWrite.
+   //
+   void* BeginWrite(size_t size);
+   void EndWrite();
+
+   //
+   // Reader side. Peek returns the oldest record and its size, or nullptr if there
+   // isn't one. Pop throws it away once it's been used.
+   //
+   const void* Peek(size_t& size);
+   void Pop();
+
+   bool Empty() const { return mRead.load(std::memory_order_relaxed) == mWrite.load(std::memory_order_acquire); }
+
+private:
+   // Records start with their size, and the data after that stays 8-byte aligned.
+   static constexpr size_t kHeaderSize = 8;
+   // Marks the rest of the ring as unused, when a record had to start over.
+   static constexpr uint64_t kSkip = UINT64_MAX;
+
+   std::unique_ptr<uint64_t[]> mData;
+   size_t mCapacity;
+
+   // Only touched by the writer.
+   uint64_t mPendingWrite = 0;
+   uint64_t mCachedRead = 0;
+
+   // Only touched by the reader.
+   uint64_t mPeeked = 0;
+
+   // Kept apart so the two threads don't fight over a cache line.
+   alignas(64) std::atomic<uint64_t> mWrite{0};
+   alignas(64) std::atomic<uint64_t> mRead{0};
+};
+
+}; // namespace Logger
+
+}; // namespace CubeWorld
@@ -0,0 +1,124 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <RGBText/Format.h>
+
+namespace CubeWorld
+{
+
+namespace Logger
+{
+
+//
+// A log call, as it waits in a LogBuffer for the logging thread: the arguments as they
+// were given, followed by a LogRecordArg for each argument. The format string and any
+// string arguments are copied in after those, since they may be gone by the time the
+// record is formatted.
+//
+struct LogRecord
+{
+   // Plain messages, from Log(message, color), don't have a level.
+   static constexpr uint8_t kNoLevel = UINT8_MAX;
+
+   // Counts up with every record, to keep them in order across threads.
+   uint64_t sequence;
+   // The length of the format string, or of the text.
+   uint32_t length;
+   uint8_t numArgs;
+   uint8_t level;
+   uint8_t color;
+   // False if text follows instead, for messages that are already formatted.
+   bool formatted;
+};
+
+struct LogRecordArg
+{
+   // A FormatImpl::basic_arg, kept as bytes since records are only 8-byte aligned.
+   unsigned char arg[sizeof(FormatImpl::basic_arg)];
+   // Strings are copied in after the arguments, and arg is left empty.
+   uint32_t stringLength;
+   bool isString;
+};
+
+namespace LogRecordImpl
+{
+
+// Strings that have to be copied, since only a pointer to them would be stored.
+template <typename T>
+constexpr bool is_string =
+   std::is_same_v<std::decay_t<T>, const char*> ||
+   std::is_same_v<std::decay_t<T>, char*> ||
+   std::is_same_v<std::decay_t<T>, std::string> ||
+   std::is_same_v<std::decay_t<T>, std::string_view>;
+
+inline std::string_view as_string(const char* str) { return str == nullptr ? std::string_view{} : std::string_view(str); }
+inline std::string_view as_string(std::string_view str) { return str; }
+
+template <typename T>
+size_t string_size(const T& arg)
+{
+   if constexpr (is_string<T>)
+   {
+      return as_string(arg).size();
+   }
+   else
+   {
+      return 0;
+   }
+}
+
+template <typename T>
+void encode_arg(LogRecordArg*& out, char*& strings, const T& arg)
+{
+   if constexpr (is_string<T>)
+   {
+      const std::string_view str = as_string(arg);
+      out->stringLength = uint32_t(str.size());
+      out->isString = true;
+      std::memcpy(strings, str.data(), str.size());
+      strings += str.size();
+   }
+   else
+   {
+      const FormatImpl::basic_arg value = FormatImpl::make_arg(arg);
+      std::memcpy(out->arg, &value, sizeof(value));
+      out->stringLength = 0;
+      out->isString = false;
+   }
+   ++out;
+}
+
+}; // namespace LogRecordImpl
+
+// How many bytes a record of this format and these arguments takes up.
+template <typename... Args>
+size_t LogRecordSize(std::string_view fmt, const Args& ... args)
+{
+   return sizeof(LogRecord) + sizeof...(Args) * sizeof(LogRecordArg) + fmt.size() + (size_t(0) + ... + LogRecordImpl::string_size(args));
+}
+
+// Fills in the format string and arguments of a record made with LogRecordSize.
+template <typename... Args>
+void EncodeLogRecord(LogRecord& record, std::string_view fmt, const Args& ... args)
+{
+   record.length = uint32_t(fmt.size());
+   record.numArgs = uint8_t(sizeof...(Args));
+   record.formatted = true;
+
+   LogRecordArg* out = reinterpret_cast<LogRecordArg*>(&record + 1);
+   char* strings = reinterpret_cast<char*>(out + sizeof...(Args));
+   std::memcpy(strings, fmt.data(), fmt.size());
+   strings += fmt.size();
+   (LogRecordImpl::encode_arg(out, strings, args), ...);
+}
+
+}; // namespace Logger
+
+}; // namespace CubeWorld
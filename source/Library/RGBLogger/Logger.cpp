@@ -1,6 +1,12 @@
 // By Thomas Steinke
 
 #include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <new>
+#include <exception>
+#include <iterator>
 
 #include "Logger.h"
 
@@ -10,6 +16,85 @@ namespace CubeWorld
 namespace Logger
 {
 
+struct ThreadLogBuffer
+{
+    explicit ThreadLogBuffer(size_t capacity) : buffer(capacity) {}
+
+    LogBuffer buffer;
+    // Set while the thread is partway through a record, so StopAsync can wait it out.
+    std::atomic<bool> busy{false};
+    std::atomic<uint64_t> dropped{0};
+    // How many of those have been reported. Only touched while draining.
+    uint64_t reported = 0;
+    // Which StartAsync this was made for, so new options make new buffers.
+    uint32_t generation = 0;
+};
+
+namespace LoggerInternal
+{
+
+// Shared with the LogManager, which can tell the thread is gone once it's the only owner.
+thread_local std::shared_ptr<ThreadLogBuffer> tThreadLogBuffer;
+
+std::terminate_handler gPreviousTerminate = nullptr;
+
+// Handlers that were installed before the crash handler, to hand crashes on to.
+using SignalHandler = void (*)(int);
+struct PreviousSignalHandler
+{
+    int signal;
+    SignalHandler handler;
+};
+PreviousSignalHandler gPreviousSignals[] = {
+    { SIGSEGV, SIG_DFL },
+    { SIGABRT, SIG_DFL },
+    { SIGFPE, SIG_DFL },
+    { SIGILL, SIG_DFL },
+};
+
+//
+// Takes a lock, or when crashing, only tries to.
+//
+template <typename Mutex>
+bool Lock(std::unique_lock<Mutex>& lock, bool crashing)
+{
+    if (crashing)
+    {
+        return lock.try_lock();
+    }
+
+    lock.lock();
+    return true;
+}
+
+void FlushOnTerminate()
+{
+    LogManager::Instance().FlushForCrash();
+    if (gPreviousTerminate != nullptr)
+    {
+        gPreviousTerminate();
+    }
+    std::abort();
+}
+
+void FlushOnSignal(int signal)
+{
+    LogManager::Instance().FlushForCrash();
+
+    SignalHandler previous = SIG_DFL;
+    for (const PreviousSignalHandler& entry : gPreviousSignals)
+    {
+        if (entry.signal == signal)
+        {
+            previous = entry.handler;
+        }
+    }
+    std::signal(signal, previous);
+    std::raise(signal);
+}
+
+}; // namespace LoggerInternal
+
 LogManager::LogManager()
 {
     loggers.clear();
@@ -17,6 +102,8 @@ LogManager::LogManager()
 
 LogManager::~LogManager()
 {
+    StopAsync();
+
     std::unique_lock<std::mutex> lock{ mLogMutex };
     for (auto logger = loggers.begin(); logger != loggers.end(); ++logger)
     {
@@ -26,6 +113,36 @@ LogManager::~LogManager()
 }
 
 void LogManager::Log(LogLevel level, const char* message)
+{
+    if (!LogAsyncText(uint8_t(level), Color::Default, message))
+    {
+        Write(level, message);
+    }
+}
+
+void LogManager::Log(const char* message, Color color)
+{
+    if (!LogAsyncText(LogRecord::kNoLevel, color, message))
+    {
+        Write(message, color);
+    }
+}
+
+void LogManager::Flush()
+{
+    if (mAsync.load(std::memory_order_acquire))
+    {
+        Drain();
+    }
+
+    std::unique_lock<std::mutex> lock{ mLogMutex };
+    for (auto logger = loggers.begin(); logger != loggers.end(); ++logger)
+    {
+        (*logger)->Flush();
+    }
+}
+
+void LogManager::Write(LogLevel level, const char* message, bool crashing)
 {
     const char *prefix;
     switch (level)
@@ -49,7 +166,12 @@ void LogManager::Log(LogLevel level, const char* message)
         prefix = "??????| ";
     }
 
-    std::unique_lock<std::mutex> lock{ mLogMutex };
+    std::unique_lock<std::mutex> lock{ mLogMutex, std::defer_lock };
+    if (!LoggerInternal::Lock(lock, crashing))
+    {
+        return;
+    }
+
     for (auto logger = loggers.begin(); logger != loggers.end(); ++logger)
     {
         (*logger)->Log(prefix);
@@ -58,15 +180,315 @@ void LogManager::Log(LogLevel level, const char* message)
     }
 }
 
-void LogManager::Log(const char* message, Color color)
+void LogManager::Write(const char* message, Color color, bool crashing)
 {
-    std::unique_lock<std::mutex> lock{ mLogMutex };
+    std::unique_lock<std::mutex> lock{ mLogMutex, std::defer_lock };
+    if (!LoggerInternal::Lock(lock, crashing))
+    {
+        return;
+    }
+
     for (auto logger = loggers.begin(); logger != loggers.end(); ++logger)
     {
         (*logger)->Log(message, color);
     }
 }
 
+bool LogManager::LogAsyncText(uint8_t level, Color color, const char* message)
+{
+    if (!mAsync.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    const size_t length = strlen(message);
+    bool dropped = false;
+    LogRecord* record = BeginRecord(sizeof(LogRecord) + length, dropped);
+    if (record == nullptr)
+    {
+        return dropped;
+    }
+
+    record->formatted = false;
+    record->length = uint32_t(length);
+    record->numArgs = 0;
+    record->level = level;
+    record->color = uint8_t(color);
+    memcpy(record + 1, message, length);
+    EndRecord();
+    return true;
+}
+
+LogRecord* LogManager::BeginRecord(size_t size, bool& dropped)
+{
+    std::shared_ptr<ThreadLogBuffer>& buffer = LoggerInternal::tThreadLogBuffer;
+    const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+    if (!buffer || buffer->generation != generation)
+    {
+        // The old buffer, if any, is let go of once it's been drained.
+        buffer = std::make_shared<ThreadLogBuffer>(mOptions.bufferSize);
+        buffer->generation = generation;
+        std::unique_lock<std::mutex> lock{ mBuffersMutex };
+        mBuffers.push_back(buffer);
+    }
+
+    // StopAsync waits on busy after turning async off, so one of the two sees the other.
+    buffer->busy.store(true, std::memory_order_seq_cst);
+    if (!mAsync.load(std::memory_order_seq_cst) || size > buffer->buffer.MaxRecordSize())
+    {
+        buffer->busy.store(false, std::memory_order_release);
+        return nullptr;
+    }
+
+    // Taken before reserving space, so a thread that waits for room keeps its place.
+    const uint64_t sequence = mSequence.fetch_add(1, std::memory_order_relaxed);
+
+    void* data = buffer->buffer.BeginWrite(size);
+    while (data == nullptr)
+    {
+        if (mOptions.overflow == OverflowPolicy::kDrop)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            buffer->busy.store(false, std::memory_order_release);
+            dropped = true;
+            return nullptr;
+        }
+
+        mThreadCondition.notify_one();
+        std::this_thread::yield();
+        data = buffer->buffer.BeginWrite(size);
+    }
+
+    LogRecord* record = new (data) LogRecord;
+    record->sequence = sequence;
+    record->color = uint8_t(Color::Default);
+    return record;
+}
+
+void LogManager::EndRecord()
+{
+    ThreadLogBuffer& buffer = *LoggerInternal::tThreadLogBuffer;
+    buffer.buffer.EndWrite();
+    buffer.busy.store(false, std::memory_order_release);
+}
+
+void LogManager::WriteRecord(const LogRecord& record, bool crashing)
+{
+    const char* text = reinterpret_cast<const char*>(&record + 1);
+    if (record.formatted)
+    {
+        // Put the arguments back together, pointing strings at their copies.
+        const LogRecordArg* recordArgs = reinterpret_cast<const LogRecordArg*>(&record + 1);
+        const char* fmt = reinterpret_cast<const char*>(recordArgs + record.numArgs);
+        const char* strings = fmt + record.length;
+
+        FormatImpl::basic_arg args[kMaxAsyncArgs];
+        for (size_t i = 0; i < record.numArgs; ++i)
+        {
+            if (recordArgs[i].isString)
+            {
+                args[i] = FormatImpl::make_arg(std::string_view(strings, recordArgs[i].stringLength));
+                strings += recordArgs[i].stringLength;
+            }
+            else
+            {
+                memcpy(&args[i], recordArgs[i].arg, sizeof(args[i]));
+            }
+        }
+
+        mFormatted.clear();
+        FormatImpl::iterator_output<std::back_insert_iterator<std::string>> output(std::back_inserter(mFormatted));
+        FormatImpl::vformat_to(output, std::string_view(fmt, record.length), FormatImpl::basic_format_args(args, record.numArgs));
+    }
+    else
+    {
+        mFormatted.assign(text, record.length);
+    }
+
+    if (record.level == LogRecord::kNoLevel)
+    {
+        Write(mFormatted.c_str(), Color(record.color), crashing);
+    }
+    else
+    {
+        Write(LogLevel(record.level), mFormatted.c_str(), crashing);
+    }
+}
+
+bool LogManager::Drain(bool crashing)
+{
+    std::unique_lock<std::recursive_timed_mutex> lock{ mDrainMutex };
+
+    std::vector<std::shared_ptr<ThreadLogBuffer>> buffers;
+    {
+        std::unique_lock<std::mutex> buffersLock{ mBuffersMutex, std::defer_lock };
+        if (!LoggerInternal::Lock(buffersLock, crashing))
+        {
+            return false;
+        }
+        buffers = mBuffers;
+    }
+
+    // The oldest record waiting in each buffer.
+    std::vector<const LogRecord*> heads(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        size_t size;
+        heads[i] = static_cast<const LogRecord*>(buffers[i]->buffer.Peek(size));
+    }
+
+    bool wrote = false;
+    for (;;)
+    {
+        size_t next = buffers.size();
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            if (heads[i] != nullptr && (next == buffers.size() || heads[i]->sequence < heads[next]->sequence))
+            {
+                next = i;
+            }
+        }
+
+        if (next == buffers.size())
+        {
+            break;
+        }
+
+        WriteRecord(*heads[next], crashing);
+        wrote = true;
+
+        size_t size;
+        buffers[next]->buffer.Pop();
+        heads[next] = static_cast<const LogRecord*>(buffers[next]->buffer.Peek(size));
+    }
+
+    for (const std::shared_ptr<ThreadLogBuffer>& buffer : buffers)
+    {
+        const uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped != buffer->reported)
+        {
+            Write(LogLevel::kWarning, FormatString("Dropped {count} log messages", dropped - buffer->reported).c_str(), crashing);
+            buffer->reported = dropped;
+        }
+    }
+    buffers.clear();
+
+    // Let go of buffers whose threads have exited, now that they're empty.
+    std::unique_lock<std::mutex> buffersLock{ mBuffersMutex, std::defer_lock };
+    if (!LoggerInternal::Lock(buffersLock, crashing))
+    {
+        return wrote;
+    }
+
+    mBuffers.erase(std::remove_if(mBuffers.begin(), mBuffers.end(), [](const std::shared_ptr<ThreadLogBuffer>& buffer) {
+        return buffer.use_count() == 1 && buffer->buffer.Empty();
+    }), mBuffers.end());
+
+    return wrote;
+}
+
+void LogManager::RunAsync()
+{
+    std::unique_lock<std::mutex> lock{ mThreadMutex };
+    while (mRunning)
+    {
+        lock.unlock();
+        const bool wrote = Drain();
+        lock.lock();
+
+        if (!wrote && mRunning)
+        {
+            mThreadCondition.wait_for(lock, std::chrono::milliseconds(2));
+        }
+    }
+}
+
+void LogManager::StartAsync(const AsyncOptions& options)
+{
+    std::unique_lock<std::mutex> lock{ mThreadMutex };
+    if (mRunning)
+    {
+        return;
+    }
+
+    mOptions = options;
+    mGeneration.fetch_add(1, std::memory_order_release);
+    mRunning = true;
+    mThread = std::thread(&LogManager::RunAsync, this);
+    mAsync.store(true, std::memory_order_seq_cst);
+}
+
+void LogManager::StopAsync()
+{
+    {
+        std::unique_lock<std::mutex> lock{ mThreadMutex };
+        if (!mRunning)
+        {
+            return;
+        }
+
+        mAsync.store(false, std::memory_order_seq_cst);
+        mRunning = false;
+    }
+    mThreadCondition.notify_one();
+    mThread.join();
+
+    // Anyone partway through a record still gets to finish it.
+    {
+        std::unique_lock<std::mutex> buffersLock{ mBuffersMutex };
+        for (const std::shared_ptr<ThreadLogBuffer>& buffer : mBuffers)
+        {
+            while (buffer->busy.load(std::memory_order_seq_cst))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    Drain();
+}
+
+void LogManager::FlushForCrash()
+{
+    // Whatever crashed might be holding the lock, so don't wait on it forever.
+    std::unique_lock<std::recursive_timed_mutex> lock{ mDrainMutex, std::defer_lock };
+    if (!lock.try_lock_for(std::chrono::milliseconds(100)))
+    {
+        return;
+    }
+
+    if (mAsync.load(std::memory_order_acquire))
+    {
+        Drain(true);
+    }
+
+    std::unique_lock<std::mutex> logLock{ mLogMutex, std::defer_lock };
+    if (logLock.try_lock())
+    {
+        for (auto logger = loggers.begin(); logger != loggers.end(); ++logger)
+        {
+            (*logger)->Flush();
+        }
+    }
+}
+
+void LogManager::InstallCrashHandler()
+{
+    std::terminate_handler previous = std::set_terminate(&LoggerInternal::FlushOnTerminate);
+    if (previous != &LoggerInternal::FlushOnTerminate)
+    {
+        LoggerInternal::gPreviousTerminate = previous;
+    }
+    for (LoggerInternal::PreviousSignalHandler& entry : LoggerInternal::gPreviousSignals)
+    {
+        LoggerInternal::SignalHandler previous = std::signal(entry.signal, &LoggerInternal::FlushOnSignal);
+        if (previous != SIG_ERR && previous != &LoggerInternal::FlushOnSignal)
+        {
+            entry.handler = previous;
+        }
+    }
+}
+
 void LogManager::RegisterLogger(Logger* logger)
 {
     std::unique_lock<std::mutex> lock{ mLogMutex };
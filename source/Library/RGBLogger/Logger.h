@@ -2,13 +2,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
-#include <mutex>
 
 #include <RGBDesignPatterns/Singleton.h>
 #include <RGBText/Format.h>
 
+#include "LogBuffer.h"
+#include "LogRecord.h"
+
 #define NO_ON_REGISTER void OnRegister() override {};
 #define NO_ON_DEREGISTER void OnDeregister() override {};
 #define NO_REGISTER_HOOKS NO_ON_REGISTER NO_ON_DEREGISTER
@@ -30,6 +37,8 @@ public:
    virtual void OnRegister() {};
    virtual void OnDeregister() {};
    virtual void Log(const char* message, Color color = Color::Default) = 0;
+   // Write out anything that's been held on to, like buffered output.
+   virtual void Flush() {};
 
    template <typename... Args>
    const inline void Log(std::string_view fmt, const Args& ... args) { Log(FormatString(fmt, args...).c_str()); }
@@ -45,6 +54,25 @@ enum class LogLevel
    kAlways
 };
 
+// What to do when a thread logs faster than the logging thread can write.
+enum class OverflowPolicy
+{
+   // Wait for room, so nothing is lost.
+   kBlock,
+   // Throw the message away, and report how many were lost later on.
+   kDrop,
+};
+
+struct AsyncOptions
+{
+   // Bytes of log records each thread can have waiting.
+   size_t bufferSize = 64 * 1024;
+   OverflowPolicy overflow = OverflowPolicy::kBlock;
+};
+
+// Per-thread buffers for async logging, defined in Logger.cpp.
+struct ThreadLogBuffer;
+
 class LogManager : public Singleton<LogManager>, public Logger
 {
 public:
@@ -58,14 +86,111 @@ public:
    void Log(const char* message, Color color = Color::Default) override;
    void Log(LogLevel level, const char* message);
 
+   //
+   // Format strings given as literals, which is what the LOG macros see most of the time.
+   // In async mode, this only copies the format string and the arguments.
+   //
+   template <size_t N, typename... Args>
+   inline void Log(LogLevel level, const char (&fmt)[N], const Args& ... args)
+   {
+      if (!LogAsync(level, std::string_view(fmt), args...))
+      {
+         Log(level, FormatString(fmt, args...).c_str());
+      }
+   }
+
    template <typename... Args>
    const inline void Log(LogLevel level, std::string_view fmt, const Args& ... args) { Log(level, FormatString(fmt, args...).c_str()); }
    const inline void Log(LogLevel level, const std::string& message) { Log(level, message.c_str()); }
 
+   void Flush() override;
+
+public:
+   //
+   // In async mode, each thread logs into a buffer of its own, and a background thread
+   // formats and writes everything in the order it was logged. Flush waits for it.
+   //
+   void StartAsync(const AsyncOptions& options = AsyncOptions{});
+   void StopAsync();
+
+   //
+   // Flushes on std::terminate and on crashing signals, so the last messages before a
+   // crash make it out, then hands the crash on to whatever handler was there before.
+   // Best effort: if the crash is in the middle of writing a log, it gives up rather
+   // than risk hanging.
+   //
+   void InstallCrashHandler();
+   void FlushForCrash();
+
+private:
+   // The most arguments a single async log can take.
+   static constexpr size_t kMaxAsyncArgs = FormatImpl::MAX_PACKED_ARGS;
+
+   template <typename... Args>
+   bool LogAsync(LogLevel level, std::string_view fmt, const Args& ... args)
+   {
+      static_assert(sizeof...(Args) <= kMaxAsyncArgs, "Too many arguments to log");
+      if (!mAsync.load(std::memory_order_relaxed))
+      {
+         return false;
+      }
+
+      bool dropped = false;
+      LogRecord* record = BeginRecord(LogRecordSize(fmt, args...), dropped);
+      if (record == nullptr)
+      {
+         return dropped;
+      }
+
+      record->level = uint8_t(level);
+      EncodeLogRecord(*record, fmt, args...);
+      EndRecord();
+      return true;
+   }
+
+   // Logs text that's already formatted, if in async mode.
+   bool LogAsyncText(uint8_t level, Color color, const char* message);
+
+   //
+   // Reserves a record on this thread's buffer, with its sequence filled in. Returns
+   // nullptr if the message should be written right away instead, or if it was dropped.
+   //
+   LogRecord* BeginRecord(size_t size, bool& dropped);
+   void EndRecord();
+
+   //
+   // Writes straight to the loggers. When crashing, whatever crashed might be holding
+   // the lock, so the message is skipped rather than waiting on it.
+   //
+   void Write(LogLevel level, const char* message, bool crashing = false);
+   void Write(const char* message, Color color, bool crashing = false);
+   void WriteRecord(const LogRecord& record, bool crashing = false);
+
+   // Writes out everything waiting in the thread buffers. Returns whether there was any.
+   bool Drain(bool crashing = false);
+   void RunAsync();
+
 private:
     std::mutex mLogMutex;
     std::vector<Logger*> loggers;
 
+    std::atomic<bool> mAsync{false};
+    std::atomic<uint64_t> mSequence{0};
+    std::atomic<uint32_t> mGeneration{0};
+    AsyncOptions mOptions;
+
+    std::mutex mBuffersMutex;
+    std::vector<std::shared_ptr<ThreadLogBuffer>> mBuffers;
+
+    // Held while draining. Recursive so a crash partway through can still flush.
+    std::recursive_timed_mutex mDrainMutex;
+    std::string mFormatted;
+
+    std::mutex mThreadMutex;
+    std::condition_variable mThreadCondition;
+    std::thread mThread;
+    bool mRunning = false;
+
 public:
    void RegisterLogger(Logger* logger);
    void DeregisterLogger(Logger* logger);
@@ -46,6 +46,11 @@ void StdoutLogger::Log(const char* message, Color color)
    }
 }
 
+void StdoutLogger::Flush()
+{
+   fflush(stdout);
+}
+
 }; // namespace Input
 
 }; // namespace CubeWorld
@@ -26,6 +26,7 @@ public:
 
 public:
    void Log(const char* message, Color color = Color::Default) override;
+   void Flush() override;
 
 private:
    static std::unique_ptr<StdoutLogger> sInstance;
@@ -0,0 +1,537 @@
+// By Thomas Steinke
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <RGBBinding/BindingPropertyReader.h>
+#include "BinarySerializer.h"
+
+namespace CubeWorld
+{
+
+namespace BinarySerializerInternal
+{
+
+constexpr char kMagic[3] = {'B', 'P', 'B'};
+
+// Deeper than any real document, and shallow enough not to run out of stack.
+constexpr size_t kMaxDepth = 256;
+
+//
+// Writes the string table in one pass over the document, then the values in another.
+//
+class BinaryWriter
+{
+public:
+   std::string Write(const BindingProperty& data)
+   {
+      CollectStrings(data);
+
+      mOutput.append(kMagic, sizeof(kMagic));
+      mOutput.push_back(char(BinarySerializer::kVersion));
+
+      WriteVarint(mStrings.size());
+      for (std::string_view string : mStrings)
+      {
+         WriteVarint(string.size());
+         mOutput.append(string.data(), string.size());
+      }
+
+      WriteValue(data);
+      return std::move(mOutput);
+   }
+
+private:
+   void CollectStrings(const BindingProperty& data)
+   {
+      if (data.IsString())
+      {
+         AddString(data.GetStringView());
+      }
+      else if (data.IsObject())
+      {
+         for (const auto& kv : data.object())
+         {
+            AddString(kv.key);
+            CollectStrings(kv.value);
+         }
+      }
+      else if (data.IsArray())
+      {
+         for (const BindingProperty& elem : data)
+         {
+            CollectStrings(elem);
+         }
+      }
+   }
+
+   void AddString(std::string_view string)
+   {
+      if (mStringIndex.emplace(string, mStrings.size()).second)
+      {
+         mStrings.push_back(string);
+      }
+   }
+
+   void WriteVarint(uint64_t value)
+   {
+      while (value >= 0x80)
+      {
+         mOutput.push_back(char(value | 0x80));
+         value >>= 7;
+      }
+      mOutput.push_back(char(value));
+   }
+
+   // Little endian, whatever the platform.
+   void WriteFixed(uint64_t bits, size_t size)
+   {
+      for (size_t i = 0; i < size; ++i)
+      {
+         mOutput.push_back(char(bits >> (8 * i)));
+      }
+   }
+
+   void WriteTag(BinarySerializer::Tag tag)
+   {
+      mOutput.push_back(char(tag));
+   }
+
+   void WriteNumber(const BindingProperty& data)
+   {
+      if (data.IsDouble())
+      {
+         double d = data.GetDoubleValue();
+         float f = float(d);
+         if (double(f) == d)
+         {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            WriteTag(BinarySerializer::kFloat);
+            WriteFixed(bits, sizeof(bits));
+         }
+         else
+         {
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            WriteTag(BinarySerializer::kDouble);
+            WriteFixed(bits, sizeof(bits));
+         }
+      }
+      else if (data.IsInt64())
+      {
+         int64_t i64 = data.GetInt64Value();
+         if (i64 >= 0 && i64 <= BinarySerializer::kMaxFixInt)
+         {
+            mOutput.push_back(char(i64));
+         }
+         else
+         {
+            WriteTag(BinarySerializer::kInt);
+            WriteVarint((uint64_t(i64) << 1) ^ uint64_t(i64 >> 63));
+         }
+      }
+      else
+      {
+         WriteTag(BinarySerializer::kUint64);
+         WriteVarint(data.GetUint64Value());
+      }
+   }
+
+   void WriteValue(const BindingProperty& data)
+   {
+      switch (data.GetType())
+      {
+      case BindingProperty::Type::Null:
+         WriteTag(BinarySerializer::kNull);
+         break;
+      case BindingProperty::Type::True:
+      case BindingProperty::Type::False:
+         WriteTag(data.GetBooleanValue() ? BinarySerializer::kTrue : BinarySerializer::kFalse);
+         break;
+      case BindingProperty::Type::Number:
+         WriteNumber(data);
+         break;
+      case BindingProperty::Type::String:
+         WriteTag(BinarySerializer::kString);
+         WriteVarint(mStringIndex.at(data.GetStringView()));
+         break;
+      case BindingProperty::Type::Object:
+         WriteTag(BinarySerializer::kObject);
+         WriteVarint(data.GetSize());
+         for (const auto& kv : data.object())
+         {
+            WriteVarint(mStringIndex.at(kv.key));
+            WriteValue(kv.value);
+         }
+         break;
+      case BindingProperty::Type::Array:
+         WriteTag(BinarySerializer::kArray);
+         WriteVarint(data.GetSize());
+         for (const BindingProperty& elem : data)
+         {
+            WriteValue(elem);
+         }
+         break;
+      }
+   }
+
+private:
+   std::string mOutput;
+
+   // Views into the document being written, in the order they were first seen.
+   std::vector<std::string_view> mStrings;
+   std::unordered_map<std::string_view, size_t> mStringIndex;
+};
+
+//
+// Feeds a binary document to a BindingPropertyHandler, the same way the JSON and YAML
+// parsers do. Every read is bounds checked, so a truncated or corrupt file fails
+// instead of reading past the end of the buffer.
+//
+class BinaryParser
+{
+public:
+   BinaryParser(const std::string& buffer, BindingPropertyHandler& handler)
+      : mBegin(reinterpret_cast<const uint8_t*>(buffer.data()))
+      , mCursor(mBegin)
+      , mEnd(mBegin + buffer.size())
+      , mHandler(handler)
+   {}
+
+   Maybe<void> Parse()
+   {
+      if (size_t(mEnd - mCursor) < sizeof(kMagic) + 1 || std::memcmp(mCursor, kMagic, sizeof(kMagic)) != 0)
+      {
+         return Failure{"Not a binary document"};
+      }
+      mCursor += sizeof(kMagic);
+
+      uint8_t version = *mCursor++;
+      if (version != BinarySerializer::kVersion)
+      {
+         return Failure{"Unsupported version {version}, expected {expected}", uint32_t(version), uint32_t(BinarySerializer::kVersion)};
+      }
+
+      uint64_t numStrings;
+      if (!ReadCount(numStrings))
+      {
+         return Failure{"Failed reading string table: {message}", mError};
+      }
+
+      mStrings.reserve(size_t(numStrings));
+      for (uint64_t i = 0; i < numStrings; ++i)
+      {
+         uint64_t length;
+         if (!ReadVarint(length) || !Has(length))
+         {
+            return Failure{"Failed reading string {index}: {message}", i, mError};
+         }
+         mStrings.emplace_back(reinterpret_cast<const char*>(mCursor), size_t(length));
+         mCursor += length;
+      }
+
+      if (!ParseValue(0))
+      {
+         if (mHandler.IsDone())
+         {
+            return Success;
+         }
+         return Failure{"Failed reading data at offset {offset}: {message}", GetOffset(), mError};
+      }
+
+      if (mCursor != mEnd)
+      {
+         return Failure{"Unexpected data after the document at offset {offset}", GetOffset()};
+      }
+
+      return Success;
+   }
+
+private:
+   size_t GetOffset() const
+   {
+      return size_t(mCursor - mBegin);
+   }
+
+   bool Error(const char* message)
+   {
+      mError = message;
+      return false;
+   }
+
+   bool Has(uint64_t bytes)
+   {
+      return uint64_t(mEnd - mCursor) >= bytes || Error("Unexpected end of data");
+   }
+
+   bool ReadVarint(uint64_t& value)
+   {
+      value = 0;
+      for (uint32_t shift = 0; shift < 64; shift += 7)
+      {
+         if (mCursor == mEnd)
+         {
+            return Error("Unexpected end of data");
+         }
+
+         uint8_t byte = *mCursor++;
+         value |= uint64_t(byte & 0x7f) << shift;
+         if ((byte & 0x80) == 0)
+         {
+            return true;
+         }
+      }
+      return Error("Varint is too long");
+   }
+
+   // Every element takes at least a byte, which rules out absurd counts up front.
+   bool ReadCount(uint64_t& count)
+   {
+      return ReadVarint(count) && (count <= uint64_t(mEnd - mCursor) || Error("Count is larger than the data"));
+   }
+
+   bool ReadString(const std::string_view*& string)
+   {
+      uint64_t index;
+      if (!ReadVarint(index))
+      {
+         return false;
+      }
+      if (index >= mStrings.size())
+      {
+         return Error("String index out of range");
+      }
+      string = &mStrings[size_t(index)];
+      return true;
+   }
+
+   uint64_t ReadFixed(size_t size)
+   {
+      uint64_t bits = 0;
+      for (size_t i = 0; i < size; ++i)
+      {
+         bits |= uint64_t(mCursor[i]) << (8 * i);
+      }
+      mCursor += size;
+      return bits;
+   }
+
+   bool ParseValue(size_t depth)
+   {
+      if (depth > kMaxDepth)
+      {
+         return Error("Nested too deeply");
+      }
+
+      if (!Has(1))
+      {
+         return false;
+      }
+
+      uint8_t tag = *mCursor++;
+      if (tag <= BinarySerializer::kMaxFixInt)
+      {
+         return mHandler.Int(int(tag)) || Error("Failed writing int");
+      }
+
+      switch (tag)
+      {
+      case BinarySerializer::kNull:
+         return mHandler.Null() || Error("Failed writing null");
+      case BinarySerializer::kFalse:
+         return mHandler.Bool(false) || Error("Failed writing false");
+      case BinarySerializer::kTrue:
+         return mHandler.Bool(true) || Error("Failed writing true");
+      case BinarySerializer::kInt:
+      {
+         uint64_t zigzag;
+         if (!ReadVarint(zigzag))
+         {
+            return false;
+         }
+         return mHandler.Int64(int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1)) || Error("Failed writing int");
+      }
+      case BinarySerializer::kUint64:
+      {
+         uint64_t u64;
+         if (!ReadVarint(u64))
+         {
+            return false;
+         }
+         return mHandler.Uint64(u64) || Error("Failed writing uint64");
+      }
+      case BinarySerializer::kFloat:
+      {
+         if (!Has(4))
+         {
+            return false;
+         }
+         uint32_t bits = uint32_t(ReadFixed(4));
+         float f;
+         std::memcpy(&f, &bits, sizeof(f));
+         return mHandler.Double(double(f)) || Error("Failed writing float");
+      }
+      case BinarySerializer::kDouble:
+      {
+         if (!Has(8))
+         {
+            return false;
+         }
+         uint64_t bits = ReadFixed(8);
+         double d;
+         std::memcpy(&d, &bits, sizeof(d));
+         return mHandler.Double(d) || Error("Failed writing double");
+      }
+      case BinarySerializer::kString:
+      {
+         const std::string_view* string;
+         if (!ReadString(string))
+         {
+            return false;
+         }
+         return mHandler.String(string->data(), rapidjson::SizeType(string->size()), true) || Error("Failed writing string");
+      }
+      case BinarySerializer::kArray:
+      {
+         uint64_t count;
+         if (!ReadCount(count))
+         {
+            return false;
+         }
+         if (!mHandler.StartArray())
+         {
+            return Error("Failed starting array");
+         }
+         for (uint64_t i = 0; i < count; ++i)
+         {
+            if (!ParseValue(depth + 1))
+            {
+               return false;
+            }
+         }
+         return mHandler.EndArray(rapidjson::SizeType(count)) || Error("Failed ending array");
+      }
+      case BinarySerializer::kObject:
+      {
+         uint64_t count;
+         if (!ReadCount(count))
+         {
+            return false;
+         }
+         if (!mHandler.StartObject())
+         {
+            return Error("Failed starting object");
+         }
+         for (uint64_t i = 0; i < count; ++i)
+         {
+            const std::string_view* key;
+            if (!ReadString(key))
+            {
+               return false;
+            }
+            if (!mHandler.Key(key->data(), rapidjson::SizeType(key->size()), true))
+            {
+               return Error("Failed writing key");
+            }
+            if (!ParseValue(depth + 1))
+            {
+               return false;
+            }
+         }
+         return mHandler.EndObject(rapidjson::SizeType(count)) || Error("Failed ending object");
+      }
+      default:
+         return Error("Unknown tag");
+      }
+   }
+
+private:
+   const uint8_t* mBegin;
+   const uint8_t* mCursor;
+   const uint8_t* mEnd;
+   BindingPropertyHandler& mHandler;
+
+   std::vector<std::string_view> mStrings;
+   const char* mError = "";
+};
+
+}; // namespace BinarySerializerInternal
+
+Maybe<BindingProperty> BinarySerializer::Deserialize(const std::string& buffer, RGBBinding::Arena* arena)
+{
+   BindingPropertyReader reader;
+   RGBBinding::Arena::Scope scope(arena);
+
+   if (Maybe<void> result = Read(buffer, reader); !result)
+   {
+      return result.Failure();
+   }
+
+   return reader.TakeResult();
+}
+
+Maybe<BindingProperty> BinarySerializer::DeserializeFile(FileSystem& fs, const std::string& path, RGBBinding::Arena* arena)
+{
+   Maybe<std::string> maybeResult = fs.ReadEntireFile(path);
+   if (!maybeResult)
+   {
+      return maybeResult.Failure().WithContext("Failed reading file");
+   }
+
+   return Deserialize(*maybeResult, arena);
+}
+
+Maybe<BindingProperty> BinarySerializer::DeserializeFile(const std::string& path, RGBBinding::Arena* arena)
+{
+   DiskFileSystem fs;
+   return DeserializeFile(fs, path, arena);
+}
+
+Maybe<void> BinarySerializer::Read(const std::string& buffer, BindingPropertyHandler& handler)
+{
+   return BinarySerializerInternal::BinaryParser{buffer, handler}.Parse();
+}
+
+Maybe<void> BinarySerializer::ReadFile(FileSystem& fs, const std::string& path, BindingPropertyHandler& handler)
+{
+   Maybe<std::string> maybeResult = fs.ReadEntireFile(path);
+   if (!maybeResult)
+   {
+      return maybeResult.Failure().WithContext("Failed reading file");
+   }
+
+   return Read(*maybeResult, handler);
+}
+
+Maybe<void> BinarySerializer::ReadFile(const std::string& path, BindingPropertyHandler& handler)
+{
+   DiskFileSystem fs;
+   return ReadFile(fs, path, handler);
+}
+
+Maybe<std::string> BinarySerializer::Serialize(const BindingProperty& data)
+{
+   return BinarySerializerInternal::BinaryWriter{}.Write(data);
+}
+
+Maybe<void> BinarySerializer::SerializeFile(FileSystem& fs, const std::string& path, const BindingProperty& data)
+{
+   Maybe<std::string> serialized = Serialize(data);
+   if (!serialized)
+   {
+      return serialized.Failure().WithContext("Failed to serialize data");
+   }
+
+   return fs.WriteFile(path, std::move(*serialized));
+}
+
+Maybe<void> BinarySerializer::SerializeFile(const std::string& path, const BindingProperty& data)
+{
+   DiskFileSystem fs;
+   return SerializeFile(fs, path, data);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,80 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <string>
+
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBBinding/Arena.h>
+#include <RGBBinding/BindingProperty.h>
+#include <RGBBinding/BindingPropertyHandler.h>
+#include <RGBDesignPatterns/Maybe.h>
+
+namespace CubeWorld
+{
+
+//
+// A compact binary form of a BindingProperty, loosely modelled on msgpack, for loading
+// documents without parsing any text. Converting a JSON or YAML document to binary and
+// back gives the same BindingProperty, numeric types included.
+//
+// Every string and object key is stored once, up front, and values refer to it by
+// index. Arrays and objects are prefixed with their length. All integers are LEB128
+// varints, and signed ones are zigzag encoded first.
+//
+//   char[3]      "BPB"
+//   uint8_t      kVersion
+//   varint       numStrings
+//   (varint length, char[length])[numStrings]
+//   value        the root
+//
+// Each value starts with a tag byte:
+//
+//   0x00 - 0x7f  an integer from 0 to 127, with no payload
+//   kNull, kFalse, kTrue
+//   kInt         zigzag varint
+//   kUint64      varint, for values too big for an int64_t
+//   kFloat       4 bytes, for doubles that lose nothing as a float
+//   kDouble      8 bytes
+//   kString      varint string index
+//   kArray       varint count, then count values
+//   kObject      varint count, then count (varint key index, value) pairs
+//
+class BinarySerializer
+{
+public:
+   // Bump whenever the format changes.
+   static constexpr uint8_t kVersion = 1;
+
+   enum Tag : uint8_t {
+      kMaxFixInt = 0x7f,
+      kNull = 0x80,
+      kFalse,
+      kTrue,
+      kInt,
+      kUint64,
+      kFloat,
+      kDouble,
+      kString,
+      kArray,
+      kObject,
+   };
+
+public:
+   // Given an arena, the result is allocated from it, and must be destroyed before it.
+   static Maybe<BindingProperty> Deserialize(const std::string& buffer, RGBBinding::Arena* arena = nullptr);
+   static Maybe<BindingProperty> DeserializeFile(FileSystem& fs, const std::string& path, RGBBinding::Arena* arena = nullptr);
+   static Maybe<BindingProperty> DeserializeFile(const std::string& path, RGBBinding::Arena* arena = nullptr);
+
+   // Feeds the document to a handler, like a BindingPropertyConsumer, instead of building
+   // a BindingProperty.
+   static Maybe<void> Read(const std::string& buffer, BindingPropertyHandler& handler);
+   static Maybe<void> ReadFile(FileSystem& fs, const std::string& path, BindingPropertyHandler& handler);
+   static Maybe<void> ReadFile(const std::string& path, BindingPropertyHandler& handler);
+
+   static Maybe<std::string> Serialize(const BindingProperty& data);
+   static Maybe<void> SerializeFile(FileSystem& fs, const std::string& path, const BindingProperty& data);
+   static Maybe<void> SerializeFile(const std::string& path, const BindingProperty& data);
+};
+
+}; // namespace CubeWorld
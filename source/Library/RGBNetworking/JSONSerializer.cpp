@@ -12,12 +12,12 @@
 namespace CubeWorld
 {
 
-Maybe<BindingProperty> JSONSerializer::Deserialize(const std::string& buffer)
+Maybe<BindingProperty> JSONSerializer::Deserialize(const std::string& buffer, RGBBinding::Arena* arena)
 {
-   return BindingPropertyReader{}.Read(buffer);
+   return BindingPropertyReader{arena}.Read(buffer);
 }
 
-Maybe<BindingProperty> JSONSerializer::DeserializeFile(FileSystem& fs, const std::string& path)
+Maybe<BindingProperty> JSONSerializer::DeserializeFile(FileSystem& fs, const std::string& path, RGBBinding::Arena* arena)
 {
    Maybe<std::string> maybeResult = fs.ReadEntireFile(path);
    if (!maybeResult)
@@ -25,13 +25,44 @@ Maybe<BindingProperty> JSONSerializer::DeserializeFile(FileSystem& fs, const std
       return maybeResult.Failure().WithContext("Failed reading file");
    }
 
-   return Deserialize(std::move(*maybeResult));
+   return Deserialize(std::move(*maybeResult), arena);
 }
 
-Maybe<BindingProperty> JSONSerializer::DeserializeFile(const std::string& path)
+Maybe<BindingProperty> JSONSerializer::DeserializeFile(const std::string& path, RGBBinding::Arena* arena)
 {
    DiskFileSystem fs;
-   return DeserializeFile(fs, path);
+   return DeserializeFile(fs, path, arena);
+}
+
+Maybe<void> JSONSerializer::Read(const std::string& buffer, BindingPropertyHandler& handler)
+{
+   rapidjson::GenericStringStream<rapidjson::UTF8<>> stream(buffer.c_str());
+   rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>> reader;
+
+   rapidjson::ParseResult result = reader.Parse(stream, handler);
+   if (!result && !handler.IsDone())
+   {
+      return Failure{"Failed parsing buffer: Error {error} at offset {offset}", uint32_t(result.Code()), result.Offset()};
+   }
+
+   return Success;
+}
+
+Maybe<void> JSONSerializer::ReadFile(FileSystem& fs, const std::string& path, BindingPropertyHandler& handler)
+{
+   Maybe<std::string> maybeResult = fs.ReadEntireFile(path);
+   if (!maybeResult)
+   {
+      return maybeResult.Failure().WithContext("Failed reading file");
+   }
+
+   return Read(*maybeResult, handler);
+}
+
+Maybe<void> JSONSerializer::ReadFile(const std::string& path, BindingPropertyHandler& handler)
+{
+   DiskFileSystem fs;
+   return ReadFile(fs, path, handler);
 }
 
 Maybe<std::string> JSONSerializer::Serialize(const BindingProperty& data)
@@ -5,7 +5,9 @@
 #include <string>
 
 #include <RGBFileSystem/FileSystem.h>
+#include <RGBBinding/Arena.h>
 #include <RGBBinding/BindingProperty.h>
+#include <RGBBinding/BindingPropertyHandler.h>
 #include <RGBDesignPatterns/Maybe.h>
 
 namespace CubeWorld
@@ -14,9 +16,16 @@ namespace CubeWorld
 class JSONSerializer
 {
 public:
-   static Maybe<BindingProperty> Deserialize(const std::string& buffer);
-   static Maybe<BindingProperty> DeserializeFile(FileSystem& fs, const std::string& path);
-   static Maybe<BindingProperty> DeserializeFile(const std::string& path);
+   // Given an arena, the result is allocated from it, and must be destroyed before it.
+   static Maybe<BindingProperty> Deserialize(const std::string& buffer, RGBBinding::Arena* arena = nullptr);
+   static Maybe<BindingProperty> DeserializeFile(FileSystem& fs, const std::string& path, RGBBinding::Arena* arena = nullptr);
+   static Maybe<BindingProperty> DeserializeFile(const std::string& path, RGBBinding::Arena* arena = nullptr);
+
+   // Feeds the document to a handler, like a BindingPropertyConsumer, instead of building
+   // a BindingProperty.
+   static Maybe<void> Read(const std::string& buffer, BindingPropertyHandler& handler);
+   static Maybe<void> ReadFile(FileSystem& fs, const std::string& path, BindingPropertyHandler& handler);
+   static Maybe<void> ReadFile(const std::string& path, BindingPropertyHandler& handler);
 
    static Maybe<std::string> Serialize(const BindingProperty& data);
    static Maybe<void> SerializeFile(FileSystem& fs, const std::string& path, const BindingProperty& data);
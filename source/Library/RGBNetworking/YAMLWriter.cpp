@@ -1,8 +1,10 @@
 // By Thomas Steinke
 
+#include <string_view>
 #include <yaml.h>
 
 #include <RGBText/Format.h>
+#include <RGBText/Numbers.h>
 #include "YAMLWriter.h"
 
 namespace CubeWorld
@@ -13,25 +15,45 @@ const yaml_char_t* YAMLWriter::kTrue = (const yaml_char_t*)"true";
 const yaml_char_t* YAMLWriter::kFalse = (const yaml_char_t*)"false";
 const yaml_char_t* YAMLWriter::kZero = (const yaml_char_t*)"0";
 
-bool YAMLWriter::Null()
+namespace YAMLWriterInternal
 {
-   yaml_event_t event;
-   yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)kNull, 4, 1, 1, YAML_PLAIN_SCALAR_STYLE);
-   return yaml_emitter_emit(&mEmitter, &event) != 0;
+
+// Whether a plain scalar would read back as something other than this string.
+bool NeedsQuotes(const char* str, size_t length)
+{
+   const std::string_view value(str, length);
+   if (value == std::string_view("true") || value == std::string_view("false") ||
+       value == std::string_view("null") || value == std::string_view("~"))
+   {
+      return true;
+   }
+
+   Numbers::Number number;
+   return Numbers::Parse(str, str + length, number);
 }
 
-bool YAMLWriter::Bool(bool b)
+}; // namespace YAMLWriterInternal
+
+bool YAMLWriter::Null()
 {
-   yaml_event_t event;
-   if (b)
+   if (mHolding.IsArray())
    {
-      yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)kTrue, 4, 1, 1, YAML_PLAIN_SCALAR_STYLE);
+      mHolding.push_back(BindingProperty{});
+      return true;
    }
-   else
+
+   return Plain((const char*)kNull, 4);
+}
+
+bool YAMLWriter::Bool(bool b)
+{
+   if (mHolding.IsArray())
    {
-      yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)kFalse, 5, 1, 1, YAML_PLAIN_SCALAR_STYLE);
+      mHolding.push_back(b);
+      return true;
    }
-   return yaml_emitter_emit(&mEmitter, &event) != 0;
+
+   return b ? Plain((const char*)kTrue, 4) : Plain((const char*)kFalse, 5);
 }
 
 bool YAMLWriter::Int(int i)
@@ -54,14 +76,12 @@ bool YAMLWriter::Int64(int64_t i)
 
    if (i == 0)
    {
-      yaml_event_t event;
-      yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)kZero, 1, 1, 1, YAML_PLAIN_SCALAR_STYLE);
-      return yaml_emitter_emit(&mEmitter, &event) != 0;
+      return Plain((const char*)kZero, 1);
    }
    else
    {
       std::string formatted = FormatString("{}", i);
-      return String(formatted.c_str(), (rapidjson::SizeType)formatted.size(), true);
+      return Plain(formatted.c_str(), formatted.size());
    }
 }
 
@@ -75,14 +95,12 @@ bool YAMLWriter::Uint64(uint64_t i)
 
    if (i == 0)
    {
-      yaml_event_t event;
-      yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)kZero, 1, 1, 1, YAML_PLAIN_SCALAR_STYLE);
-      return yaml_emitter_emit(&mEmitter, &event) != 0;
+      return Plain((const char*)kZero, 1);
    }
    else
    {
       std::string formatted = FormatString("{}", i);
-      return String(formatted.c_str(), (rapidjson::SizeType)formatted.size(), true);
+      return Plain(formatted.c_str(), formatted.size());
    }
 }
 
@@ -96,31 +114,40 @@ bool YAMLWriter::Double(double d)
 
    if (d == 0)
    {
-      yaml_event_t event;
-      yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)kZero, 1, 1, 1, YAML_PLAIN_SCALAR_STYLE);
-      return yaml_emitter_emit(&mEmitter, &event) != 0;
+      return Plain((const char*)kZero, 1);
    }
-   else
+
+   // Most doubles started out as floats, which need far fewer digits.
+   std::string formatted = float(d) == d ? Numbers::FormatFloat(float(d)) : Numbers::Format(d);
+   return Plain(formatted.c_str(), formatted.size());
+}
+
+bool YAMLWriter::Plain(const char* str, size_t length)
+{
+   if (mHolding.IsArray() && !FlushArray(false))
    {
-      std::string formatted = std::to_string(d);
-      size_t lastNonZero = formatted.find_last_not_of('0');
-      if (formatted.at(lastNonZero) == '.')
-      {
-         --lastNonZero;
-      }
-      return String(formatted.c_str(), (rapidjson::SizeType)lastNonZero + 1, true);
+      return false;
    }
+
+   yaml_event_t event;
+   yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)str, (int)length, 1, 1, YAML_PLAIN_SCALAR_STYLE);
+   return yaml_emitter_emit(&mEmitter, &event) != 0;
 }
 
 bool YAMLWriter::String(const Ch* str, SizeType length, bool /*copy*/)
 {
+   if (!YAMLWriterInternal::NeedsQuotes(str, length))
+   {
+      return Plain(str, length);
+   }
+
    if (mHolding.IsArray() && !FlushArray(false))
    {
       return false;
    }
 
    yaml_event_t event;
-   yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)str, (int)length, 1, 1, YAML_PLAIN_SCALAR_STYLE);
+   yaml_scalar_event_initialize(&event, nullptr, nullptr, (yaml_char_t*)str, (int)length, 1, 1, YAML_DOUBLE_QUOTED_SCALAR_STYLE);
    return yaml_emitter_emit(&mEmitter, &event) != 0;
 }
 
@@ -136,9 +163,10 @@ bool YAMLWriter::StartObject()
    return yaml_emitter_emit(&mEmitter, &event) != 0;
 }
 
-bool YAMLWriter::Key(const Ch* str, SizeType length, bool copy)
+bool YAMLWriter::Key(const Ch* str, SizeType length, bool /*copy*/)
 {
-   return String(str, length, copy);
+   // Keys are always read as strings.
+   return Plain(str, length);
 }
 
 bool YAMLWriter::EndObject(SizeType)
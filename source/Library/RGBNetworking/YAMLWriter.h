@@ -40,8 +40,9 @@ public:
    bool StartArray();
    bool EndArray(SizeType elementCount = 0);
 
-   // Helper function
+   // Helper functions
    bool FlushArray(bool condensed);
+   bool Plain(const char* str, size_t length);
 
 private:
    yaml_emitter_t& mEmitter;
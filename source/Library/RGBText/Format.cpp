@@ -1,5 +1,6 @@
 // By Thomas Steinke
 
+#include <algorithm>
 #include <cmath>
 #include <cstdarg>
 #include <stdio.h>
@@ -8,6 +9,7 @@
 #include <utility>
 
 #include "Format.h"
+#include "Numbers.h"
 
 namespace CubeWorld
 {
@@ -70,17 +72,15 @@ public:
    explicit FormatInt(uint32_t value) : str(format_decimal(value)) {}
    explicit FormatInt(uint64_t value) : str(format_decimal(value)) {}
 
-   std::string result() const { return std::string(str, uint64_t(buffer - str + BUFFER_SIZE - 1)); }
-};
+   const char* data() const { return str; }
+   size_t size() const { return size_t(buffer - str + BUFFER_SIZE - 1); }
 
-std::string FormatBool(bool value)
-{
-   return value ? "true" : "false";
-}
+   std::string result() const { return std::string(data(), size()); }
+};
 
-std::string FormatChar(char value)
+void AppendText(FormatImpl::output& out, std::string_view str)
 {
-   return std::string(1, value);
+   out.append(str.data(), str.data() + str.size());
 }
 
 // Overload used so that we only append L on a long double
@@ -89,17 +89,24 @@ void AppendFloatLength(char *&, T) {}
 void AppendFloatLength(char *&p, long double) { *p++ = 'L'; }
 
 template <typename T>
-std::string FormatDouble(T value, const FormatImpl::format_specs& specs)
+void FormatDouble(FormatImpl::output& out, T value, const FormatImpl::format_specs& specs)
 {
+   if (specs.shortest && fpclassify(value) != FP_INFINITE && fpclassify(value) != FP_NAN)
+   {
+      char buffer[Numbers::kMaxFormattedSize];
+      out.append(buffer, buffer + Numbers::Format(double(value), buffer));
+      return;
+   }
+
    switch (fpclassify(value)) {
-   case FP_INFINITE:  return "<inf>";
-   case FP_NAN:       return "<nan>";
-   case FP_ZERO:      return "0";
-   case FP_SUBNORMAL: return "<err>";
+   case FP_INFINITE:  return AppendText(out, "<inf>");
+   case FP_NAN:       return AppendText(out, "<nan>");
+   case FP_ZERO:      return AppendText(out, "0");
+   case FP_SUBNORMAL: return AppendText(out, "<err>");
    }
 
-   // TODO I'm lazy..
-   static const size_t BUFFER_SIZE = std::numeric_limits<T>::digits10 + 1;
+   // Room for most numbers with %f. Anything bigger is an error instead of an allocation.
+   static const size_t BUFFER_SIZE = 128;
    static const size_t MAX_FORMAT_SIZE = 10; // longest format: %#-*.*Lg
    char buffer[BUFFER_SIZE];
    char fmt[MAX_FORMAT_SIZE];
@@ -118,53 +125,67 @@ std::string FormatDouble(T value, const FormatImpl::format_specs& specs)
 
    // TODO snprintf_s or _snprintf_s by platform
    int written = snprintf(buffer, BUFFER_SIZE, fmt, value);
-   if (written <= (int)BUFFER_SIZE)
+   if (written >= 0 && written < (int)BUFFER_SIZE)
    {
-      return std::string(buffer);
+      out.append(buffer, buffer + written);
+      return;
    }
-   return "<error>";
+   AppendText(out, "<error>");
 }
 
-std::string FormatPointer(const void *pointer)
+void FormatPointer(FormatImpl::output& out, const void *pointer)
+{
+   FormatInt address(reinterpret_cast<uint64_t>(pointer));
+   AppendText(out, "<pointer:");
+   out.append(address.data(), address.data() + address.size());
+   AppendText(out, ">");
+}
+
+template <typename T>
+void FormatInteger(FormatImpl::output& out, T value)
 {
-   return "<pointer:" + FormatInt(reinterpret_cast<uint64_t>(pointer)).result() + ">";
+   FormatInt formatted(value);
+   out.append(formatted.data(), formatted.data() + formatted.size());
 }
 
 namespace FormatImpl {
-std::string FormatArg(const FormatImpl::basic_arg& argument, const format_specs& specs)
+void FormatArg(output& out, const FormatImpl::basic_arg& argument, const format_specs& specs)
 {
    switch (argument.type_)
    {
    case FormatImpl::type::none_type:
    case FormatImpl::type::name_arg_type:
-      return "<missing arg>";
+      return AppendText(out, "<missing arg>");
    case FormatImpl::type::int32_type:
-      return FormatInt(argument.value_.int32_value).result();
+      return FormatInteger(out, argument.value_.int32_value);
    case FormatImpl::type::uint32_type:
-      return FormatInt(argument.value_.uint32_value).result();
+      return FormatInteger(out, argument.value_.uint32_value);
    case FormatImpl::type::int64_type:
-      return FormatInt(argument.value_.int64_value).result();
+      return FormatInteger(out, argument.value_.int64_value);
    case FormatImpl::type::uint64_type:
-      return FormatInt(argument.value_.uint64_value).result();
+      return FormatInteger(out, argument.value_.uint64_value);
    case FormatImpl::type::bool_type:
-      return FormatBool(argument.value_.int32_value != 0);
+      return AppendText(out, argument.value_.int32_value != 0 ? "true" : "false");
    case FormatImpl::type::char_type:
-      return FormatChar(static_cast<char>(argument.value_.int32_value));
+   {
+      const char ch = static_cast<char>(argument.value_.int32_value);
+      return out.append(&ch, &ch + 1);
+   }
    case FormatImpl::type::double_type:
-      return FormatDouble(argument.value_.double_value, specs);
+      return FormatDouble(out, argument.value_.double_value, specs);
    case FormatImpl::type::long_double_type:
-      return FormatDouble(argument.value_.long_double_value, specs);
+      return FormatDouble(out, argument.value_.long_double_value, specs);
    case FormatImpl::type::cstring_type:
-      return std::string(argument.value_.string.value);
+      return AppendText(out, argument.value_.string.value);
    case FormatImpl::type::string_type:
-      return std::string(argument.value_.string.value, argument.value_.string.size);
+      return AppendText(out, std::string_view(argument.value_.string.value, argument.value_.string.size));
    case FormatImpl::type::pointer_type:
-      return FormatPointer(argument.value_.pointer);
+      return FormatPointer(out, argument.value_.pointer);
    case FormatImpl::type::custom_type:
       break;
    }
 
-   return "<unimplemented>";
+   AppendText(out, "<unimplemented>");
 }
 }; // namespace FormatImpl
 
@@ -197,11 +218,29 @@ uint32_t ParseNonnegativeInteger(std::string_view::iterator& it, std::string_vie
    return value;
 }
 
-std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args args)
+// Iterators can't be dereferenced at the end, so this gives pointers for appending.
+const char* ToPointer(std::string_view fmt, std::string_view::iterator it)
 {
-   std::string result;
-   result.reserve(BufferSize(fmt, args));
+   return fmt.data() + (it - fmt.begin());
+}
 
+// Parse a {name:spec} spec, which has been checked by check_spec if it was compiled in.
+void ParseSpec(std::string_view::iterator it, std::string_view::iterator end, FormatImpl::format_specs& specs)
+{
+   if (it != end && *it == '.' && it + 1 != end && '0' <= it[1] && it[1] <= '9')
+   {
+      ++it;
+      specs.precision = ParseNonnegativeInteger(it, end);
+   }
+   if (it != end && *it == 'g')
+   {
+      specs.shortest = true;
+   }
+}
+
+namespace FormatImpl {
+void vformat_to(output& out, std::string_view fmt, basic_format_args args)
+{
    // Current argument, for non-positional formatted strings.
    uint32_t _arg = 0;
 
@@ -222,19 +261,18 @@ std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args arg
       }
       else if (ch == '%')
       {
-         if (*it == ch) {
+         if (it != end && *it == ch) {
             // Append simple text.
-            result.append(start, it);
+            out.append(ToPointer(fmt, start), ToPointer(fmt, it));
             start = ++it;
             continue;
          }
 
          // Append everything before %
-         result.append(start, it - 1);
+         out.append(ToPointer(fmt, start), ToPointer(fmt, it - 1));
 
          // Parse argument index, flags, and width.
-         char c = *it;
-         if (c >= '0' && c <= '9')
+         if (it != end && *it >= '0' && *it <= '9')
          {
             // Parse argument index (followed by '$') or a width preceded with '0'.
             arg_index = ParseNonnegativeInteger(it, end) - 1;
@@ -248,12 +286,12 @@ std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args arg
             if (*newIt == '.')
             {
                ++newIt;
-               if ('0' <= *newIt && *newIt <= '9')
+               if (newIt != end && '0' <= *newIt && *newIt <= '9')
                {
                   specs.precision = ParseNonnegativeInteger(newIt, end);
                }
 
-               if (*newIt++ == 'f')
+               if (newIt != end && *newIt++ == 'f')
                {
                   // valid format, move along
                   // TODO there's a lot more to worry about here i think
@@ -265,15 +303,19 @@ std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args arg
       else if (ch == '{')
       {
          // Append everything before {
-         result.append(start, it - 1);
+         out.append(ToPointer(fmt, start), ToPointer(fmt, it - 1));
 
-         // Parse argument name
-         std::string argName;
+         // Skip the argument name, and read the spec after it if there is one.
          std::string_view::iterator nameStart = it;
-         while (*it++ != '}' && it != end)
+         while (it != end && *it++ != '}')
          {}
 
-         argName.assign(nameStart, it);
+         std::string_view::iterator nameEnd = it == end ? it : it - 1;
+         std::string_view::iterator colon = std::find(nameStart, nameEnd, ':');
+         if (colon != nameEnd)
+         {
+            ParseSpec(colon + 1, nameEnd, specs);
+         }
          start = it;
       }
       else
@@ -288,11 +330,33 @@ std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args arg
 
       FormatImpl::basic_arg arg = args[arg_index];
 
-      result.append(FormatArg(arg, specs));
+      FormatArg(out, arg, specs);
 
       start = it;
    }
-   result.append(start, it);
+   out.append(ToPointer(fmt, start), ToPointer(fmt, it));
+}
+}; // namespace FormatImpl
+
+// Appends to a string, for FormatString.
+class StringOutput : public FormatImpl::output
+{
+public:
+   explicit StringOutput(std::string& result) : mResult(result) {}
+
+   void append(const char* begin, const char* end) override { mResult.append(begin, end); }
+
+private:
+   std::string& mResult;
+};
+
+std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args args)
+{
+   std::string result;
+   result.reserve(BufferSize(fmt, args));
+
+   StringOutput output(result);
+   FormatImpl::vformat_to(output, fmt, args);
 
    return result;
 }
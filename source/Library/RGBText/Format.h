@@ -2,11 +2,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 namespace CubeWorld
 {
@@ -109,8 +112,12 @@ struct typed_value : value {
 struct format_specs
 {
    uint32_t precision = UINT32_MAX;
+   // Write doubles with the fewest digits that read back exactly.
+   bool shortest = false;
 };
 
+class output;
+
 class basic_arg
 {
 private:
@@ -120,7 +127,7 @@ private:
    template <typename T>
    friend constexpr basic_arg make_arg(const T &value);
 
-   friend std::string FormatArg(const basic_arg& argument, const format_specs& precision);
+   friend void FormatArg(output& out, const basic_arg& argument, const format_specs& specs);
    friend class basic_format_args;
 
 public:
@@ -249,6 +256,7 @@ private:
 
 public:
    basic_format_args() : size_(0), args_(nullptr) {}
+   basic_format_args(const basic_arg *args, size_t size) : size_(size), args_(args) {}
 
    template<typename... Args>
    basic_format_args(const arg_store<Args...> &store) : size_(store.NUM_ARGS), args_(store.data()) {}
@@ -300,8 +308,180 @@ inline arg_store<Args...> make_args(const Args & ... args)
    return arg_store<Args...>(args...);
 }
 
+// Where formatted text goes. Everything is written through this, so the parsing can
+// stay in Format.cpp no matter where the text ends up.
+class output
+{
+public:
+   virtual void append(const char* begin, const char* end) = 0;
+};
+
+template <typename OutputIt>
+class iterator_output : public output
+{
+public:
+   explicit iterator_output(OutputIt out) : out_(out) {}
+
+   void append(const char* begin, const char* end) override { out_ = std::copy(begin, end, out_); }
+
+   OutputIt out() const { return out_; }
+
+private:
+   OutputIt out_;
+};
+
+// Writes up to a limit, but keeps counting past it.
+class truncating_output : public output
+{
+public:
+   truncating_output(char* out, size_t limit) : out_(out), limit_(limit) {}
+
+   void append(const char* begin, const char* end) override
+   {
+      const size_t length = size_t(end - begin);
+      if (size_ < limit_)
+      {
+         const size_t written = std::min(length, limit_ - size_);
+         std::memcpy(out_ + size_, begin, written);
+      }
+      size_ += length;
+   }
+
+   char* out() const { return out_ + std::min(size_, limit_); }
+   size_t size() const { return size_; }
+
+private:
+   char* out_;
+   size_t limit_;
+   size_t size_ = 0;
+};
+
+void vformat_to(output& out, std::string_view fmt, basic_format_args args);
+
+constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Checks a {name:spec} spec, which is an optional .precision and then f or g.
+constexpr bool check_spec(std::string_view spec)
+{
+   size_t i = 0;
+   if (i < spec.size() && spec[i] == '.')
+   {
+      if (++i == spec.size() || !is_digit(spec[i])) { return false; }
+      while (i < spec.size() && is_digit(spec[i])) { ++i; }
+   }
+   if (i < spec.size() && (spec[i] == 'f' || spec[i] == 'g'))
+   {
+      ++i;
+   }
+   return i == spec.size();
+}
+
+//
+// Reads a format string the same way FormatString does, and returns false if it
+// would print <missing arg> or has a broken {} or spec. Used by CUBEWORLD_FORMAT to
+// check format strings at compile time.
+//
+constexpr bool check_format(std::string_view fmt, size_t numArgs)
+{
+   size_t nextArg = 0;
+   size_t i = 0;
+   while (i < fmt.size())
+   {
+      size_t argIndex = SIZE_MAX;
+
+      char ch = fmt[i++];
+      if (ch == '\\')
+      {
+         ++i;
+         continue;
+      }
+      else if (ch == '%')
+      {
+         if (i < fmt.size() && fmt[i] == '%')
+         {
+            ++i;
+            continue;
+         }
+
+         if (i < fmt.size() && is_digit(fmt[i]))
+         {
+            size_t index = 0;
+            while (i < fmt.size() && is_digit(fmt[i]))
+            {
+               index = index * 10 + size_t(fmt[i++] - '0');
+            }
+
+            // Positions start at 1.
+            if (index == 0) { return false; }
+            argIndex = index - 1;
+         }
+
+         if (i < fmt.size() && fmt[i] == '.')
+         {
+            size_t end = i + 1;
+            while (end < fmt.size() && is_digit(fmt[end])) { ++end; }
+            if (end < fmt.size() && fmt[end] == 'f')
+            {
+               i = end + 1;
+            }
+         }
+      }
+      else if (ch == '{')
+      {
+         const size_t close = fmt.find('}', i);
+         if (close == std::string_view::npos) { return false; }
+
+         const size_t colon = fmt.find(':', i);
+         if (colon < close && !check_spec(fmt.substr(colon + 1, close - colon - 1)))
+         {
+            return false;
+         }
+         i = close + 1;
+      }
+      else
+      {
+         continue;
+      }
+
+      if (argIndex == SIZE_MAX)
+      {
+         argIndex = nextArg++;
+      }
+      if (argIndex >= numArgs)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+// What CUBEWORLD_FORMAT makes. data() is the format string.
+struct compile_string {};
+
+template <typename S>
+constexpr bool is_compile_string = std::is_base_of_v<compile_string, S>;
+
+template <typename S, typename... Args>
+constexpr void check_compile_string()
+{
+   static_assert(check_format(S::data(), sizeof...(Args)), "Format string doesn't match its arguments");
+}
+
 }; // namespace FormatImpl
 
+//
+// Marks a format string to be checked against its arguments at compile time.
+//
+// Example: FormatString(CUBEWORLD_FORMAT("{name} has {count} things"), name, count);
+//
+#define CUBEWORLD_FORMAT(s) [] { \
+      struct str : CubeWorld::FormatImpl::compile_string { \
+         static constexpr std::string_view data() { return s; } \
+      }; \
+      return str{}; \
+   }()
+
 std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args args);
 
 //
@@ -311,7 +491,9 @@ std::string FormatString(std::string_view fmt, FormatImpl::basic_format_args arg
 // Example: FormatString("This incorporates %1 values, starting with %2 and %3", 2, "my string", &myObject);
 //          FormatString("This incorporates {num} values, starting with {first} and {second}", 2, "my string", &myObject);
 //
-// Usual types from printf are also "supported" (incomplete), such as %d, %s, etc.
+// Usual types from printf are also "supported" (incomplete), such as %d, %s, etc. Numbers
+// can be given a precision with %.2f or {value:.2f}, and {value:g} writes a double with
+// the fewest digits that read back exactly.
 //
 template <typename... Args>
 std::string FormatString(std::string_view fmt, const Args& ... args)
@@ -319,4 +501,63 @@ std::string FormatString(std::string_view fmt, const Args& ... args)
    return FormatString(fmt, *FormatImpl::arg_store<Args...>(args...));
 }
 
+template <typename S, typename... Args, typename = std::enable_if_t<FormatImpl::is_compile_string<S>>>
+std::string FormatString(S, const Args& ... args)
+{
+   FormatImpl::check_compile_string<S, Args...>();
+   return FormatString(S::data(), *FormatImpl::arg_store<Args...>(args...));
+}
+
+//
+// Like FormatString, but writes to an output iterator instead of allocating a string.
+// Returns the iterator past the end of the output.
+//
+// Example: FormatTo(std::back_inserter(buffer), "{x}, {y}", x, y);
+//
+template <typename OutputIt, typename... Args>
+OutputIt FormatTo(OutputIt out, std::string_view fmt, const Args& ... args)
+{
+   FormatImpl::iterator_output<OutputIt> output(out);
+   FormatImpl::vformat_to(output, fmt, *FormatImpl::arg_store<Args...>(args...));
+   return output.out();
+}
+
+template <typename OutputIt, typename S, typename... Args, typename = std::enable_if_t<FormatImpl::is_compile_string<S>>>
+OutputIt FormatTo(OutputIt out, S, const Args& ... args)
+{
+   FormatImpl::check_compile_string<S, Args...>();
+   return FormatTo(out, S::data(), args...);
+}
+
+struct FormatToNResult
+{
+   // Past the last character written.
+   char* out;
+   // How long the whole thing would have been, which is more than was written if it
+   // was cut off.
+   size_t size;
+};
+
+//
+// Writes at most n characters to out, without a null terminator.
+//
+// Example: char label[64];
+//          FormatToNResult result = FormatToN(label, sizeof(label) - 1, "Element {num}", index);
+//          *result.out = '\0';
+//
+template <typename... Args>
+FormatToNResult FormatToN(char* out, size_t n, std::string_view fmt, const Args& ... args)
+{
+   FormatImpl::truncating_output output(out, n);
+   FormatImpl::vformat_to(output, fmt, *FormatImpl::arg_store<Args...>(args...));
+   return FormatToNResult{output.out(), output.size()};
+}
+
+template <typename S, typename... Args, typename = std::enable_if_t<FormatImpl::is_compile_string<S>>>
+FormatToNResult FormatToN(char* out, size_t n, S, const Args& ... args)
+{
+   FormatImpl::check_compile_string<S, Args...>();
+   return FormatToN(out, n, S::data(), args...);
+}
+
 }; // namespace CubeWorld
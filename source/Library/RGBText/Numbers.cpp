@@ -0,0 +1,562 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "Numbers.h"
+
+namespace CubeWorld
+{
+
+namespace NumbersInternal
+{
+
+inline bool IsDigit(char c)
+{
+   return c >= '0' && c <= '9';
+}
+
+// Every power of ten a double holds exactly.
+constexpr double kExactPow10[] = {
+   1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+constexpr uint64_t kMaxExactMantissa = uint64_t(1) << 53;
+
+//
+// Clinger's fast path. When the digits and the power of ten are both exact doubles,
+// one multiply or divide rounds correctly. Almost every number people type, like
+// 0.25 or -6.4, gets this far.
+//
+bool FastPath(uint64_t mantissa, int exponent, double& result)
+{
+   if (mantissa > kMaxExactMantissa)
+   {
+      return false;
+   }
+
+   if (exponent < 0)
+   {
+      if (exponent < -22) { return false; }
+      result = double(mantissa) / kExactPow10[-exponent];
+      return true;
+   }
+
+   if (exponent > 22)
+   {
+      // 123e25 is 123000e22, and the first part may still be exact.
+      if (exponent > 22 + 15) { return false; }
+      for (; exponent > 22; --exponent)
+      {
+         mantissa *= 10;
+         if (mantissa > kMaxExactMantissa) { return false; }
+      }
+   }
+
+   result = double(mantissa) * kExactPow10[exponent];
+   return true;
+}
+
+//
+// Everything else goes through exact decimal arithmetic: the digits are shifted by
+// powers of two until they form the double's significand, then rounded once. This is
+// the algorithm from Go's strconv, and while it's slow, it's only needed for numbers
+// with more than 15 or so digits or huge exponents.
+//
+class Decimal
+{
+public:
+   Decimal(const char* begin, const char* end)
+   {
+      bool sawDot = false;
+      const char* str = begin;
+      for (; str != end; ++str)
+      {
+         if (*str == '.')
+         {
+            sawDot = true;
+            mDecimalPoint = mNumDigits;
+         }
+         else if (IsDigit(*str))
+         {
+            if (*str == '0' && mNumDigits == 0)
+            {
+               // Leading zeros only move the decimal point.
+               --mDecimalPoint;
+            }
+            else if (mNumDigits < kMaxDigits)
+            {
+               mDigits[mNumDigits++] = uint8_t(*str - '0');
+            }
+            else if (*str != '0')
+            {
+               mTruncated = true;
+            }
+         }
+         else
+         {
+            break;
+         }
+      }
+
+      if (!sawDot)
+      {
+         mDecimalPoint = mNumDigits;
+      }
+
+      if (str != end && (*str == 'e' || *str == 'E'))
+      {
+         ++str;
+         bool negative = str != end && *str == '-';
+         if (str != end && (*str == '-' || *str == '+')) { ++str; }
+
+         int exponent = 0;
+         for (; str != end && IsDigit(*str); ++str)
+         {
+            if (exponent < 10000)
+            {
+               exponent = exponent * 10 + (*str - '0');
+            }
+         }
+         mDecimalPoint += negative ? -exponent : exponent;
+      }
+
+      Trim();
+   }
+
+   // Returns false if the number is too big for a double.
+   bool ToDouble(double& result)
+   {
+      // Powers of two that keep the number from crossing a power of ten, by distance.
+      static const int kPowers[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+      static const int kNumPowers = int(sizeof(kPowers) / sizeof(kPowers[0]));
+      const int kBias = -1023;
+      const int kMantissaBits = 52;
+      const int kExponentBits = 11;
+
+      uint64_t mantissa = 0;
+      int exponent = 0;
+
+      if (mNumDigits == 0 || mDecimalPoint < -330)
+      {
+         result = 0.0;
+         return true;
+      }
+      if (mDecimalPoint > 310)
+      {
+         return false;
+      }
+
+      // Scale to [0.5, 1).
+      while (mDecimalPoint > 0)
+      {
+         int n = mDecimalPoint >= kNumPowers ? 27 : kPowers[mDecimalPoint];
+         Shift(-n);
+         exponent += n;
+      }
+      while (mDecimalPoint < 0 || (mDecimalPoint == 0 && mDigits[0] < 5))
+      {
+         int n = -mDecimalPoint >= kNumPowers ? 27 : kPowers[-mDecimalPoint];
+         Shift(n);
+         exponent -= n;
+      }
+
+      // Doubles are in [1, 2) instead.
+      --exponent;
+
+      // Denormals share the smallest exponent.
+      if (exponent < kBias + 1)
+      {
+         int n = kBias + 1 - exponent;
+         Shift(-n);
+         exponent += n;
+      }
+
+      if (exponent - kBias >= (1 << kExponentBits) - 1)
+      {
+         return false;
+      }
+
+      Shift(1 + kMantissaBits);
+      mantissa = RoundedInteger();
+
+      // Rounding up can carry into another bit.
+      if (mantissa == (uint64_t(2) << kMantissaBits))
+      {
+         mantissa >>= 1;
+         ++exponent;
+         if (exponent - kBias >= (1 << kExponentBits) - 1)
+         {
+            return false;
+         }
+      }
+
+      if ((mantissa & (uint64_t(1) << kMantissaBits)) == 0)
+      {
+         exponent = kBias;
+      }
+
+      uint64_t bits = mantissa & ((uint64_t(1) << kMantissaBits) - 1);
+      bits |= uint64_t((exponent - kBias) & ((1 << kExponentBits) - 1)) << kMantissaBits;
+      std::memcpy(&result, &bits, sizeof(result));
+      return true;
+   }
+
+private:
+   // Enough for any double, which needs at most 767 significant digits.
+   static constexpr int kMaxDigits = 800;
+
+   // Shifts of more than this would overflow the uint64_t doing the work.
+   static constexpr int kMaxShift = 60;
+
+   void Trim()
+   {
+      while (mNumDigits > 0 && mDigits[mNumDigits - 1] == 0)
+      {
+         --mNumDigits;
+      }
+      if (mNumDigits == 0)
+      {
+         mDecimalPoint = 0;
+      }
+   }
+
+   void Shift(int k)
+   {
+      if (mNumDigits == 0)
+      {
+         return;
+      }
+
+      for (; k > kMaxShift; k -= kMaxShift) { ShiftLeft(kMaxShift); }
+      for (; k < -kMaxShift; k += kMaxShift) { ShiftRight(kMaxShift); }
+      if (k > 0) { ShiftLeft(k); }
+      else if (k < 0) { ShiftRight(-k); }
+   }
+
+   // Multiplies by 2^k.
+   void ShiftLeft(int k)
+   {
+      // Written from the back, since it isn't known how many digits get added.
+      uint8_t result[kMaxDigits + 20];
+      int write = int(sizeof(result));
+
+      uint64_t n = 0;
+      for (int read = mNumDigits - 1; read >= 0; --read)
+      {
+         n += uint64_t(mDigits[read]) << k;
+         result[--write] = uint8_t(n % 10);
+         n /= 10;
+      }
+      for (; n > 0; n /= 10)
+      {
+         result[--write] = uint8_t(n % 10);
+      }
+
+      int numDigits = int(sizeof(result)) - write;
+      mDecimalPoint += numDigits - mNumDigits;
+      mNumDigits = std::min(numDigits, kMaxDigits);
+      for (int i = kMaxDigits; i < numDigits; ++i)
+      {
+         mTruncated |= result[write + i] != 0;
+      }
+      std::memcpy(mDigits, result + write, size_t(mNumDigits));
+      Trim();
+   }
+
+   // Divides by 2^k.
+   void ShiftRight(int k)
+   {
+      int read = 0;
+      int write = 0;
+
+      // Take enough digits for the first one out.
+      uint64_t n = 0;
+      for (; (n >> k) == 0; ++read)
+      {
+         if (read >= mNumDigits)
+         {
+            for (; (n >> k) == 0; ++read)
+            {
+               n *= 10;
+            }
+            break;
+         }
+         n = n * 10 + mDigits[read];
+      }
+      mDecimalPoint -= read - 1;
+
+      const uint64_t mask = (uint64_t(1) << k) - 1;
+      for (; read < mNumDigits; ++read)
+      {
+         mDigits[write++] = uint8_t(n >> k);
+         n = (n & mask) * 10 + mDigits[read];
+      }
+
+      for (; n > 0; n = (n & mask) * 10)
+      {
+         uint8_t digit = uint8_t(n >> k);
+         if (write < kMaxDigits)
+         {
+            mDigits[write++] = digit;
+         }
+         else if (digit > 0)
+         {
+            mTruncated = true;
+         }
+      }
+
+      mNumDigits = write;
+      Trim();
+   }
+
+   // The integer part, rounded half to even.
+   uint64_t RoundedInteger() const
+   {
+      if (mDecimalPoint > 20)
+      {
+         return UINT64_MAX;
+      }
+
+      int i = 0;
+      uint64_t n = 0;
+      for (; i < mDecimalPoint && i < mNumDigits; ++i)
+      {
+         n = n * 10 + mDigits[i];
+      }
+      for (; i < mDecimalPoint; ++i)
+      {
+         n *= 10;
+      }
+
+      if (ShouldRoundUp(mDecimalPoint))
+      {
+         ++n;
+      }
+      return n;
+   }
+
+   bool ShouldRoundUp(int numDigits) const
+   {
+      if (numDigits < 0 || numDigits >= mNumDigits)
+      {
+         return false;
+      }
+
+      if (mDigits[numDigits] == 5 && numDigits + 1 == mNumDigits)
+      {
+         // Exactly halfway, unless digits were dropped.
+         if (mTruncated)
+         {
+            return true;
+         }
+         return numDigits > 0 && mDigits[numDigits - 1] % 2 == 1;
+      }
+
+      return mDigits[numDigits] >= 5;
+   }
+
+private:
+   uint8_t mDigits[kMaxDigits];
+   int mNumDigits = 0;
+   int mDecimalPoint = 0;
+   bool mTruncated = false;
+};
+
+}; // namespace NumbersInternal
+
+namespace Numbers
+{
+
+using namespace NumbersInternal;
+
+bool Parse(const char* begin, const char* end, Number& result)
+{
+   const char* str = begin;
+
+   bool negative = str != end && *str == '-';
+   if (negative) { ++str; }
+
+   if (str == end || !IsDigit(*str))
+   {
+      return false;
+   }
+
+   // Leading zeros aren't allowed.
+   if (*str == '0' && str + 1 != end && IsDigit(str[1]))
+   {
+      return false;
+   }
+
+   // The first 19 significant digits, which always fit.
+   uint64_t mantissa = 0;
+   int numDigits = 0;
+   int exponent = 0;
+   bool truncated = false;
+
+   // The integer part, as long as it fits.
+   uint64_t integer = 0;
+   bool overflow = false;
+
+   for (; str != end && IsDigit(*str); ++str)
+   {
+      uint64_t digit = uint64_t(*str - '0');
+      if (integer > (UINT64_MAX - digit) / 10)
+      {
+         overflow = true;
+      }
+      integer = integer * 10 + digit;
+
+      if (numDigits < 19)
+      {
+         mantissa = mantissa * 10 + digit;
+         numDigits += mantissa > 0 ? 1 : 0;
+      }
+      else
+      {
+         ++exponent;
+         truncated |= digit != 0;
+      }
+   }
+
+   bool isInteger = true;
+   if (str != end && *str == '.')
+   {
+      isInteger = false;
+      if (++str == end || !IsDigit(*str))
+      {
+         return false;
+      }
+
+      for (; str != end && IsDigit(*str); ++str)
+      {
+         uint64_t digit = uint64_t(*str - '0');
+         if (numDigits < 19)
+         {
+            mantissa = mantissa * 10 + digit;
+            numDigits += mantissa > 0 ? 1 : 0;
+            --exponent;
+         }
+         else
+         {
+            truncated |= digit != 0;
+         }
+      }
+   }
+
+   if (str != end && (*str == 'e' || *str == 'E'))
+   {
+      isInteger = false;
+      ++str;
+
+      bool negativeExponent = str != end && *str == '-';
+      if (str != end && (*str == '-' || *str == '+')) { ++str; }
+      if (str == end || !IsDigit(*str))
+      {
+         return false;
+      }
+
+      int explicitExponent = 0;
+      for (; str != end && IsDigit(*str); ++str)
+      {
+         // Past this, the number is either 0 or too big anyway.
+         if (explicitExponent < 100000)
+         {
+            explicitExponent = explicitExponent * 10 + (*str - '0');
+         }
+      }
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+   }
+
+   if (str != end)
+   {
+      return false;
+   }
+
+   if (isInteger && !overflow)
+   {
+      if (!negative && integer <= UINT32_MAX)
+      {
+         result.type = Number::kUint;
+         result.u = uint32_t(integer);
+         return true;
+      }
+      else if (!negative)
+      {
+         result.type = Number::kUint64;
+         result.u64 = integer;
+         return true;
+      }
+      else if (integer <= uint64_t(INT32_MAX) + 1)
+      {
+         result.type = Number::kInt;
+         result.i = int32_t(-int64_t(integer));
+         return true;
+      }
+      else if (integer <= uint64_t(INT64_MAX) + 1)
+      {
+         result.type = Number::kInt64;
+         result.i64 = int64_t(~integer + 1);
+         return true;
+      }
+   }
+
+   double d;
+   if (truncated || !FastPath(mantissa, exponent, d))
+   {
+      if (!Decimal(negative ? begin + 1 : begin, end).ToDouble(d))
+      {
+         return false;
+      }
+   }
+
+   result.type = Number::kDouble;
+   result.d = negative ? -d : d;
+   return true;
+}
+
+size_t Format(double d, char* buffer)
+{
+   int length = 0;
+   for (int precision = 15; precision <= 17; ++precision)
+   {
+      length = snprintf(buffer, kMaxFormattedSize, "%.*g", precision, d);
+
+      Number parsed;
+      if (Parse(buffer, buffer + length, parsed) && parsed.AsDouble() == d)
+      {
+         break;
+      }
+   }
+   return size_t(length);
+}
+
+std::string Format(double d)
+{
+   char buffer[kMaxFormattedSize];
+   return std::string(buffer, Format(d, buffer));
+}
+
+std::string FormatFloat(float f)
+{
+   char buffer[32];
+   int length = 0;
+   for (int precision = 6; precision <= 9; ++precision)
+   {
+      length = snprintf(buffer, sizeof(buffer), "%.*g", precision, double(f));
+
+      Number parsed;
+      if (Parse(buffer, buffer + length, parsed) && float(parsed.AsDouble()) == f)
+      {
+         break;
+      }
+   }
+   return std::string(buffer, size_t(length));
+}
+
+}; // namespace Numbers
+
+}; // namespace CubeWorld
@@ -0,0 +1,75 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace CubeWorld
+{
+
+namespace Numbers
+{
+
+//
+// A number read out of text, in the smallest of the types rapidjson uses that holds it.
+//
+struct Number
+{
+   enum Type
+   {
+      kUint,
+      kInt,
+      kUint64,
+      kInt64,
+      kDouble,
+   };
+
+   Type type;
+   union
+   {
+      uint32_t u;
+      int32_t i;
+      uint64_t u64;
+      int64_t i64;
+      double d;
+   };
+
+   double AsDouble() const
+   {
+      switch (type)
+      {
+      case kUint: return double(u);
+      case kInt: return double(i);
+      case kUint64: return double(u64);
+      case kInt64: return double(i64);
+      default: return d;
+      }
+   }
+};
+
+//
+// Reads all of [begin, end) as a JSON-style number: an optional minus, digits without
+// leading zeros, then an optional fraction and exponent. Returns false if that's not
+// exactly what's there, or if the number is too big for a double.
+//
+// Doubles are correctly rounded, so anything Format writes reads back exactly.
+//
+bool Parse(const char* begin, const char* end, Number& result);
+
+// Writes the fewest digits that Parse reads back as the same double. Whole numbers
+// come out without a decimal point, so they read back as integers.
+std::string Format(double d);
+
+// The same, into a buffer of at least kMaxFormattedSize characters. Returns how many
+// were written; there's no null terminator.
+constexpr size_t kMaxFormattedSize = 32;
+size_t Format(double d, char* buffer);
+
+// Writes the fewest digits that Parse reads back as a double that rounds to the same
+// float. For doubles that were floats to begin with, this keeps 0.1f as "0.1".
+std::string FormatFloat(float f);
+
+}; // namespace Numbers
+
+}; // namespace CubeWorld
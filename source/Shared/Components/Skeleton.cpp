@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <glm/ext.hpp>
 
+#include <RGBBinding/BindingPropertyConsumer.h>
 #include <RGBBinding/BindingPropertyMeta.h>
 #include <RGBFileSystem/Paths.h>
 #include <RGBLogger/Logger.h>
@@ -49,21 +50,28 @@ void Skeleton::Reset()
 
 void Skeleton::Load(const std::string& path)
 {
-   Maybe<BindingProperty> data = YAMLSerializer::DeserializeFile(path);
-   if (!data)
+   Reset();
+
+   // Read straight into the skeleton, without building a BindingProperty in between.
+   BindingPropertyConsumer consumer(*this);
+   Maybe<void> result = YAMLSerializer::ReadFile(path, consumer);
+   if (!result)
    {
-      LOG_ERROR(data.Failure().WithContext("Failed loading file").GetMessage());
+      LOG_ERROR(result.Failure().WithContext("Failed loading file").GetMessage());
       return;
    }
-   Load(*data);
+   Build();
 }
 
 void Skeleton::Load(const BindingProperty& data)
 {
    Reset();
-
    Binding::deserialize(*this, data);
+   Build();
+}
 
+void Skeleton::Build()
+{
    if (defaultModel.empty())
    {
       LOG_ERROR("No default model provided");
@@ -52,6 +52,10 @@ public:
 
    BindingProperty Serialize();
 
+private:
+   // Loads the model and sets up the bones, once the skeleton has been read.
+   void Build();
+
 public:
    // Data
    std::string name;
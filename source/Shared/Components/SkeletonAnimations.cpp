@@ -38,6 +38,8 @@ void SkeletonAnimations::Load(const std::string& entity_)
 {
    Reset();
 
+   // Declared first, so it outlives every animation parsed into it.
+   RGBBinding::Arena arena;
    BindingProperty data(BindingProperty::Type::Object);
 
    FileSystem& fs = Engine::FileSystemProvider::Instance();
@@ -51,7 +53,7 @@ void SkeletonAnimations::Load(const std::string& entity_)
 
    for (const FileSystem::FileEntry& entry : *maybeFiles)
    {
-      Maybe<BindingProperty> animation = YAMLSerializer::DeserializeFile(fs, Paths::Join(dir, entry.name));
+      Maybe<BindingProperty> animation = YAMLSerializer::DeserializeFile(fs, Paths::Join(dir, entry.name), &arena);
       if (!animation)
       {
          animation.Failure().WithContext("Failed loading animation {name}", entry.name).Log();
@@ -10,18 +10,20 @@ namespace CubeWorld
 
 VoxModel::VoxModel()
     : mTint(glm::vec3(255))
-    , mParts{}
-    , mPartLookup{}
+    , mModel(nullptr)
+    , mTransforms{}
 {
 }
 
 VoxModel::VoxModel(const BindingProperty& data)
+    : VoxModel()
 {
     Load(Asset::Path(data["path"]));
     mTint = data["tint"].GetVec3();
 }
 
 VoxModel::VoxModel(const std::string& path, glm::vec3 tint)
+    : VoxModel()
 {
     Load(path);
     mTint = tint;
@@ -41,9 +43,24 @@ void VoxModel::Load(const std::string& path)
 
 void VoxModel::Set(Voxel::VoxModel* data)
 {
-    mParts = data->parts;
-    mPartLookup = data->partLookup;
-    mVBO = data->vbo;
+    mModel = data;
+    mTransforms.resize(data->parts.size());
+    for (size_t i = 0; i < data->parts.size(); ++i)
+    {
+        mTransforms[i] = data->parts[i].transform;
+    }
+}
+
+const std::vector<VoxModel::Part>& VoxModel::GetParts() const
+{
+    static const std::vector<Part> kNoParts;
+    return mModel ? mModel->parts : kNoParts;
+}
+
+const std::unordered_map<std::string, size_t>& VoxModel::GetPartLookup() const
+{
+    static const std::unordered_map<std::string, size_t> kNoLookup;
+    return mModel ? mModel->partLookup : kNoLookup;
 }
 
 }; // namespace CubeWorld
@@ -9,7 +9,6 @@
 
 #include <RGBBinding/BindingProperty.h>
 #include <Engine/Entity/Component.h>
-#include <Engine/Graphics/VBO.h>
 #include "../Voxel.h"
 #include "../Helpers/VoxFormat.h"
 
@@ -35,14 +34,20 @@ public:
    void Load(const std::string& path);
    void Set(Voxel::VoxModel* model);
 
+   // Parts, names and vertex data shared by every instance of the model. Empty if it failed to load.
+   const std::vector<Part>& GetParts() const;
+   const std::unordered_map<std::string, size_t>& GetPartLookup() const;
+
 public:
    // Member data
    glm::vec3 mTint;
-   
-   std::vector<Part> mParts;
-   std::unordered_map<std::string, size_t> mPartLookup;
 
-   Engine::Graphics::VBO mVBO;
+   // Owned by VoxFormat's model cache, so it outlives every component using it.
+   const Voxel::VoxModel* mModel;
+
+   // One per part. These start out as the model's base transforms, and are what
+   // animation modifies on a per-entity basis.
+   std::vector<glm::mat4> mTransforms;
 };
 
 //class VoxModelComponent : public Engine::Component<VoxModelComponent>, public VoxModel {
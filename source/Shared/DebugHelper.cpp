@@ -4,6 +4,8 @@
 #include <imgui.h>
 
 #include <RGBDesignPatterns/Scope.h>
+#include <Engine/Core/AllocationTracker.h>
+#include <Engine/Core/Clock.h>
 #include <Engine/Core/Window.h>
 #include <RGBLogger/Logger.h>
 
@@ -23,6 +25,13 @@ DebugHelper::DebugHelper()
    mMetrics = std::make_unique<MetricLink>(this, "None", nullptr);
    mMetrics->next = mMetrics->prev = mMetrics.get();
 
+   // Headless runs never create a window, so there's no GL context for fonts or shaders.
+   // Metrics still get registered; they just never get rendered.
+   if (!Engine::Window::Instance().IsReady())
+   {
+      return;
+   }
+
    auto maybeFont = Engine::Graphics::FontManager::Instance().GetFont(Asset::Font("debug"));
    assert(maybeFont);
    mFont = *maybeFont;
@@ -66,6 +75,7 @@ std::unique_ptr<DebugHelper::MetricLink> DebugHelper::RegisterMetric(const std::
 
 void DebugHelper::SetMetric(const std::string& name, const std::string& value)
 {
+    std::unique_lock<std::mutex> lock{ mGlobalMetricsMutex };
     if (mGlobalMetrics.size() == 0)
     {
         return;
@@ -74,6 +84,7 @@ void DebugHelper::SetMetric(const std::string& name, const std::string& value)
     if (mGlobalMetrics.count(name) == 0)
     {
         mGlobalMetricLinks.push_back(RegisterMetric(name, [this, name] {
+            std::unique_lock<std::mutex> lock{ mGlobalMetricsMutex };
             return mGlobalMetrics.at(name);
         }));
     }
@@ -104,11 +115,22 @@ void DebugHelper::RemoveLink(MetricLink* link)
 
 void DebugHelper::Update(bool imgui)
 {
+   ALLOCATION_SCOPE("DebugHelper::Update");
+
    if (mBounds == nullptr)
    {
       return;
    }
 
+   // How often the overlay catches up with Engine::Metrics, in seconds.
+   const double kMetricsSnapshotInterval = 0.5;
+   const double now = Engine::Clock::Default().Now();
+   if (now - mMetricsSnapshot.time >= kMetricsSnapshotInterval)
+   {
+       mMetricsSnapshot = Engine::Metrics::TakeSnapshot();
+       mMetricsSnapshotLines = mMetricsSnapshot.ToLines();
+   }
+
    float left = 0, top = 0, right = 0;
    if (imgui)
    {
@@ -125,6 +147,11 @@ void DebugHelper::Update(bool imgui)
            metric = metric->next;
        }
 
+       for (const std::string& line : mMetricsSnapshotLines)
+       {
+           ImGui::Text("%s", line.c_str());
+       }
+
        ImGui::End();
    }
    else
@@ -144,6 +171,11 @@ void DebugHelper::Update(bool imgui)
            metric = metric->next;
        }
 
+       for (const std::string& line : mMetricsSnapshotLines)
+       {
+           text += "\n" + line;
+       }
+
        left = GLfloat(mBounds->GetX());
        top = GLfloat(mBounds->GetY() + mBounds->GetHeight()) - 40.0f;
        right = left + GLfloat(mBounds->GetWidth());
@@ -189,12 +221,14 @@ void DebugHelper::Update(bool imgui)
            for (auto system : mSystemManager->GetBenchmarks())
            {
                leftText += "\n" + system.first;
-               std::string ms = FormatString("%.1fms", system.second * 1000.0);
-               if (ms.size() < 7)
+               char ms[16];
+               FormatToNResult formatted = FormatToN(ms, sizeof(ms), CUBEWORLD_FORMAT("%.1fms"), system.second * 1000.0);
+               rightText += "\n";
+               if (formatted.size < 7)
                {
-                   ms.insert(ms.begin(), 7 - ms.size(), ' ');
+                   rightText.append(7 - formatted.size, ' ');
                }
-               rightText += "\n" + std::move(ms);
+               rightText.append(ms, formatted.out);
            }
            std::vector<Engine::Graphics::Font::CharacterVertexUV> systemsText = mFont->Write(right - 400, top, 0, 1, leftText, Engine::Graphics::Font::Left);
            std::vector<Engine::Graphics::Font::CharacterVertexUV> rightUVs = mFont->Write(right - 105, top, 0, 1, rightText, Engine::Graphics::Font::Left);
@@ -8,10 +8,14 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <RGBDesignPatterns/Singleton.h>
+#include <Engine/Core/Metrics.h>
 #include <Engine/Core/Window.h>
 #include <Engine/Graphics/FontManager.h>
 #include <Engine/Graphics/Program.h>
@@ -68,10 +72,20 @@ public:
 
    void SetMetric(const std::string& name, const std::string& value);
 
+   // Numbers go to a gauge in Engine::Metrics, which shows up on the overlay with the rest.
+   // That means looking the gauge up by name on every call, so hot paths should use
+   // METRIC_GAUGE instead, which only does it once.
    template <typename T>
    void SetMetric(const std::string& name, T value)
    {
-      SetMetric(name, FormatString("%1", value));
+      if constexpr (std::is_arithmetic_v<T>)
+      {
+         Engine::Metrics::GetGauge(name)->Set(double(value));
+      }
+      else
+      {
+         SetMetric(name, FormatString("%1", value));
+      }
    }
 
    void Update(bool imgui = false);
@@ -94,6 +108,11 @@ private:
 
    std::vector<std::unique_ptr<MetricLink>> mGlobalMetricLinks;
    std::unordered_map<std::string, std::string> mGlobalMetrics;
+   std::mutex mGlobalMetricsMutex;
+
+   // Engine::Metrics gets added up every so often, rather than every frame.
+   Engine::Metrics::Snapshot mMetricsSnapshot;
+   std::vector<std::string> mMetricsSnapshotLines;
 
 private:
    std::vector<std::pair<std::string, std::string>> mMetricsState;
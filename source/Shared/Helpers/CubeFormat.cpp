@@ -77,7 +77,7 @@ Model* CubeFormat::Load(const std::string& path, bool tintable)
    }
    std::unique_ptr<Model> model = std::make_unique<Model>(std::move(result.Result()));
 
-   model->mVBO.BufferData(sizeof(Data) * model->mVoxelData.size(), &model->mVoxelData[0], GL_STATIC_DRAW);
+   model->mVBO.BufferData(Pack(model->mVoxelData));
    model->mIsTintable = tintable;
 
    auto emplaceResult = sModels.emplace(path, std::move(model));
@@ -0,0 +1,180 @@
+// By Thomas Steinke
+
+#include <cstring>
+
+#include "../Voxel.h"
+#include "OccupancyGrid.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+namespace
+{
+
+// Index of each Side's bit, which is also where its mask lives in OccupancyGrid::mFaces.
+constexpr uint32_t kBackBit = 0;
+constexpr uint32_t kBottomBit = 1;
+constexpr uint32_t kLeftBit = 2;
+constexpr uint32_t kFrontBit = 3;
+constexpr uint32_t kTopBit = 4;
+constexpr uint32_t kRightBit = 5;
+
+static_assert(Back == 1 << kBackBit && Bottom == 1 << kBottomBit && Left == 1 << kLeftBit);
+static_assert(Front == 1 << kFrontBit && Top == 1 << kTopBit && Right == 1 << kRightBit);
+
+}; // anonymous namespace
+
+///
+///
+///
+OccupancyGrid::OccupancyGrid(uint32_t width, uint32_t height, uint32_t length)
+   : mWidth(width)
+   , mHeight(height)
+   , mLength(length)
+   , mWordsPerRow((width + 63) / 64)
+   , mFilled(size_t(height) * length * mWordsPerRow, 0)
+{}
+
+///
+///
+///
+bool OccupancyGrid::IsFilled(uint32_t x, uint32_t y, uint32_t z) const
+{
+   if (x >= mWidth || y >= mHeight || z >= mLength)
+   {
+      return false;
+   }
+
+   return (mFilled[Row(y, z) + x / 64] >> (x % 64)) & 1;
+}
+
+///
+///
+///
+uint64_t OccupancyGrid::Word(int64_t y, int64_t z, uint32_t word) const
+{
+   if (y < 0 || y >= mHeight || z < 0 || z >= mLength || word >= mWordsPerRow)
+   {
+      return 0;
+   }
+
+   return mFilled[Row(uint32_t(y), uint32_t(z)) + word];
+}
+
+///
+///
+///
+uint64_t OccupancyGrid::NextX(int64_t y, int64_t z, uint32_t word) const
+{
+   // Bits past the width are never set, so the last voxel in a row sees an empty neighbor.
+   return (Word(y, z, word) >> 1) | (Word(y, z, word + 1) << 63);
+}
+
+///
+///
+///
+uint64_t OccupancyGrid::PrevX(int64_t y, int64_t z, uint32_t word) const
+{
+   uint64_t previous = word > 0 ? Word(y, z, word - 1) : 0;
+   return (Word(y, z, word) << 1) | (previous >> 63);
+}
+
+///
+///
+///
+void OccupancyGrid::ComputeFaces()
+{
+   mFaces.assign(mFilled.size() * kNumSides, 0);
+
+   const uint64_t area = uint64_t(mWidth) * mHeight;
+   for (uint32_t y = 0; y < mHeight; ++y)
+   {
+      for (uint32_t z = 0; z < mLength; ++z)
+      {
+         uint64_t* faces = &mFaces[Row(y, z) * kNumSides];
+         for (uint32_t word = 0; word < mWordsPerRow; ++word, faces += kNumSides)
+         {
+            uint64_t filled = Word(y, z, word);
+            faces[kRightBit] = filled & ~NextX(y, z, word);
+            faces[kLeftBit] = filled & ~PrevX(y, z, word);
+            faces[kTopBit] = filled & ~Word(int64_t(y) + 1, z, word);
+            faces[kBottomBit] = filled & ~Word(int64_t(y) - 1, z, word);
+            faces[kBackBit] = filled & ~Word(y, int64_t(z) + 1, word);
+            faces[kFrontBit] = filled & ~Word(y, int64_t(z) - 1, word);
+         }
+
+         // The original per-voxel check threw away any front neighbor whose flat index
+         // was a multiple of width * height, leaving that face exposed. Nothing looks
+         // wrong for it, and shipped models depend on the exact output, so keep it.
+         if (z > 0 && area > 0)
+         {
+            uint64_t front = (uint64_t(z - 1) * mWidth + uint64_t(y) * mWidth * mLength) % area;
+            uint64_t x = (area - front) % area;
+            if (x < mWidth)
+            {
+               uint64_t bit = uint64_t(1) << (x % 64);
+               uint64_t* word = &mFaces[(Row(y, z) + x / 64) * kNumSides];
+               word[kFrontBit] |= mFilled[Row(y, z) + x / 64] & bit;
+            }
+         }
+      }
+   }
+}
+
+///
+///
+///
+void OccupancyGrid::GetOcclusion(uint32_t y, uint32_t z, uint32_t word, uint32_t occlusion[64]) const
+{
+   memset(occlusion, 0, sizeof(uint32_t) * 64);
+
+   for (uint32_t corner = 0; corner < 8; ++corner)
+   {
+      // Corner bits are (dx, dy, dz) in model space, and model z runs against grid z.
+      int64_t dy = (corner & 0b010) ? 1 : -1;
+      int64_t dz = (corner & 0b001) ? -1 : 1;
+      bool nextX = (corner & 0b100) != 0;
+
+      auto shifted = [&](int64_t rowY, int64_t rowZ) {
+         return nextX ? NextX(rowY, rowZ, word) : PrevX(rowY, rowZ, word);
+      };
+
+      // The 7 other voxels sharing this corner.
+      const uint64_t neighbors[] = {
+         shifted(y, z),
+         Word(y + dy, z, word),
+         shifted(y + dy, z),
+         Word(y, z + dz, word),
+         shifted(y, z + dz),
+         Word(y + dy, z + dz, word),
+         shifted(y + dy, z + dz),
+      };
+
+      // Count them for all 64 voxels at once, one bit of the count per word.
+      uint64_t count[3] = {0, 0, 0};
+      for (uint64_t neighbor : neighbors)
+      {
+         uint64_t carry = count[0] & neighbor;
+         count[0] ^= neighbor;
+         uint64_t carry2 = count[1] & carry;
+         count[1] ^= carry;
+         count[2] ^= carry2;
+      }
+
+      const uint32_t shift = 28 - 4 * corner;
+      for (uint32_t bit = 0; bit < 64; ++bit)
+      {
+         uint32_t n = uint32_t((count[0] >> bit) & 1)
+                    | uint32_t((count[1] >> bit) & 1) << 1
+                    | uint32_t((count[2] >> bit) & 1) << 2;
+         occlusion[bit] |= n << shift;
+      }
+   }
+}
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -0,0 +1,101 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+//
+// OccupancyGrid stores which cells of a model are filled as one bit per voxel, in rows
+// of 64-bit words running along x. Neighbor queries then become shifts and masks over
+// whole words, handling 64 voxels at a time instead of probing them one by one.
+//
+// Coordinates are the same as a .vox file's: x < width, y < height, z < length.
+//
+class OccupancyGrid {
+public:
+   OccupancyGrid(uint32_t width, uint32_t height, uint32_t length);
+
+   // Returns false, and fills nothing, if the voxel is out of bounds.
+   bool Set(uint32_t x, uint32_t y, uint32_t z)
+   {
+      if (x >= mWidth || y >= mHeight || z >= mLength)
+      {
+         return false;
+      }
+
+      mFilled[Row(y, z) + x / 64] |= uint64_t(1) << (x % 64);
+      return true;
+   }
+
+   bool IsFilled(uint32_t x, uint32_t y, uint32_t z) const;
+
+   //
+   // Works out which faces of every filled voxel are exposed. Call this once after
+   // everything is Set, before GetExposedFaces.
+   //
+   void ComputeFaces();
+
+   // Exposed faces of a voxel as a mask of Voxel::Side, or 0 if it isn't filled.
+   uint8_t GetExposedFaces(uint32_t x, uint32_t y, uint32_t z) const
+   {
+      if (x >= mWidth || y >= mHeight || z >= mLength || mFaces.empty())
+      {
+         return 0;
+      }
+
+      // Masks are stored in Side bit order, so each one lands right where it belongs.
+      const uint64_t* faces = &mFaces[(Row(y, z) + x / 64) * kNumSides];
+      const uint64_t bit = uint64_t(1) << (x % 64);
+      return uint8_t(
+         ((faces[0] & bit) ? 0x01 : 0) |
+         ((faces[1] & bit) ? 0x02 : 0) |
+         ((faces[2] & bit) ? 0x04 : 0) |
+         ((faces[3] & bit) ? 0x08 : 0) |
+         ((faces[4] & bit) ? 0x10 : 0) |
+         ((faces[5] & bit) ? 0x20 : 0)
+      );
+   }
+
+   //
+   // Ambient occlusion for the 64 voxels in row (y, z) starting at x = 64 * word, in the
+   // format of Data::occlusion. Note that Data::occlusion's corners are in model space,
+   // where z runs the opposite direction.
+   //
+   void GetOcclusion(uint32_t y, uint32_t z, uint32_t word, uint32_t occlusion[64]) const;
+
+   uint32_t GetWordsPerRow() const { return mWordsPerRow; }
+
+private:
+   static constexpr uint32_t kNumSides = 6;
+
+   size_t Row(uint32_t y, uint32_t z) const { return (size_t(y) * mLength + z) * mWordsPerRow; }
+
+   // Word of the row at (y, z), or 0 if the row is outside the grid.
+   uint64_t Word(int64_t y, int64_t z, uint32_t word) const;
+
+   // The same row, shifted so each bit holds its neighbor at x + 1 (or x - 1).
+   uint64_t NextX(int64_t y, int64_t z, uint32_t word) const;
+   uint64_t PrevX(int64_t y, int64_t z, uint32_t word) const;
+
+private:
+   uint32_t mWidth;
+   uint32_t mHeight;
+   uint32_t mLength;
+   uint32_t mWordsPerRow;
+
+   std::vector<uint64_t> mFilled;
+
+   // One exposure mask per Voxel::Side for each word of mFilled.
+   std::vector<uint64_t> mFaces;
+};
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -0,0 +1,278 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <RGBDesignPatterns/Hash.h>
+
+#include "VoxBake.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+namespace VoxBake
+{
+
+namespace
+{
+
+constexpr char kMagic[4] = {'V', 'X', 'B', 'K'};
+constexpr size_t kSectionAlignment = 16;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   uint64_t sourceHash;
+   float min[3];
+   float max[3];
+   uint32_t numParts;
+   uint32_t numParents;
+   uint32_t stringsSize;
+   uint32_t numVoxels;
+   uint32_t partsOffset;
+   uint32_t parentsOffset;
+   uint32_t stringsOffset;
+   uint32_t voxelsOffset;
+};
+
+static_assert(sizeof(Header) == 72);
+
+struct BakedPart {
+   enum Flags : uint32_t {
+      Tintable = 0x1,
+      Hidden = 0x2,
+   };
+
+   uint32_t id;
+   uint32_t nameOffset; // Into the strings section
+   uint32_t nameLength;
+   uint32_t flags;
+   uint32_t start;
+   uint32_t size;
+   float position[3];
+   float rotation[3];
+   float transform[16];
+};
+
+static_assert(sizeof(BakedPart) == 112);
+
+size_t AlignSection(size_t offset)
+{
+   return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+// Whether [offset, offset + count * stride) fits in a file of the given size.
+bool SectionFits(size_t offset, size_t count, size_t stride, size_t size)
+{
+   return offset <= size && count <= (size - offset) / stride;
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+uint64_t Hash(const void* data, size_t size)
+{
+   return Fnv1a(data, size);
+}
+
+///
+///
+///
+std::string Filename(uint64_t sourceHash)
+{
+   static const char kHex[] = "0123456789abcdef";
+
+   std::string result(16, '0');
+   for (size_t i = 0; i < 16; ++i)
+   {
+      result[15 - i] = kHex[(sourceHash >> (4 * i)) & 0xf];
+   }
+   return result + ".vxb";
+}
+
+///
+///
+///
+std::string Write(const VoxModel& model, uint64_t sourceHash)
+{
+   Header header;
+   memcpy(header.magic, kMagic, sizeof(kMagic));
+   header.version = kVersion;
+   header.sourceHash = sourceHash;
+   header.numParts = uint32_t(model.parts.size());
+   header.numParents = uint32_t(model.parents.size());
+   header.numVoxels = uint32_t(model.voxels.size());
+
+   // Bounds cover whole voxels, not just their centers.
+   glm::vec3 min(0), max(0);
+   for (size_t i = 0; i < model.voxels.size(); ++i)
+   {
+      glm::vec3 position = Unpack(model.voxels[i]).position;
+      min = i == 0 ? position : glm::min(min, position);
+      max = i == 0 ? position : glm::max(max, position);
+   }
+   if (!model.voxels.empty())
+   {
+      min -= glm::vec3(0.5f);
+      max += glm::vec3(0.5f);
+   }
+   memcpy(header.min, glm::value_ptr(min), sizeof(header.min));
+   memcpy(header.max, glm::value_ptr(max), sizeof(header.max));
+
+   std::string strings;
+   std::vector<BakedPart> parts;
+   parts.reserve(model.parts.size());
+   for (const VoxModel::Part& part : model.parts)
+   {
+      BakedPart& baked = parts.emplace_back();
+      baked.id = part.id;
+      baked.nameOffset = uint32_t(strings.size());
+      baked.nameLength = uint32_t(part.name.size());
+      baked.flags = (part.tintable ? BakedPart::Tintable : 0) | (part.hidden ? BakedPart::Hidden : 0);
+      baked.start = part.start;
+      baked.size = part.size;
+      memcpy(baked.position, glm::value_ptr(part.position), sizeof(baked.position));
+      memcpy(baked.rotation, glm::value_ptr(part.rotation), sizeof(baked.rotation));
+      memcpy(baked.transform, glm::value_ptr(part.transform), sizeof(baked.transform));
+      strings += part.name;
+   }
+   header.stringsSize = uint32_t(strings.size());
+
+   header.partsOffset = uint32_t(AlignSection(sizeof(Header)));
+   header.parentsOffset = uint32_t(AlignSection(header.partsOffset + parts.size() * sizeof(BakedPart)));
+   header.stringsOffset = uint32_t(header.parentsOffset + model.parents.size() * sizeof(uint32_t));
+   header.voxelsOffset = uint32_t(AlignSection(header.stringsOffset + strings.size()));
+
+   std::string result(header.voxelsOffset + model.voxels.size() * sizeof(PackedData), '\0');
+   char* out = &result[0];
+   memcpy(out, &header, sizeof(Header));
+   memcpy(out + header.partsOffset, parts.data(), parts.size() * sizeof(BakedPart));
+   memcpy(out + header.parentsOffset, model.parents.data(), model.parents.size() * sizeof(uint32_t));
+   memcpy(out + header.stringsOffset, strings.data(), strings.size());
+   memcpy(out + header.voxelsOffset, model.voxels.data(), model.voxels.size() * sizeof(PackedData));
+   return result;
+}
+
+///
+///
+///
+Maybe<Info> ReadInfo(const void* data, size_t size, uint64_t expectedHash)
+{
+   if (size < sizeof(Header))
+   {
+      return Failure{"Bake is only {size} bytes, too small for a header", size};
+   }
+
+   Header header;
+   memcpy(&header, data, sizeof(Header));
+   if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+   {
+      return Failure{"Not a baked model"};
+   }
+
+   if (header.version != kVersion)
+   {
+      return Failure{"Bake is version {version}, expected {expected}", header.version, kVersion};
+   }
+
+   if (header.sourceHash != expectedHash)
+   {
+      return Failure{"Bake is for a different source file"};
+   }
+
+   if (!SectionFits(header.partsOffset, header.numParts, sizeof(BakedPart), size) ||
+       !SectionFits(header.parentsOffset, header.numParents, sizeof(uint32_t), size) ||
+       !SectionFits(header.stringsOffset, header.stringsSize, 1, size) ||
+       !SectionFits(header.voxelsOffset, header.numVoxels, sizeof(PackedData), size))
+   {
+      return Failure{"Bake is truncated"};
+   }
+
+   Info info;
+   info.sourceHash = header.sourceHash;
+   info.min = glm::make_vec3(header.min);
+   info.max = glm::make_vec3(header.max);
+   info.numParts = header.numParts;
+   info.numVoxels = header.numVoxels;
+   return info;
+}
+
+///
+///
+///
+Maybe<std::unique_ptr<VoxModel>> Read(const void* data, size_t size, uint64_t expectedHash)
+{
+   Maybe<Info> info = ReadInfo(data, size, expectedHash);
+   if (!info)
+   {
+      return info.Failure();
+   }
+
+   const char* bytes = static_cast<const char*>(data);
+   Header header;
+   memcpy(&header, bytes, sizeof(Header));
+
+   std::unique_ptr<VoxModel> model = std::make_unique<VoxModel>();
+   model->parts.reserve(header.numParts);
+   for (uint32_t i = 0; i < header.numParts; ++i)
+   {
+      BakedPart baked;
+      memcpy(&baked, bytes + header.partsOffset + i * sizeof(BakedPart), sizeof(BakedPart));
+
+      if (baked.nameOffset > header.stringsSize || baked.nameLength > header.stringsSize - baked.nameOffset)
+      {
+         return Failure{"Part {index} has a name outside the bake", i};
+      }
+
+      if (baked.start > header.numVoxels || baked.size > header.numVoxels - baked.start)
+      {
+         return Failure{"Part {index} draws voxels outside the bake", i};
+      }
+
+      // Skeletons index both their bones and the parent table by id.
+      if (baked.id >= header.numParts || baked.id >= header.numParents)
+      {
+         return Failure{"Part {index} has an out of range id {id}", i, baked.id};
+      }
+
+      VoxModel::Part& part = model->parts.emplace_back();
+      part.id = baked.id;
+      part.name.assign(bytes + header.stringsOffset + baked.nameOffset, baked.nameLength);
+      part.tintable = (baked.flags & BakedPart::Tintable) != 0;
+      part.hidden = (baked.flags & BakedPart::Hidden) != 0;
+      part.start = baked.start;
+      part.size = baked.size;
+      part.position = glm::make_vec3(baked.position);
+      part.rotation = glm::make_vec3(baked.rotation);
+      part.transform = glm::make_mat4(baked.transform);
+      model->partLookup.emplace(part.name, i);
+   }
+
+   model->parents.resize(header.numParents);
+   memcpy(model->parents.data(), bytes + header.parentsOffset, header.numParents * sizeof(uint32_t));
+   for (size_t i = 0; i < model->parents.size(); ++i)
+   {
+      if (model->parents[i] >= header.numParts)
+      {
+         return Failure{"Part {index} has an out of range parent {parent}", i, model->parents[i]};
+      }
+   }
+
+   model->voxels.resize(header.numVoxels);
+   memcpy(model->voxels.data(), bytes + header.voxelsOffset, header.numVoxels * sizeof(PackedData));
+
+   return std::move(model);
+}
+
+}; // namespace VoxBake
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -0,0 +1,68 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include <RGBDesignPatterns/Maybe.h>
+
+#include "VoxFormat.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+//
+// VoxBake reads and writes baked models: everything VoxFormat::Build produces from a
+// .vox file, laid out so it can be mapped straight from disk with no parsing.
+//
+// A bake is keyed by a hash of the .vox file's contents, so editing the source simply
+// misses the cache. It's native endian and only meant to live in a local cache, never
+// in version control.
+//
+//   Header
+//   BakedPart[numParts]       (16-byte aligned)
+//   uint32_t[numParents]      (16-byte aligned)
+//   char[stringsSize]         part names, not null terminated
+//   PackedData[numVoxels]     (16-byte aligned) ready to hand to the VBO
+//
+namespace VoxBake
+{
+
+// Bump whenever the layout, or the output of VoxFormat::Build, changes.
+constexpr uint32_t kVersion = 2;
+
+struct Info {
+   uint64_t sourceHash;
+   glm::vec3 min, max;
+   uint32_t numParts;
+   uint32_t numVoxels;
+};
+
+// Fnv1a over the source file's contents.
+uint64_t Hash(const void* data, size_t size);
+
+// Name of the bake for a given source hash, e.g. "0123456789abcdef.vxb".
+std::string Filename(uint64_t sourceHash);
+
+std::string Write(const VoxModel& model, uint64_t sourceHash);
+
+//
+// Checks the header and section bounds without reading any parts or voxels.
+// Fails if the bake is from another version or doesn't match expectedHash.
+//
+Maybe<Info> ReadInfo(const void* data, size_t size, uint64_t expectedHash);
+
+// Rebuilds a model from its bake, with voxels ready to be buffered.
+Maybe<std::unique_ptr<VoxModel>> Read(const void* data, size_t size, uint64_t expectedHash);
+
+}; // namespace VoxBake
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -3,7 +3,9 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/ext.hpp>
 #include <glm/gtx/string_cast.hpp>
+#include <limits>
 #include <queue>
+#include <unordered_set>
 #include <vector>
 
 #include <RGBDesignPatterns/Scope.h>
@@ -11,8 +13,11 @@
 #include <RGBText/StringHelper.h>
 #include <Engine/Core/Config.h>
 #include <Engine/Core/FileSystemProvider.h>
+#include <Engine/Core/Window.h>
 
 #include "VoxFormat.h"
+#include "VoxLoader.h"
+#include "VoxReader.h"
 
 namespace CubeWorld
 {
@@ -21,7 +26,6 @@ namespace Voxel
 {
 
 std::unordered_map<std::string, std::unique_ptr<Model>> VoxFormat::sDepModels;
-std::unordered_map<std::string, std::unique_ptr<VoxModel>> VoxFormat::sModels;
 
 const VoxModelData::Material VoxModelData::Material::Default = {
    0, // id
@@ -64,20 +68,6 @@ struct VoxFormat::Chunk {
       uint32_t childLength;
    };
 
-   Chunk() : header{0,0,0}, data{}, children{} {};
-   Chunk(Chunk&& other)
-      : header(other.header)
-      , data(std::move(other.data))
-      , children(std::move(other.children))
-   {};
-
-   Header header;
-   std::vector<uint8_t> data;
-   std::vector<Chunk> children;
-
-public:
-   std::string id() const { return ReadChunkID(header.id); }
-
 public:
    const static uint32_t MAIN;
    const static uint32_t SIZE;
@@ -213,50 +203,6 @@ struct VoxFormat::LAYR {
    int32_t reserved = -1;
 };
 
-Maybe<VoxFormat::Chunk> VoxFormat::ReadChunk(FileSystem& fs, FileSystem::FileHandle handle)
-{
-   Chunk chunk;
-
-   if (Maybe<void> read = fs.ReadFile(handle, &chunk.header, sizeof(Chunk::Header)); !read)
-   {
-      return read.Failure().WithContext("Failed reading chunk header");
-   }
-
-   chunk.data.resize(chunk.header.length);
-
-   if (chunk.header.length > 0)
-   {
-      if (Maybe<void> read = fs.ReadFile(handle, &chunk.data[0], chunk.header.length); !read)
-      {
-         return read.Failure().WithContext("Failed reading chunk data");
-      }
-   }
-
-   uint32_t read = 0;
-   while (read < chunk.header.childLength)
-   {
-      Maybe<Chunk> child = ReadChunk(fs, handle);
-      if (!child)
-      {
-         return child.Failure().WithContext("Failed reading child {num} of {id} chunk", chunk.children.size(), chunk.id());
-      }
-      read += sizeof(child->header) + child->header.length + child->header.childLength;
-      chunk.children.push_back(std::move(*child));
-   }
-
-   return chunk;
-}
-
-std::string VoxFormat::ParseString(int32_t*& data)
-{
-   int32_t size = *data++;
-   int8_t* start = (int8_t*)data;
-   int8_t* end = start + size;
-
-   data = (int32_t*)end;
-   return std::string(start, end);
-}
-
 int32_t* VoxFormat::WriteString(int32_t* data, const std::string& string)
 {
    *data++ = int32_t(string.size());
@@ -266,19 +212,6 @@ int32_t* VoxFormat::WriteString(int32_t* data, const std::string& string)
    return (int32_t*)end;
 }
 
-std::vector<std::pair<std::string, std::string>> VoxFormat::ParseDict(int32_t*& data)
-{
-   std::vector<std::pair<std::string, std::string>> result;
-   int32_t nAttributes = *data++;
-   while (nAttributes-- > 0)
-   {
-      std::string key = ParseString(data);
-      std::string value = ParseString(data);
-      result.push_back(std::make_pair(key, value));
-   }
-   return result;
-}
-
 int32_t* VoxFormat::WriteDict(int32_t* data, const std::vector<std::pair<std::string, std::string>>& pairs)
 {
    *data++ = int32_t(pairs.size());
@@ -298,570 +231,304 @@ std::string VoxFormat::ToShortString(float val)
    return result;
 }
 
-Maybe<void> VoxFormat::ParseChunk(VoxModelData* model, const Chunk& chunk)
+Maybe<void> VoxFormat::ParseRenderObject(VoxModelData* model, const std::vector<std::pair<std::string, std::string>>& properties)
 {
-   int32_t* data = (int32_t*)&chunk.data[0];
-   if (chunk.header.id == Chunk::SIZE)
+   if (properties.size() == 0)
    {
-      VoxModelData::Model m;
-
-      if (chunk.header.length != sizeof(SIZE))
-      {
-         return Failure("Chunk body was not {expected} bytes (was {actual} instead)", sizeof(SIZE), chunk.header.length);
-      }
-      SIZE* size = (SIZE*)data;
-      m.width = size->width;
-      m.height = size->height;
-      m.length = size->length;
-
-      model->models.push_back(m);
-      data = (int32_t*)(&chunk.data[0] + chunk.header.length);
+      return Failure("No properties provided for rOBJ");
    }
-   else if (chunk.header.id == Chunk::XYZI)
+   if (properties[0].first != "_type")
    {
-      XYZI* xyzi = (XYZI*)data;
-      size_t chunkSize = sizeof(XYZI) + sizeof(uint32_t) * xyzi->numVoxels;
-      if (chunk.header.length != chunkSize)
-      {
-         return Failure("Chunk body was not {expected} bytes (was {actual} instead)", chunkSize, chunk.header.length);
-      }
-
-      model->models[model->models.size() - 1].voxels.assign(
-         (uint32_t*)(xyzi + 1),
-         (uint32_t*)data + chunk.header.length / sizeof(uint32_t));
-      data = (int32_t*)(&chunk.data[0] + chunk.header.length);
+      return Failure("First key expected to be _type (was {key})", properties[0].first);
    }
-   else if (chunk.header.id == Chunk::nTRN)
-   {
-      VoxModelData::TransformNode node;
-      node.id = *data++;
 
-      // Read node attributes
-      auto attributes = ParseDict(data);
-      for (const auto& keyval : attributes)
+   std::string type = properties[0].second;
+   if (type == "_inf")
+   {
+      // Who needs flexibility?
+      if (properties.size() != 6 ||
+          properties[1].first != "_i" ||
+          properties[2].first != "_k" ||
+          properties[3].first != "_angle" ||
+          properties[4].first != "_area" ||
+          properties[5].first != "_disk")
       {
-         if (keyval.first == "_name")
-         {
-            node.name = keyval.second;
-         }
-         else if (keyval.first == "_hidden")
-         {
-            node.hidden = keyval.second == "1";
-         }
-         else
-         {
-            return Failure("Unrecognized attribute: {key}={val}", keyval.first, keyval.second);
-         }
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      nTRN::Body* body = (nTRN::Body*)data;
-      if (body->reserved != -1)
+      model->sun.intensity = std::stof(properties[1].second);
+      std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
+      if (components.size() != 3)
       {
-         return Failure("Reserved id was not -1 (was {val})", body->reserved);
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
-      if (body->nFrames != 1)
+      model->sun.color[0] = uint8_t(std::stoi(components[0]));
+      model->sun.color[1] = uint8_t(std::stoi(components[1]));
+      model->sun.color[2] = uint8_t(std::stoi(components[2]));
+      components = StringHelper::Split(properties[3].second, ' ');
+      if (components.size() != 2)
       {
-         return Failure("Num frames was not 1 (was {num})", body->nFrames);
-      }
-
-      node.child = body->child;
-      node.layer = body->layer;
-
-      // Parse frame attributes
-      data = (int32_t*)(body + 1);
-      attributes = ParseDict(data);
-      for (const auto& keyval : attributes)
-      {
-         if (keyval.first == "_r")
-         {
-            node.rotate = int8_t(std::stoi(keyval.second));
-         }
-         else if (keyval.first == "_t")
-         {
-            std::vector<std::string> components = StringHelper::Split(keyval.second, ' ');
-            if (components.size() != 3)
-            {
-               return Failure("Unexpected number of components: {attr} must have 3 parts, not {num}", keyval.second, components.size());
-            }
-            node.translate[0] = std::stoi(components[0]);
-            node.translate[1] = std::stoi(components[1]);
-            node.translate[2] = std::stoi(components[2]);
-         }
-         else
-         {
-            return Failure("Unrecognized frame attribute: {key}={value}", keyval.first, keyval.second);
-         }
+         return Failure("Unexpected number of components: {prop} must have 2 parts, not {num}", properties[2].second, components.size());
       }
-
-      model->transforms.emplace(node.id, node);
+      model->sun.angle[0] = int8_t(std::stoi(components[0]));
+      model->sun.angle[1] = int8_t(std::stoi(components[1]));
+      model->sun.area = std::stof(properties[4].second);
+      model->sun.disk = properties[5].second == "1";
    }
-   else if (chunk.header.id == Chunk::nGRP)
+   else if (type == "_uni")
    {
-      VoxModelData::GroupNode node;
-      node.id = *data++;
-
-      // Read node attributes
-      auto attributes = ParseDict(data);
-      if (attributes.size() > 0)
+      // Who needs flexibility?
+      if (properties.size() != 3 ||
+          properties[1].first != "_i" ||
+          properties[2].first != "_k")
       {
-         return Failure("Unrecognized attribute: {key}={value}", attributes[0].first, attributes[1].second);
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      nGRP::Body* body = (nGRP::Body*)data;
-      data = (int32_t*)(body + 1);
-      for (int c = 0; c < body->children; c ++)
+      model->sky.intensity = std::stof(properties[1].second);
+      std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
+      if (components.size() != 3)
       {
-         node.children.push_back(*data++);
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num", properties[2].second, components.size());
       }
-
-      model->groups.emplace(node.id, node);
+      model->sky.color[0] = uint8_t(std::stoi(components[0]));
+      model->sky.color[1] = uint8_t(std::stoi(components[1]));
+      model->sky.color[2] = uint8_t(std::stoi(components[2]));
    }
-   else if (chunk.header.id == Chunk::nSHP)
+   else if (type == "_atm")
    {
-      VoxModelData::ShapeNode node;
-      node.id = *data++;
-
-      // Read node attributes
-      auto attributes = ParseDict(data);
-      if (attributes.size() > 0)
+      // Who needs flexibility?
+      if (properties.size() != 8 ||
+          properties[1].first != "_ray_d" ||
+          properties[2].first != "_ray_k" ||
+          properties[3].first != "_mie_d" ||
+          properties[4].first != "_mie_k" ||
+          properties[5].first != "_mie_g" ||
+          properties[6].first != "_o3_d" ||
+          properties[7].first != "_o3_k")
       {
-         return Failure("Unrecognized attribute: {key}={value}", attributes[0].first, attributes[1].second);
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      nSHP::Body* body = (nSHP::Body*)data;
-      data = (int32_t*)(body + 1);
-
-      if (body->nModels != 1)
+      model->atm.rayleighDensity = std::stof(properties[1].second);
+      std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
+      if (components.size() != 3)
       {
-         return Failure("nSHP object must have only 1 model (value: {value})", body->nModels);
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
+      model->atm.rayleighColor[0] = uint8_t(std::stoi(components[0]));
+      model->atm.rayleighColor[1] = uint8_t(std::stoi(components[1]));
+      model->atm.rayleighColor[2] = uint8_t(std::stoi(components[2]));
 
-      // Parse the one model
-      node.model = *data++;
-
-      // Read model attributes
-      attributes = ParseDict(data);
-      if (attributes.size() > 0)
+      model->atm.mieDensity = std::stof(properties[3].second);
+      components = StringHelper::Split(properties[4].second, ' ');
+      if (components.size() != 3)
       {
-         return Failure("Unrecognized attribute: {key}={value}", attributes[0].first, attributes[1].second);
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[4].second, components.size());
       }
+      model->atm.mieColor[0] = uint8_t(std::stoi(components[0]));
+      model->atm.mieColor[1] = uint8_t(std::stoi(components[1]));
+      model->atm.mieColor[2] = uint8_t(std::stoi(components[2]));
+      model->atm.miePhase = std::stof(properties[5].second);
 
-      model->shapes.emplace(node.id, node);
-   }
-   else if (chunk.header.id == Chunk::IMAP)
-   {
-      // Unused??
-      data = (int32_t*)(&chunk.data[0] + chunk.header.length);
+      model->atm.ozoneDensity = std::stof(properties[6].second);
+      components = StringHelper::Split(properties[7].second, ' ');
+      if (components.size() != 3)
+      {
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[7].second, components.size());
+      }
+      model->atm.ozoneColor[0] = uint8_t(std::stoi(components[0]));
+      model->atm.ozoneColor[1] = uint8_t(std::stoi(components[1]));
+      model->atm.ozoneColor[2] = uint8_t(std::stoi(components[2]));
    }
-   else if (chunk.header.id == Chunk::LAYR)
+   else if (type == "_fog_uni")
    {
-      VoxModelData::Layer layer;
-      layer.id = *data++;
-
-      // Read layer attributes
-      auto attributes = ParseDict(data);
-      for (const auto& keyval : attributes)
+      // Who needs flexibility?
+      if (properties.size() != 3 ||
+          properties[1].first != "_d" ||
+          properties[2].first != "_k")
       {
-         if (keyval.first == "_name")
-         {
-            layer.name = keyval.second;
-         }
-         else if (keyval.first == "_hidden")
-         {
-            layer.hidden = keyval.second == "1";
-         }
-         else
-         {
-            return Failure("Unrecognized attribute: {key}={value}", keyval.first, keyval.second);
-         }
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      int32_t reserved = *data++;
-      if (reserved != -1)
+      model->fog.density = std::stof(properties[1].second);
+      std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
+      if (components.size() != 3)
       {
-         return Failure("Reserved ID was not -1 (was {value})", reserved);
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
-
-      model->layers.push_back(layer);
+      model->fog.color[0] = uint8_t(std::stoi(components[0]));
+      model->fog.color[1] = uint8_t(std::stoi(components[1]));
+      model->fog.color[2] = uint8_t(std::stoi(components[2]));
+   }
+   else if (type == "_lens")
+   {
+      // Who needs flexibility?
+      if (properties.size() != 8 ||
+          properties[1].first != "_fov" ||
+          properties[2].first != "_dof" ||
+          properties[3].first != "_expo" ||
+          properties[4].first != "_vig" ||
+          properties[5].first != "_sg" ||
+          properties[6].first != "_blade_n" ||
+          properties[7].first != "_blade_r")
+      {
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
+      }
+
+      model->lens.fov = std::stoi(properties[1].second);
+      model->lens.depthOfField = std::stof(properties[2].second);
+      model->lens.exposure = std::stof(properties[3].second);
+      model->lens.vignette = properties[4].second == "1";
+      model->lens.stereographics = properties[5].second == "1";
+      model->lens.bladeNumber = uint8_t(std::stoi(properties[6].second));
+      model->lens.bladeRotation = int16_t(std::stoi(properties[7].second));
    }
-   else if (chunk.header.id == Chunk::RGBA)
+   else if (type == "_bloom")
    {
-      if (chunk.header.length != sizeof(model->palette))
+      // Who needs flexibility?
+      if (properties.size() != 5 ||
+          properties[1].first != "_mix" ||
+          properties[2].first != "_scale" ||
+          properties[3].first != "_aspect" ||
+          properties[4].first != "_threshold")
       {
-         return Failure("Chunk body was not {expected} bytes (was {actual} instead)", sizeof(model->palette), chunk.header.length);
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      memcpy(model->palette, data, sizeof(model->palette));
-      data += sizeof(model->palette) / sizeof(int32_t);
+      model->bloom.mix = std::stof(properties[1].second);
+      model->bloom.scale = std::stof(properties[2].second);
+      model->bloom.aspect = std::stof(properties[3].second);
+      model->bloom.threshold = std::stof(properties[4].second);
    }
-   else if (chunk.header.id == Chunk::MATL)
+   else if (type == "_tone")
    {
-      VoxModelData::Material material;
-      material.id = *data++;
-
-      auto attributes = ParseDict(data);
-      for (const auto& keyval : attributes)
+      // Who needs flexibility?
+      if (properties.size() != 3 ||
+          properties[1].first != "_aces" ||
+          properties[2].first != "_gam")
       {
-         if (keyval.first == "_type")
-         {
-            if (keyval.second == "_diffuse") { material.type = VoxModelData::Material::Diffuse; }
-            else if (keyval.second == "_metal") { material.type = VoxModelData::Material::Metal; }
-            else if (keyval.second == "_glass") { material.type = VoxModelData::Material::Glass; }
-            else if (keyval.second == "_emit") { material.type = VoxModelData::Material::Emit; }
-            else
-            {
-               return Failure("Unrecognized material type: {type}", keyval.second);
-            }
-         }
-         else if (keyval.first == "_weight")
-         {
-            material.weight = std::stof(keyval.second);
-         }
-         else if (keyval.first == "_rough")
-         {
-            material.rough = std::stof(keyval.second);
-         }
-         else if (keyval.first == "_spec")
-         {
-            material.spec = std::stof(keyval.second);
-         }
-         else if (keyval.first == "_ior")
-         {
-            material.ior = std::stof(keyval.second);
-         }
-         else if (keyval.first == "_att")
-         {
-            material.att = std::stof(keyval.second);
-         }
-         else if (keyval.first == "_flux")
-         {
-            material.flux = std::stof(keyval.second);
-         }
-         else if (keyval.first == "_plastic")
-         {
-            material.plastic = keyval.second == "1";
-         }
-         else if (keyval.first == "_ldr")
-         {
-            material.ldr = keyval.second == "1";
-         }
-         else
-         {
-            return Failure("Unknown material property: {key}={value}", keyval.first, keyval.second);
-         }
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      model->materials.push_back(material);
+      model->tone.aces = properties[1].second == "1";
+      model->tone.gamma = std::stof(properties[2].second);
    }
-   else if (chunk.header.id == Chunk::rOBJ)
+   else if (type == "_ground")
    {
-      // Render settings are ignored
-      auto properties = ParseDict(data);
-      if (properties.size() == 0)
+      // Who needs flexibility?
+      if (properties.size() != 3 ||
+          properties[1].first != "_color" ||
+          properties[2].first != "_hor")
       {
-         return Failure("No properties provided for rOBJ");
-      }
-      if (properties[0].first != "_type")
-      {
-         return Failure("First key expected to be _type (was {key})", properties[0].first);
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
 
-      std::string type = properties[0].second;
-      if (type == "_inf")
+      std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
+      if (components.size() != 3)
       {
-         // Who needs flexibility?
-         if (properties.size() != 6 ||
-             properties[1].first != "_i" ||
-             properties[2].first != "_k" ||
-             properties[3].first != "_angle" ||
-             properties[4].first != "_area" ||
-             properties[5].first != "_disk")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         model->sun.intensity = std::stof(properties[1].second);
-         std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->sun.color[0] = uint8_t(std::stoi(components[0]));
-         model->sun.color[1] = uint8_t(std::stoi(components[1]));
-         model->sun.color[2] = uint8_t(std::stoi(components[2]));
-         components = StringHelper::Split(properties[3].second, ' ');
-         if (components.size() != 2)
-         {
-            return Failure("Unexpected number of components: {prop} must have 2 parts, not {num}", properties[2].second, components.size());
-         }
-         model->sun.angle[0] = int8_t(std::stoi(components[0]));
-         model->sun.angle[1] = int8_t(std::stoi(components[1]));
-         model->sun.area = std::stof(properties[4].second);
-         model->sun.disk = properties[5].second == "1";
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
-      else if (type == "_uni")
+      model->ground.color[0] = uint8_t(std::stoi(components[0]));
+      model->ground.color[1] = uint8_t(std::stoi(components[1]));
+      model->ground.color[2] = uint8_t(std::stoi(components[2]));
+      model->ground.horizon = std::stof(properties[2].second);
+   }
+   else if (type == "_bg")
+   {
+      // Who needs flexibility?
+      if (properties.size() != 2 ||
+          properties[1].first != "_color")
       {
-         // Who needs flexibility?
-         if (properties.size() != 3 ||
-             properties[1].first != "_i" ||
-             properties[2].first != "_k")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         model->sky.intensity = std::stof(properties[1].second);
-         std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num", properties[2].second, components.size());
-         }
-         model->sky.color[0] = uint8_t(std::stoi(components[0]));
-         model->sky.color[1] = uint8_t(std::stoi(components[1]));
-         model->sky.color[2] = uint8_t(std::stoi(components[2]));
-      }
-      else if (type == "_atm")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 8 ||
-             properties[1].first != "_ray_d" ||
-             properties[2].first != "_ray_k" ||
-             properties[3].first != "_mie_d" ||
-             properties[4].first != "_mie_k" ||
-             properties[5].first != "_mie_g" ||
-             properties[6].first != "_o3_d" ||
-             properties[7].first != "_o3_k")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         model->atm.rayleighDensity = std::stof(properties[1].second);
-         std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->atm.rayleighColor[0] = uint8_t(std::stoi(components[0]));
-         model->atm.rayleighColor[1] = uint8_t(std::stoi(components[1]));
-         model->atm.rayleighColor[2] = uint8_t(std::stoi(components[2]));
-
-         model->atm.mieDensity = std::stof(properties[3].second);
-         components = StringHelper::Split(properties[4].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[4].second, components.size());
-         }
-         model->atm.mieColor[0] = uint8_t(std::stoi(components[0]));
-         model->atm.mieColor[1] = uint8_t(std::stoi(components[1]));
-         model->atm.mieColor[2] = uint8_t(std::stoi(components[2]));
-         model->atm.miePhase = std::stof(properties[5].second);
-
-         model->atm.ozoneDensity = std::stof(properties[6].second);
-         components = StringHelper::Split(properties[7].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[7].second, components.size());
-         }
-         model->atm.ozoneColor[0] = uint8_t(std::stoi(components[0]));
-         model->atm.ozoneColor[1] = uint8_t(std::stoi(components[1]));
-         model->atm.ozoneColor[2] = uint8_t(std::stoi(components[2]));
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
-      else if (type == "_fog_uni")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 3 ||
-             properties[1].first != "_d" ||
-             properties[2].first != "_k")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
 
-         model->fog.density = std::stof(properties[1].second);
-         std::vector<std::string> components = StringHelper::Split(properties[2].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->fog.color[0] = uint8_t(std::stoi(components[0]));
-         model->fog.color[1] = uint8_t(std::stoi(components[1]));
-         model->fog.color[2] = uint8_t(std::stoi(components[2]));
-      }
-      else if (type == "_lens")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 8 ||
-             properties[1].first != "_fov" ||
-             properties[2].first != "_dof" ||
-             properties[3].first != "_expo" ||
-             properties[4].first != "_vig" ||
-             properties[5].first != "_sg" ||
-             properties[6].first != "_blade_n" ||
-             properties[7].first != "_blade_r")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         model->lens.fov = std::stoi(properties[1].second);
-         model->lens.depthOfField = std::stof(properties[2].second);
-         model->lens.exposure = std::stof(properties[3].second);
-         model->lens.vignette = properties[4].second == "1";
-         model->lens.stereographics = properties[5].second == "1";
-         model->lens.bladeNumber = uint8_t(std::stoi(properties[6].second));
-         model->lens.bladeRotation = int16_t(std::stoi(properties[7].second));
-      }
-      else if (type == "_bloom")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 5 ||
-             properties[1].first != "_mix" ||
-             properties[2].first != "_scale" ||
-             properties[3].first != "_aspect" ||
-             properties[4].first != "_threshold")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         model->bloom.mix = std::stof(properties[1].second);
-         model->bloom.scale = std::stof(properties[2].second);
-         model->bloom.aspect = std::stof(properties[3].second);
-         model->bloom.threshold = std::stof(properties[4].second);
-      }
-      else if (type == "_tone")
+      std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
+      if (components.size() != 3)
       {
-         // Who needs flexibility?
-         if (properties.size() != 3 ||
-             properties[1].first != "_aces" ||
-             properties[2].first != "_gam")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         model->tone.aces = properties[1].second == "1";
-         model->tone.gamma = std::stof(properties[2].second);
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
-      else if (type == "_ground")
+      model->bg.color[0] = uint8_t(std::stoi(components[0]));
+      model->bg.color[1] = uint8_t(std::stoi(components[1]));
+      model->bg.color[2] = uint8_t(std::stoi(components[2]));
+   }
+   else if (type == "_edge")
+   {
+      // Who needs flexibility?
+      if (properties.size() != 3 ||
+          properties[1].first != "_color" ||
+          properties[2].first != "_width")
       {
-         // Who needs flexibility?
-         if (properties.size() != 3 ||
-             properties[1].first != "_color" ||
-             properties[2].first != "_hor")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->ground.color[0] = uint8_t(std::stoi(components[0]));
-         model->ground.color[1] = uint8_t(std::stoi(components[1]));
-         model->ground.color[2] = uint8_t(std::stoi(components[2]));
-         model->ground.horizon = std::stof(properties[2].second);
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
       }
-      else if (type == "_bg")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 2 ||
-             properties[1].first != "_color")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
 
-         std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->bg.color[0] = uint8_t(std::stoi(components[0]));
-         model->bg.color[1] = uint8_t(std::stoi(components[1]));
-         model->bg.color[2] = uint8_t(std::stoi(components[2]));
+      std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
+      if (components.size() != 3)
+      {
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
-      else if (type == "_edge")
+      model->edge.color[0] = uint8_t(std::stoi(components[0]));
+      model->edge.color[1] = uint8_t(std::stoi(components[1]));
+      model->edge.color[2] = uint8_t(std::stoi(components[2]));
+      model->edge.width = std::stof(properties[2].second);
+   }
+   else if (type == "_grid")
+   {
+      // Who needs flexibility?
+      if (properties.size() != 5 ||
+          properties[1].first != "_color" ||
+          properties[2].first != "_spacing" ||
+          properties[3].first != "_width" ||
+          properties[4].first != "_display")
       {
-         // Who needs flexibility?
-         if (properties.size() != 3 ||
-             properties[1].first != "_color" ||
-             properties[2].first != "_width")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->edge.color[0] = uint8_t(std::stoi(components[0]));
-         model->edge.color[1] = uint8_t(std::stoi(components[1]));
-         model->edge.color[2] = uint8_t(std::stoi(components[2]));
-         model->edge.width = std::stof(properties[2].second);
-      }
-      else if (type == "_grid")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 5 ||
-             properties[1].first != "_color" ||
-             properties[2].first != "_spacing" ||
-             properties[3].first != "_width" ||
-             properties[4].first != "_display")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
-
-         std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->grid.color[0] = uint8_t(std::stoi(components[0]));
-         model->grid.color[1] = uint8_t(std::stoi(components[1]));
-         model->grid.color[2] = uint8_t(std::stoi(components[2]));
-         model->grid.spacing = uint32_t(std::stoi(properties[2].second));
-         model->grid.width = std::stof(properties[3].second);
-         model->grid.onGround = properties[4].second == "1";
-      }
-      else if (type == "_setting")
-      {
-         // Who needs flexibility?
-         if (properties.size() != 9 ||
-             properties[1].first != "_ground" ||
-             properties[2].first != "_sw" ||
-             properties[3].first != "_aa" ||
-             properties[4].first != "_grid" ||
-             properties[5].first != "_edge" ||
-             properties[6].first != "_bg_c" ||
-             properties[7].first != "_bg_a" ||
-             properties[8].first != "_scale")
-         {
-            return Failure("Unexpected property length or order for {type} rOBJ", type);
-         }
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
+      }
 
-         model->settings.ground = properties[1].second == "1";
-         model->settings.shadow = properties[2].second == "1";
-         model->settings.antialias = properties[3].second == "1";
-         model->settings.grid = properties[4].second == "1";
-         model->settings.edge = properties[5].second == "1";
-         model->settings.background = properties[6].second == "1";
-         model->settings.bgTransparent = properties[7].second == "1";
-         std::vector<std::string> components = StringHelper::Split(properties[8].second, ' ');
-         if (components.size() != 3)
-         {
-            return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
-         }
-         model->settings.scale[0] = uint8_t(std::stoi(components[0]));
-         model->settings.scale[1] = uint8_t(std::stoi(components[1]));
-         model->settings.scale[2] = uint8_t(std::stoi(components[2]));
+      std::vector<std::string> components = StringHelper::Split(properties[1].second, ' ');
+      if (components.size() != 3)
+      {
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
       }
+      model->grid.color[0] = uint8_t(std::stoi(components[0]));
+      model->grid.color[1] = uint8_t(std::stoi(components[1]));
+      model->grid.color[2] = uint8_t(std::stoi(components[2]));
+      model->grid.spacing = uint32_t(std::stoi(properties[2].second));
+      model->grid.width = std::stof(properties[3].second);
+      model->grid.onGround = properties[4].second == "1";
    }
-   else
+   else if (type == "_setting")
    {
-      return Failure("Unrecognized chunk type");
+      // Who needs flexibility?
+      if (properties.size() != 9 ||
+          properties[1].first != "_ground" ||
+          properties[2].first != "_sw" ||
+          properties[3].first != "_aa" ||
+          properties[4].first != "_grid" ||
+          properties[5].first != "_edge" ||
+          properties[6].first != "_bg_c" ||
+          properties[7].first != "_bg_a" ||
+          properties[8].first != "_scale")
+      {
+         return Failure("Unexpected property length or order for {type} rOBJ", type);
+      }
+
+      model->settings.ground = properties[1].second == "1";
+      model->settings.shadow = properties[2].second == "1";
+      model->settings.antialias = properties[3].second == "1";
+      model->settings.grid = properties[4].second == "1";
+      model->settings.edge = properties[5].second == "1";
+      model->settings.background = properties[6].second == "1";
+      model->settings.bgTransparent = properties[7].second == "1";
+      std::vector<std::string> components = StringHelper::Split(properties[8].second, ' ');
+      if (components.size() != 3)
+      {
+         return Failure("Unexpected number of components: {prop} must have 3 parts, not {num}", properties[2].second, components.size());
+      }
+      model->settings.scale[0] = uint8_t(std::stoi(components[0]));
+      model->settings.scale[1] = uint8_t(std::stoi(components[1]));
+      model->settings.scale[2] = uint8_t(std::stoi(components[2]));
    }
 
-   if ((uint8_t*)data != &chunk.data[0] + chunk.header.length)
-   {
-      return Failure("Failed to parse all of body");
-   }
    return Success;
 }
 
@@ -895,44 +562,23 @@ Maybe<size_t> VoxFormat::WriteRenderObj(FileSystem& fs, FileSystem::FileHandle h
    return data.size();
 }
 
-bool VoxFormat::IsFilled(const std::vector<bool>& filled, int index)
+Maybe<OccupancyGrid> VoxFormat::BuildOccupancy(const VoxModelData::Model& model)
 {
-   if (index < 0 || size_t(index) >= filled.size())
+   OccupancyGrid grid(model.width, model.height, model.length);
+   for (const auto& info : model.voxels)
    {
-      return false;
-   }
-
-   return filled[size_t(index)];
-}
+      uint8_t y = (info >> 16) & 0xff;
+      uint8_t z = (info >> 8) & 0xff;
+      uint8_t x = info & 0xff;
 
-int32_t VoxFormat::Index(const Model::Metadata& metadata, uint32_t x, uint32_t y, uint32_t z)
-{
-   if (x >= metadata.width || y >= metadata.height || z >= metadata.length) { return -1; }
-   return int32_t(x + z * metadata.width + y * metadata.width * metadata.length);
-}
+      if (!grid.Set(x, y, z))
+      {
+         return Failure("Voxel ({x}, {y}, {z}) is outside the {w}x{h}x{l} model", uint32_t(x), uint32_t(y), uint32_t(z), model.width, model.height, model.length);
+      }
+   }
 
-uint8_t VoxFormat::GetExposedFaces(const std::vector<bool>& filled, const Model::Metadata& metadata, uint32_t x, uint32_t y, uint32_t z)
-{
-   uint8_t faces = All;
-   int right = Index(metadata, x + 1, y, z);
-   int left = Index(metadata, x - 1, y, z);
-   int front = Index(metadata, x, y, z - 1);
-   int behind = Index(metadata, x, y, z + 1);
-   int above = Index(metadata, x, y + 1, z);
-   int below = Index(metadata, x, y - 1, z);
-
-   // Check overflows
-   if (right % metadata.width == 0) { right = -1; }
-   if (front % (metadata.width * metadata.height) == 0) { front = -1; }
-
-   if (IsFilled(filled, right)) { faces ^= Right; }
-   if (IsFilled(filled, left)) { faces ^= Left; }
-   if (IsFilled(filled, front)) { faces ^= Front; }
-   if (IsFilled(filled, behind)) { faces ^= Back; }
-   if (IsFilled(filled, above)) { faces ^= Top; }
-   if (IsFilled(filled, below)) { faces ^= Bottom; }
-
-   return faces;
+   grid.ComputeFaces();
+   return std::move(grid);
 }
 
 Model* VoxFormat::Load(const std::string& path, bool tintable)
@@ -953,7 +599,11 @@ Model* VoxFormat::Load(const std::string& path, bool tintable)
    }
    std::unique_ptr<Model> model = std::make_unique<Model>(std::move(result.Result()));
 
-   model->mVBO.BufferData(sizeof(Data) * model->mVoxelData.size(), &model->mVoxelData[0], GL_STATIC_DRAW);
+   // No GL context in headless runs; the CPU data is all anyone needs there.
+   if (Engine::Window::Instance().IsReady())
+   {
+      model->mVBO.BufferData(Pack(model->mVoxelData));
+   }
    model->mIsTintable = tintable;
 
    auto emplaceResult = sDepModels.emplace(path, std::move(model));
@@ -962,25 +612,16 @@ Model* VoxFormat::Load(const std::string& path, bool tintable)
 
 Maybe<VoxModel*> VoxFormat::Load(const std::string& path)
 {
-   auto maybeModel = sModels.find(path);
-   if (maybeModel != sModels.end())
-   {
-      return maybeModel->second.get();
-   }
-
-   Maybe<std::unique_ptr<VoxModelData>> maybeData = ReadScene(path);
-   if (!maybeData)
-   {
-      return maybeData.Failure().WithContext("Failed loading scene");
-   }
+   return VoxLoader::Instance().Load(path);
+}
 
-   // Construct a VoxModel based on the data we read.
+Maybe<std::unique_ptr<VoxModel>> VoxFormat::Build(const VoxModelData& data)
+{
    std::unique_ptr<VoxModel> model = std::make_unique<VoxModel>();
 
-   std::vector<Voxel::Data> voxels{};
+   std::vector<Voxel::PackedData>& voxels = model->voxels;
    std::vector<VoxModel::Part> models{};
-   std::unique_ptr<VoxModelData> data = std::move(maybeData.Result());
-   for (const Voxel::VoxModelData::Model& subModel : data->models)
+   for (const Voxel::VoxModelData::Model& subModel : data.models)
    {
       VoxModel::Part part;
       part.tintable = false; // May be changed later
@@ -992,16 +633,10 @@ Maybe<VoxModel*> VoxFormat::Load(const std::string& path)
       metadata.length = subModel.length;
       metadata.height = subModel.height;
 
-      // TODO allocation might be slow
-      std::vector<bool> filled(subModel.width * subModel.height * subModel.length, false);
-      for (const auto& info : subModel.voxels)
+      Maybe<OccupancyGrid> grid = BuildOccupancy(subModel);
+      if (!grid)
       {
-         uint8_t y = (info >> 16) & 0xff;
-         uint8_t z = (info >> 8) & 0xff;
-         uint8_t x = info & 0xff;
-
-         size_t ndx = (size_t)Index(metadata, x, y, z);
-         filled[ndx] = true;
+         return grid.Failure().WithContext("Failed building model {index}", models.size());
       }
 
       for (const auto& info : subModel.voxels)
@@ -1014,14 +649,14 @@ Maybe<VoxModel*> VoxFormat::Load(const std::string& path)
          voxel.position.x = float(x) - float(metadata.width) / 2;
          voxel.position.y = float(y) - float(metadata.height) / 2;
          voxel.position.z = float(metadata.length) / 2 - float(z);
-         uint32_t rgba = data->palette[i - 1];
+         uint32_t rgba = data.palette[i - 1];
          voxel.color.r = float((rgba) & 0xff);
          voxel.color.g = float((rgba >> 8) & 0xff);
          voxel.color.b = float((rgba >> 16) & 0xff);
-         voxel.enabledFaces = GetExposedFaces(filled, metadata, x, y, z);
+         voxel.enabledFaces = grid->GetExposedFaces(x, y, z);
          if (voxel.enabledFaces != 0)
          {
-            voxels.push_back(voxel);
+            voxels.push_back(Pack(voxel));
             part.size ++;
          }
       }
@@ -1029,81 +664,25 @@ Maybe<VoxModel*> VoxFormat::Load(const std::string& path)
       models.push_back(part);
    }
 
-   // Buffer to GPU
-   model->vbo.BufferData(sizeof(Data) * voxels.size(), &voxels[0], GL_STATIC_DRAW);
-
-   // Dive down the tree, building all shapes
-   std::queue<std::tuple<int32_t, uint32_t, glm::mat4>> remaining({ {int32_t(0), uint32_t(0), glm::mat4(1)} });
-   model->parents.resize(data->transforms.size(), 0);
-   while (!remaining.empty())
+   if (data.transforms.empty())
    {
-      auto [id, parentID, parent] = remaining.front();
-      remaining.pop();
+      return Failure("Unexpected non-nTRN node: {id}", 0);
+   }
 
-      if (data->transforms.count(id) == 0)
-      {
-         return Failure("Unexpected non-nTRN node: {id}", id);
-      }
-
-      const VoxModelData::TransformNode& node = data->transforms[id];
-
-      // Rotation
-      int8_t col0 = ((node.rotate >> 0) & 0b11);
-      int8_t col1 = ((node.rotate >> 2) & 0b11);
-      int8_t col2 = 3 - col0 - col1;
-      int8_t val0 = (node.rotate & 0b10000) ? -1 : 1;
-      int8_t val1 = (node.rotate & 0b100000) ? -1 : 1;
-      int8_t val2 = (node.rotate & 0b1000000) ? -1 : 1;
-
-      glm::mat4 rotate = glm::mat4(1);
-      rotate[0][0] = rotate[1][1] = rotate[2][2] = 0;
-
-      // Another weird fallout of y/z inversion: the rotation matrix looks like
-      // 1  0  0
-      // 0  0 -1
-      // 0  1  0
-      // The value ON the identity axis (in this case, [0][0], or x) is the axis
-      // we're rotating around. So in order to swap y and z correctly, we need
-      // to (a) figure out what axis is being rotated around, and then shimmy the
-      // values so that the REAL axis is being rotated. For example:
-      // 0  0 -1       0 -1  0
-      // 0  1  0   ->  1  0  0
-      // 1  0  0       0  0  1
-      // or:
-      //  0  1  0      0  0 -1
-      // -1  0  0  ->  0  1  0
-      //  0  0  1      1  0  0
-      // it should not change x-rotations however:
-      //  1  0  0      1  0  0
-      //  0  0 -1  ->  0  0 -1
-      //  0  1  0      0  1  0
-      // Notice that it's not a reversible transformation. If T(A) = B in the
-      // first example, then T(inv(B)) = A in the second.
-
-      if (col0 != 0)
-      {
-         if (col1 == 1) // Y -> Z rotation
-         {
-            col0 = 1;
-            col1 = 0;
-            col2 = 2;
-            val1 = val2;
-            val2 = 1; // previous val1
-         }
-         else // if col2 == 2, Z -> Y rotation
-         {
-            col0 = 2;
-            col1 = 1;
-            col2 = 0;
-            val0 = -val0;
-            val2 = -val1;
-            val1 = 1; // previous val2
-         }
-      }
+   Maybe<std::vector<VoxModelData::Instance>> instances = Flatten(data, true);
+   if (!instances)
+   {
+      return instances.Failure().WithContext("Failed flattening scene");
+   }
 
-      rotate[col0][0] = val0;
-      rotate[col1][1] = val1;
-      rotate[col2][2] = val2;
+   // Every node in the graph becomes a part, in the same order, so parents can be
+   // looked up by instance.
+   model->parts.reserve(instances->size());
+   model->parents.resize(instances->size(), 0);
+   for (const VoxModelData::Instance& instance : *instances)
+   {
+      const VoxModelData::TransformNode& node = data.transforms.at(instance.node);
+      glm::mat4 rotate = GetPartRotation(GetRotation(node.rotate));
 
       VoxModel::Part part;
       part.id = uint32_t(model->parts.size());
@@ -1112,18 +691,16 @@ Maybe<VoxModel*> VoxFormat::Load(const std::string& path)
       {
          part.name = FormatString("Unnammed node {id}", part.id);
       }
-      // Combine rotation and translation
-      part.transform = glm::translate(parent, glm::vec3{
-         node.translate[0],
-         node.translate[2],
-         -node.translate[1],
-      }) * rotate;
       part.tintable = false;
       part.hidden = false;
       part.size = part.start = 0;
-      model->parents[part.id] = parentID;
 
-      part.position = glm::vec3{node.translate[0],node.translate[2],-node.translate[1]};
+      // Combine rotation and translation
+      glm::mat4 parent = instance.parent >= 0 ? model->parts[size_t(instance.parent)].transform : glm::mat4(1);
+      part.position = glm::vec3{node.translate[0], node.translate[2], -node.translate[1]};
+      part.transform = glm::translate(parent, part.position) * rotate;
+      model->parents[part.id] = instance.parent >= 0 ? uint32_t(instance.parent) : 0;
+
       part.rotation.y = DEGREES(asin(-rotate[0][2]));
       if (cos(part.rotation.y) != 0) {
          part.rotation.x = DEGREES(atan2(rotate[1][2], rotate[2][2]));
@@ -1139,138 +716,577 @@ Maybe<VoxModel*> VoxFormat::Load(const std::string& path)
       // part.transform = glm::rotate(part.transform, part.rotation.x, glm::vec3(1, 0, 0));
       // part.transform = glm::rotate(part.transform, part.rotation.z, glm::vec3(0, 0, 1));
 
-      // Respect layer names
-      if (node.layer >= 0)
+      // Respect layer names. Flatten has already dropped anything excluded.
+      if (instance.layer >= 0)
       {
-         const VoxModelData::Layer& layer = data->layers[size_t(node.layer)];
+         const VoxModelData::Layer& layer = data.layers[size_t(instance.layer)];
          if (layer.name == "Tintable")
          {
             part.tintable = true;
          }
-         else if (layer.name == "Exclude")
-         {
-            //LOG_DEBUG("Ignoring node {id} ({name}), which is in the Exclude layer", node.id, node.name);
-            continue;
-         }
          else if (layer.name == "Hidden" || layer.name == "Debug" || layer.hidden)
          {
             part.hidden = true;
          }
       }
 
-      // Figure out what kind of node this is
-      if (data->groups.find(node.child) != data->groups.end())
+      if (instance.model >= 0)
       {
-         const VoxModelData::GroupNode& group = data->groups[node.child];
+         if (size_t(instance.model) >= models.size())
+         {
+            return Failure("Shape {id} uses model {model}, but there are only {num}", instance.shape, instance.model, models.size());
+         }
 
-         for (const int32_t& child : group.children)
+         part.start = models[size_t(instance.model)].start;
+         part.size = models[size_t(instance.model)].size;
+      }
+
+      // Add to the final model
+      model->parts.push_back(part);
+      model->partLookup.emplace(part.name, model->parts.size() - 1);
+   }
+
+   return std::move(model);
+}
+
+Maybe<std::unique_ptr<VoxModelData>> VoxFormat::ReadScene(const std::string& path)
+{
+   FileSystem& fs = Engine::FileSystemProvider::Instance();
+   Maybe<std::string> maybeContents = fs.ReadEntireFile(path);
+   if (!maybeContents)
+   {
+      return maybeContents.Failure().WithContext("Failed reading model");
+   }
+
+   return ParseScene(maybeContents->data(), maybeContents->size());
+}
+
+Maybe<std::unique_ptr<VoxModelData>> VoxFormat::ParseScene(const void* data, size_t size)
+{
+   Maybe<VoxReader::Scene> maybeScene = VoxReader::Parse(data, size);
+   if (!maybeScene)
+   {
+      return maybeScene.Failure().WithContext("Failed reading RIFF file");
+   }
+
+   const VoxReader::Scene& scene = maybeScene.Result();
+   std::unique_ptr<VoxModelData> model = std::make_unique<VoxModelData>();
+
+   for (const VoxReader::Model& shape : scene.models)
+   {
+      VoxModelData::Model& m = model->models.emplace_back();
+      m.width = shape.width;
+      m.height = shape.height;
+      m.length = shape.length;
+      m.voxels.resize(shape.voxels.size);
+      if (shape.voxels.size > 0)
+      {
+         memcpy(&m.voxels[0], shape.voxels.data, sizeof(uint32_t) * shape.voxels.size);
+      }
+   }
+
+   if (scene.palette.data != nullptr)
+   {
+      memcpy(model->palette, scene.palette.data, sizeof(model->palette));
+   }
+   else
+   {
+      // default_palette is indexed by color index, where palette is offset by one.
+      memcpy(model->palette, &default_palette[1], sizeof(uint32_t) * 255);
+      model->palette[255] = default_palette[0];
+   }
+
+   for (const VoxReader::Transform& transform : scene.transforms)
+   {
+      VoxModelData::TransformNode node;
+      node.id = transform.id;
+
+      for (const auto& [key, value] : transform.attributes)
+      {
+         if (key == "_name")
+         {
+            node.name = value;
+         }
+         else if (key == "_hidden")
+         {
+            node.hidden = value == "1";
+         }
+         else
          {
-            remaining.push({ child, part.id, part.transform });
+            return Failure("Unrecognized attribute: {key}={val}", std::string(key), std::string(value)).WithContext("Failed parsing nTRN chunk");
          }
+      }
+
+      if (transform.reserved != -1)
+      {
+         return Failure("Reserved id was not -1 (was {val})", transform.reserved).WithContext("Failed parsing nTRN chunk");
+      }
+      if (transform.frames.size() != 1)
+      {
+         return Failure("Num frames was not 1 (was {num})", transform.frames.size()).WithContext("Failed parsing nTRN chunk");
+      }
+
+      node.child = transform.child;
+      node.layer = transform.layer;
 
-         // Add to the final model
-         model->parts.push_back(part);
-         if (part.name != "")
+      for (const auto& [key, value] : transform.frames[0])
+      {
+         if (key == "_r")
          {
-            model->partLookup.emplace(part.name, model->parts.size() - 1);
+            node.rotate = int8_t(std::stoi(std::string(value)));
          }
+         else if (key == "_t")
+         {
+            std::vector<std::string> components = StringHelper::Split(std::string(value), ' ');
+            if (components.size() != 3)
+            {
+               return Failure("Unexpected number of components: {attr} must have 3 parts, not {num}", std::string(value), components.size()).WithContext("Failed parsing nTRN chunk");
+            }
+            node.translate[0] = std::stoi(components[0]);
+            node.translate[1] = std::stoi(components[1]);
+            node.translate[2] = std::stoi(components[2]);
+         }
+         else
+         {
+            return Failure("Unrecognized frame attribute: {key}={value}", std::string(key), std::string(value)).WithContext("Failed parsing nTRN chunk");
+         }
+      }
+
+      model->transforms.emplace(node.id, node);
+   }
+
+   for (const VoxReader::Group& group : scene.groups)
+   {
+      if (!group.attributes.empty())
+      {
+         return Failure("Unrecognized attribute: {key}={value}", std::string(group.attributes[0].first), std::string(group.attributes[0].second)).WithContext("Failed parsing nGRP chunk");
+      }
+
+      VoxModelData::GroupNode node;
+      node.id = group.id;
+      node.children.reserve(group.children.size);
+      for (uint32_t c = 0; c < group.children.size; ++c)
+      {
+         node.children.push_back(group.children[c]);
+      }
+
+      model->groups.emplace(node.id, node);
+   }
+
+   for (const VoxReader::Shape& shape : scene.shapes)
+   {
+      if (!shape.attributes.empty())
+      {
+         return Failure("Unrecognized attribute: {key}={value}", std::string(shape.attributes[0].first), std::string(shape.attributes[0].second)).WithContext("Failed parsing nSHP chunk");
+      }
+
+      if (shape.models.size() != 1)
+      {
+         return Failure("nSHP object must have only 1 model (value: {value})", shape.models.size()).WithContext("Failed parsing nSHP chunk");
       }
-      else if (data->shapes.find(node.child) != data->shapes.end())
+
+      const auto& [modelID, attributes] = shape.models[0];
+      if (!attributes.empty())
       {
-         const VoxModelData::ShapeNode& shape = data->shapes[node.child];
+         return Failure("Unrecognized attribute: {key}={value}", std::string(attributes[0].first), std::string(attributes[0].second)).WithContext("Failed parsing nSHP chunk");
+      }
+
+      VoxModelData::ShapeNode node;
+      node.id = shape.id;
+      node.model = modelID;
+      model->shapes.emplace(node.id, node);
+   }
 
-         part.start = models[(size_t)shape.model].start;
-         part.size = models[(size_t)shape.model].size;
+   for (const VoxReader::Layer& layerView : scene.layers)
+   {
+      VoxModelData::Layer layer;
+      layer.id = layerView.id;
 
-         // Add to the final model
-         model->parts.push_back(part);
-         if (part.name != "")
+      for (const auto& [key, value] : layerView.attributes)
+      {
+         if (key == "_name")
+         {
+            layer.name = value;
+         }
+         else if (key == "_hidden")
+         {
+            layer.hidden = value == "1";
+         }
+         else
          {
-            model->partLookup.emplace(part.name, model->parts.size() - 1);
+            return Failure("Unrecognized attribute: {key}={value}", std::string(key), std::string(value)).WithContext("Failed parsing LAYR chunk");
          }
       }
-      else
+
+      if (layerView.reserved != -1)
       {
-         return Failure("Expected a shape or group, but got transform for node {id}", node.child);
+         return Failure("Reserved ID was not -1 (was {value})", layerView.reserved).WithContext("Failed parsing LAYR chunk");
       }
+
+      model->layers.push_back(layer);
    }
 
-   auto emplaceResult = sModels.emplace(path, std::move(model));
-   return emplaceResult.first->second.get();
-}
+   for (const VoxReader::Material& materialView : scene.materials)
+   {
+      VoxModelData::Material material = VoxModelData::Material::Default;
+      material.id = materialView.id;
 
-Maybe<std::unique_ptr<VoxModelData>> VoxFormat::ReadScene(const std::string& path)
-{
-   std::unique_ptr<VoxModelData> model = std::make_unique<VoxModelData>();
+      for (const auto& [key, view] : materialView.properties)
+      {
+         std::string value(view);
+         if (key == "_type")
+         {
+            if (value == "_diffuse") { material.type = VoxModelData::Material::Diffuse; }
+            else if (value == "_metal") { material.type = VoxModelData::Material::Metal; }
+            else if (value == "_glass") { material.type = VoxModelData::Material::Glass; }
+            else if (value == "_emit") { material.type = VoxModelData::Material::Emit; }
+            else
+            {
+               return Failure("Unrecognized material type: {type}", value).WithContext("Failed parsing MATL chunk");
+            }
+         }
+         else if (key == "_weight")
+         {
+            material.weight = std::stof(value);
+         }
+         else if (key == "_rough")
+         {
+            material.rough = std::stof(value);
+         }
+         else if (key == "_spec")
+         {
+            material.spec = std::stof(value);
+         }
+         else if (key == "_ior")
+         {
+            material.ior = std::stof(value);
+         }
+         else if (key == "_att")
+         {
+            material.att = std::stof(value);
+         }
+         else if (key == "_flux")
+         {
+            material.flux = std::stof(value);
+         }
+         else if (key == "_plastic")
+         {
+            material.plastic = value == "1";
+         }
+         else if (key == "_ldr")
+         {
+            material.ldr = value == "1";
+         }
+         else
+         {
+            return Failure("Unknown material property: {key}={value}", std::string(key), value).WithContext("Failed parsing MATL chunk");
+         }
+      }
 
-   FileSystem& fs = Engine::FileSystemProvider::Instance();
-   Maybe<FileSystem::FileHandle> maybeHandle = fs.OpenFileRead(path);
-   if (!maybeHandle)
+      model->materials.push_back(material);
+   }
+
+   for (const VoxReader::Dict& renderObject : scene.renderObjects)
    {
-      return maybeHandle.Failure().WithContext("Failed opening model");
+      std::vector<std::pair<std::string, std::string>> properties;
+      properties.reserve(renderObject.size());
+      for (const auto& [key, value] : renderObject)
+      {
+         properties.emplace_back(key, value);
+      }
+
+      if (Maybe<void> result = ParseRenderObject(model.get(), properties); !result)
+      {
+         return result.Failure().WithContext("Failed parsing rOBJ chunk");
+      }
    }
 
-   FileSystem::FileHandle handle = maybeHandle.Result();
-   CUBEWORLD_SCOPE_EXIT([&] { fs.CloseFile(handle); });
+   return std::move(model);
+}
+
+Maybe<std::unique_ptr<ModelData>> VoxFormat::Read(const std::string& path, bool tintable)
+{
+   Maybe<std::unique_ptr<VoxModelData>> maybeModel = ReadScene(path);
 
-   FileHeader header;
-   if (Maybe<void> read = fs.ReadFile(handle, &header, sizeof(FileHeader)); !read)
+   if (!maybeModel)
    {
-      return read.Failure().WithContext("Failed reading file header");
+      return maybeModel.Failure();
    }
 
-   if (strncmp(header.id, "VOX ", 4) != 0)
+   return Merge(*maybeModel.Result(), tintable);
+}
+
+glm::mat4 VoxFormat::GetRotation(int8_t rotate)
+{
+   // Each row has a single 1 or -1. Bits 0-1 and 2-3 hold the columns of the first two
+   // rows' entries, and bits 4, 5 and 6 the signs of each row.
+   int8_t col0 = ((rotate >> 0) & 0b11);
+   int8_t col1 = ((rotate >> 2) & 0b11);
+   int8_t col2 = 3 - col0 - col1;
+   if (col0 == col1 || col0 > 2 || col1 > 2)
    {
-      return Failure("Header ID ({id}) did not match expected (VOXV)", std::string(header.id, header.id + sizeof(header.id)));
+      // Not a rotation at all.
+      return glm::mat4(1);
    }
 
-   if (header.version != 150)
+   glm::mat4 rotation(1);
+   rotation[0][0] = rotation[1][1] = rotation[2][2] = 0;
+   rotation[col0][0] = (rotate & 0b10000) ? -1.0f : 1.0f;
+   rotation[col1][1] = (rotate & 0b100000) ? -1.0f : 1.0f;
+   rotation[col2][2] = (rotate & 0b1000000) ? -1.0f : 1.0f;
+   return rotation;
+}
+
+glm::mat4 VoxFormat::GetPartRotation(const glm::mat4& rotation)
+{
+   int8_t col[3] = {0, 1, 2};
+   float val[3] = {1, 1, 1};
+   for (int8_t row = 0; row < 3; ++row)
    {
-      return Failure("Header version is {version}. Only 150 is supported", header.version);
+      for (int8_t column = 0; column < 3; ++column)
+      {
+         if (rotation[column][row] != 0)
+         {
+            col[row] = column;
+            val[row] = rotation[column][row];
+         }
+      }
    }
 
-   Maybe<Chunk> maybeChunk = ReadChunk(fs, handle);
-   if (!maybeChunk)
+   // Another weird fallout of y/z inversion: the rotation matrix looks like
+   // 1  0  0
+   // 0  0 -1
+   // 0  1  0
+   // The value ON the identity axis (in this case, [0][0], or x) is the axis
+   // we're rotating around. So in order to swap y and z correctly, we need
+   // to (a) figure out what axis is being rotated around, and then shimmy the
+   // values so that the REAL axis is being rotated. For example:
+   // 0  0 -1       0 -1  0
+   // 0  1  0   ->  1  0  0
+   // 1  0  0       0  0  1
+   // or:
+   //  0  1  0      0  0 -1
+   // -1  0  0  ->  0  1  0
+   //  0  0  1      1  0  0
+   // it should not change x-rotations however:
+   //  1  0  0      1  0  0
+   //  0  0 -1  ->  0  0 -1
+   //  0  1  0      0  1  0
+   // Notice that it's not a reversible transformation. If T(A) = B in the
+   // first example, then T(inv(B)) = A in the second.
+   if (col[0] != 0)
    {
-      return maybeChunk.Failure().WithContext("Failed reading RIFF file");
+      if (col[1] == 1) // Y -> Z rotation
+      {
+         col[0] = 1;
+         col[1] = 0;
+         col[2] = 2;
+         val[1] = val[2];
+         val[2] = 1; // previous val1
+      }
+      else // if col2 == 2, Z -> Y rotation
+      {
+         col[0] = 2;
+         col[1] = 1;
+         col[2] = 0;
+         val[0] = -val[0];
+         val[2] = -val[1];
+         val[1] = 1; // previous val2
+      }
    }
 
-   Chunk chunk = std::move(maybeChunk.Result());
+   glm::mat4 result(1);
+   result[0][0] = result[1][1] = result[2][2] = 0;
+   result[col[0]][0] = val[0];
+   result[col[1]][1] = val[1];
+   result[col[2]][2] = val[2];
+   return result;
+}
+
+Maybe<std::vector<VoxModelData::Instance>> VoxFormat::Flatten(const VoxModelData& scene, bool includeGroups)
+{
+   std::vector<VoxModelData::Instance> instances;
 
-   if (chunk.header.id != Chunk::MAIN)
+   // Files from before the scene graph existed just have their models, all at the origin.
+   if (scene.transforms.empty())
    {
-      return Failure("First chunk was {chunkId} ({headerId}), expected MAIN ({main}).", chunk.id(), chunk.header.id, Chunk::MAIN);
+      for (size_t i = 0; i < scene.models.size(); ++i)
+      {
+         instances.push_back(VoxModelData::Instance{-1, int32_t(i), -1, "", false, glm::mat4(1)});
+      }
+      return std::move(instances);
    }
 
-   for (const Chunk& node : chunk.children)
+   struct Pending {
+      int32_t id;
+      glm::mat4 parent;
+      bool hidden;
+      int32_t group; // Instance of the enclosing group, if groups are included
+   };
+
+   std::queue<Pending> remaining({ {0, glm::mat4(1), false, -1} });
+   std::unordered_set<int32_t> visited;
+   while (!remaining.empty())
    {
-      if (Maybe<void> result = ParseChunk(model.get(), node); !result)
+      Pending pending = remaining.front();
+      remaining.pop();
+
+      auto transform = scene.transforms.find(pending.id);
+      if (transform == scene.transforms.end())
       {
-         return result.Failure().WithContext("Failed parsing {id} chunk", node.id());
+         return Failure("Unexpected non-nTRN node: {id}", pending.id);
+      }
+
+      if (!visited.insert(pending.id).second)
+      {
+         return Failure("Node {id} appears in the scene graph more than once", pending.id);
+      }
+
+      const VoxModelData::TransformNode& node = transform->second;
+
+      bool hidden = pending.hidden || node.hidden;
+      if (node.layer >= 0)
+      {
+         if (size_t(node.layer) >= scene.layers.size())
+         {
+            return Failure("Node {id} is in layer {layer}, which doesn't exist", node.id, node.layer);
+         }
+
+         const VoxModelData::Layer& layer = scene.layers[size_t(node.layer)];
+         if (layer.name == "Exclude")
+         {
+            continue;
+         }
+         hidden = hidden || layer.hidden || layer.name == "Hidden" || layer.name == "Debug";
+      }
+
+      glm::mat4 matrix = glm::translate(pending.parent, glm::vec3{
+         node.translate[0],
+         node.translate[1],
+         node.translate[2],
+      }) * GetRotation(node.rotate);
+
+      if (auto group = scene.groups.find(node.child); group != scene.groups.end())
+      {
+         int32_t index = -1;
+         if (includeGroups)
+         {
+            index = int32_t(instances.size());
+            instances.push_back(VoxModelData::Instance{-1, -1, node.layer, node.name, hidden, matrix, node.id, pending.group});
+         }
+
+         for (const int32_t& child : group->second.children)
+         {
+            remaining.push({ child, matrix, hidden, index });
+         }
+      }
+      else if (auto shape = scene.shapes.find(node.child); shape != scene.shapes.end())
+      {
+         instances.push_back(VoxModelData::Instance{
+            shape->second.id,
+            shape->second.model,
+            node.layer,
+            node.name,
+            hidden,
+            matrix,
+            node.id,
+            pending.group,
+         });
+      }
+      else
+      {
+         return Failure("Expected a shape or group, but got transform for node {id}", node.child);
       }
    }
 
-   return std::move(model);
+   return std::move(instances);
 }
 
-Maybe<std::unique_ptr<ModelData>> VoxFormat::Read(const std::string& path, bool tintable)
+Maybe<std::unique_ptr<ModelData>> VoxFormat::Merge(const VoxModelData& scene, bool tintable)
 {
-   Maybe<std::unique_ptr<VoxModelData>> maybeModel = ReadScene(path);
+   if (scene.models.empty())
+   {
+      return Failure("Scene has no models");
+   }
 
-   if (!maybeModel)
+   if (scene.models.size() == 1 && scene.shapes.size() <= 1)
    {
-      return maybeModel.Failure();
+      return BuildModelData(scene.models[0], scene.palette, tintable);
+   }
+
+   Maybe<std::vector<VoxModelData::Instance>> instances = Flatten(scene);
+   if (!instances)
+   {
+      return instances.Failure().WithContext("Failed flattening scene");
+   }
+
+   // Place every voxel in the scene, keeping track of how much space they cover.
+   std::vector<std::pair<glm::ivec3, uint8_t>> placed;
+   glm::ivec3 min{std::numeric_limits<int32_t>::max()};
+   glm::ivec3 max{std::numeric_limits<int32_t>::min()};
+   for (const VoxModelData::Instance& instance : *instances)
+   {
+      if (instance.hidden)
+      {
+         continue;
+      }
+
+      if (instance.model < 0 || size_t(instance.model) >= scene.models.size())
+      {
+         return Failure("Shape {id} uses model {model}, but there are only {num}", instance.shape, instance.model, scene.models.size());
+      }
+
+      // Models rotate around their center, in .vox axes.
+      const VoxModelData::Model& shape = scene.models[size_t(instance.model)];
+      const glm::vec3 center = glm::vec3{shape.width, shape.length, shape.height} / 2.0f;
+      for (uint32_t info : shape.voxels)
+      {
+         glm::vec3 local = glm::vec3{info & 0xff, (info >> 8) & 0xff, (info >> 16) & 0xff} + 0.5f - center;
+         glm::ivec3 position = glm::ivec3(glm::floor(glm::vec3(instance.transform * glm::vec4(local, 1))));
+         min = glm::min(min, position);
+         max = glm::max(max, position);
+         placed.emplace_back(position, uint8_t(info >> 24));
+      }
    }
 
-   std::unique_ptr<VoxModelData> model = std::move(maybeModel.Result());
+   if (placed.empty())
+   {
+      return Failure("Scene has no visible voxels");
+   }
 
-   if (model->shapes.size() > 1)
+   const glm::ivec3 size = max - min + 1;
+   if (size.x > 256 || size.y > 256 || size.z > 256)
    {
-      return Failure("Multi-shape models not yet supported");
+      return Failure("Merged scene is {x}x{y}x{z}, but models can be at most 256 on a side", size.x, size.y, size.z);
    }
 
-   const VoxModelData::Model& shape = model->models[0];
+   VoxModelData::Model merged;
+   merged.width = uint32_t(size.x);
+   merged.length = uint32_t(size.y);
+   merged.height = uint32_t(size.z);
 
+   // Shapes may overlap, in which case the last one placed wins.
+   std::unordered_map<uint32_t, size_t> occupied;
+   for (const auto& [position, color] : placed)
+   {
+      glm::uvec3 p = glm::uvec3(position - min);
+      uint32_t packed = p.x | (p.y << 8) | (p.z << 16);
+      auto [existing, inserted] = occupied.emplace(packed, merged.voxels.size());
+      if (inserted)
+      {
+         merged.voxels.push_back(packed | (uint32_t(color) << 24));
+      }
+      else
+      {
+         merged.voxels[existing->second] = packed | (uint32_t(color) << 24);
+      }
+   }
+
+   return BuildModelData(merged, scene.palette, tintable);
+}
+
+Maybe<std::unique_ptr<ModelData>> VoxFormat::BuildModelData(const VoxModelData::Model& shape, const uint32_t palette[256], bool tintable)
+{
    std::unique_ptr<ModelData> result = std::make_unique<ModelData>();
 
    result->mMetadata.width = shape.width;
@@ -1278,15 +1294,10 @@ Maybe<std::unique_ptr<ModelData>> VoxFormat::Read(const std::string& path, bool
    result->mMetadata.length = shape.length;
    result->mIsTintable = tintable;
 
-   std::vector<bool> filled(shape.width * shape.height * shape.length, false);
-   for (const auto& info : shape.voxels)
+   Maybe<OccupancyGrid> grid = BuildOccupancy(shape);
+   if (!grid)
    {
-      uint8_t y = (info >> 16) & 0xff;
-      uint8_t z = (info >> 8) & 0xff;
-      uint8_t x = info & 0xff;
-
-      size_t ndx = (size_t)Index(result->mMetadata, x, y, z);
-      filled[ndx] = true;
+      return grid.Failure();
    }
 
    for (const auto& info : shape.voxels)
@@ -1299,11 +1310,11 @@ Maybe<std::unique_ptr<ModelData>> VoxFormat::Read(const std::string& path, bool
       voxel.position.x = float(x) - float(result->mMetadata.width - 1) / 2;
       voxel.position.y = float(y) - float(result->mMetadata.height) / 2;
       voxel.position.z = float(result->mMetadata.length - 1) / 2 - float(z);
-      uint32_t rgba = model->palette[i - 1];
+      uint32_t rgba = palette[i - 1];
       voxel.color.r = float((rgba) & 0xff);
       voxel.color.g = float((rgba >> 8) & 0xff);
       voxel.color.b = float((rgba >> 16) & 0xff);
-      voxel.enabledFaces = GetExposedFaces(filled, result->mMetadata, x, y, z);
+      voxel.enabledFaces = grid->GetExposedFaces(x, y, z);
       result->mVoxelData.push_back(voxel);
    }
 
@@ -8,6 +8,7 @@
 #include <RGBDesignPatterns/Maybe.h>
 #include <RGBFileSystem/FileSystem.h>
 #include "../Voxel.h"
+#include "OccupancyGrid.h"
 
 namespace CubeWorld
 {
@@ -162,6 +163,27 @@ struct VoxModelData {
       };
    };
 
+   //
+   // A shape (or group) placed in the scene, with every transform above it applied.
+   // See VoxFormat::Flatten.
+   //
+   struct Instance {
+      int32_t shape;    // nSHP node id, or -1 for a group
+      int32_t model;    // Index into models, or -1 for a group
+      int32_t layer;    // Of the shape's own transform, or -1
+      std::string name; // Of the shape's own transform
+      bool hidden;
+
+      //
+      // Maps a voxel's center, relative to the center of its model, into the scene.
+      // In .vox axes, so z is up.
+      //
+      glm::mat4 transform;
+
+      int32_t node = -1;   // Of the shape's own transform, or -1 without a scene graph
+      int32_t parent = -1; // Index of the enclosing group's instance, when groups are listed
+   };
+
    std::vector<Model> models;
    uint32_t palette[256]; // r, g, b, a packed
 
@@ -229,6 +251,8 @@ public:
    std::vector<uint32_t> parents;
    std::unordered_map<std::string, size_t> partLookup;
 
+   // CPU copy of the voxels, kept only until they've been buffered to vbo.
+   std::vector<Voxel::PackedData> voxels;
    Engine::Graphics::VBO vbo;
 };
 
@@ -244,16 +268,45 @@ public:
    // Also soft-deprecated, I want to use VoxModel for everything.
    //
    static Model* Load(const std::string& path, bool tintable);
+
+   //
+   // Blocks until the model at path is loaded and buffered. Shares its cache with
+   // VoxLoader, so use that directly to load many models in parallel.
+   //
    static Maybe<VoxModel*> Load(const std::string& path);
 
+   //
+   // Builds parts and exposed voxels from parsed data. Touches neither GL nor any
+   // shared state, so it's safe to call from worker threads.
+   //
+   static Maybe<std::unique_ptr<VoxModel>> Build(const VoxModelData& data);
+
    static Maybe<std::unique_ptr<VoxModelData>> ReadScene(const std::string& path);
+
+   //
+   // Walks the scene graph from its root, listing every shape it places. Nodes in
+   // the "Exclude" layer are left out along with everything under them. Nodes in
+   // hidden layers are kept, but marked hidden, as is everything under them.
+   //
+   // With includeGroups, groups are listed too, each before anything under it.
+   //
+   static Maybe<std::vector<VoxModelData::Instance>> Flatten(const VoxModelData& scene, bool includeGroups = false);
+
+   //
+   // Combines every visible shape in the scene into one model, in the same space as
+   // a single-shape file would be read. Files with just one shape come out exactly as
+   // they always have, ignoring its transform.
+   //
+   static Maybe<std::unique_ptr<ModelData>> Merge(const VoxModelData& scene, bool tintable);
+
+   // Parse a whole .vox file that's already in memory. See VoxReader.
+   static Maybe<std::unique_ptr<VoxModelData>> ParseScene(const void* data, size_t size);
    static Maybe<std::unique_ptr<ModelData>> Read(const std::string& path, bool tintable);
    static Maybe<void> Write(const std::string& path, const VoxModelData& model);
    static Maybe<void> Write(const std::string& path, const ModelData& model);
 
 private:
    static std::unordered_map<std::string, std::unique_ptr<Model>> sDepModels;
-   static std::unordered_map<std::string, std::unique_ptr<VoxModel>> sModels;
 
 private:
    // Internal helpers
@@ -271,28 +324,27 @@ private:
    struct MATL;
    struct LAYR;
 
-   static Maybe<Chunk> ReadChunk(FileSystem& fs, FileSystem::FileHandle handle);
-   static std::string ParseString(int32_t*& data);
    static int32_t* WriteString(int32_t* data, const std::string& string);
-   static std::vector<std::pair<std::string, std::string>> ParseDict(int32_t*& data);
    static int32_t* WriteDict(int32_t* data, const std::vector<std::pair<std::string, std::string>>& pairs);
    static std::string ToShortString(float val);
-   static Maybe<void> ParseChunk(VoxModelData* model, const Chunk& chunk);
+   static Maybe<void> ParseRenderObject(VoxModelData* model, const std::vector<std::pair<std::string, std::string>>& properties);
    static Maybe<size_t> WriteRenderObj(
       FileSystem& fs,
       FileSystem::FileHandle handle,
       const std::vector<std::pair<std::string, std::string>>& properties
    );
 
-   static bool IsFilled(const std::vector<bool>& filled, int index);
-   static int32_t Index(const Model::Metadata& metadata, uint32_t x, uint32_t y, uint32_t z);
-   static uint8_t GetExposedFaces(
-      const std::vector<bool>& filled,
-      const Model::Metadata& metadata,
-      uint32_t x,
-      uint32_t y,
-      uint32_t z
-   );
+   // Fails if any voxel is outside the model's bounds.
+   static Maybe<OccupancyGrid> BuildOccupancy(const VoxModelData::Model& model);
+
+   // Rotation matrix for an nTRN frame's _r attribute, in .vox axes.
+   static glm::mat4 GetRotation(int8_t rotate);
+
+   // Moves a GetRotation matrix into the y-up axes of VoxModel parts.
+   static glm::mat4 GetPartRotation(const glm::mat4& rotation);
+
+   // Converts one shape, centered, into ModelData.
+   static Maybe<std::unique_ptr<ModelData>> BuildModelData(const VoxModelData::Model& shape, const uint32_t palette[256], bool tintable);
 };
 
 }; // namespace Voxel
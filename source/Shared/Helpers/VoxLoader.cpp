@@ -0,0 +1,222 @@
+// By Thomas Steinke
+
+#include <chrono>
+#include <thread>
+
+#include <Engine/Core/FileSystemProvider.h>
+#include <Engine/Core/Window.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBLogger/Logger.h>
+
+#include "VoxBake.h"
+#include "VoxLoader.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+///
+///
+///
+bool VoxLoader::Handle::IsReady() const
+{
+   return mResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+///
+///
+///
+Maybe<VoxModel*> VoxLoader::Handle::Get() const
+{
+   const Result& result = mResult.get();
+   if (result.model == nullptr)
+   {
+      return result.failure;
+   }
+   return result.model;
+}
+
+///
+///
+///
+VoxLoader::Handle VoxLoader::Request(const std::string& path)
+{
+   // Resolve the file system here, since the provider creates its default lazily and
+   // that isn't safe to race on.
+   FileSystem& fs = *Engine::FileSystemProvider::Instance().get();
+
+   std::unique_lock<std::mutex> lock{mMutex};
+   auto existing = mRequests.find(path);
+   if (existing != mRequests.end())
+   {
+      return existing->second;
+   }
+
+   // Submitting while holding the lock means the worker can't get to its result (and
+   // possibly erase it) until it's been recorded.
+   Handle handle;
+   handle.mResult = mPool.Submit([this, &fs, path, cacheDirectory = mCacheDirectory] {
+      return BuildOnWorker(fs, path, cacheDirectory);
+   }).share();
+
+   mRequests.emplace(path, handle);
+   return handle;
+}
+
+///
+///
+///
+Maybe<VoxModel*> VoxLoader::Load(const std::string& path)
+{
+   Maybe<VoxModel*> result = Request(path).Get();
+   if (result)
+   {
+      Finalize();
+   }
+   return result;
+}
+
+///
+///
+///
+size_t VoxLoader::Finalize()
+{
+   std::vector<VoxModel*> finished;
+   {
+      std::unique_lock<std::mutex> lock{mMutex};
+      finished.swap(mFinished);
+   }
+
+   // No GL context in headless runs; the CPU data is all anyone needs there.
+   if (Engine::Window::Instance().IsReady())
+   {
+      for (VoxModel* model : finished)
+      {
+         model->vbo.BufferData(model->voxels);
+         std::vector<Voxel::PackedData>().swap(model->voxels);
+      }
+   }
+
+   return finished.size();
+}
+
+///
+///
+///
+void VoxLoader::SetCacheDirectory(const std::string& directory)
+{
+   std::unique_lock<std::mutex> lock{mMutex};
+   mCacheDirectory = directory;
+}
+
+///
+///
+///
+VoxLoader::Handle::Result VoxLoader::BuildOnWorker(FileSystem& fs, const std::string& path, const std::string& cacheDirectory)
+{
+   Maybe<VoxModel*> maybeModel = Build(fs, path, cacheDirectory);
+   if (!maybeModel)
+   {
+      std::unique_lock<std::mutex> lock{mMutex};
+      mRequests.erase(path);
+      return Handle::Result{nullptr, maybeModel.Failure().WithContext("Failed loading {path}", path)};
+   }
+   return Handle::Result{maybeModel.Result(), Failure{}};
+}
+
+///
+///
+///
+Maybe<VoxModel*> VoxLoader::Build(FileSystem& fs, const std::string& path, const std::string& cacheDirectory)
+{
+   Maybe<std::string> contents = fs.ReadEntireFile(path);
+   if (!contents)
+   {
+      return contents.Failure().WithContext("Failed reading model");
+   }
+
+   Maybe<std::unique_ptr<VoxModel>> model = BuildOrBake(fs, *contents, cacheDirectory);
+   if (!model)
+   {
+      return model.Failure();
+   }
+
+   VoxModel* result = model.Result().get();
+   {
+      std::unique_lock<std::mutex> lock{mMutex};
+      mModels.push_back(std::move(model.Result()));
+      mFinished.push_back(result);
+   }
+   return result;
+}
+
+///
+///
+///
+Maybe<std::unique_ptr<VoxModel>> VoxLoader::BuildOrBake(FileSystem& fs, const std::string& contents, const std::string& cacheDirectory)
+{
+   uint64_t hash = 0;
+   std::string bakePath;
+   if (!cacheDirectory.empty())
+   {
+      hash = VoxBake::Hash(contents.data(), contents.size());
+      bakePath = Paths::Join(cacheDirectory, VoxBake::Filename(hash));
+
+      auto [_1, exists] = fs.Exists(bakePath);
+      if (exists)
+      {
+         Maybe<std::unique_ptr<FileSystem::MappedFile>> bake = fs.MapFile(bakePath);
+         if (bake)
+         {
+            Maybe<std::unique_ptr<VoxModel>> model = VoxBake::Read(bake.Result()->data(), bake.Result()->size(), hash);
+            if (model)
+            {
+               return std::move(model.Result());
+            }
+
+            // Most likely from an older version. It'll be replaced below.
+            LOG_WARNING("Ignoring bake {path}: {message}", bakePath, model.Failure().GetMessage());
+         }
+      }
+   }
+
+   Maybe<std::unique_ptr<VoxModelData>> data = VoxFormat::ParseScene(contents.data(), contents.size());
+   if (!data)
+   {
+      return data.Failure().WithContext("Failed loading scene");
+   }
+
+   Maybe<std::unique_ptr<VoxModel>> model = VoxFormat::Build(*data.Result());
+   if (!model)
+   {
+      return model.Failure().WithContext("Failed building model");
+   }
+
+   if (!bakePath.empty())
+   {
+      // A missing bake only costs time, so don't fail the load over it. It's written
+      // alongside and moved into place so that nobody maps a half-written bake.
+      std::string tempPath = FormatString("{path}.{thread}.tmp", bakePath, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+      Maybe<void> written = fs.MakeDirectory(cacheDirectory);
+      if (written)
+      {
+         written = fs.WriteFile(tempPath, VoxBake::Write(*model.Result(), hash));
+      }
+      if (written)
+      {
+         written = fs.Rename(tempPath, bakePath);
+      }
+      if (!written)
+      {
+         LOG_WARNING("Failed writing bake {path}: {message}", bakePath, written.Failure().GetMessage());
+      }
+   }
+
+   return std::move(model.Result());
+}
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
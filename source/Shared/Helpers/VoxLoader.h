@@ -0,0 +1,119 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <RGBDesignPatterns/Maybe.h>
+#include <RGBDesignPatterns/Singleton.h>
+#include <RGBDesignPatterns/ThreadPool.h>
+#include <RGBFileSystem/FileSystem.h>
+
+#include "VoxFormat.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+//
+// VoxLoader reads, parses and builds VoxModels on a pool of worker threads, and caches
+// them by path. Requesting a path that's already loaded or in flight hands back the
+// same load instead of starting another one.
+//
+// With a cache directory set, each model is also baked (see VoxBake) the first time it's
+// built, and later loads of the same source map the bake instead of parsing it again.
+//
+// Workers never touch GL. Anything they finish waits until Finalize() is called on the
+// main thread, which buffers it to the GPU.
+//
+class VoxLoader : public Singleton<VoxLoader> {
+public:
+   //
+   // A requested model. Copies all refer to the same load.
+   //
+   class Handle {
+   public:
+      bool IsValid() const { return mResult.valid(); }
+
+      // Whether the load has finished, successfully or not. Never blocks.
+      bool IsReady() const;
+
+      //
+      // Blocks until the load finishes. The model's vbo is empty until the next
+      // Finalize(), so don't draw it before then.
+      //
+      Maybe<VoxModel*> Get() const;
+
+   private:
+      friend class VoxLoader;
+
+      // Maybe is move-only, and a shared_future only hands out const references.
+      struct Result {
+         VoxModel* model = nullptr;
+         Failure failure;
+      };
+
+      std::shared_future<Result> mResult;
+   };
+
+public:
+   VoxLoader() : VoxLoader(std::thread::hardware_concurrency()) {}
+   explicit VoxLoader(size_t numThreads) : mPool(numThreads) {}
+
+   //
+   // Starts loading path on a worker, unless it's already loaded or in flight.
+   // Failed loads aren't cached, so requesting them again tries again.
+   //
+   Handle Request(const std::string& path);
+
+   //
+   // Requests path, blocks until it's ready, and finalizes it. Main thread only.
+   //
+   Maybe<VoxModel*> Load(const std::string& path);
+
+   //
+   // Buffers every model that finished since the last call to the GPU, unless we're
+   // running headless. Main thread only. Returns the number of models finalized.
+   //
+   size_t Finalize();
+
+   //
+   // Where baked models are read from and written to. Empty, the default, turns baking
+   // off. Only affects requests made after it's set.
+   //
+   void SetCacheDirectory(const std::string& directory);
+
+   size_t GetNumThreads() const { return mPool.size(); }
+
+private:
+   Maybe<VoxModel*> Build(FileSystem& fs, const std::string& path, const std::string& cacheDirectory);
+   Handle::Result BuildOnWorker(FileSystem& fs, const std::string& path, const std::string& cacheDirectory);
+
+   // Parses the source, or maps its bake if there's a current one, writing it if not.
+   Maybe<std::unique_ptr<VoxModel>> BuildOrBake(FileSystem& fs, const std::string& contents, const std::string& cacheDirectory);
+
+private:
+   // Protects everything below it, except the pool.
+   std::mutex mMutex;
+
+   std::string mCacheDirectory;
+   std::unordered_map<std::string, Handle> mRequests;
+   std::vector<std::unique_ptr<VoxModel>> mModels;
+
+   // Built on a worker, but not yet finalized.
+   std::vector<VoxModel*> mFinished;
+
+   // Last, so workers are joined before anything they touch is destroyed.
+   ThreadPool mPool;
+};
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -0,0 +1,326 @@
+// By Thomas Steinke
+
+#include <string>
+
+#include "VoxReader.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+namespace
+{
+
+constexpr uint32_t MakeVoxChunkID(const char id[])
+{
+   return uint32_t((id[3] << 24) | (id[2] << 16) | (id[1] << 8) | id[0]);
+}
+
+std::string VoxChunkName(uint32_t id)
+{
+   char name[] = {
+      static_cast<char>(id & 0xff),
+      static_cast<char>(id >> 8 & 0xff),
+      static_cast<char>(id >> 16 & 0xff),
+      static_cast<char>(id >> 24 & 0xff),
+   };
+   return std::string(name, 4);
+}
+
+constexpr uint32_t kVoxMAIN = MakeVoxChunkID("MAIN");
+constexpr uint32_t kVoxSIZE = MakeVoxChunkID("SIZE");
+constexpr uint32_t kVoxXYZI = MakeVoxChunkID("XYZI");
+constexpr uint32_t kVoxRGBA = MakeVoxChunkID("RGBA");
+constexpr uint32_t kVoxnTRN = MakeVoxChunkID("nTRN");
+constexpr uint32_t kVoxnGRP = MakeVoxChunkID("nGRP");
+constexpr uint32_t kVoxnSHP = MakeVoxChunkID("nSHP");
+constexpr uint32_t kVoxMATL = MakeVoxChunkID("MATL");
+constexpr uint32_t kVoxLAYR = MakeVoxChunkID("LAYR");
+constexpr uint32_t kVoxrOBJ = MakeVoxChunkID("rOBJ");
+
+//
+// Bounds-checked reads over part of the buffer. The first read that would go past the
+// end marks the cursor as failed, and every read after that returns nothing, so callers
+// can read a whole structure and check Failed() once at the end.
+//
+class VoxCursor {
+public:
+   VoxCursor(const uint8_t* begin, size_t size) : mPos(begin), mEnd(begin + size) {}
+
+   bool Failed() const { return mFailed; }
+   bool AtEnd() const { return mPos == mEnd; }
+   size_t Remaining() const { return size_t(mEnd - mPos); }
+
+   void Fail() { mFailed = true; }
+
+   const uint8_t* Take(size_t size)
+   {
+      if (mFailed || size > Remaining())
+      {
+         mFailed = true;
+         return nullptr;
+      }
+
+      const uint8_t* result = mPos;
+      mPos += size;
+      return result;
+   }
+
+   template<typename T>
+   T Read()
+   {
+      T value{};
+      if (const uint8_t* bytes = Take(sizeof(T)))
+      {
+         memcpy(&value, bytes, sizeof(T));
+      }
+      return value;
+   }
+
+   // Reads a count, failing if it's negative or couldn't possibly fit in what's left.
+   // This keeps garbage counts from turning into huge allocations.
+   uint32_t ReadCount(size_t minimumSize)
+   {
+      int32_t count = Read<int32_t>();
+      if (count < 0 || size_t(count) > Remaining() / minimumSize)
+      {
+         mFailed = true;
+         return 0;
+      }
+      return uint32_t(count);
+   }
+
+   std::string_view ReadString()
+   {
+      uint32_t size = ReadCount(1);
+      const uint8_t* bytes = Take(size);
+      return bytes ? std::string_view(reinterpret_cast<const char*>(bytes), size) : std::string_view{};
+   }
+
+   VoxReader::Dict ReadDict()
+   {
+      // Each entry is at least two empty strings.
+      uint32_t count = ReadCount(2 * sizeof(int32_t));
+
+      VoxReader::Dict dict;
+      dict.reserve(count);
+      for (uint32_t i = 0; i < count && !mFailed; ++i)
+      {
+         std::string_view key = ReadString();
+         std::string_view value = ReadString();
+         dict.emplace_back(key, value);
+      }
+      return dict;
+   }
+
+   template<typename T>
+   VoxReader::Array<T> ReadArray(uint32_t count)
+   {
+      if (count > Remaining() / sizeof(T))
+      {
+         mFailed = true;
+         return {};
+      }
+      return VoxReader::Array<T>{Take(sizeof(T) * count), count};
+   }
+
+private:
+   const uint8_t* mPos;
+   const uint8_t* mEnd;
+   bool mFailed = false;
+};
+
+Maybe<void> ParseVoxChunk(VoxReader::Scene& scene, uint32_t id, VoxCursor& chunk)
+{
+   if (id == kVoxSIZE)
+   {
+      VoxReader::Model model;
+      model.width = chunk.Read<uint32_t>();
+      model.length = chunk.Read<uint32_t>();
+      model.height = chunk.Read<uint32_t>();
+      scene.models.push_back(model);
+   }
+   else if (id == kVoxXYZI)
+   {
+      if (scene.models.empty() || scene.models.back().voxels.data != nullptr)
+      {
+         return Failure("XYZI chunk did not follow a SIZE chunk");
+      }
+
+      uint32_t numVoxels = chunk.Read<uint32_t>();
+      scene.models.back().voxels = chunk.ReadArray<uint32_t>(numVoxels);
+   }
+   else if (id == kVoxRGBA)
+   {
+      scene.palette = chunk.ReadArray<uint32_t>(256);
+   }
+   else if (id == kVoxnTRN)
+   {
+      VoxReader::Transform node;
+      node.id = chunk.Read<int32_t>();
+      node.attributes = chunk.ReadDict();
+      node.child = chunk.Read<int32_t>();
+      node.reserved = chunk.Read<int32_t>();
+      node.layer = chunk.Read<int32_t>();
+
+      uint32_t numFrames = chunk.ReadCount(sizeof(int32_t));
+      for (uint32_t i = 0; i < numFrames && !chunk.Failed(); ++i)
+      {
+         node.frames.push_back(chunk.ReadDict());
+      }
+      scene.transforms.push_back(std::move(node));
+   }
+   else if (id == kVoxnGRP)
+   {
+      VoxReader::Group node;
+      node.id = chunk.Read<int32_t>();
+      node.attributes = chunk.ReadDict();
+      node.children = chunk.ReadArray<int32_t>(chunk.ReadCount(sizeof(int32_t)));
+      scene.groups.push_back(std::move(node));
+   }
+   else if (id == kVoxnSHP)
+   {
+      VoxReader::Shape node;
+      node.id = chunk.Read<int32_t>();
+      node.attributes = chunk.ReadDict();
+
+      uint32_t numModels = chunk.ReadCount(2 * sizeof(int32_t));
+      for (uint32_t i = 0; i < numModels && !chunk.Failed(); ++i)
+      {
+         int32_t model = chunk.Read<int32_t>();
+         node.models.emplace_back(model, chunk.ReadDict());
+      }
+      scene.shapes.push_back(std::move(node));
+   }
+   else if (id == kVoxMATL)
+   {
+      VoxReader::Material material;
+      material.id = chunk.Read<int32_t>();
+      material.properties = chunk.ReadDict();
+      scene.materials.push_back(std::move(material));
+   }
+   else if (id == kVoxLAYR)
+   {
+      VoxReader::Layer layer;
+      layer.id = chunk.Read<int32_t>();
+      layer.attributes = chunk.ReadDict();
+      layer.reserved = chunk.Read<int32_t>();
+      scene.layers.push_back(std::move(layer));
+   }
+   else if (id == kVoxrOBJ)
+   {
+      scene.renderObjects.push_back(chunk.ReadDict());
+   }
+   else
+   {
+      // PACK is redundant with counting SIZE chunks, and anything else (IMAP, rCAM,
+      // NOTE, ...) isn't something we use.
+      return Success;
+   }
+
+   if (chunk.Failed())
+   {
+      return Failure("Chunk body was truncated");
+   }
+   if (!chunk.AtEnd())
+   {
+      return Failure("Failed to parse all of body ({remaining} bytes left)", chunk.Remaining());
+   }
+   return Success;
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+Maybe<VoxReader::Scene> VoxReader::Parse(const void* data, size_t size)
+{
+   VoxCursor file(static_cast<const uint8_t*>(data), size);
+
+   const uint8_t* id = file.Take(4);
+   int32_t version = file.Read<int32_t>();
+   if (file.Failed())
+   {
+      return Failure("File is too small to be a VOX file ({size} bytes)", size);
+   }
+
+   if (memcmp(id, "VOX ", 4) != 0)
+   {
+      return Failure("Header ID ({id}) did not match expected (VOX )", std::string(id, id + 4));
+   }
+
+   if (version != 150)
+   {
+      return Failure("Header version is {version}. Only 150 is supported", version);
+   }
+
+   uint32_t mainID = file.Read<uint32_t>();
+   uint32_t mainLength = file.Read<uint32_t>();
+   uint32_t mainChildLength = file.Read<uint32_t>();
+   file.Take(mainLength);
+   const uint8_t* children = file.Take(mainChildLength);
+   if (file.Failed())
+   {
+      return Failure("MAIN chunk runs past the end of the file");
+   }
+
+   if (mainID != kVoxMAIN)
+   {
+      return Failure("First chunk was {chunkId}, expected MAIN", VoxChunkName(mainID));
+   }
+
+   Scene scene;
+   scene.version = version;
+
+   // Walk chunks in file order. MagicaVoxel only ever nests chunks one level deep, under
+   // MAIN, but the format allows more, so deeper children go on a stack instead of
+   // recursing.
+   std::vector<VoxCursor> regions{VoxCursor(children, mainChildLength)};
+   while (!regions.empty())
+   {
+      VoxCursor& region = regions.back();
+      if (region.AtEnd())
+      {
+         regions.pop_back();
+         continue;
+      }
+
+      uint32_t chunkID = region.Read<uint32_t>();
+      uint32_t length = region.Read<uint32_t>();
+      uint32_t childLength = region.Read<uint32_t>();
+      const uint8_t* content = region.Take(length);
+      const uint8_t* nested = region.Take(childLength);
+      if (region.Failed())
+      {
+         return Failure("{id} chunk runs past the end of its parent", VoxChunkName(chunkID));
+      }
+
+      VoxCursor chunk(content, length);
+      if (Maybe<void> result = ParseVoxChunk(scene, chunkID, chunk); !result)
+      {
+         return result.Failure().WithContext("Failed parsing {id} chunk", VoxChunkName(chunkID));
+      }
+
+      if (childLength > 0)
+      {
+         regions.push_back(VoxCursor(nested, childLength));
+      }
+   }
+
+   for (size_t i = 0; i < scene.models.size(); ++i)
+   {
+      if (scene.models[i].voxels.data == nullptr)
+      {
+         return Failure("Model {index} has a SIZE chunk but no XYZI chunk", i);
+      }
+   }
+
+   return std::move(scene);
+}
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -0,0 +1,118 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <RGBDesignPatterns/Maybe.h>
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+//
+// VoxReader walks a .vox file that's already in memory (read whole, or mapped), without
+// copying anything out of it. Chunks are walked iteratively, and every view it hands back
+// points straight into the original buffer, so the buffer must outlive the Scene.
+//
+// Every read is bounds checked, so Parse is safe to call on arbitrary bytes. Anything
+// malformed comes back as a Failure rather than a crash.
+//
+// Documentation:
+// https://github.com/ephtracy/voxel-model/blob/master/MagicaVoxel-file-format-vox.txt
+//
+class VoxReader {
+public:
+   using Dict = std::vector<std::pair<std::string_view, std::string_view>>;
+
+   //
+   // An array of little-endian 32-bit values in the buffer. Chunks aren't guaranteed to
+   // be aligned (dictionaries have arbitrary-length strings), so values are copied out
+   // one at a time instead of handing out a pointer.
+   //
+   template<typename T>
+   struct Array {
+      const uint8_t* data = nullptr;
+      uint32_t size = 0;
+
+      T operator[](size_t index) const
+      {
+         T value;
+         memcpy(&value, data + sizeof(T) * index, sizeof(T));
+         return value;
+      }
+   };
+
+   // SIZE and the XYZI chunk that follows it.
+   struct Model {
+      uint32_t width; // x
+      uint32_t length; // z
+      uint32_t height; // y
+
+      // x, y, z, colorIndex packed into one uint32_t
+      Array<uint32_t> voxels;
+   };
+
+   struct Transform {
+      int32_t id;
+      Dict attributes;
+      int32_t child;
+      int32_t reserved;
+      int32_t layer;
+      std::vector<Dict> frames;
+   };
+
+   struct Group {
+      int32_t id;
+      Dict attributes;
+      Array<int32_t> children;
+   };
+
+   struct Shape {
+      int32_t id;
+      Dict attributes;
+      std::vector<std::pair<int32_t, Dict>> models;
+   };
+
+   struct Material {
+      int32_t id;
+      Dict properties;
+   };
+
+   struct Layer {
+      int32_t id;
+      Dict attributes;
+      int32_t reserved;
+   };
+
+   struct Scene {
+      int32_t version;
+
+      std::vector<Model> models;
+
+      // 256 RGBA colors, or empty if the file uses the default palette.
+      Array<uint32_t> palette;
+
+      std::vector<Transform> transforms;
+      std::vector<Group> groups;
+      std::vector<Shape> shapes;
+      std::vector<Material> materials;
+      std::vector<Layer> layers;
+
+      // Render settings (rOBJ)
+      std::vector<Dict> renderObjects;
+   };
+
+public:
+   static Maybe<Scene> Parse(const void* data, size_t size);
+};
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
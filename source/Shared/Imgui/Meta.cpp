@@ -118,10 +118,13 @@ std::pair<bool, bool> DrawInternal(const std::string& label, BindingProperty& va
          }
       }
 
+      // Drawn every frame, so the labels are written into a buffer instead of a new string.
+      char nodeLabel[256];
       size_t index = 0;
       for (auto& keyval : value.object())
       {
-         if (ImGui::TreeNode(FormatString("Element {num}{label}", index++, label).c_str()))
+         *FormatToN(nodeLabel, sizeof(nodeLabel) - 1, CUBEWORLD_FORMAT("Element {num}{label}"), index++, label).out = '\0';
+         if (ImGui::TreeNode(nodeLabel))
          {
             ImGui::InputText(keyLabel.c_str(), &keyval.key);
 
@@ -186,10 +189,12 @@ std::pair<bool, bool> DrawInternal(const std::string& label, BindingProperty& va
       }
       else
       {
+         char nodeLabel[256];
          size_t index = 0;
          for (auto& elem : value)
          {
-            if (ImGui::TreeNode(FormatString("Element {num}{label}", index, label).c_str()))
+            *FormatToN(nodeLabel, sizeof(nodeLabel) - 1, CUBEWORLD_FORMAT("Element {num}{label}"), index, label).out = '\0';
+            if (ImGui::TreeNode(nodeLabel))
             {
                std::pair<bool, bool> valueResult = DrawInternal(FormatString(label + "##{num}", index), elem);
                result.first |= valueResult.first;
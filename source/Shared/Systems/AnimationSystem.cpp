@@ -5,6 +5,7 @@
 
 #include <RGBLogger/Logger.h>
 #include <Engine/Core/Config.h>
+#include <Engine/Core/FrameAllocator.h>
 
 #include "../Components/VoxModel.h"
 #include "BulletPhysicsSystem.h"
@@ -249,7 +250,8 @@ void AnimationApplicator::Update(Engine::EntityManager& entities, Engine::EventM
    // First, update skeletons.
    entities.Each<AnimationController>([&](Engine::Entity entity, AnimationController& controller) {
       size_t boneId = 0;
-      std::vector<glm::mat4> matrixes;
+      // Scratch space only, the results get copied into each bone.
+      Engine::FrameVector<glm::mat4> matrixes(Engine::FrameAllocator::Get());
       matrixes.resize(controller.bones.size(), glm::mat4(1));
 
       AnimationController::Stance& stance = controller.stances[controller.states[controller.current].stance];
@@ -299,15 +301,15 @@ void AnimationApplicator::Update(Engine::EntityManager& entities, Engine::EventM
 
    entities.Each<Skeleton, VoxModel>([&](Engine::Entity, Skeleton& skeleton, VoxModel& model) {
       size_t nBones = skeleton.bones.size();
-      if (skeleton.bones.size() != model.mParts.size())
+      if (skeleton.bones.size() != model.mTransforms.size())
       {
          LOG_WARNING("Attached model and skeleton have a different amount of parts. Something may look strange");
-         nBones = std::min(skeleton.bones.size(), model.mParts.size());
+         nBones = std::min(skeleton.bones.size(), model.mTransforms.size());
       }
 
       for (size_t b = 0; b < nBones; ++b)
       {
-         model.mParts[b].transform = skeleton.bones[b].matrix;
+         model.mTransforms[b] = skeleton.bones[b].matrix;
       }
    });
 }
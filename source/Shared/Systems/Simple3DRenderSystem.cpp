@@ -82,6 +82,8 @@ void ShadedMesh::Set(
 
 std::unique_ptr<Engine::Graphics::Program> Simple3DRenderSystem::stupid = nullptr;
 std::unique_ptr<Engine::Graphics::Program> Simple3DRenderSystem::shaded = nullptr;
+Simple3DRenderSystem::Locations Simple3DRenderSystem::stupidLocations;
+Simple3DRenderSystem::Locations Simple3DRenderSystem::shadedLocations;
 
 Simple3DRenderSystem::Simple3DRenderSystem(Engine::Graphics::Camera* camera) : mCamera(camera)
 {
@@ -103,11 +105,12 @@ void Simple3DRenderSystem::Configure(Engine::EntityManager&, Engine::EventManage
         }
 
         stupid = std::move(*maybeProgram);
-        stupid->Attrib("aPosition");
-        stupid->Attrib("aColor");
-        stupid->Uniform("uProjMatrix");
-        stupid->Uniform("uViewMatrix");
-        stupid->Uniform("uModelMatrix");
+        stupidLocations.aPosition = stupid->Attrib("aPosition");
+        stupidLocations.aColor = stupid->Attrib("aColor");
+        stupidLocations.aOffset = stupid->Attrib("aOffset");
+        stupidLocations.projMatrix = stupid->GetUniform<glm::mat4>("uProjMatrix");
+        stupidLocations.viewMatrix = stupid->GetUniform<glm::mat4>("uViewMatrix");
+        stupidLocations.modelMatrix = stupid->GetUniform<glm::mat4>("uModelMatrix");
     }
 
     if (!shaded)
@@ -120,13 +123,12 @@ void Simple3DRenderSystem::Configure(Engine::EntityManager&, Engine::EventManage
         }
 
         shaded = std::move(*maybeProgram);
-        shaded->Attrib("aPosition");
-        shaded->Attrib("aColor");
-        shaded->Attrib("aNormal");
-        shaded->Attrib("aOcclusion");
-        shaded->Uniform("uProjMatrix");
-        shaded->Uniform("uViewMatrix");
-        shaded->Uniform("uModelMatrix");
+        shadedLocations.aPosition = shaded->Attrib("aPosition");
+        shadedLocations.aColor = shaded->Attrib("aColor");
+        shadedLocations.aNormal = shaded->Attrib("aNormal");
+        shadedLocations.projMatrix = shaded->GetUniform<glm::mat4>("uProjMatrix");
+        shadedLocations.viewMatrix = shaded->GetUniform<glm::mat4>("uViewMatrix");
+        shadedLocations.modelMatrix = shaded->GetUniform<glm::mat4>("uModelMatrix");
     }
 }
 
@@ -145,8 +147,8 @@ void Simple3DRenderSystem::Update(Engine::EntityManager& entities, Engine::Event
     std::unique_lock<std::mutex> lock{gSimple3DMutex};
     {
         BIND_PROGRAM_IN_SCOPE(stupid);
-        stupid->UniformMatrix4f("uProjMatrix", perspective);
-        stupid->UniformMatrix4f("uViewMatrix", view);
+        stupid->Set(stupidLocations.projMatrix, perspective);
+        stupid->Set(stupidLocations.viewMatrix, view);
 
         entities.Each<Transform, Simple3DRender>([&](Transform& transform, Simple3DRender& render) {
             if (render.mCount == 0)
@@ -159,11 +161,11 @@ void Simple3DRenderSystem::Update(Engine::EntityManager& entities, Engine::Event
                 glDisable(GL_CULL_FACE);
             }
 
-            render.mVertices.AttribPointer(stupid->Attrib("aPosition"), 3, GL_FLOAT, GL_FALSE, 0, 0);
-            render.mColors.AttribPointer(stupid->Attrib("aColor"), 3, GL_FLOAT, GL_FALSE, 0, 0);
+            render.mVertices.AttribPointer(stupidLocations.aPosition, 3, GL_FLOAT, GL_FALSE, 0, 0);
+            render.mColors.AttribPointer(stupidLocations.aColor, 3, GL_FLOAT, GL_FALSE, 0, 0);
 
             glm::mat4 model = transform.GetMatrix();
-            stupid->UniformMatrix4f("uModelMatrix", model);
+            stupid->Set(stupidLocations.modelMatrix, model);
 
             glDrawArrays(render.renderType, 0, GLsizei(render.mCount));
             glEnable(GL_CULL_FACE);
@@ -183,12 +185,12 @@ void Simple3DRenderSystem::Update(Engine::EntityManager& entities, Engine::Event
                 return;
             }
 
-            stupid->UniformMatrix4f("uModelMatrix", transform.GetMatrix());
+            stupid->Set(stupidLocations.modelMatrix, transform.GetMatrix());
 
-            render.mVertices.AttribPointer(stupid->Attrib("aPosition"), 3, GL_FLOAT, GL_FALSE, 0, 0);
-            render.mColors.AttribPointer(stupid->Attrib("aColor"), 3, GL_FLOAT, GL_FALSE, 0, 0);
-            render.mOffsets.AttribPointer(stupid->Attrib("aOffset"), 3, GL_FLOAT, GL_FALSE, 0, 0);
-            glVertexAttribDivisor(stupid->Attrib("aOffset"), 1);
+            render.mVertices.AttribPointer(stupidLocations.aPosition, 3, GL_FLOAT, GL_FALSE, 0, 0);
+            render.mColors.AttribPointer(stupidLocations.aColor, 3, GL_FLOAT, GL_FALSE, 0, 0);
+            render.mOffsets.AttribPointer(stupidLocations.aOffset, 3, GL_FLOAT, GL_FALSE, 0, 0);
+            glVertexAttribDivisor(stupidLocations.aOffset, 1);
 
             render.mIndices.Bind(VBOTarget::VertexIndices);
             glDrawElementsInstanced(render.renderType, GLsizei(render.mCount), GL_UNSIGNED_INT, nullptr, GLsizei(render.mInstances));
@@ -203,8 +205,8 @@ void Simple3DRenderSystem::Update(Engine::EntityManager& entities, Engine::Event
 
     {
         BIND_PROGRAM_IN_SCOPE(shaded);
-        shaded->UniformMatrix4f("uProjMatrix", perspective);
-        shaded->UniformMatrix4f("uViewMatrix", view);
+        shaded->Set(shadedLocations.projMatrix, perspective);
+        shaded->Set(shadedLocations.viewMatrix, view);
 
         entities.Each<Transform, ShadedMesh>([&](Transform& transform, ShadedMesh& mesh) {
             if (mesh.mIndexCount == 0)
@@ -217,11 +219,11 @@ void Simple3DRenderSystem::Update(Engine::EntityManager& entities, Engine::Event
                 return;
             }
 
-            shaded->UniformMatrix4f("uModelMatrix", transform.GetMatrix());
+            shaded->Set(shadedLocations.modelMatrix, transform.GetMatrix());
 
-            mesh.mVertices.AttribPointer(shaded->Attrib("aPosition"), 4, GL_FLOAT, GL_FALSE, 0, 0);
-            mesh.mColors.AttribPointer(shaded->Attrib("aColor"), 4, GL_FLOAT, GL_FALSE, 0, 0);
-            mesh.mNormals.AttribPointer(shaded->Attrib("aNormal"), 4, GL_FLOAT, GL_FALSE, 0, 0);
+            mesh.mVertices.AttribPointer(shadedLocations.aPosition, 4, GL_FLOAT, GL_FALSE, 0, 0);
+            mesh.mColors.AttribPointer(shadedLocations.aColor, 4, GL_FLOAT, GL_FALSE, 0, 0);
+            mesh.mNormals.AttribPointer(shadedLocations.aNormal, 4, GL_FLOAT, GL_FALSE, 0, 0);
 
             mesh.mIndices.Bind(VBOTarget::VertexIndices);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.mIndices.GetBuffer());
@@ -80,6 +80,21 @@ private:
 
     static std::unique_ptr<Engine::Graphics::Program> stupid;
     static std::unique_ptr<Engine::Graphics::Program> shaded;
+
+    // Resolved when the programs are loaded, so drawing never looks anything up by name.
+    struct Locations
+    {
+        Engine::Graphics::UniformHandle<glm::mat4> projMatrix;
+        Engine::Graphics::UniformHandle<glm::mat4> viewMatrix;
+        Engine::Graphics::UniformHandle<glm::mat4> modelMatrix;
+
+        GLuint aPosition;
+        GLuint aColor;
+        GLuint aNormal;
+        GLuint aOffset;
+    };
+    static Locations stupidLocations;
+    static Locations shadedLocations;
 };
 
 }; // namespace CubeWorld
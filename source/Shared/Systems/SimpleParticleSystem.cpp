@@ -421,16 +421,12 @@ void SimpleParticleSystem::RenderParticleSystem(
 
     for (const auto& [key, value] : system.uniforms.pairs())
     {
-        GLint uniform = system.program->Uniform(key.GetStringValue());
-        if (uniform < 0)
+        GLenum type = system.program->GetUniformType(key.GetStringValue());
+        if (type == GL_NONE)
         {
             continue;
         }
 
-        GLsizei uniformSize;
-        GLenum type;
-        glGetActiveUniform(system.program->GetID(), GLuint(uniform), 0, nullptr, &uniformSize, &type, nullptr);
-
         if (value.IsNumber() && (type == GL_FLOAT || type == GL_DOUBLE || type == GL_INT))
         {
             system.program->Uniform1f(key.GetStringValue(), value.GetFloatValue());
@@ -11,6 +11,7 @@
 #include <RGBLogger/Logger.h>
 #include <RGBDesignPatterns/Scope.h>
 #include <Engine/Graphics/Program.h>
+#include <Engine/Graphics/RenderQueue.h>
 #include <Shared/Helpers/Asset.h>
 
 #include "../Components/VoxModel.h"
@@ -34,16 +35,19 @@ VoxelRender::VoxelRender(const VoxelRender& other)
 void VoxelRender::Set(std::vector<Voxel::Data>&& voxels)
 {
    mSize = GLsizei(voxels.size());
-   mVoxelData.BufferData(sizeof(Voxel::Data) * voxels.size(), voxels.data(), GL_STATIC_DRAW);
+   mVoxelData.BufferData(Voxel::Pack(voxels));
 }
 
 void VoxelRender::Set(const std::vector<Voxel::Data>& voxels)
 {
    mSize = GLsizei(voxels.size());
-   mVoxelData.BufferData(sizeof(Voxel::Data) * voxels.size(), (void*)voxels.data(), GL_STATIC_DRAW);
+   mVoxelData.BufferData(Voxel::Pack(voxels));
 }
 
 std::unique_ptr<Engine::Graphics::Program> VoxelRenderSystem::program = nullptr;
+VoxelRenderSystem::Locations VoxelRenderSystem::locations;
+std::unique_ptr<Engine::Graphics::Program> VoxelRenderSystem::instancedProgram = nullptr;
+VoxelRenderSystem::InstancedLocations VoxelRenderSystem::instancedLocations;
 
 VoxelRenderSystem::VoxelRenderSystem(Engine::Graphics::Camera* camera) : mCamera(camera)
 {}
@@ -70,73 +74,135 @@ void VoxelRenderSystem::Reconfigure()
     }
 
     program = std::move(*maybeProgram);
-    program->Attrib("aPosition");
-    program->Attrib("aColor");
-    program->Attrib("aEnabledFaces");
-    program->Attrib("aOcclusion");
-    program->Uniform("uProjMatrix");
-    program->Uniform("uViewMatrix");
-    program->Uniform("uModelMatrix");
-    program->Uniform("uTint");
+    locations.layout.attributes = {
+        {program->Attrib("aPosition"), 1, GL_UNSIGNED_INT, sizeof(Voxel::PackedData), offsetof(Voxel::PackedData, position), 0, true},
+        {program->Attrib("aColor"), 1, GL_UNSIGNED_INT, sizeof(Voxel::PackedData), offsetof(Voxel::PackedData, color), 0, true},
+        {program->Attrib("aOcclusion"), 1, GL_UNSIGNED_SHORT, sizeof(Voxel::PackedData), offsetof(Voxel::PackedData, occlusion), 0, true},
+    };
+    locations.projMatrix = program->GetUniform<glm::mat4>("uProjMatrix");
+    locations.viewMatrix = program->GetUniform<glm::mat4>("uViewMatrix");
+    locations.modelMatrix = program->GetUniform<glm::mat4>("uModelMatrix");
+    locations.tint = program->GetUniform<glm::vec3>("uTint");
+
+    maybeProgram = Engine::Graphics::Program::Load(Asset::Shader("VoxelInstanced.vert"), Asset::Shader("Voxel.geom"), Asset::Shader("Voxel.frag"));
+    if (!maybeProgram)
+    {
+        LOG_ERROR(maybeProgram.Failure().WithContext("Failed loading instanced Voxel shader").GetMessage());
+        return;
+    }
+
+    instancedProgram = std::move(*maybeProgram);
+    instancedLocations.layout.attributes = {
+        {instancedProgram->Attrib("aPosition"), 1, GL_UNSIGNED_INT, sizeof(Voxel::PackedData), offsetof(Voxel::PackedData, position), 0, true},
+        {instancedProgram->Attrib("aColor"), 1, GL_UNSIGNED_INT, sizeof(Voxel::PackedData), offsetof(Voxel::PackedData, color), 0, true},
+        {instancedProgram->Attrib("aOcclusion"), 1, GL_UNSIGNED_SHORT, sizeof(Voxel::PackedData), offsetof(Voxel::PackedData, occlusion), 0, true},
+        {instancedProgram->Attrib("aTint"), 3, GL_FLOAT, sizeof(Instance), offsetof(Instance, tint), 1, false, GL_FALSE, 1},
+    };
+
+    // A mat4 attribute takes up four consecutive locations, one per column.
+    GLuint aModelMatrix = instancedProgram->Attrib("aModelMatrix");
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        instancedLocations.layout.attributes.push_back({aModelMatrix + column, 4, GL_FLOAT, sizeof(Instance), offsetof(Instance, model) + sizeof(glm::vec4) * column, 1, false, GL_FALSE, 1});
+    }
+
+    instancedLocations.projMatrix = instancedProgram->GetUniform<glm::mat4>("uProjMatrix");
+    instancedLocations.viewMatrix = instancedProgram->GetUniform<glm::mat4>("uViewMatrix");
 }
 
 using Engine::Transform;
 
-template<typename T, typename U> constexpr void* offsetOf(U T::* member)
-{
-    return &((T*)nullptr->*member);
-}
+// Beyond this, draws aren't sorted by distance any more.
+constexpr float kMaxSortDistance = 1024.0f;
 
 void VoxelRenderSystem::Update(Engine::EntityManager& entities, Engine::EventManager&, TIMEDELTA)
 {
-   BIND_PROGRAM_IN_SCOPE(program);
-
-   glm::mat4 perspective = mCamera->GetPerspective();
-   glm::mat4 view = mCamera->GetView();
-   program->UniformMatrix4f("uProjMatrix", perspective);
-   program->UniformMatrix4f("uViewMatrix", view);
+   using namespace Engine::Graphics;
 
    mClock.Reset();
+
+   glm::vec3 cameraPos = mCamera->GetPosition();
+   mQueue.Uniform(*program, locations.projMatrix, mCamera->GetPerspective());
+   mQueue.Uniform(*program, locations.viewMatrix, mCamera->GetView());
+
+   DrawCommand command;
+   command.program = program.get();
+   command.layout = &locations.layout;
+   command.mode = GL_POINTS;
+
+   // Sorting by buffer means entities sharing a model only set up their attributes once.
+   auto key = [&](GLuint buffer, const glm::mat4& matrix) {
+      uint32_t depth = RenderKey::QuantizeDepth(glm::length(glm::vec3(matrix[3]) - cameraPos), kMaxSortDistance);
+      return RenderKey::Make(0, program->GetID(), buffer, depth);
+   };
+
    entities.Each<Transform, VoxelRender>([&](Transform& transform, VoxelRender& render) {
-      render.mVoxelData.AttribPointer(program->Attrib("aPosition"), 3, GL_FLOAT, GL_FALSE, sizeof(Voxel::Data), (void*)0);
-      render.mVoxelData.AttribPointer(program->Attrib("aColor"), 3, GL_FLOAT, GL_FALSE, sizeof(Voxel::Data), (void*)(sizeof(float) * 3));
-      render.mVoxelData.AttribIPointer(program->Attrib("aEnabledFaces"), 1, GL_UNSIGNED_BYTE, sizeof(Voxel::Data), (void*)(sizeof(float) * 6));
-      render.mVoxelData.AttribIPointer(program->Attrib("aOcclusion"), 1, GL_UNSIGNED_INT, sizeof(Voxel::Data), offsetOf(&Voxel::Data::occlusion));
+      if (render.mSize == 0)
+      {
+         return;
+      }
 
       glm::mat4 model = transform.GetMatrix();
-      program->UniformMatrix4f("uModelMatrix", model);
-      program->UniformVector3f("uTint", glm::vec3(255.0f));
-
-      glDrawArrays(GL_POINTS, 0, render.mSize);
+      mQueue.Uniform(locations.modelMatrix, model);
+      mQueue.Uniform(locations.tint, glm::vec3(255.0f));
 
-      CHECK_GL_ERRORS();
+      command.buffers[0] = render.mVoxelData.GetBuffer();
+      command.first = 0;
+      command.count = render.mSize;
+      mQueue.Draw(key(command.buffers[0], model), command);
    });
 
+   // VoxModels are usually shared by many entities, so they're grouped by part and each
+   // group is drawn once, with the per-entity transforms and tints in an instance buffer.
+   mBatcher.Clear();
    entities.Each<Transform, VoxModel>([&](Transform& transform, VoxModel& voxModel) {
-      voxModel.mVBO.AttribPointer(program->Attrib("aPosition"), 3, GL_FLOAT, GL_FALSE, sizeof(Voxel::Data), (void*)0);
-      voxModel.mVBO.AttribPointer(program->Attrib("aColor"), 3, GL_FLOAT, GL_FALSE, sizeof(Voxel::Data), (void*)(sizeof(float) * 3));
-      voxModel.mVBO.AttribIPointer(program->Attrib("aEnabledFaces"), 1, GL_UNSIGNED_BYTE, sizeof(Voxel::Data), (void*)(sizeof(float) * 6));
-      voxModel.mVBO.AttribIPointer(program->Attrib("aOcclusion"), 1, GL_UNSIGNED_INT, sizeof(Voxel::Data), offsetOf(&Voxel::Data::occlusion));
+      if (voxModel.mModel == nullptr)
+      {
+         return;
+      }
 
       glm::mat4 matrix = transform.GetMatrix();
-
-      for (const VoxModel::Part& part : voxModel.mParts)
+      const std::vector<VoxModel::Part>& parts = voxModel.mModel->parts;
+      for (uint32_t i = 0; i < parts.size(); ++i)
       {
+         const VoxModel::Part& part = parts[i];
          if (part.size == 0 || part.hidden)
          {
             continue;
          }
 
-         glm::mat4 partMatrix = matrix * part.transform;
          glm::vec3 noTint = glm::vec3(255.0f);
+         mBatcher.Add(PartKey{voxModel.mModel, i}, Instance{matrix * voxModel.mTransforms[i], part.tintable ? voxModel.mTint : noTint});
+      }
+   });
+   mBatcher.Build();
+
+   if (instancedProgram && !mBatcher.GetBatches().empty())
+   {
+      mInstances.BufferData(mBatcher.GetInstances(), GL_STREAM_DRAW);
+      mQueue.Uniform(*instancedProgram, instancedLocations.projMatrix, mCamera->GetPerspective());
+      mQueue.Uniform(*instancedProgram, instancedLocations.viewMatrix, mCamera->GetView());
 
-         program->UniformMatrix4f("uModelMatrix", partMatrix);
-         program->UniformVector3f("uTint", part.tintable ? voxModel.mTint : noTint);
+      DrawCommand instanced;
+      instanced.program = instancedProgram.get();
+      instanced.layout = &instancedLocations.layout;
+      instanced.buffers[1] = mInstances.GetBuffer();
+      instanced.mode = GL_POINTS;
 
-         glDrawArrays(GL_POINTS, GLsizei(part.start), GLsizei(part.size));
-         CHECK_GL_ERRORS();
+      for (const auto& batch : mBatcher.GetBatches())
+      {
+         const VoxModel::Part& part = batch.key.model->parts[batch.key.part];
+
+         instanced.buffers[0] = batch.key.model->vbo.GetBuffer();
+         instanced.first = GLint(part.start);
+         instanced.count = GLsizei(part.size);
+         instanced.instances = GLsizei(batch.count);
+         instanced.baseInstance = batch.first;
+         mQueue.Draw(RenderKey::Make(0, instancedProgram->GetID(), instanced.buffers[0], 0), instanced);
       }
-   });
+   }
+
+   mQueue.Submit(mBackend);
    mClock.Elapsed();
 }
 
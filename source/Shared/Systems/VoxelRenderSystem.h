@@ -10,7 +10,9 @@
 #include <Engine/Core/Timer.h>
 #include <Engine/Entity/EntityManager.h>
 #include <Engine/Graphics/Camera.h>
+#include <Engine/Graphics/InstanceBatcher.h>
 #include <Engine/Graphics/Program.h>
+#include <Engine/Graphics/RenderQueue.h>
 #include <Engine/Graphics/VBO.h>
 #include <Engine/System/System.h>
 
@@ -20,6 +22,11 @@
 namespace CubeWorld
 {
 
+namespace Voxel
+{
+class VoxModel;
+}; // namespace Voxel
+
 struct VoxelRender : public Engine::Component<VoxelRender> {
    VoxelRender(std::vector<Voxel::Data>&& voxels);
    VoxelRender(const VoxelRender& other);
@@ -48,6 +55,64 @@ private:
 
    static std::unique_ptr<Engine::Graphics::Program> program;
 
+   // Resolved whenever the program is (re)loaded, so drawing never looks anything up by name.
+   struct Locations
+   {
+      Engine::Graphics::UniformHandle<glm::mat4> projMatrix;
+      Engine::Graphics::UniformHandle<glm::mat4> viewMatrix;
+      Engine::Graphics::UniformHandle<glm::mat4> modelMatrix;
+      Engine::Graphics::UniformHandle<glm::vec3> tint;
+
+      Engine::Graphics::VertexLayout layout;
+   };
+   static Locations locations;
+
+   static std::unique_ptr<Engine::Graphics::Program> instancedProgram;
+
+   struct InstancedLocations
+   {
+      Engine::Graphics::UniformHandle<glm::mat4> projMatrix;
+      Engine::Graphics::UniformHandle<glm::mat4> viewMatrix;
+
+      // Vertex data in buffer 0, per-instance data in buffer 1.
+      Engine::Graphics::VertexLayout layout;
+   };
+   static InstancedLocations instancedLocations;
+
+public:
+   // Per-instance data for instanced VoxModel parts.
+   struct Instance
+   {
+      glm::mat4 model;
+      glm::vec3 tint;
+   };
+
+   // One batch per part of each distinct model.
+   struct PartKey
+   {
+      const Voxel::VoxModel* model;
+      uint32_t part;
+
+      bool operator==(const PartKey& other) const { return model == other.model && part == other.part; }
+   };
+
+   struct PartKeyHash
+   {
+      size_t operator()(const PartKey& key) const
+      {
+         return std::hash<const void*>{}(key.model) ^ (size_t(key.part) * 0x9e3779b97f4a7c15ull);
+      }
+   };
+
+   using Batcher = Engine::Graphics::InstanceBatcher<PartKey, Instance, PartKeyHash>;
+
+private:
+   Batcher mBatcher;
+   Engine::Graphics::VBO mInstances;
+
+   Engine::Graphics::RenderQueue mQueue;
+   Engine::Graphics::GLRenderBackend mBackend;
+
 private:
    Engine::Timer<100> mClock;
 };
@@ -1,6 +1,7 @@
 // By Thomas Steinke
 
 #include <RGBLogger/Logger.h>
+#include <Engine/Core/Metrics.h>
 
 #include "../Event/NamedEvent.h"
 #include "AnimationSystem.h"
@@ -50,11 +51,11 @@ void WalkAnimationSystem::Update(Engine::EntityManager& entities, Engine::EventM
          anim.walkAnimationProgress = 0;
          if (debug)
          {
-            DebugHelper::Instance().SetMetric("speed", 0);
-            DebugHelper::Instance().SetMetric("walkAnimationProgress", anim.walkAnimationProgress);
-            DebugHelper::Instance().SetMetric("baseBlend", 0);
-            DebugHelper::Instance().SetMetric("walkBlend", 0);
-            DebugHelper::Instance().SetMetric("runBlend", 0);
+            METRIC_GAUGE("speed", 0);
+            METRIC_GAUGE("walkAnimationProgress", anim.walkAnimationProgress);
+            METRIC_GAUGE("baseBlend", 0);
+            METRIC_GAUGE("walkBlend", 0);
+            METRIC_GAUGE("runBlend", 0);
          }
          return;
       }
@@ -133,12 +134,12 @@ void WalkAnimationSystem::Update(Engine::EntityManager& entities, Engine::EventM
 
       if (debug)
       {
-         DebugHelper::Instance().SetMetric("cycleLength", cycleLength);
-         DebugHelper::Instance().SetMetric("speed", speed);
-         DebugHelper::Instance().SetMetric("walkAnimationProgress", anim.walkAnimationProgress);
-         DebugHelper::Instance().SetMetric("baseBlend", baseBlend);
-         DebugHelper::Instance().SetMetric("walkBlend", walkBlend);
-         DebugHelper::Instance().SetMetric("runBlend", runBlend);
+         METRIC_GAUGE("cycleLength", cycleLength);
+         METRIC_GAUGE("speed", speed);
+         METRIC_GAUGE("walkAnimationProgress", anim.walkAnimationProgress);
+         METRIC_GAUGE("baseBlend", baseBlend);
+         METRIC_GAUGE("walkBlend", walkBlend);
+         METRIC_GAUGE("runBlend", runBlend);
       }
 
       BlendState(include, anim, walk, walkBlend);
@@ -0,0 +1,105 @@
+// By Thomas Steinke
+
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+#include "Voxel.h"
+
+namespace CubeWorld
+{
+
+namespace Voxel
+{
+
+namespace
+{
+
+constexpr uint32_t kPositionBits = 10;
+constexpr uint32_t kPositionMask = (1 << kPositionBits) - 1;
+constexpr int32_t kPositionOffset = 1 << (kPositionBits - 1);
+
+uint32_t PackCoordinate(float value)
+{
+   int32_t halves = int32_t(std::round(value * 2.0f)) + kPositionOffset;
+   assert(halves >= 0 && halves <= int32_t(kPositionMask) && "Voxel position out of packable range");
+   return uint32_t(std::clamp(halves, 0, int32_t(kPositionMask)));
+}
+
+float UnpackCoordinate(uint32_t bits)
+{
+   return float(int32_t(bits & kPositionMask) - kPositionOffset) / 2.0f;
+}
+
+uint32_t PackChannel(float value)
+{
+   return uint32_t(std::clamp(std::round(value), 0.0f, 255.0f));
+}
+
+}; // anonymous namespace
+
+///
+///
+///
+PackedData Pack(const Data& voxel)
+{
+   PackedData packed;
+   packed.position = PackCoordinate(voxel.position.x) |
+                     (PackCoordinate(voxel.position.y) << kPositionBits) |
+                     (PackCoordinate(voxel.position.z) << (2 * kPositionBits));
+   packed.color = PackChannel(voxel.color.r) |
+                  (PackChannel(voxel.color.g) << 8) |
+                  (PackChannel(voxel.color.b) << 16) |
+                  (uint32_t(voxel.enabledFaces & All) << 24);
+
+   packed.occlusion = 0;
+   for (uint32_t corner = 0; corner < 8; ++corner)
+   {
+      uint32_t neighbors = (voxel.occlusion >> (28 - 4 * corner)) & 0xf;
+      uint32_t level = std::min((neighbors + 1) / 2, 3u);
+      packed.occlusion |= uint16_t(level << (14 - 2 * corner));
+   }
+   packed.padding = 0;
+   return packed;
+}
+
+///
+///
+///
+Data Unpack(const PackedData& packed)
+{
+   Data voxel;
+   voxel.position.x = UnpackCoordinate(packed.position);
+   voxel.position.y = UnpackCoordinate(packed.position >> kPositionBits);
+   voxel.position.z = UnpackCoordinate(packed.position >> (2 * kPositionBits));
+   voxel.color.r = float(packed.color & 0xff);
+   voxel.color.g = float((packed.color >> 8) & 0xff);
+   voxel.color.b = float((packed.color >> 16) & 0xff);
+   voxel.enabledFaces = uint8_t((packed.color >> 24) & All);
+
+   voxel.occlusion = 0;
+   for (uint32_t corner = 0; corner < 8; ++corner)
+   {
+      uint32_t level = (packed.occlusion >> (14 - 2 * corner)) & 0x3;
+      voxel.occlusion |= (level * 2) << (28 - 4 * corner);
+   }
+   return voxel;
+}
+
+///
+///
+///
+std::vector<PackedData> Pack(const std::vector<Data>& voxels)
+{
+   std::vector<PackedData> packed;
+   packed.reserve(voxels.size());
+   for (const Data& voxel : voxels)
+   {
+      packed.push_back(Pack(voxel));
+   }
+   return packed;
+}
+
+}; // namespace Voxel
+
+}; // namespace CubeWorld
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 #include <Engine/Graphics/VBO.h>
@@ -54,6 +55,32 @@ struct Data {
     uint32_t occlusion;
 };
 
+//
+// What actually gets uploaded to the GPU for each voxel: 12 bytes instead of Data's 32.
+//
+//   position:  x, y, z in 10 bits each, in half-voxel steps, covering [-256, 255.5]
+//   color:     r, g, b in 8 bits each, then enabledFaces in the top 6 bits
+//   occlusion: one 2-bit level per corner, in the same corner order as Data::occlusion
+//
+// Colors are kept at full precision, since palettes rarely survive being squeezed into
+// 16 bits. Occlusion levels are Data::occlusion's neighbor counts halved (rounding up)
+// and capped at 3; Unpack doubles them back.
+//
+struct PackedData {
+   uint32_t position;
+   uint32_t color;
+   uint16_t occlusion;
+   uint16_t padding;
+};
+
+static_assert(sizeof(PackedData) == 12);
+
+PackedData Pack(const Data& voxel);
+Data Unpack(const PackedData& packed);
+
+// Pack a whole model, ready for uploading.
+std::vector<PackedData> Pack(const std::vector<Data>& voxels);
+
 class ModelData {
 public:
    struct Metadata {
@@ -0,0 +1,135 @@
+// By Thomas Steinke
+
+#include "../catch.h"
+
+#include <random>
+
+#include <DataCLI/Scrambler.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+const uint32_t kReferenceOffsets[] = {
+   0x1092, 0x254F, 0x348, 0x14B40, 0x241A, 0x2676, 0x7F, 0x9, 0x250B,
+   0x18A, 0x7B, 0x12E2, 0x7EBC, 0x5F23, 0x981, 0x11, 0x85BA, 0x0A566,
+   0x1093, 0x0E, 0x2D266, 0x7C3, 0x0C16, 0x76D, 0x15D41, 0x12CD,
+   0x25, 0x8F, 0x0DA2, 0x4C1B, 0x53F, 0x1B0, 0x14AFC, 0x23E0, 0x258C,
+   0x4D1, 0x0D6A, 0x72F, 0x0BA8, 0x7C9, 0x0BA8, 0x131F, 0x0C75C7, 0x0D
+};
+
+//
+// The original Scrambler, kept verbatim as the reference for what the game's data
+// actually looks like.
+//
+void ReferenceScramble(char* data, size_t size)
+{
+   for (size_t i = 0; i < size; i++)
+   {
+      data[i] = (char)(-1 - data[i]);
+   }
+
+   for (size_t currOff = 0; currOff < size; currOff++)
+   {
+      size_t offset = (currOff + kReferenceOffsets[currOff % 44]) % size;
+
+      char temp = data[currOff];
+      data[currOff] = data[offset];
+      data[offset] = temp;
+   }
+}
+
+void ReferenceUnscramble(char* data, size_t size)
+{
+   for (int currOff = int(size) - 1; currOff >= 0; --currOff)
+   {
+      size_t offset = (currOff + kReferenceOffsets[currOff % 44]) % size;
+
+      char temp = data[currOff];
+      data[currOff] = data[offset];
+      data[offset] = temp;
+   }
+
+   for (size_t i = 0; i < size; i++)
+   {
+      data[i] = (char)(-1 - data[i]);
+   }
+}
+
+std::string RandomBlob(std::mt19937& random, size_t size)
+{
+   std::string result(size, '\0');
+   for (char& c : result)
+   {
+      c = char(random() & 0xff);
+   }
+   return result;
+}
+
+// Small sizes, sizes around the SIMD width, and sizes past the largest offset.
+std::vector<size_t> TestSizes()
+{
+   std::vector<size_t> sizes;
+   for (size_t size = 0; size <= 100; ++size)
+   {
+      sizes.push_back(size);
+   }
+   for (size_t size : {127, 128, 129, 1000, 4096, 65537, 0xC75C7, 0xC75C8, 1000000})
+   {
+      sizes.push_back(size);
+   }
+   return sizes;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Scrambler matches the original implementation") {
+   std::mt19937 random(0x5c7a);
+   Scrambler scrambler;
+
+   for (size_t size : TestSizes())
+   {
+      INFO("Size " << size);
+      std::string original = RandomBlob(random, size);
+
+      std::string expected = original;
+      std::string actual = original;
+      ReferenceScramble(&expected[0], size);
+      scrambler.Scramble(&actual[0], size);
+      REQUIRE(actual == expected);
+
+      ReferenceUnscramble(&expected[0], size);
+      scrambler.Unscramble(&actual[0], size);
+      REQUIRE(actual == expected);
+      REQUIRE(actual == original);
+   }
+}
+
+TEST_CASE("Scrambler round trips any data") {
+   std::mt19937 random(0xb10b);
+   Scrambler scrambler;
+
+   for (int i = 0; i < 200; ++i)
+   {
+      size_t size = random() % 5000;
+      std::string original = RandomBlob(random, size);
+      std::string data = original;
+
+      scrambler.Unscramble(&data[0], size);
+      scrambler.Scramble(&data[0], size);
+      REQUIRE(data == original);
+
+      scrambler.Scramble(&data[0], size);
+      if (size > 0)
+      {
+         // Inverting every byte always changes something.
+         CHECK(data != original);
+      }
+      scrambler.Unscramble(&data[0], size);
+      REQUIRE(data == original);
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,108 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <cmath>
+
+#include <Engine/Core/Clock.h>
+#include <Engine/Core/Timer.h>
+
+namespace CubeWorld
+{
+
+using Engine::FakeClock;
+using Engine::SteadyClock;
+using Engine::TSCClock;
+
+TEST_CASE("Timers run on the clock they're given") {
+   FakeClock clock;
+   Engine::Timer<4> timer(0.5, clock);
+
+   // Not past the gate yet.
+   clock.AdvanceSeconds(0.25);
+   CHECK(timer.Elapsed() == 0);
+
+   clock.AdvanceSeconds(0.5);
+   CHECK(timer.Elapsed() == Approx(0.75));
+   CHECK(timer.Average() == Approx(0.75 / 4));
+
+   clock.AdvanceSeconds(1.25);
+   CHECK(timer.Elapsed() == Approx(1.25));
+   CHECK(timer.Average() == Approx(2.0 / 4));
+
+   clock.AdvanceSeconds(3);
+   timer.Reset();
+   clock.AdvanceSeconds(0.5);
+   CHECK(timer.Elapsed() == Approx(0.5));
+}
+
+TEST_CASE("Window timers keep the spread") {
+   FakeClock clock(1000);
+   Engine::WindowTimer<8> timer(clock);
+   CHECK(timer.Count() == 0);
+   CHECK(timer.Percentile(0.5) == 0);
+
+   for (double ms : { 16, 17, 15, 16, 100, 16, 14, 18 })
+   {
+      clock.AdvanceSeconds(ms / 1000);
+      timer.Elapsed();
+   }
+
+   CHECK(timer.Count() == 8);
+   CHECK(timer.Min() == Approx(0.014));
+   CHECK(timer.Max() == Approx(0.1));
+   CHECK(timer.Average() == Approx(0.0265));
+   CHECK(timer.Percentile(0) == Approx(0.014));
+   CHECK(timer.Percentile(0.5) == Approx(0.016));
+   CHECK(timer.Percentile(0.75) == Approx(0.017));
+   CHECK(timer.Percentile(1) == Approx(0.1));
+
+   // The slow frame falls out of the window.
+   for (int i = 0; i < 8; ++i)
+   {
+      timer.Record(0.02);
+   }
+   CHECK(timer.Count() == 8);
+   CHECK(timer.Max() == Approx(0.02));
+
+   timer.Clear();
+   CHECK(timer.Count() == 0);
+   CHECK(timer.Average() == 0);
+}
+
+TEST_CASE("Real clocks are monotonic") {
+   SteadyClock steady;
+   TSCClock tsc(0.005);
+   INFO("TSC supported: " << TSCClock::IsSupported() << ", ticks per ns: " << tsc.GetTicksPerNanosecond());
+
+   uint64_t lastSteady = steady.NowNanoseconds();
+   uint64_t lastTSC = tsc.NowNanoseconds();
+   for (int i = 0; i < 100000; ++i)
+   {
+      const uint64_t nowSteady = steady.NowNanoseconds();
+      const uint64_t nowTSC = tsc.NowNanoseconds();
+      REQUIRE(nowSteady >= lastSteady);
+      REQUIRE(nowTSC >= lastTSC);
+      lastSteady = nowSteady;
+      lastTSC = nowTSC;
+   }
+
+   // Both line up with steady_clock, so they can be compared with each other.
+   const double drift = tsc.Now() - steady.Now();
+   CHECK(std::abs(drift) < 0.001);
+}
+
+TEST_CASE("Changing the default clock") {
+   FakeClock clock(5000000000);
+   Engine::Clock::SetDefault(&clock);
+   CHECK(Engine::Clock::Default().Now() == Approx(5.0));
+
+   Engine::Timer<1> timer;
+   clock.AdvanceSeconds(0.125);
+   CHECK(timer.Elapsed() == Approx(0.125));
+
+   Engine::Clock::SetDefault(nullptr);
+   CHECK(dynamic_cast<const SteadyClock*>(&Engine::Clock::Default()) != nullptr);
+}
+
+}; // namespace CubeWorld
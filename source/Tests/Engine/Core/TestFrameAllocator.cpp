@@ -0,0 +1,53 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <Engine/Core/FrameAllocator.h>
+
+namespace CubeWorld
+{
+
+using Engine::FrameVector;
+using Engine::LinearArena;
+
+TEST_CASE("LinearArena respects alignment") {
+   LinearArena arena(256);
+
+   arena.Allocate(1, 1);
+   void* aligned = arena.Allocate(16, 64);
+   CHECK(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+
+   // Bigger than a block, so it gets one of its own.
+   void* big = arena.Allocate(1000, 32);
+   CHECK(reinterpret_cast<uintptr_t>(big) % 32 == 0);
+}
+
+TEST_CASE("LinearArena coalesces blocks on reset") {
+   LinearArena arena(128);
+
+   for (int frame = 0; frame < 3; ++frame)
+   {
+      FrameVector<uint64_t> values(arena);
+      for (uint64_t i = 0; i < 100; ++i)
+      {
+         values.push_back(i);
+      }
+
+      for (uint64_t i = 0; i < 100; ++i)
+      {
+         CHECK(values[i] == i);
+      }
+
+      arena.Reset();
+      CHECK(arena.GetBytesUsed() == 0);
+   }
+
+   // After the first frame, everything should fit in one block.
+   size_t capacity = arena.GetCapacity();
+   FrameVector<uint64_t> values(arena);
+   values.reserve(100);
+   CHECK(arena.GetCapacity() == capacity);
+   CHECK(arena.GetHighWaterMark() <= capacity);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,50 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <Engine/Core/HeadlessInput.h>
+
+namespace CubeWorld
+{
+
+using Engine::HeadlessInput;
+
+TEST_CASE("HeadlessInput tracks the last key and mouse button") {
+   HeadlessInput input;
+
+   input.KeyDown(GLFW_KEY_LAST);
+   input.MouseDown(GLFW_MOUSE_BUTTON_LAST);
+   CHECK(input.IsKeyDown(GLFW_KEY_LAST));
+   CHECK(input.IsMouseDown(GLFW_MOUSE_BUTTON_LAST));
+
+   input.KeyUp(GLFW_KEY_LAST);
+   input.MouseUp(GLFW_MOUSE_BUTTON_LAST);
+   CHECK(!input.IsKeyDown(GLFW_KEY_LAST));
+   CHECK(!input.IsMouseDown(GLFW_MOUSE_BUTTON_LAST));
+}
+
+TEST_CASE("HeadlessInput ignores codes out of GLFW's range") {
+   HeadlessInput input;
+
+   int keyEvents = 0;
+   auto keyLink = input.OnKey([&](int, int, int) { ++keyEvents; });
+
+   for (int key : {GLFW_KEY_UNKNOWN, GLFW_KEY_LAST + 1})
+   {
+      input.KeyDown(key);
+      input.KeyRepeat(key);
+      CHECK(!input.IsKeyDown(key));
+      input.KeyUp(key);
+   }
+   CHECK(keyEvents == 0);
+
+   for (int button : {-1, GLFW_MOUSE_BUTTON_LAST + 1})
+   {
+      input.MouseDown(button);
+      CHECK(!input.IsMouseDown(button));
+      CHECK(!input.IsDragging(button));
+      input.MouseUp(button);
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,145 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <Engine/Core/HeadlessInput.h>
+#include <Engine/Core/InputRecording.h>
+
+namespace CubeWorld
+{
+
+using Engine::HeadlessInput;
+using Engine::InputPlayer;
+using Engine::InputRecorder;
+using Engine::InputRecording;
+
+TEST_CASE("InputRecording serialization round trip") {
+   InputRecording recording;
+   recording.frames.resize(3);
+   recording.frames[0].dt = 1.0 / 60.0;
+   recording.frames[1].dt = 1.0 / 30.0;
+   recording.frames[1].mouseMovement = {3.5, -2.0};
+   recording.frames[1].events.push_back({InputRecording::EventType::KeyDown, GLFW_MOD_SHIFT, GLFW_KEY_W});
+   recording.frames[1].events.push_back({InputRecording::EventType::Character, 0, 0x1F600});
+   recording.frames[2].dt = 0.25;
+   recording.frames[2].mouseScroll = {0, 1};
+   recording.frames[2].events.push_back({InputRecording::EventType::MouseDown, 0, GLFW_MOUSE_BUTTON_LEFT});
+
+   std::string data = recording.Serialize();
+   Maybe<InputRecording> result = InputRecording::Deserialize(data);
+   REQUIRE(result);
+
+   REQUIRE(result->frames.size() == recording.frames.size());
+   for (size_t i = 0; i < recording.frames.size(); ++i)
+   {
+      const InputRecording::Frame& expected = recording.frames[i];
+      const InputRecording::Frame& actual = result->frames[i];
+      CHECK(actual.dt == expected.dt);
+      CHECK(actual.mouseMovement == expected.mouseMovement);
+      CHECK(actual.mouseScroll == expected.mouseScroll);
+      REQUIRE(actual.events.size() == expected.events.size());
+      for (size_t j = 0; j < expected.events.size(); ++j)
+      {
+         CHECK(actual.events[j].type == expected.events[j].type);
+         CHECK(actual.events[j].mods == expected.events[j].mods);
+         CHECK(actual.events[j].code == expected.events[j].code);
+      }
+   }
+
+   SECTION("Truncated data is rejected") {
+      for (size_t length = 0; length < data.size(); ++length)
+      {
+         CHECK(!InputRecording::Deserialize(data.substr(0, length)));
+      }
+   }
+
+   SECTION("Trailing data is rejected") {
+      CHECK(!InputRecording::Deserialize(data + '\0'));
+   }
+}
+
+TEST_CASE("InputRecording counts that can't fit are rejected") {
+   // The frame count ends the header, and an empty frame ends with its event count.
+   std::string header = InputRecording{}.Serialize();
+   header.replace(header.size() - sizeof(uint32_t), sizeof(uint32_t), "\xff\xff\xff\x7f", sizeof(uint32_t));
+   CHECK(!InputRecording::Deserialize(header));
+
+   InputRecording recording;
+   recording.frames.resize(1);
+   std::string frame = recording.Serialize();
+   REQUIRE(frame.back() == '\0');
+   frame.pop_back();
+   frame += "\xff\xff\xff\xff\x0f";
+   CHECK(!InputRecording::Deserialize(frame));
+}
+
+TEST_CASE("InputRecording codes that can't be replayed are rejected") {
+   for (InputRecording::Event event : {
+      InputRecording::Event{InputRecording::EventType::KeyDown, 0, uint32_t(GLFW_KEY_UNKNOWN)},
+      InputRecording::Event{InputRecording::EventType::KeyRepeat, 0, GLFW_KEY_LAST + 1},
+      InputRecording::Event{InputRecording::EventType::MouseUp, 0, GLFW_MOUSE_BUTTON_LAST + 1},
+   })
+   {
+      InputRecording recording;
+      recording.frames.resize(1);
+      recording.frames[0].events.push_back(event);
+      CHECK(!InputRecording::Deserialize(recording.Serialize()));
+
+      recording.frames[0].events[0].code = 0;
+      CHECK(InputRecording::Deserialize(recording.Serialize()));
+   }
+}
+
+TEST_CASE("Unknown keys aren't recorded") {
+   HeadlessInput live;
+   InputRecorder recorder(live);
+
+   live.KeyDown(GLFW_KEY_UNKNOWN);
+   recorder.RecordFrame(0.5);
+
+   REQUIRE(recorder.GetRecording().frames.size() == 1);
+   CHECK(recorder.GetRecording().frames[0].events.empty());
+}
+
+TEST_CASE("Recorded input replays identically") {
+   HeadlessInput live;
+   InputRecorder recorder(live);
+
+   live.KeyDown(GLFW_KEY_A);
+   live.Type('a');
+   live.MoveMouse({10, 5});
+   live.Update();
+   recorder.RecordFrame(0.5);
+
+   live.MouseDown(GLFW_MOUSE_BUTTON_RIGHT);
+   live.KeyUp(GLFW_KEY_A);
+   live.Scroll({0, -1});
+   live.Update();
+   recorder.RecordFrame(0.25);
+
+   InputPlayer player{InputRecording(recorder.GetRecording())};
+   CHECK(player.GetFrameCount() == 2);
+
+   HeadlessInput replay;
+   std::vector<std::pair<int, int>> keys;
+   std::vector<unsigned int> characters;
+   auto keyLink = replay.OnKey([&](int key, int action, int) { keys.push_back({key, action}); });
+   auto charLink = replay.OnCharacter([&](unsigned int codePoint) { characters.push_back(codePoint); });
+
+   CHECK(player.PlayFrame(replay) == 0.5);
+   replay.Update();
+   CHECK(replay.IsKeyDown(GLFW_KEY_A));
+   CHECK(replay.GetMouseMovement() == glm::tvec2<double>(10, 5));
+
+   CHECK(player.PlayFrame(replay) == 0.25);
+   replay.Update();
+   CHECK(!replay.IsKeyDown(GLFW_KEY_A));
+   CHECK(replay.IsMouseDown(GLFW_MOUSE_BUTTON_RIGHT));
+   CHECK(replay.GetMouseScroll() == glm::tvec2<double>(0, -1));
+   CHECK(player.IsDone());
+
+   CHECK(keys == std::vector<std::pair<int, int>>{{GLFW_KEY_A, GLFW_PRESS}, {GLFW_KEY_A, GLFW_RELEASE}});
+   CHECK(characters == std::vector<unsigned int>{'a'});
+}
+
+}; // namespace CubeWorld
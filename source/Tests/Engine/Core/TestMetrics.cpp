@@ -0,0 +1,166 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <Engine/Core/Metrics.h>
+#include <RGBNetworking/JSONSerializer.h>
+
+namespace CubeWorld
+{
+
+using Engine::Metrics;
+
+namespace
+{
+
+const Metrics::HistogramSnapshot& FindHistogram(const Metrics::Snapshot& snapshot, const std::string& name)
+{
+   for (const auto& [histogramName, histogram] : snapshot.histograms)
+   {
+      if (histogramName == name)
+      {
+         return histogram;
+      }
+   }
+
+   FAIL("No histogram named " << name);
+   return snapshot.histograms.front().second;
+}
+
+int64_t FindCounter(const Metrics::Snapshot& snapshot, const std::string& name)
+{
+   for (const auto& [counterName, value] : snapshot.counters)
+   {
+      if (counterName == name)
+      {
+         return value;
+      }
+   }
+
+   FAIL("No counter named " << name);
+   return 0;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Histogram buckets cover every value") {
+   CHECK(Metrics::Histogram::BucketIndex(0) == 0);
+   CHECK(Metrics::Histogram::BucketIndex(31) == 31);
+
+   // Each bucket picks up right where the last one left off.
+   for (uint32_t i = 0; i + 1 < Metrics::Histogram::kBuckets; ++i)
+   {
+      CHECK(Metrics::Histogram::BucketHigh(i) == Metrics::Histogram::BucketLow(i + 1));
+   }
+
+   std::mt19937_64 random(1234);
+   for (int i = 0; i < 10000; ++i)
+   {
+      const uint64_t value = random() >> (random() % 48 + 16);
+      const uint32_t index = Metrics::Histogram::BucketIndex(value);
+      REQUIRE(index < Metrics::Histogram::kBuckets);
+      CHECK(Metrics::Histogram::BucketLow(index) <= value);
+      CHECK(value < Metrics::Histogram::BucketHigh(index));
+
+      // Within 1/16th.
+      CHECK(Metrics::Histogram::BucketHigh(index) - Metrics::Histogram::BucketLow(index) <= std::max(uint64_t(1), value / 16));
+   }
+
+   // Anything too big goes in the last bucket.
+   CHECK(Metrics::Histogram::BucketIndex(UINT64_MAX) == Metrics::Histogram::kBuckets - 1);
+}
+
+TEST_CASE("Histogram percentiles") {
+   Metrics::Histogram* histogram = Metrics::GetHistogram("Test percentiles");
+   CHECK(Metrics::GetHistogram("Test percentiles") == histogram);
+
+   for (uint64_t value = 1; value <= 100000; ++value)
+   {
+      histogram->Record(value);
+   }
+
+   const Metrics::Snapshot snapshot = Metrics::TakeSnapshot();
+   const Metrics::HistogramSnapshot& result = FindHistogram(snapshot, "Test percentiles");
+   CHECK(result.count == 100000);
+   CHECK(result.min == 1);
+   CHECK(result.max == 100000);
+   CHECK(result.Mean() == Approx(50000.5));
+
+   for (double p : { 0.5, 0.9, 0.99, 0.999 })
+   {
+      INFO(p);
+      CHECK(double(result.Percentile(p)) == Approx(p * 100000).epsilon(1.0 / 32));
+   }
+   CHECK(result.Percentile(0) == 1);
+   CHECK(result.Percentile(1) == 100000);
+}
+
+TEST_CASE("Recording metrics from several threads") {
+   Metrics::Counter* counter = Metrics::GetCounter("Test threads counter");
+   Metrics::Histogram* histogram = Metrics::GetHistogram("Test threads histogram");
+   const Metrics::Snapshot before = Metrics::TakeSnapshot();
+
+   const int kThreads = 6;
+   const int kCount = 20000;
+   std::vector<std::thread> threads;
+   for (int t = 0; t < kThreads; ++t)
+   {
+      threads.emplace_back([&, t] {
+         for (int i = 0; i < kCount; ++i)
+         {
+            counter->Add(2);
+            histogram->Record(uint64_t(t * 1000 + i % 1000));
+         }
+      });
+   }
+   for (std::thread& thread : threads)
+   {
+      thread.join();
+   }
+
+   const Metrics::Snapshot after = Metrics::TakeSnapshot();
+   CHECK(FindCounter(after, "Test threads counter") == 2 * kThreads * kCount);
+
+   const Metrics::HistogramSnapshot& result = FindHistogram(after, "Test threads histogram");
+   CHECK(result.count == kThreads * kCount);
+   CHECK(result.min == 0);
+   CHECK(result.max == (kThreads - 1) * 1000 + 999);
+
+   // Only what happened in between.
+   const Metrics::Snapshot interval = after.Since(before);
+   CHECK(FindCounter(interval, "Test threads counter") == 2 * kThreads * kCount);
+   CHECK(FindHistogram(interval, "Test threads histogram").count == kThreads * kCount);
+
+   const Metrics::Snapshot nothing = after.Since(after);
+   CHECK(FindCounter(nothing, "Test threads counter") == 0);
+   CHECK(FindHistogram(nothing, "Test threads histogram").Percentile(0.5) == 0);
+}
+
+TEST_CASE("Dumping metrics") {
+   Metrics::GetCounter("Test dump counter")->Add(3);
+   Metrics::GetGauge("Test dump gauge")->Set(0.25);
+   Metrics::GetHistogram("Test dump histogram")->RecordSeconds(0.002);
+
+   const Metrics::Snapshot snapshot = Metrics::TakeSnapshot();
+
+   const std::string text = snapshot.ToText();
+   CHECK(text.find("Test dump counter: 3\n") != std::string::npos);
+   CHECK(text.find("Test dump gauge: 0.25\n") != std::string::npos);
+   CHECK(text.find("Test dump histogram: p50 2.00ms | p90 2.00ms | p99 2.00ms | max 2.00ms (1)\n") != std::string::npos);
+
+   Maybe<std::string> json = JSONSerializer::Serialize(snapshot.Serialize());
+   REQUIRE(json);
+   Maybe<BindingProperty> parsed = JSONSerializer::Deserialize(*json);
+   REQUIRE(parsed);
+   const BindingProperty& dump = *parsed;
+   CHECK(dump["counters"]["Test dump counter"].GetIntValue() == 3);
+   CHECK(dump["gauges"]["Test dump gauge"].GetDoubleValue() == 0.25);
+   CHECK(dump["histograms"]["Test dump histogram"]["count"].GetUintValue() == 1);
+   CHECK(dump["histograms"]["Test dump histogram"]["p99"].GetUint64Value() == 2000000);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,46 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <Engine/Graphics/InstanceBatcher.h>
+
+namespace CubeWorld
+{
+
+using Engine::Graphics::InstanceBatcher;
+
+TEST_CASE("InstanceBatcher groups instances by key") {
+   InstanceBatcher<uint32_t, int> batcher;
+
+   batcher.Add(7, 1);
+   batcher.Add(3, 2);
+   batcher.Add(7, 3);
+   batcher.Add(5, 4);
+   batcher.Add(3, 5);
+   batcher.Add(7, 6);
+   batcher.Build();
+
+   const auto& batches = batcher.GetBatches();
+   REQUIRE(batches.size() == 3);
+
+   // Batches are in order of first appearance, and instances keep their order within a batch.
+   CHECK(batches[0].key == 7);
+   CHECK(batches[0].first == 0);
+   CHECK(batches[0].count == 3);
+   CHECK(batches[1].key == 3);
+   CHECK(batches[1].first == 3);
+   CHECK(batches[1].count == 2);
+   CHECK(batches[2].key == 5);
+   CHECK(batches[2].first == 5);
+   CHECK(batches[2].count == 1);
+   CHECK(batcher.GetInstances() == std::vector<int>{1, 3, 6, 2, 5, 4});
+
+   batcher.Clear();
+   batcher.Add(5, 7);
+   batcher.Build();
+   REQUIRE(batcher.GetBatches().size() == 1);
+   CHECK(batcher.GetBatches()[0].count == 1);
+   CHECK(batcher.GetInstances() == std::vector<int>{7});
+}
+
+}; // namespace CubeWorld
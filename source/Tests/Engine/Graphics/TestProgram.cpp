@@ -0,0 +1,102 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+#include "../../Mocks/MockGL.h"
+
+#include <Engine/Graphics/Program.h>
+
+namespace CubeWorld
+{
+
+using Engine::Graphics::Program;
+using Engine::Graphics::UniformHandle;
+using Test::MockGL;
+
+TEST_CASE("Program resolves locations once") {
+   MockGL gl;
+   gl.SetUniforms({
+      {"uProjMatrix", GL_FLOAT_MAT4},
+      {"uTint", GL_FLOAT_VEC3},
+      {"uBones[0]", GL_FLOAT_MAT4, 8},
+   });
+   gl.SetAttributes({
+      {"aPosition", GL_FLOAT_VEC3},
+      {"aColor", GL_FLOAT_VEC3},
+   });
+
+   Program program(1);
+   program.ResolveLocations();
+   size_t queries = gl.GetLocationQueries();
+
+   CHECK(program.Uniform("uProjMatrix") == 0);
+   CHECK(program.Uniform("uTint") == 1);
+   CHECK(program.Uniform("uBones") == 2);
+   CHECK(program.Uniform("uBones[0]") == 2);
+   CHECK(program.Attrib("aPosition") == 0);
+   CHECK(program.Attrib("aColor") == 1);
+   CHECK(program.GetUniformType("uTint") == GL_FLOAT_VEC3);
+   CHECK(gl.GetLocationQueries() == queries);
+
+   SECTION("Missing names are only queried once") {
+      CHECK(program.Uniform("uMissing") == -1);
+      CHECK(!program.GetUniform<float>("uMissing").IsValid());
+      CHECK(program.GetUniformType("uMissing") == GL_NONE);
+      CHECK(gl.GetLocationQueries() == queries + 1);
+
+      CHECK(program.Attrib("aMissing") == GLuint(-1));
+      CHECK(program.Attrib("aMissing") == GLuint(-1));
+      CHECK(gl.GetLocationQueries() == queries + 2);
+   }
+}
+
+TEST_CASE("Program skips redundant uniform updates") {
+   MockGL gl;
+   gl.SetUniforms({
+      {"uModelMatrix", GL_FLOAT_MAT4},
+      {"uTint", GL_FLOAT_VEC3},
+      {"uTexture", GL_SAMPLER_2D},
+   });
+
+   Program program(1);
+   program.ResolveLocations();
+
+   UniformHandle<glm::mat4> model = program.GetUniform<glm::mat4>("uModelMatrix");
+   UniformHandle<glm::vec3> tint = program.GetUniform<glm::vec3>("uTint");
+   REQUIRE(model.IsValid());
+   REQUIRE(tint.IsValid());
+
+   program.Set(model, glm::mat4(1));
+   program.Set(tint, glm::vec3(255));
+   REQUIRE(gl.GetUniformCalls().size() == 2);
+   CHECK(gl.GetUniformCalls()[0].function == "glUniformMatrix4fv");
+   CHECK(gl.GetUniformCalls()[0].location == 0);
+   CHECK(gl.GetUniformCalls()[1].function == "glUniform3fv");
+   CHECK(gl.GetUniformCalls()[1].location == 1);
+   gl.ClearUniformCalls();
+
+   // Same values: no driver calls.
+   program.Set(model, glm::mat4(1));
+   program.Set(tint, glm::vec3(255));
+   program.UniformVector3f("uTint", glm::vec3(255));
+   CHECK(gl.GetUniformCalls().empty());
+
+   // Changed values go through, whichever API sets them.
+   program.Set(model, glm::mat4(2));
+   program.Uniform3f("uTint", 1, 2, 3);
+   program.Uniform1i("uTexture", 0);
+   CHECK(gl.GetUniformCalls().size() == 3);
+   gl.ClearUniformCalls();
+
+   // Invalid handles are ignored, like location -1.
+   program.Set(UniformHandle<float>{}, 1.0f);
+   program.Uniform1f("uMissing", 1.0f);
+   CHECK(gl.GetUniformCalls().empty());
+
+   // After invalidating, everything gets sent again.
+   program.InvalidateUniformCache();
+   program.Set(model, glm::mat4(2));
+   program.Uniform1i("uTexture", 0);
+   CHECK(gl.GetUniformCalls().size() == 2);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,129 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <Engine/Graphics/RenderQueue.h>
+
+namespace CubeWorld
+{
+
+using Engine::Graphics::DrawCommand;
+using Engine::Graphics::Program;
+using Engine::Graphics::RenderBackend;
+using Engine::Graphics::RenderKey;
+using Engine::Graphics::RenderQueue;
+using Engine::Graphics::UniformHandle;
+using Engine::Graphics::UniformWrite;
+using Engine::Graphics::VertexLayout;
+
+namespace
+{
+
+//
+// Records what the queue asked for, without touching GL.
+//
+class RecordingBackend : public RenderBackend
+{
+public:
+   void BindProgram(Program& program) override { programs.push_back(&program); }
+   void BindVertices(Program&, const DrawCommand& command) override { buffers.push_back(command.buffers[0]); }
+   void SetUniform(Program&, const UniformWrite& write, const void* data) override
+   {
+      uniforms.push_back(std::make_pair(write.index, *static_cast<const float*>(data)));
+   }
+   void Draw(const DrawCommand& command) override { draws.push_back(command.first); }
+   void Finish() override { ++finished; }
+
+   std::vector<Program*> programs;
+   std::vector<GLuint> buffers;
+   std::vector<std::pair<uint32_t, float>> uniforms;
+   std::vector<GLint> draws;
+   int finished = 0;
+};
+
+DrawCommand MakeDraw(Program& program, const VertexLayout& layout, GLuint buffer, GLint first)
+{
+   DrawCommand command;
+   command.program = &program;
+   command.layout = &layout;
+   command.buffers[0] = buffer;
+   command.first = first;
+   return command;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("RenderQueue sorts by key and keeps ties in order") {
+   Program program(0);
+   VertexLayout layout;
+   RenderQueue queue;
+   RecordingBackend backend;
+
+   queue.Draw(RenderKey::Make(1, 0, 0, 0), MakeDraw(program, layout, 1, 0));
+   queue.Draw(RenderKey::Make(0, 0, 0, 5), MakeDraw(program, layout, 1, 1));
+   queue.Draw(RenderKey::Make(0, 0, 0, 2), MakeDraw(program, layout, 1, 2));
+   queue.Draw(RenderKey::Make(0, 0, 0, 5), MakeDraw(program, layout, 1, 3));
+   queue.Draw(RenderKey::Make(0, 0, 0, 2), MakeDraw(program, layout, 1, 4));
+
+   RenderQueue::Stats stats = queue.Submit(backend);
+   CHECK(stats.draws == 5);
+   CHECK(backend.draws == std::vector<GLint>{2, 4, 1, 3, 0});
+   CHECK(backend.finished == 1);
+   CHECK(queue.GetSize() == 0);
+}
+
+TEST_CASE("RenderQueue drops redundant state changes") {
+   Program first(0), second(0);
+   VertexLayout layout;
+   RenderQueue queue;
+   RecordingBackend backend;
+
+   // Interleaved on purpose; sorting should group them back up.
+   queue.Draw(RenderKey::Make(0, 1, 7, 0), MakeDraw(first, layout, 7, 0));
+   queue.Draw(RenderKey::Make(0, 2, 7, 0), MakeDraw(second, layout, 7, 1));
+   queue.Draw(RenderKey::Make(0, 1, 8, 0), MakeDraw(first, layout, 8, 2));
+   queue.Draw(RenderKey::Make(0, 2, 7, 1), MakeDraw(second, layout, 7, 3));
+   queue.Draw(RenderKey::Make(0, 1, 7, 1), MakeDraw(first, layout, 7, 4));
+
+   RenderQueue::Stats stats = queue.Submit(backend);
+   CHECK(stats.draws == 5);
+   CHECK(stats.programBinds == 2);
+   CHECK(stats.vertexBinds == 3);
+   CHECK(backend.programs == std::vector<Program*>{&first, &second});
+   CHECK(backend.buffers == std::vector<GLuint>{7, 8, 7});
+   CHECK(backend.draws == std::vector<GLint>{0, 4, 2, 1, 3});
+}
+
+TEST_CASE("RenderQueue applies uniforms to the right draws") {
+   Program first(0), second(0);
+   VertexLayout layout;
+   RenderQueue queue;
+   RecordingBackend backend;
+
+   UniformHandle<float> camera{0};
+   UniformHandle<float> model{1};
+
+   queue.Uniform(first, camera, 10.0f);
+   queue.Uniform(second, camera, 20.0f);
+
+   queue.Uniform(model, 2.0f);
+   queue.Draw(RenderKey::Make(0, 2, 0, 0), MakeDraw(first, layout, 1, 0));
+
+   // Invalid handles are ignored.
+   queue.Uniform(UniformHandle<float>{}, 3.0f);
+   queue.Draw(RenderKey::Make(0, 1, 0, 0), MakeDraw(second, layout, 1, 1));
+
+   queue.Uniform(model, 4.0f);
+   queue.Draw(RenderKey::Make(0, 2, 0, 1), MakeDraw(first, layout, 1, 2));
+
+   RenderQueue::Stats stats = queue.Submit(backend);
+   CHECK(stats.uniformWrites == 4);
+   CHECK(backend.draws == std::vector<GLint>{1, 0, 2});
+   CHECK(backend.uniforms == std::vector<std::pair<uint32_t, float>>{
+      {0, 20.0f},
+      {0, 10.0f}, {1, 2.0f},
+      {1, 4.0f},
+   });
+}
+
+}; // namespace CubeWorld
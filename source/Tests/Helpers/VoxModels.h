@@ -0,0 +1,62 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include "../catch.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBText/StringHelper.h>
+#include <Shared/Helpers/Asset.h>
+
+namespace CubeWorld
+{
+
+namespace Test
+{
+
+//
+// For tests and benchmarks that run over every model the game ships with. Both fail
+// the current test if Assets/Models can't be read or has no .vox files.
+//
+
+// Path to every .vox file in Assets/Models.
+inline std::vector<std::string> ListAllVoxModels()
+{
+   DiskFileSystem fs;
+   std::vector<std::string> result;
+
+   Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(Asset::Model(""), false, false);
+   REQUIRE(entries);
+   for (const FileSystem::FileEntry& entry : *entries)
+   {
+      if (StringHelper::EndsWith(entry.name, ".vox"))
+      {
+         result.push_back(Asset::Model(entry.name));
+      }
+   }
+
+   REQUIRE(!result.empty());
+   return result;
+}
+
+// Path and contents of every .vox file in Assets/Models.
+inline std::vector<std::pair<std::string, std::string>> ReadAllVoxModels()
+{
+   DiskFileSystem fs;
+   std::vector<std::pair<std::string, std::string>> result;
+   for (const std::string& path : ListAllVoxModels())
+   {
+      Maybe<std::string> contents = fs.ReadEntireFile(path);
+      REQUIRE(contents);
+      result.emplace_back(path, std::move(*contents));
+   }
+   return result;
+}
+
+}; // namespace Test
+
+}; // namespace CubeWorld
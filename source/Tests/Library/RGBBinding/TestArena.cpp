@@ -0,0 +1,120 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <string>
+
+#include <RGBBinding/Arena.h>
+#include <RGBBinding/BindingPropertyReader.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+// Long enough that none of the strings fit inside a property.
+std::string MakeDocument(size_t numBones)
+{
+   std::string document = "{\"name\": \"a skeleton with a long name\", \"bones\": [";
+   for (size_t i = 0; i < numBones; ++i)
+   {
+      document += i > 0 ? ", " : "";
+      document += "{\"name\": \"bone number " + std::to_string(i) + " of the skeleton\", "
+                  "\"position\": [" + std::to_string(i) + ", 2.5, -3], "
+                  "\"parent\": \"the parent of bone number " + std::to_string(i) + "\"}";
+   }
+   return document + "]}";
+}
+
+void CheckDocument(const BindingProperty& document, size_t numBones)
+{
+   REQUIRE(document.IsObject());
+   CHECK(document["name"].GetStringValue() == "a skeleton with a long name");
+   REQUIRE(document["bones"].GetSize() == numBones);
+   for (size_t i = 0; i < numBones; ++i)
+   {
+      const BindingProperty& bone = document["bones"][i];
+      CHECK(bone["name"].GetStringValue() == "bone number " + std::to_string(i) + " of the skeleton");
+      CHECK(bone["position"].GetVec3() == glm::vec3(i, 2.5, -3));
+      CHECK(bone["parent"].GetStringValue() == "the parent of bone number " + std::to_string(i));
+   }
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Blocks come from the current arena") {
+   RGBBinding::Arena arena;
+
+   void* heapBlock = RGBBinding::AllocateBlock(32, RGBBinding::Arena::GetCurrent());
+   CHECK(RGBBinding::GetBlockHeader(heapBlock)->arena == nullptr);
+   CHECK(arena.GetBytesUsed() == 0);
+
+   {
+      RGBBinding::Arena::Scope scope(&arena);
+      CHECK(RGBBinding::Arena::GetCurrent() == &arena);
+
+      void* arenaBlock = RGBBinding::AllocateBlock(32, RGBBinding::Arena::GetCurrent());
+      CHECK(RGBBinding::GetBlockHeader(arenaBlock)->arena == &arena);
+      CHECK(RGBBinding::GetBlockHeader(arenaBlock)->size == 32);
+      CHECK(arena.GetBytesUsed() >= 32);
+
+      {
+         RGBBinding::Arena::Scope heap(nullptr);
+         CHECK(RGBBinding::Arena::GetCurrent() == nullptr);
+      }
+      CHECK(RGBBinding::Arena::GetCurrent() == &arena);
+
+      // Freeing an arena block leaves it to the arena.
+      RGBBinding::FreeBlock(arenaBlock);
+   }
+
+   CHECK(RGBBinding::Arena::GetCurrent() == nullptr);
+   RGBBinding::FreeBlock(heapBlock);
+}
+
+TEST_CASE("Parsing into an arena") {
+   // Fills the bones array to capacity, so adding one more has to grow it.
+   const size_t numBones = 64;
+   const std::string json = MakeDocument(numBones);
+
+   RGBBinding::Arena arena;
+   BindingProperty document = BindingPropertyReader{&arena}.Read(json);
+   CheckDocument(document, numBones);
+
+   // Every string, array and object went to the arena.
+   CHECK(arena.GetBytesUsed() > json.size());
+   CHECK(RGBBinding::Arena::GetCurrent() == nullptr);
+
+   SECTION("Copies outlive the arena") {
+      BindingProperty copy;
+      {
+         RGBBinding::Arena temporary;
+         BindingProperty parsed = BindingPropertyReader{&temporary}.Read(json);
+         copy = parsed;
+      }
+      CheckDocument(copy, numBones);
+   }
+
+   SECTION("Changing a parsed document") {
+      size_t used = arena.GetBytesUsed();
+
+      document["bones"].PushBack(BindingProperty("one more bone, on the heap this time"));
+      document["bones"][0]["name"] = "renamed, and still far too long to be inline";
+      document["name"] = "short";
+
+      CHECK(document["bones"].GetSize() == numBones + 1);
+      CHECK(document["bones"][numBones].GetStringValue() == "one more bone, on the heap this time");
+      CHECK(document["bones"][0]["name"].GetStringValue() == "renamed, and still far too long to be inline");
+      CHECK(document["name"].GetStringValue() == "short");
+
+      // Only the array that grew stays in the arena. New values are on the heap.
+      CHECK(arena.GetBytesUsed() > used);
+   }
+
+   SECTION("Matches a document parsed onto the heap") {
+      CHECK(document == BindingPropertyReader{}.Read(json));
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,168 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <string>
+#include <vector>
+
+#include <RGBBinding/BindingProperty.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+std::vector<std::string> MakeKeys(size_t count)
+{
+   std::vector<std::string> keys;
+   for (size_t i = 0; i < count; ++i)
+   {
+      keys.push_back("key" + std::to_string(i));
+   }
+   return keys;
+}
+
+BindingProperty MakeObject(const std::vector<std::string>& keys)
+{
+   BindingProperty object;
+   for (size_t i = 0; i < keys.size(); ++i)
+   {
+      object[keys[i]] = uint32_t(i);
+   }
+   return object;
+}
+
+// Every key is found, in order, and nothing else is.
+void CheckObject(const BindingProperty& object, const std::vector<std::string>& keys)
+{
+   REQUIRE(object.GetSize() == keys.size());
+
+   size_t i = 0;
+   for (const auto& [key, value] : object.pairs())
+   {
+      CHECK(key.GetStringValue() == keys[i]);
+      CHECK(value.GetUintValue() == i);
+      ++i;
+   }
+
+   for (size_t i = 0; i < keys.size(); ++i)
+   {
+      INFO(keys[i]);
+      CHECK(object.Has(keys[i]));
+      CHECK(object[keys[i]].GetUintValue() == i);
+      CHECK(object[BindingProperty::Key(keys[i])].GetUintValue() == i);
+      CHECK(object.Find(keys[i])->key == keys[i]);
+   }
+
+   CHECK(!object.Has("missing"));
+   CHECK(!object.Has(BindingProperty::Key("missing")));
+   CHECK(object["missing"].IsNull());
+   CHECK(object.Find("missing") == object.end_object());
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Objects find their keys at any size") {
+   for (size_t count : {1, 15, 16, 17, 100, 1000})
+   {
+      INFO(count << " keys");
+      std::vector<std::string> keys = MakeKeys(count);
+      CheckObject(MakeObject(keys), keys);
+   }
+}
+
+TEST_CASE("Indexed objects keep their index through changes") {
+   std::vector<std::string> keys = MakeKeys(40);
+   BindingProperty object = MakeObject(keys);
+
+   SECTION("Copying") {
+      BindingProperty copy = object;
+      CheckObject(copy, keys);
+      CHECK(copy == object);
+   }
+
+   SECTION("Moving") {
+      BindingProperty moved = std::move(object);
+      CheckObject(moved, keys);
+   }
+
+   SECTION("Popping") {
+      // Down past the point where the index is dropped.
+      while (keys.size() > 10)
+      {
+         object.PopBack();
+         keys.pop_back();
+         CheckObject(object, keys);
+      }
+   }
+
+   SECTION("Inserting with interned keys") {
+      BindingProperty::Key key("interned");
+      object[key] = uint32_t(keys.size());
+      keys.push_back("interned");
+      CheckObject(object, keys);
+
+      // Finding it again doesn't add a second copy.
+      object[key] = uint32_t(keys.size() - 1);
+      CheckObject(object, keys);
+   }
+}
+
+TEST_CASE("Properties are 16 bytes") {
+   CHECK(sizeof(BindingProperty) == 16);
+}
+
+TEST_CASE("Strings survive being stored inline or out of line") {
+   // Either side of the longest string that fits inside the property.
+   for (size_t length : {0, 1, 12, 13, 14, 100})
+   {
+      INFO(length << " characters");
+      std::string string(length, 'x');
+      for (size_t i = 0; i < length; ++i)
+      {
+         string[i] = char('a' + i % 26);
+      }
+
+      BindingProperty property(string);
+      CHECK(property.IsString());
+      CHECK(property.GetType() == BindingProperty::Type::String);
+      CHECK(property.GetStringValue() == string);
+      CHECK(property.GetStringView() == std::string_view(string));
+      CHECK(property.GetStringView().data()[length] == '\0');
+
+      BindingProperty copy = property;
+      CHECK(copy == property);
+      CHECK(copy.GetStringValue() == string);
+
+      BindingProperty moved = std::move(copy);
+      CHECK(moved.GetStringValue() == string);
+      CHECK(copy.IsNull());
+
+      BindingProperty other("something else entirely, and long");
+      other = property;
+      CHECK(other.GetStringValue() == string);
+   }
+
+   CHECK(BindingProperty(BindingProperty::Type::String).GetStringValue() == "");
+   CHECK(BindingProperty(5).GetStringView("default") == std::string_view("default"));
+}
+
+TEST_CASE("Assigning a child to its parent") {
+   BindingProperty parent;
+   parent["child"]["name"] = "a name long enough to need its own block";
+   parent["other"] = 5;
+
+   SECTION("By copy") {
+      parent = parent["child"];
+   }
+
+   SECTION("By move") {
+      parent = std::move(parent["child"]);
+   }
+
+   CHECK(parent.GetSize() == 1);
+   CHECK(parent["name"].GetStringValue() == "a name long enough to need its own block");
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,346 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <RGBBinding/BindingPropertyConsumer.h>
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBNetworking/BinarySerializer.h>
+#include <RGBNetworking/JSONSerializer.h>
+#include <RGBNetworking/YAMLSerializer.h>
+#include <Shared/Helpers/Asset.h>
+
+namespace CubeWorld
+{
+
+enum class StreamedShape
+{
+   Cube, Sphere
+};
+
+struct StreamedPart
+{
+   std::string name;
+   StreamedShape shape = StreamedShape::Cube;
+   glm::vec3 position{7};
+   std::vector<int> tags;
+};
+
+struct StreamedModel
+{
+   std::string name;
+   double scale = 1.0;
+   uint32_t count = 0;
+   bool visible = false;
+   std::vector<StreamedPart> parts;
+   std::map<std::string, glm::vec3> offsets;
+   std::unordered_map<std::string, std::string> properties;
+   std::optional<int> lod;
+
+   const glm::vec4& GetColor() const { return color; }
+   void SetColor(const glm::vec4& color_) { color = color_; }
+   glm::vec4 color{0};
+};
+
+// Shaped like the skeleton assets.
+struct StreamedStance
+{
+   std::string name;
+   std::string parent;
+   std::map<std::string, std::string> parents;
+   std::map<std::string, glm::vec3> positions;
+   std::map<std::string, glm::vec3> rotations;
+   std::map<std::string, glm::vec3> scales;
+};
+
+struct StreamedSkeleton
+{
+   std::string name;
+   std::string parent;
+   std::string defaultModel;
+   std::vector<StreamedStance> stances;
+};
+
+}; // namespace CubeWorld
+
+namespace meta
+{
+
+using namespace CubeWorld;
+
+template<>
+inline auto registerValues<StreamedShape>()
+{
+   return values(
+      value("Cube", StreamedShape::Cube),
+      value("Sphere", StreamedShape::Sphere)
+   );
+}
+
+template<>
+inline auto registerMembers<StreamedPart>()
+{
+   return members(
+      member("name", &StreamedPart::name),
+      member("shape", &StreamedPart::shape),
+      member("position", &StreamedPart::position),
+      member("tags", &StreamedPart::tags)
+   );
+}
+
+template<>
+inline auto registerMembers<StreamedModel>()
+{
+   return members(
+      member("name", &StreamedModel::name),
+      member("scale", &StreamedModel::scale),
+      member("count", &StreamedModel::count),
+      member("visible", &StreamedModel::visible),
+      member("parts", &StreamedModel::parts),
+      member("offsets", &StreamedModel::offsets),
+      member("properties", &StreamedModel::properties),
+      member("lod", &StreamedModel::lod),
+      member("color", &StreamedModel::GetColor, &StreamedModel::SetColor)
+   );
+}
+
+template<>
+inline auto registerMembers<StreamedStance>()
+{
+   return members(
+      member("name", &StreamedStance::name),
+      member("parent", &StreamedStance::parent),
+      member("parents", &StreamedStance::parents),
+      member("positions", &StreamedStance::positions),
+      member("rotations", &StreamedStance::rotations),
+      member("scales", &StreamedStance::scales)
+   );
+}
+
+template<>
+inline auto registerMembers<StreamedSkeleton>()
+{
+   return members(
+      member("name", &StreamedSkeleton::name),
+      member("parent", &StreamedSkeleton::parent),
+      member("default_model", &StreamedSkeleton::defaultModel),
+      member("stances", &StreamedSkeleton::stances)
+   );
+}
+
+}; // namespace meta
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+const std::string kModel = R"({
+   "name": "a model with a name too long to be inline",
+   "scale": 2.5,
+   "count": 3,
+   "visible": true,
+   "unknown": {"deeply": [{"nested": ["things", 1, null, {}]}]},
+   "parts": [
+      {"name": "head", "shape": "Sphere", "position": [1, 2, 3], "tags": [1, 2]},
+      {"name": "body", "position": [1, 2], "extra": {"a": []}},
+      {"name": "tail", "position": {"x": 1}, "tags": []}
+   ],
+   "offsets": {"head": [0, 1, 0], "body": [0, -1, 0.5]},
+   "properties": {"a": "b", "c": "d"},
+   "lod": 2,
+   "color": [0.5, 0.25, 1, 1]
+})";
+
+void CheckModel(const StreamedModel& model)
+{
+   CHECK(model.name == "a model with a name too long to be inline");
+   CHECK(model.scale == 2.5);
+   CHECK(model.count == 3);
+   CHECK(model.visible);
+
+   REQUIRE(model.parts.size() == 3);
+   CHECK(model.parts[0].name == "head");
+   CHECK(model.parts[0].shape == StreamedShape::Sphere);
+   CHECK(model.parts[0].position == glm::vec3(1, 2, 3));
+   CHECK(model.parts[0].tags == std::vector<int>{1, 2});
+   // Anything but three numbers is zero, like GetVec3.
+   CHECK(model.parts[1].position == glm::vec3(0));
+   CHECK(model.parts[2].position == glm::vec3(0));
+
+   REQUIRE(model.offsets.size() == 2);
+   CHECK(model.offsets.at("body") == glm::vec3(0, -1, 0.5));
+   REQUIRE(model.properties.size() == 2);
+   CHECK(model.properties.at("c") == "d");
+   CHECK(model.lod == 2);
+   CHECK(model.color == glm::vec4(0.5, 0.25, 1, 1));
+}
+
+BindingProperty Parse(const std::string& json)
+{
+   Maybe<BindingProperty> parsed = JSONSerializer::Deserialize(json);
+   REQUIRE(parsed);
+   return std::move(parsed.Result());
+}
+
+template <typename T>
+T Deserialize(const std::string& json)
+{
+   T result;
+   Binding::deserialize(result, Parse(json));
+   return result;
+}
+
+template <typename T>
+T Stream(const std::string& json)
+{
+   T result;
+   BindingPropertyConsumer consumer(result);
+   Maybe<void> read = JSONSerializer::Read(json, consumer);
+   REQUIRE(read);
+   CHECK(consumer.IsDone());
+   return result;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Streaming a document into a struct") {
+   StreamedModel streamed = Stream<StreamedModel>(kModel);
+   CheckModel(streamed);
+
+   // Matches the usual way of doing it.
+   StreamedModel deserialized = Deserialize<StreamedModel>(kModel);
+   CheckModel(deserialized);
+   CHECK(Binding::serialize(streamed) == Binding::serialize(deserialized));
+}
+
+TEST_CASE("Streaming from every format") {
+   BindingProperty data = Parse(kModel);
+
+   SECTION("YAML") {
+      Maybe<std::string> yaml = YAMLSerializer::Serialize(data);
+      REQUIRE(yaml);
+
+      StreamedModel model;
+      BindingPropertyConsumer consumer(model);
+      REQUIRE(YAMLSerializer::Read(*yaml, consumer));
+      CheckModel(model);
+   }
+
+   SECTION("Binary") {
+      Maybe<std::string> binary = BinarySerializer::Serialize(data);
+      REQUIRE(binary);
+
+      StreamedModel model;
+      BindingPropertyConsumer consumer(model);
+      REQUIRE(BinarySerializer::Read(*binary, consumer));
+      CheckModel(model);
+   }
+}
+
+TEST_CASE("Streaming values of the wrong type") {
+   const std::string json = R"({
+      "name": [1, 2],
+      "scale": null,
+      "count": "three",
+      "visible": {"yes": true},
+      "properties": {"a": 1, "b": [2], "c": "c"},
+      "lod": null,
+      "color": "red"
+   })";
+
+   StreamedModel streamed = Stream<StreamedModel>(json);
+   StreamedModel deserialized = Deserialize<StreamedModel>(json);
+   CHECK(Binding::serialize(streamed) == Binding::serialize(deserialized));
+
+   // Nulls leave members alone.
+   CHECK(streamed.scale == 1.0);
+   CHECK(!streamed.lod.has_value());
+
+   // Containers of the wrong shape are skipped.
+   streamed = Stream<StreamedModel>(R"({"parts": {"head": {}}, "offsets": [[0, 1, 0]]})");
+   CHECK(streamed.parts.empty());
+   CHECK(streamed.offsets.empty());
+}
+
+TEST_CASE("Streaming one key") {
+   std::vector<StreamedPart> parts;
+
+   SECTION("Stops reading once the key is done") {
+      // Cut off right after the parts, so the rest doesn't even parse.
+      const std::string json = kModel.substr(0, kModel.find("\"offsets\""));
+
+      BindingPropertyConsumer consumer(parts, "parts");
+      REQUIRE(JSONSerializer::Read(json, consumer));
+      CHECK(consumer.IsDone());
+      REQUIRE(parts.size() == 3);
+      CHECK(parts[2].name == "tail");
+   }
+
+   SECTION("Works for scalars") {
+      std::string name;
+      BindingPropertyConsumer consumer(name, "name");
+      REQUIRE(JSONSerializer::Read(kModel, consumer));
+      CHECK(name == "a model with a name too long to be inline");
+   }
+
+   SECTION("Missing keys leave the target alone") {
+      parts.emplace_back();
+      BindingPropertyConsumer consumer(parts, "nope");
+      REQUIRE(JSONSerializer::Read(kModel, consumer));
+      CHECK(parts.size() == 1);
+   }
+}
+
+TEST_CASE("Streaming broken documents") {
+   StreamedModel model;
+
+   SECTION("Bad JSON") {
+      BindingPropertyConsumer consumer(model);
+      CHECK(!JSONSerializer::Read(R"({"name": "model", "parts": [})", consumer));
+      CHECK(!consumer.IsDone());
+   }
+
+   SECTION("Truncated binary") {
+      Maybe<std::string> binary = BinarySerializer::Serialize(Parse(kModel));
+      REQUIRE(binary);
+
+      BindingPropertyConsumer consumer(model);
+      CHECK(!BinarySerializer::Read(binary->substr(0, binary->size() / 2), consumer));
+   }
+}
+
+TEST_CASE("Streaming the skeleton assets") {
+   DiskFileSystem fs;
+   Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(Asset::Skeleton(""), false, false);
+   REQUIRE(entries);
+   REQUIRE(!entries->empty());
+
+   for (const FileSystem::FileEntry& entry : *entries)
+   {
+      const std::string path = Paths::Join(Asset::Skeleton(""), entry.name);
+      INFO(path);
+
+      StreamedSkeleton streamed;
+      BindingPropertyConsumer consumer(streamed);
+      REQUIRE(YAMLSerializer::ReadFile(path, consumer));
+
+      Maybe<BindingProperty> data = YAMLSerializer::DeserializeFile(path);
+      REQUIRE(data);
+      StreamedSkeleton deserialized;
+      Binding::deserialize(deserialized, *data);
+
+      CHECK(!streamed.name.empty());
+      CHECK(Binding::serialize(streamed) == Binding::serialize(deserialized));
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,44 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <atomic>
+
+#include <RGBDesignPatterns/ThreadPool.h>
+
+namespace CubeWorld
+{
+
+TEST_CASE("ThreadPool runs everything it's given") {
+   std::atomic<int> count{0};
+   std::vector<std::future<int>> results;
+   {
+      ThreadPool pool(4);
+      REQUIRE(pool.size() == 4);
+
+      for (int i = 0; i < 1000; ++i)
+      {
+         results.push_back(pool.Submit([&count, i] { ++count; return i * 2; }));
+      }
+
+      for (int i = 0; i < 100; ++i)
+      {
+         CHECK(results[size_t(i)].get() == i * 2);
+      }
+   }
+
+   // Destroying the pool finishes anything still queued.
+   CHECK(count == 1000);
+   for (size_t i = 100; i < results.size(); ++i)
+   {
+      CHECK(results[i].get() == int(i) * 2);
+   }
+}
+
+TEST_CASE("ThreadPool always has at least one thread") {
+   ThreadPool pool(0);
+   CHECK(pool.size() == 1);
+   CHECK(pool.Submit([] { return 5; }).get() == 5);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,284 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <RGBLogger/LogBuffer.h>
+#include <RGBLogger/Logger.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+using Logger::LogManager;
+
+//
+// Keeps every line that's logged, while it's registered.
+//
+class CaptureLogger : public Logger::Logger
+{
+public:
+   CaptureLogger() { LogManager::Instance().RegisterLogger(this); }
+   ~CaptureLogger() { LogManager::Instance().DeregisterLogger(this); }
+
+   NO_REGISTER_HOOKS
+
+   void Log(const char* message, Color) override
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      mCurrent += message;
+      size_t newline;
+      while ((newline = mCurrent.find('\n')) != std::string::npos)
+      {
+         lines.push_back(mCurrent.substr(0, newline));
+         mCurrent.erase(0, newline + 1);
+      }
+   }
+
+   std::vector<std::string> lines;
+
+private:
+   std::mutex mMutex;
+   std::string mCurrent;
+};
+
+}; // anonymous namespace
+
+TEST_CASE("Log buffers hand records over in order") {
+   Logger::LogBuffer buffer(128);
+   CHECK(buffer.Capacity() == 128);
+   CHECK(buffer.Empty());
+
+   size_t size;
+   CHECK(buffer.Peek(size) == nullptr);
+
+   // Go around the ring a few times, with records that don't line up with its end.
+   for (uint32_t i = 0; i < 50; ++i)
+   {
+      void* data = buffer.BeginWrite(20);
+      REQUIRE(data != nullptr);
+      memset(data, int(i), 20);
+      buffer.EndWrite();
+
+      const void* record = buffer.Peek(size);
+      REQUIRE(record != nullptr);
+      CHECK(size == 20);
+      CHECK(static_cast<const uint8_t*>(record)[0] == i);
+      CHECK(static_cast<const uint8_t*>(record)[19] == i);
+      buffer.Pop();
+      CHECK(buffer.Empty());
+   }
+}
+
+TEST_CASE("Log buffers refuse records when they're full") {
+   Logger::LogBuffer buffer(128);
+   CHECK(buffer.BeginWrite(buffer.MaxRecordSize() + 1) == nullptr);
+
+   // 32 bytes each, with the size in front.
+   uint32_t written = 0;
+   while (void* data = buffer.BeginWrite(24))
+   {
+      memcpy(data, &written, sizeof(written));
+      buffer.EndWrite();
+      ++written;
+   }
+   CHECK(written == 4);
+
+   // Room opens up as records are read.
+   size_t size;
+   buffer.Peek(size);
+   buffer.Pop();
+   void* data = buffer.BeginWrite(24);
+   REQUIRE(data != nullptr);
+   memcpy(data, &written, sizeof(written));
+   buffer.EndWrite();
+
+   for (uint32_t i = 1; i <= written; ++i)
+   {
+      const void* record = buffer.Peek(size);
+      REQUIRE(record != nullptr);
+      uint32_t value;
+      memcpy(&value, record, sizeof(value));
+      CHECK(value == i);
+      buffer.Pop();
+   }
+   CHECK(buffer.Empty());
+}
+
+TEST_CASE("Log buffers between two threads") {
+   Logger::LogBuffer buffer(256);
+   const uint32_t kCount = 100000;
+
+   std::thread writer([&] {
+      for (uint32_t i = 0; i < kCount; ++i)
+      {
+         const size_t size = 4 + (i % 5) * 8;
+         void* data;
+         while ((data = buffer.BeginWrite(size)) == nullptr)
+         {
+            std::this_thread::yield();
+         }
+         memcpy(data, &i, sizeof(i));
+         buffer.EndWrite();
+      }
+   });
+
+   uint32_t expected = 0;
+   bool inOrder = true;
+   while (expected < kCount)
+   {
+      size_t size;
+      const void* record = buffer.Peek(size);
+      if (record == nullptr)
+      {
+         std::this_thread::yield();
+         continue;
+      }
+
+      uint32_t value;
+      memcpy(&value, record, sizeof(value));
+      inOrder = inOrder && value == expected && size == 4 + (expected % 5) * 8;
+      buffer.Pop();
+      ++expected;
+   }
+
+   writer.join();
+   CHECK(inOrder);
+   CHECK(buffer.Empty());
+}
+
+TEST_CASE("Logging asynchronously") {
+   CaptureLogger capture;
+   LogManager& manager = LogManager::Instance();
+   manager.StartAsync();
+
+   SECTION("Formats arguments later") {
+      LOG_INFO("{name} is {age} years old, {height}m tall", "Thomas", 25, 1.75);
+      LOG_ERROR("Plain message");
+      LOG_WARNING(std::string("Made at runtime"));
+      manager.Log("Raw\n");
+      manager.Flush();
+
+      REQUIRE(capture.lines.size() == 4);
+      CHECK(capture.lines[0] == "INFO  | Thomas is 25 years old, 1.750000m tall");
+      CHECK(capture.lines[1] == "ERROR | Plain message");
+      CHECK(capture.lines[2] == "WARN  | Made at runtime");
+      CHECK(capture.lines[3] == "Raw");
+   }
+
+   SECTION("Copies strings that might not live long enough") {
+      {
+         std::string name = "original";
+         char buffer[16] = "buffer";
+         LOG_INFO("{name} {buffer} {view}", name, (const char*)buffer, std::string_view(name));
+         name = "changed";
+         memcpy(buffer, "changed", sizeof("changed"));
+      }
+      manager.Flush();
+
+      REQUIRE(capture.lines.size() == 1);
+      CHECK(capture.lines[0] == "INFO  | original buffer original");
+   }
+
+   SECTION("Copies formats that aren't literals") {
+      char fmt[32] = "Format {value}";
+      LOG_INFO(fmt, 1);
+      memcpy(fmt, "Changed {value}", sizeof("Changed {value}"));
+      manager.Flush();
+
+      REQUIRE(capture.lines.size() == 1);
+      CHECK(capture.lines[0] == "INFO  | Format 1");
+      CHECK(std::string(fmt) == "Changed {value}");
+   }
+
+   SECTION("Keeps the order across threads") {
+      const int kThreads = 4;
+      const int kCount = 2000;
+
+      std::vector<std::thread> threads;
+      for (int t = 0; t < kThreads; ++t)
+      {
+         threads.emplace_back([t] {
+            for (int i = 0; i < kCount; ++i)
+            {
+               LOG_DEBUG("{thread} {i}", t, i);
+            }
+         });
+      }
+      for (std::thread& thread : threads)
+      {
+         thread.join();
+      }
+      manager.Flush();
+
+      REQUIRE(capture.lines.size() == kThreads * kCount);
+
+      // Each thread's messages come out in the order it logged them.
+      std::vector<int> next(kThreads, 0);
+      bool inOrder = true;
+      for (const std::string& line : capture.lines)
+      {
+         REQUIRE(line.compare(0, 8, "DEBUG | ") == 0);
+         size_t end;
+         const int thread = std::stoi(line.substr(8), &end);
+         const int i = std::stoi(line.substr(8 + end));
+         inOrder = inOrder && i == next[thread]++;
+      }
+      CHECK(inOrder);
+   }
+
+   SECTION("Too big for the buffer") {
+      std::string huge(200 * 1024, 'x');
+      LOG_INFO("{huge}", huge);
+      manager.Flush();
+
+      REQUIRE(capture.lines.size() == 1);
+      CHECK(capture.lines[0].size() == huge.size() + 8);
+   }
+
+   manager.StopAsync();
+}
+
+TEST_CASE("Dropping messages when the buffer overflows") {
+   CaptureLogger capture;
+   LogManager& manager = LogManager::Instance();
+
+   Logger::AsyncOptions options;
+   options.bufferSize = 1024;
+   options.overflow = Logger::OverflowPolicy::kDrop;
+   manager.StartAsync(options);
+
+   for (int i = 0; i < 10000; ++i)
+   {
+      LOG_INFO("Message {i}", i);
+   }
+   manager.StopAsync();
+
+   REQUIRE(capture.lines.size() > 1);
+   CHECK(capture.lines.size() < 10000);
+   CHECK(capture.lines.front() == "INFO  | Message 0");
+
+   // Every message is either written or counted.
+   size_t accounted = 0;
+   for (const std::string& line : capture.lines)
+   {
+      const std::string dropped = "WARN  | Dropped ";
+      if (line.compare(0, dropped.size(), dropped) == 0)
+      {
+         accounted += std::stoul(line.substr(dropped.size()));
+      }
+      else
+      {
+         ++accounted;
+      }
+   }
+   CHECK(accounted == 10000);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,176 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBNetworking/BinarySerializer.h>
+#include <RGBNetworking/JSONSerializer.h>
+#include <RGBNetworking/YAMLSerializer.h>
+#include <Shared/Helpers/Asset.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+// Covers every type, and every way a number can be stored.
+const std::string kDocument = R"({
+   "null": null,
+   "bools": [true, false],
+   "ints": [0, 1, 127, 128, -1, -128, 2147483647, -2147483648, 4294967295],
+   "int64s": [4294967296, -4294967297, 9223372036854775807, -9223372036854775808],
+   "uint64": 18446744073709551615,
+   "doubles": [0.0, 0.5, -2.25, 3.14159265358979, 1e300, -1e-300],
+   "strings": ["", "short", "a string long enough to be stored out of line", "short"],
+   "nested": {"short": {"short": [[], {}, [[1]]]}}
+})";
+
+BindingProperty Parse(const std::string& json)
+{
+   Maybe<BindingProperty> parsed = JSONSerializer::Deserialize(json);
+   REQUIRE(parsed);
+   return std::move(parsed.Result());
+}
+
+std::string ToBinary(const BindingProperty& data)
+{
+   Maybe<std::string> serialized = BinarySerializer::Serialize(data);
+   REQUIRE(serialized);
+   return std::move(serialized.Result());
+}
+
+BindingProperty FromBinary(const std::string& binary)
+{
+   Maybe<BindingProperty> deserialized = BinarySerializer::Deserialize(binary);
+   REQUIRE(deserialized);
+   return std::move(deserialized.Result());
+}
+
+std::string ToJSON(const BindingProperty& data)
+{
+   Maybe<std::string> serialized = JSONSerializer::Serialize(data);
+   REQUIRE(serialized);
+   return std::move(serialized.Result());
+}
+
+std::string ToYAML(const BindingProperty& data)
+{
+   Maybe<std::string> serialized = YAMLSerializer::Serialize(data);
+   REQUIRE(serialized);
+   return std::move(serialized.Result());
+}
+
+// Every skeleton and animation in the assets, as YAML.
+std::vector<std::string> LoadAssets()
+{
+   DiskFileSystem fs;
+   std::vector<std::string> result;
+
+   for (const std::string& dir : {Asset::Skeleton(""), Asset::Animation("character")})
+   {
+      Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(dir, false, false);
+      REQUIRE(entries);
+      for (const FileSystem::FileEntry& entry : *entries)
+      {
+         Maybe<std::string> contents = fs.ReadEntireFile(Paths::Join(dir, entry.name));
+         REQUIRE(contents);
+         result.push_back(std::move(*contents));
+      }
+   }
+
+   REQUIRE(!result.empty());
+   return result;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Binary documents round trip losslessly") {
+   BindingProperty original = Parse(kDocument);
+   BindingProperty roundTripped = FromBinary(ToBinary(original));
+
+   CHECK(roundTripped == original);
+
+   // The JSON writer picks Int, Uint, Int64, Uint64 or Double from the number's flags,
+   // so matching text means every number kept its type too.
+   CHECK(ToJSON(roundTripped) == ToJSON(original));
+
+   CHECK(roundTripped["uint64"].GetUint64Value() == std::numeric_limits<uint64_t>::max());
+   CHECK(roundTripped["int64s"][3].GetInt64Value() == std::numeric_limits<int64_t>::min());
+   CHECK(roundTripped["doubles"][3].GetDoubleValue() == 3.14159265358979);
+}
+
+TEST_CASE("Binary documents round trip through YAML") {
+   for (const std::string& yaml : LoadAssets())
+   {
+      Maybe<BindingProperty> original = YAMLSerializer::Deserialize(yaml);
+      REQUIRE(original);
+
+      std::string binary = ToBinary(*original);
+      CHECK(binary.size() < yaml.size());
+      CHECK(ToYAML(FromBinary(binary)) == ToYAML(*original));
+   }
+}
+
+TEST_CASE("Binary documents store each string once") {
+   BindingProperty data;
+   for (int i = 0; i < 100; ++i)
+   {
+      data.PushBack(BindingProperty("the same long string, over and over again"));
+   }
+
+   std::string binary = ToBinary(data);
+   CHECK(binary.size() < 100 * 2 + 64);
+   CHECK(FromBinary(binary) == data);
+}
+
+TEST_CASE("Binary documents in an arena") {
+   RGBBinding::Arena arena;
+   Maybe<BindingProperty> deserialized = BinarySerializer::Deserialize(ToBinary(Parse(kDocument)), &arena);
+   REQUIRE(deserialized);
+   CHECK(*deserialized == Parse(kDocument));
+   CHECK(arena.GetBytesUsed() > 0);
+}
+
+TEST_CASE("Damaged binary documents fail cleanly") {
+   const std::string binary = ToBinary(Parse(kDocument));
+
+   SECTION("Truncated anywhere") {
+      for (size_t size = 0; size < binary.size(); ++size)
+      {
+         INFO("Truncated to " << size << " bytes");
+         CHECK(!BinarySerializer::Deserialize(binary.substr(0, size)));
+      }
+   }
+
+   SECTION("Extra data") {
+      CHECK(!BinarySerializer::Deserialize(binary + '\0'));
+   }
+
+   SECTION("Not binary at all") {
+      CHECK(!BinarySerializer::Deserialize(kDocument));
+   }
+
+   SECTION("From another version") {
+      std::string other = binary;
+      other[3] = char(BinarySerializer::kVersion + 1);
+      CHECK(!BinarySerializer::Deserialize(other));
+   }
+
+   SECTION("Flipped bytes") {
+      // None of these can be checked for, but none may crash.
+      for (size_t i = 4; i < binary.size(); ++i)
+      {
+         std::string damaged = binary;
+         damaged[i] = char(~damaged[i]);
+         BinarySerializer::Deserialize(damaged);
+      }
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,197 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <RGBFileSystem/FileSystem.h>
+#include <RGBFileSystem/Paths.h>
+#include <RGBNetworking/JSONSerializer.h>
+#include <RGBNetworking/YAMLSerializer.h>
+#include <Shared/Helpers/Asset.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+BindingProperty ParseYAML(const std::string& yaml)
+{
+   Maybe<BindingProperty> parsed = YAMLSerializer::Deserialize(yaml);
+   REQUIRE(parsed);
+   return std::move(parsed.Result());
+}
+
+std::string ToYAML(const BindingProperty& data)
+{
+   Maybe<std::string> serialized = YAMLSerializer::Serialize(data);
+   REQUIRE(serialized);
+   return std::move(serialized.Result());
+}
+
+// Every YAML file in the asset directories that have them.
+std::vector<std::string> ListYAMLAssets()
+{
+   DiskFileSystem fs;
+   std::vector<std::string> paths;
+   for (const std::string& dir : {Asset::Skeleton(""), Asset::Animation(""), Asset::Path("Particles"), Asset::Path("Scenes")})
+   {
+      Maybe<std::vector<FileSystem::FileEntry>> entries = fs.ListDirectory(dir, false, true);
+      REQUIRE(entries);
+      for (const FileSystem::FileEntry& entry : *entries)
+      {
+         if (entry.name.size() > 5 && entry.name.compare(entry.name.size() - 5, 5, ".yaml") == 0)
+         {
+            paths.push_back(Paths::Join(dir, entry.name));
+         }
+      }
+   }
+   return paths;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Reading YAML scalars") {
+   BindingProperty data = ParseYAML(R"(
+uint: 3
+int: -3
+int64: 9223372036854775807
+double: 0.25
+exponent: -1.5e-3
+true: true
+false: false
+null: null
+tilde: ~
+empty:
+string: hello
+quoted: "3"
+single: '0.25'
+literal: |
+  4
+not_a_number: 2d
+leading_zero: 007
+)");
+
+   CHECK(data["uint"].IsUint());
+   CHECK(data["uint"].GetUintValue() == 3);
+   CHECK(data["int"].GetIntValue() == -3);
+   CHECK(data["int64"].GetInt64Value() == std::numeric_limits<int64_t>::max());
+   CHECK(data["double"].GetDoubleValue() == 0.25);
+   CHECK(data["exponent"].GetDoubleValue() == -1.5e-3);
+   CHECK(data["true"] == true);
+   CHECK(data["false"] == false);
+   CHECK(data["null"].IsNull());
+   CHECK(data["tilde"].IsNull());
+
+   // Empty values stay strings, since assets use them for "nothing".
+   CHECK(data["empty"] == "");
+   CHECK(data["string"] == "hello");
+
+   // Quoted and block scalars are always strings.
+   CHECK(data["quoted"] == "3");
+   CHECK(data["single"] == "0.25");
+   CHECK(data["literal"] == "4\n");
+
+   // Scalars that only start like numbers used to read as part of one.
+   CHECK(data["not_a_number"] == "2d");
+   CHECK(data["leading_zero"] == "007");
+}
+
+TEST_CASE("Reading YAML tags") {
+   BindingProperty data = ParseYAML(R"(
+str: !!str 3
+int: !!int 3
+float: !!float 0.5
+bool: !!bool true
+null: !!null null
+bad_int: !!int three
+custom: !thing 3
+)");
+
+   CHECK(data["str"] == "3");
+   CHECK(data["int"].GetUintValue() == 3);
+   CHECK(data["float"].GetDoubleValue() == 0.5);
+   CHECK(data["bool"] == true);
+   CHECK(data["null"].IsNull());
+
+   // Tags that can't be honored fall back to strings.
+   CHECK(data["bad_int"] == "three");
+   CHECK(data["custom"] == "3");
+}
+
+TEST_CASE("YAML round trips are exact") {
+   SECTION("Strings that look like other things") {
+      BindingProperty data;
+      for (const char* str : {"3", "-0.5", "1e10", "true", "false", "null", "~", "", "2d", "hello"})
+      {
+         data[str] = str;
+      }
+
+      std::string yaml = ToYAML(data);
+      INFO(yaml);
+      CHECK(ParseYAML(yaml) == data);
+   }
+
+   SECTION("Numbers") {
+      BindingProperty data;
+      data["uint64"] = std::numeric_limits<uint64_t>::max();
+      data["int64"] = std::numeric_limits<int64_t>::min();
+      data["tenth"] = 0.1;
+      data["float"] = double(7.198518f);
+      data["third"] = 1.0 / 3.0;
+      data["huge"] = 1.7976931348623157e308;
+      data["tiny"] = 4.9406564584124654e-324;
+
+      std::string yaml = ToYAML(data);
+      INFO(yaml);
+      BindingProperty parsed = ParseYAML(yaml);
+      CHECK(parsed["uint64"].GetUint64Value() == std::numeric_limits<uint64_t>::max());
+      CHECK(parsed["int64"].GetInt64Value() == std::numeric_limits<int64_t>::min());
+      CHECK(parsed["tenth"].GetDoubleValue() == 0.1);
+      CHECK(parsed["float"].GetFloatValue() == 7.198518f);
+      CHECK(parsed["third"].GetDoubleValue() == 1.0 / 3.0);
+      CHECK(parsed["huge"].GetDoubleValue() == 1.7976931348623157e308);
+      CHECK(parsed["tiny"].GetDoubleValue() == 4.9406564584124654e-324);
+
+      // Doubles that hold a float are written like the float, since that's what they
+      // are read back into.
+      CHECK(yaml.find("float: 7.198518\n") != std::string::npos);
+   }
+
+   SECTION("Random doubles") {
+      std::mt19937_64 random(1234);
+      BindingProperty data;
+      for (int i = 0; i < 1000; ++i)
+      {
+         uint64_t bits = random();
+         double d;
+         std::memcpy(&d, &bits, sizeof(d));
+         data.push_back(std::isfinite(d) ? d : 1.0);
+      }
+
+      BindingProperty parsed = ParseYAML(ToYAML(data));
+      REQUIRE(parsed.GetSize() == data.GetSize());
+      for (size_t i = 0; i < data.GetSize(); ++i)
+      {
+         CHECK(parsed[i].GetDoubleValue() == data[i].GetDoubleValue());
+      }
+   }
+
+   SECTION("Assets") {
+      for (const std::string& path : ListYAMLAssets())
+      {
+         INFO(path);
+         Maybe<BindingProperty> data = YAMLSerializer::DeserializeFile(path);
+         REQUIRE(data);
+         CHECK(ParseYAML(ToYAML(*data)) == *data);
+      }
+   }
+}
+
+}; // namespace CubeWorld
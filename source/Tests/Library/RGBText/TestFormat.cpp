@@ -2,6 +2,10 @@
 
 #include "../../catch.h"
 
+#include <iterator>
+#include <string>
+#include <vector>
+
 #include <RGBText/Format.h>
 
 namespace CubeWorld
@@ -43,4 +47,82 @@ TEST_CASE("FormatString errors") {
    CHECK(FormatString("Unclosed brace: {whatever man...") == "Unclosed brace: <missing arg>");
 }
 
+TEST_CASE("FormatString specs") {
+   CHECK(FormatString("Precision: %.2f", 2.0) == "Precision: 2.00");
+   CHECK(FormatString("Precision: {value:.2f}", 2.0) == "Precision: 2.00");
+   CHECK(FormatString("Shortest: {value:g}", 0.1) == "Shortest: 0.1");
+   CHECK(FormatString("Shortest: {value:g}", 1.0 / 3.0) == "Shortest: 0.3333333333333333");
+   CHECK(FormatString("Shortest: {value:g}", 2.0f) == "Shortest: 2");
+   CHECK(FormatString("Big: {value}", 1e20) == "Big: 100000000000000000000.000000");
+   CHECK(FormatString("Trailing %", 1) == "Trailing 1");
+}
+
+TEST_CASE("FormatTo") {
+   SECTION("Appends to a string") {
+      std::string result = "Prefix ";
+      FormatTo(std::back_inserter(result), "{int} and {string}", 2, "a string");
+      CHECK(result == "Prefix 2 and a string");
+   }
+
+   SECTION("Writes to a buffer") {
+      char buffer[64];
+      char* end = FormatTo(buffer, "Element %1 of %2", 3, 10);
+      CHECK(std::string(buffer, end) == "Element 3 of 10");
+   }
+
+   SECTION("Matches FormatString") {
+      std::vector<char> result;
+      FormatTo(std::back_inserter(result), "Test string with {num} arguments, {arg1} and {arg2}", 2, "argument 1", 2.0);
+      CHECK(std::string(result.begin(), result.end()) == FormatString("Test string with {num} arguments, {arg1} and {arg2}", 2, "argument 1", 2.0));
+   }
+}
+
+TEST_CASE("FormatToN") {
+   char buffer[16];
+
+   SECTION("Fits") {
+      FormatToNResult result = FormatToN(buffer, sizeof(buffer), "{a}ms", 12);
+      CHECK(result.size == 4);
+      CHECK(std::string(buffer, result.out) == "12ms");
+   }
+
+   SECTION("Cut off") {
+      FormatToNResult result = FormatToN(buffer, 8, "A string that is too {adjective}", "long");
+      CHECK(result.size == 25);
+      CHECK(result.out == buffer + 8);
+      CHECK(std::string(buffer, result.out) == "A string");
+   }
+
+   SECTION("Null terminated") {
+      FormatToNResult result = FormatToN(buffer, sizeof(buffer) - 1, "Element {num}", 7);
+      *result.out = '\0';
+      CHECK(std::string(buffer) == "Element 7");
+   }
+}
+
+TEST_CASE("Compile-time checked format strings") {
+   // These are what CUBEWORLD_FORMAT checks.
+   static_assert(FormatImpl::check_format("No args", 0));
+   static_assert(FormatImpl::check_format("{a} and {b}", 2));
+   static_assert(FormatImpl::check_format("%2 then %1", 2));
+   static_assert(FormatImpl::check_format("Escaped \\{a} and 100%%", 0));
+   static_assert(FormatImpl::check_format("{value:.2f} {value:g}", 2));
+   static_assert(!FormatImpl::check_format("{a} and {b}", 1));
+   static_assert(!FormatImpl::check_format("%3", 2));
+   static_assert(!FormatImpl::check_format("%0", 1));
+   static_assert(!FormatImpl::check_format("Unclosed {a", 1));
+   static_assert(!FormatImpl::check_format("{value:x}", 1));
+   static_assert(!FormatImpl::check_format("100% sure", 0));
+
+   CHECK(FormatString(CUBEWORLD_FORMAT("{a} and {b}"), 1, "two") == "1 and two");
+
+   char buffer[32];
+   FormatToNResult result = FormatToN(buffer, sizeof(buffer), CUBEWORLD_FORMAT("%.1fms"), 1.26);
+   CHECK(std::string(buffer, result.out) == "1.3ms");
+
+   std::string appended;
+   FormatTo(std::back_inserter(appended), CUBEWORLD_FORMAT("{x:g}"), 0.5);
+   CHECK(appended == "0.5");
+}
+
 }; // namespace CubeWorld
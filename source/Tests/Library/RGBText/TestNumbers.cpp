@@ -0,0 +1,161 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include <RGBText/Numbers.h>
+
+namespace CubeWorld
+{
+
+namespace
+{
+
+Numbers::Number ParseNumber(const std::string& str)
+{
+   INFO(str);
+   Numbers::Number number;
+   REQUIRE(Numbers::Parse(str.data(), str.data() + str.size(), number));
+   return number;
+}
+
+double ParseDouble(const std::string& str)
+{
+   return ParseNumber(str).AsDouble();
+}
+
+bool SameBits(double a, double b)
+{
+   return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Parsing integers") {
+   CHECK(ParseNumber("0").type == Numbers::Number::kUint);
+   CHECK(ParseNumber("4294967295").u == 4294967295u);
+   CHECK(ParseNumber("-1").i == -1);
+   CHECK(ParseNumber("-2147483648").i == std::numeric_limits<int32_t>::min());
+
+   CHECK(ParseNumber("4294967296").type == Numbers::Number::kUint64);
+   CHECK(ParseNumber("18446744073709551615").u64 == std::numeric_limits<uint64_t>::max());
+   CHECK(ParseNumber("-2147483649").type == Numbers::Number::kInt64);
+   CHECK(ParseNumber("-9223372036854775808").i64 == std::numeric_limits<int64_t>::min());
+
+   // Too big for any integer.
+   CHECK(ParseNumber("18446744073709551616").type == Numbers::Number::kDouble);
+   CHECK(ParseDouble("18446744073709551616") == 18446744073709551616.0);
+   CHECK(ParseDouble("-9223372036854775809") == -9223372036854775808.0);
+}
+
+TEST_CASE("Parsing things that aren't numbers") {
+   for (const char* str : {"", "-", "+1", "01", "-01", "1.", ".5", "1e", "1e+", "2d", "1.5.5", "0x10", "inf", "nan", "1 ", " 1", "1e400", "-1e400"})
+   {
+      INFO(str);
+      Numbers::Number number;
+      CHECK(!Numbers::Parse(str, str + strlen(str), number));
+   }
+}
+
+TEST_CASE("Parsing doubles") {
+   CHECK(ParseDouble("0.5") == 0.5);
+   CHECK(ParseDouble("-6.4") == -6.4);
+   CHECK(ParseDouble("1e10") == 1e10);
+   CHECK(ParseDouble("1E-5") == 1e-5);
+   CHECK(ParseDouble("1.5e+3") == 1500.0);
+   CHECK(SameBits(ParseDouble("-0.0"), -0.0));
+
+   SECTION("Matches strtod where the fast path can't be used") {
+      const char* hard[] = {
+         // Halfway between two doubles, both ways.
+         "9007199254740993.0",
+         "9007199254740995e0",
+         "9007199254740993.0000000000000000000000000001",
+         // 17 significant digits.
+         "0.10000000000000001",
+         "2.2250738585072014e-308",
+         "1.7976931348623157e308",
+         // Subnormals.
+         "4.9406564584124654e-324",
+         "2.4703282292062328e-324",
+         "2.4703282292062327e-324",
+         "2.2250738585072011e-308",
+         // Long inputs.
+         "3.14159265358979323846264338327950288419716939937510582097494459",
+         "0.000000000000000000000000000000000000000000000000000000000000123456789012345678901234567890",
+         "123456789012345678901234567890e-10",
+         "1e-400",
+         "8.98846567431158e307",
+         "123e25",
+      };
+
+      for (const char* str : hard)
+      {
+         INFO(str);
+         CHECK(SameBits(ParseDouble(str), std::strtod(str, nullptr)));
+      }
+   }
+}
+
+TEST_CASE("Formatting numbers") {
+   CHECK(Numbers::Format(0.1) == "0.1");
+   CHECK(Numbers::Format(-2.25) == "-2.25");
+   CHECK(Numbers::Format(1.0 / 3.0) == "0.3333333333333333");
+   CHECK(Numbers::Format(1e300) == "1e+300");
+   CHECK(Numbers::Format(163007.0) == "163007");
+
+   // Not "0.100000001490116", which is the same float but a different double.
+   CHECK(Numbers::FormatFloat(0.1f) == "0.1");
+   CHECK(Numbers::FormatFloat(7.198518f) == "7.198518");
+}
+
+TEST_CASE("Formatted numbers read back exactly") {
+   std::mt19937_64 random(1234);
+
+   SECTION("Doubles") {
+      for (int i = 0; i < 100000; ++i)
+      {
+         uint64_t bits = random();
+         double d;
+         std::memcpy(&d, &bits, sizeof(d));
+         if (!std::isfinite(d)) { continue; }
+
+         std::string formatted = Numbers::Format(d);
+         INFO(formatted);
+         REQUIRE(SameBits(ParseDouble(formatted), d));
+      }
+   }
+
+   SECTION("Floats") {
+      for (int i = 0; i < 100000; ++i)
+      {
+         uint32_t bits = uint32_t(random());
+         float f;
+         std::memcpy(&f, &bits, sizeof(f));
+         if (!std::isfinite(f)) { continue; }
+
+         std::string formatted = Numbers::FormatFloat(f);
+         INFO(formatted);
+         REQUIRE(float(ParseDouble(formatted)) == f);
+      }
+   }
+
+   SECTION("Short decimals, like the ones in assets") {
+      std::uniform_int_distribution<int> mantissa(-100000000, 100000000);
+      std::uniform_int_distribution<int> exponent(0, 8);
+      for (int i = 0; i < 100000; ++i)
+      {
+         const std::string str = std::to_string(mantissa(random)) + "e-" + std::to_string(exponent(random));
+         INFO(str);
+         REQUIRE(SameBits(ParseDouble(str), std::strtod(str.c_str(), nullptr)));
+      }
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,183 @@
+// By Thomas Steinke
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "MockGL.h"
+
+namespace CubeWorld
+{
+
+namespace Test
+{
+
+// Every glad function pointer MockGL replaces.
+#define MOCK_GL_FUNCTIONS(X) \
+   X(glad_glGetError) \
+   X(glad_glUseProgram) \
+   X(glad_glDeleteProgram) \
+   X(glad_glDisableVertexAttribArray) \
+   X(glad_glGetProgramiv) \
+   X(glad_glGetActiveUniform) \
+   X(glad_glGetActiveAttrib) \
+   X(glad_glGetUniformLocation) \
+   X(glad_glGetAttribLocation) \
+   X(glad_glUniform1i) \
+   X(glad_glUniform1ui) \
+   X(glad_glUniform1f) \
+   X(glad_glUniform2fv) \
+   X(glad_glUniform3fv) \
+   X(glad_glUniform4fv) \
+   X(glad_glUniform2iv) \
+   X(glad_glUniform3iv) \
+   X(glad_glUniform3uiv) \
+   X(glad_glUniformMatrix4fv)
+
+struct MockGL::Saved
+{
+#define DECLARE_SAVED(fn) decltype(::fn) fn;
+   MOCK_GL_FUNCTIONS(DECLARE_SAVED)
+#undef DECLARE_SAVED
+};
+
+MockGL* MockGL::sInstance = nullptr;
+
+struct MockGLFunctions
+{
+   static GLint Find(const std::vector<MockGL::Variable>& variables, const GLchar* name)
+   {
+      ++MockGL::sInstance->mLocationQueries;
+      for (size_t i = 0; i < variables.size(); ++i)
+      {
+         const std::string& candidate = variables[i].name;
+         if (candidate == name)
+         {
+            return GLint(i);
+         }
+
+         // Arrays can be looked up with or without the [0].
+         if (candidate.size() > 3 && candidate.compare(candidate.size() - 3, 3, "[0]") == 0 && candidate.substr(0, candidate.size() - 3) == name)
+         {
+            return GLint(i);
+         }
+      }
+      return -1;
+   }
+
+   static void GetActive(const std::vector<MockGL::Variable>& variables, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+   {
+      assert(index < variables.size());
+      const MockGL::Variable& variable = variables[index];
+      GLsizei count = std::min(GLsizei(variable.name.size()), bufSize - 1);
+      memcpy(name, variable.name.data(), size_t(count));
+      name[count] = '\0';
+      *length = count;
+      *size = variable.size;
+      *type = variable.type;
+   }
+
+   static GLint MaxLength(const std::vector<MockGL::Variable>& variables)
+   {
+      GLint result = 0;
+      for (const MockGL::Variable& variable : variables)
+      {
+         result = std::max(result, GLint(variable.name.size()) + 1);
+      }
+      return result;
+   }
+
+   static void Record(const char* function, GLint location)
+   {
+      MockGL::sInstance->mUniformCalls.push_back(MockGL::UniformCall{function, location});
+   }
+
+   static GLenum APIENTRY GetError() { return GL_NO_ERROR; }
+   static void APIENTRY UseProgram(GLuint) {}
+   static void APIENTRY DeleteProgram(GLuint) {}
+   static void APIENTRY DisableVertexAttribArray(GLuint) {}
+
+   static void APIENTRY GetProgramiv(GLuint, GLenum pname, GLint* params)
+   {
+      switch (pname)
+      {
+      case GL_ACTIVE_UNIFORMS: *params = GLint(MockGL::sInstance->mUniforms.size()); break;
+      case GL_ACTIVE_ATTRIBUTES: *params = GLint(MockGL::sInstance->mAttributes.size()); break;
+      case GL_ACTIVE_UNIFORM_MAX_LENGTH: *params = MaxLength(MockGL::sInstance->mUniforms); break;
+      case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH: *params = MaxLength(MockGL::sInstance->mAttributes); break;
+      case GL_LINK_STATUS: *params = GL_TRUE; break;
+      default: *params = 0; break;
+      }
+   }
+
+   static void APIENTRY GetActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+   {
+      GetActive(MockGL::sInstance->mUniforms, index, bufSize, length, size, type, name);
+   }
+
+   static void APIENTRY GetActiveAttrib(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+   {
+      GetActive(MockGL::sInstance->mAttributes, index, bufSize, length, size, type, name);
+   }
+
+   static GLint APIENTRY GetUniformLocation(GLuint, const GLchar* name) { return Find(MockGL::sInstance->mUniforms, name); }
+   static GLint APIENTRY GetAttribLocation(GLuint, const GLchar* name) { return Find(MockGL::sInstance->mAttributes, name); }
+
+   static void APIENTRY Uniform1i(GLint location, GLint) { Record("glUniform1i", location); }
+   static void APIENTRY Uniform1ui(GLint location, GLuint) { Record("glUniform1ui", location); }
+   static void APIENTRY Uniform1f(GLint location, GLfloat) { Record("glUniform1f", location); }
+   static void APIENTRY Uniform2fv(GLint location, GLsizei, const GLfloat*) { Record("glUniform2fv", location); }
+   static void APIENTRY Uniform3fv(GLint location, GLsizei, const GLfloat*) { Record("glUniform3fv", location); }
+   static void APIENTRY Uniform4fv(GLint location, GLsizei, const GLfloat*) { Record("glUniform4fv", location); }
+   static void APIENTRY Uniform2iv(GLint location, GLsizei, const GLint*) { Record("glUniform2iv", location); }
+   static void APIENTRY Uniform3iv(GLint location, GLsizei, const GLint*) { Record("glUniform3iv", location); }
+   static void APIENTRY Uniform3uiv(GLint location, GLsizei, const GLuint*) { Record("glUniform3uiv", location); }
+   static void APIENTRY UniformMatrix4fv(GLint location, GLsizei, GLboolean, const GLfloat*) { Record("glUniformMatrix4fv", location); }
+};
+
+//
+//
+//
+MockGL::MockGL()
+   : mSaved(std::make_unique<Saved>())
+{
+   assert(sInstance == nullptr);
+   sInstance = this;
+
+#define SAVE(fn) mSaved->fn = fn;
+   MOCK_GL_FUNCTIONS(SAVE)
+#undef SAVE
+
+   glad_glGetError = MockGLFunctions::GetError;
+   glad_glUseProgram = MockGLFunctions::UseProgram;
+   glad_glDeleteProgram = MockGLFunctions::DeleteProgram;
+   glad_glDisableVertexAttribArray = MockGLFunctions::DisableVertexAttribArray;
+   glad_glGetProgramiv = MockGLFunctions::GetProgramiv;
+   glad_glGetActiveUniform = MockGLFunctions::GetActiveUniform;
+   glad_glGetActiveAttrib = MockGLFunctions::GetActiveAttrib;
+   glad_glGetUniformLocation = MockGLFunctions::GetUniformLocation;
+   glad_glGetAttribLocation = MockGLFunctions::GetAttribLocation;
+   glad_glUniform1i = MockGLFunctions::Uniform1i;
+   glad_glUniform1ui = MockGLFunctions::Uniform1ui;
+   glad_glUniform1f = MockGLFunctions::Uniform1f;
+   glad_glUniform2fv = MockGLFunctions::Uniform2fv;
+   glad_glUniform3fv = MockGLFunctions::Uniform3fv;
+   glad_glUniform4fv = MockGLFunctions::Uniform4fv;
+   glad_glUniform2iv = MockGLFunctions::Uniform2iv;
+   glad_glUniform3iv = MockGLFunctions::Uniform3iv;
+   glad_glUniform3uiv = MockGLFunctions::Uniform3uiv;
+   glad_glUniformMatrix4fv = MockGLFunctions::UniformMatrix4fv;
+}
+
+MockGL::~MockGL()
+{
+#define RESTORE(fn) fn = mSaved->fn;
+   MOCK_GL_FUNCTIONS(RESTORE)
+#undef RESTORE
+
+   sInstance = nullptr;
+}
+
+}; // namespace Test
+
+}; // namespace CubeWorld
@@ -0,0 +1,71 @@
+// By Thomas Steinke
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/includes.h>
+
+namespace CubeWorld
+{
+
+namespace Test
+{
+
+//
+// MockGL swaps out glad's function table for the lifetime of the object, so that the
+// CPU side of graphics code can be tested without a GL context. Only the program and
+// uniform functions are faked so far; anything else is left pointing at whatever glad
+// had loaded (i.e. nullptr, in tests).
+//
+class MockGL
+{
+public:
+   struct Variable
+   {
+      std::string name;
+      GLenum type;
+      GLint size = 1;
+   };
+
+   struct UniformCall
+   {
+      std::string function;
+      GLint location;
+   };
+
+public:
+   MockGL();
+   ~MockGL();
+
+   // Describe the active uniforms and attributes of every program. Locations are
+   // assigned in order, starting from 0.
+   void SetUniforms(std::vector<Variable>&& uniforms) { mUniforms = std::move(uniforms); }
+   void SetAttributes(std::vector<Variable>&& attributes) { mAttributes = std::move(attributes); }
+
+   // Every glUniform* call made, in order.
+   const std::vector<UniformCall>& GetUniformCalls() const { return mUniformCalls; }
+   void ClearUniformCalls() { mUniformCalls.clear(); }
+
+   // Number of glGetUniformLocation and glGetAttribLocation calls made.
+   size_t GetLocationQueries() const { return mLocationQueries; }
+
+private:
+   static MockGL* sInstance;
+
+   std::vector<Variable> mUniforms;
+   std::vector<Variable> mAttributes;
+   std::vector<UniformCall> mUniformCalls;
+   size_t mLocationQueries = 0;
+
+   struct Saved;
+   std::unique_ptr<Saved> mSaved;
+
+   friend struct MockGLFunctions;
+};
+
+}; // namespace Test
+
+}; // namespace CubeWorld
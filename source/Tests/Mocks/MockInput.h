@@ -10,10 +10,9 @@ namespace CubeWorld
 namespace Test
 {
 
-// TODO Implement a "GL stub" that fakes all of the OpenGL calls,
-// so that tests involving graphics resources can be run without
-// spinning up real graphical contexts. In the meantime, hide all
-// tests with graphical tie-ins
+// MockGL (see MockGL.h) fakes the program and uniform calls, but not
+// buffers, textures or drawing. Until it does, hide all tests with
+// other graphical tie-ins
 #define GL_TEST_FLAG "[.] [OpenGL]"
 
 class MockInput : public Engine::Input
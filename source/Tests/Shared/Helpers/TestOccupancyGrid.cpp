@@ -0,0 +1,247 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+#include "../../Helpers/VoxModels.h"
+
+#include <random>
+
+#include <Shared/Helpers/OccupancyGrid.h>
+#include <Shared/Helpers/VoxReader.h>
+#include <Shared/Voxel.h>
+
+namespace CubeWorld
+{
+
+using Test::ReadAllVoxModels;
+using Voxel::OccupancyGrid;
+using Voxel::VoxReader;
+
+namespace
+{
+
+struct TestModel {
+   uint32_t width, height, length;
+   std::vector<glm::uvec3> voxels;
+};
+
+// Every model in every .vox file in Assets/Models.
+std::vector<TestModel> LoadAllModels()
+{
+   std::vector<TestModel> result;
+   for (const auto& [_, contents] : ReadAllVoxModels())
+   {
+      Maybe<VoxReader::Scene> scene = VoxReader::Parse(contents.data(), contents.size());
+      REQUIRE(scene);
+
+      for (const VoxReader::Model& model : scene->models)
+      {
+         TestModel& test = result.emplace_back();
+         test.width = model.width;
+         test.height = model.height;
+         test.length = model.length;
+         for (uint32_t i = 0; i < model.voxels.size; ++i)
+         {
+            uint32_t info = model.voxels[i];
+            test.voxels.emplace_back(info & 0xff, (info >> 16) & 0xff, (info >> 8) & 0xff);
+         }
+      }
+   }
+
+   REQUIRE(!result.empty());
+   return result;
+}
+
+//
+// The per-voxel exposed face check that OccupancyGrid replaced, kept verbatim as the
+// reference for what it has to produce.
+//
+class ReferenceFaces {
+public:
+   ReferenceFaces(const TestModel& model)
+      : metadata{model.width, model.length, model.height}
+      , filled(model.width * model.height * model.length, false)
+   {
+      for (const glm::uvec3& voxel : model.voxels)
+      {
+         filled[size_t(Index(voxel.x, voxel.y, voxel.z))] = true;
+      }
+   }
+
+   bool IsFilled(int index) const
+   {
+      if (index < 0 || size_t(index) >= filled.size())
+      {
+         return false;
+      }
+
+      return filled[size_t(index)];
+   }
+
+   int32_t Index(uint32_t x, uint32_t y, uint32_t z) const
+   {
+      if (x >= metadata.width || y >= metadata.height || z >= metadata.length) { return -1; }
+      return int32_t(x + z * metadata.width + y * metadata.width * metadata.length);
+   }
+
+   uint8_t GetExposedFaces(uint32_t x, uint32_t y, uint32_t z) const
+   {
+      uint8_t faces = Voxel::All;
+      int right = Index(x + 1, y, z);
+      int left = Index(x - 1, y, z);
+      int front = Index(x, y, z - 1);
+      int behind = Index(x, y, z + 1);
+      int above = Index(x, y + 1, z);
+      int below = Index(x, y - 1, z);
+
+      // Check overflows
+      if (right % metadata.width == 0) { right = -1; }
+      if (front % (metadata.width * metadata.height) == 0) { front = -1; }
+
+      if (IsFilled(right)) { faces ^= Voxel::Right; }
+      if (IsFilled(left)) { faces ^= Voxel::Left; }
+      if (IsFilled(front)) { faces ^= Voxel::Front; }
+      if (IsFilled(behind)) { faces ^= Voxel::Back; }
+      if (IsFilled(above)) { faces ^= Voxel::Top; }
+      if (IsFilled(below)) { faces ^= Voxel::Bottom; }
+
+      return faces;
+   }
+
+   // Counts neighbors one at a time, in the corner order of Data::occlusion.
+   uint32_t GetOcclusion(uint32_t x, uint32_t y, uint32_t z) const
+   {
+      uint32_t occlusion = 0;
+      for (uint32_t corner = 0; corner < 8; ++corner)
+      {
+         int32_t dx = (corner & 0b100) ? 1 : -1;
+         int32_t dy = (corner & 0b010) ? 1 : -1;
+         int32_t dz = (corner & 0b001) ? -1 : 1; // Model z runs against grid z
+
+         uint32_t count = 0;
+         for (int32_t i = 1; i < 8; ++i)
+         {
+            uint32_t nx = x + uint32_t((i & 0b100) ? dx : 0);
+            uint32_t ny = y + uint32_t((i & 0b010) ? dy : 0);
+            uint32_t nz = z + uint32_t((i & 0b001) ? dz : 0);
+            count += IsFilled(Index(nx, ny, nz)) ? 1 : 0;
+         }
+         occlusion |= count << (28 - 4 * corner);
+      }
+      return occlusion;
+   }
+
+   Voxel::ModelData::Metadata metadata;
+   std::vector<bool> filled;
+};
+
+OccupancyGrid MakeGrid(const TestModel& model)
+{
+   OccupancyGrid grid(model.width, model.height, model.length);
+   bool inBounds = true;
+   for (const glm::uvec3& voxel : model.voxels)
+   {
+      inBounds &= grid.Set(voxel.x, voxel.y, voxel.z);
+   }
+   REQUIRE(inBounds);
+   grid.ComputeFaces();
+   return grid;
+}
+
+void CheckMatchesReference(const TestModel& model)
+{
+   ReferenceFaces reference(model);
+   OccupancyGrid grid = MakeGrid(model);
+
+   for (const glm::uvec3& voxel : model.voxels)
+   {
+      REQUIRE(grid.IsFilled(voxel.x, voxel.y, voxel.z));
+      REQUIRE(grid.GetExposedFaces(voxel.x, voxel.y, voxel.z) == reference.GetExposedFaces(voxel.x, voxel.y, voxel.z));
+   }
+
+   uint32_t occlusion[64];
+   for (uint32_t y = 0; y < model.height; ++y)
+   {
+      for (uint32_t z = 0; z < model.length; ++z)
+      {
+         for (uint32_t word = 0; word < grid.GetWordsPerRow(); ++word)
+         {
+            grid.GetOcclusion(y, z, word, occlusion);
+            for (uint32_t bit = 0; bit < 64 && 64 * word + bit < model.width; ++bit)
+            {
+               REQUIRE(occlusion[bit] == reference.GetOcclusion(64 * word + bit, y, z));
+            }
+         }
+      }
+   }
+}
+
+}; // anonymous namespace
+
+TEST_CASE("OccupancyGrid matches per-voxel face checks on every shipped model") {
+   for (const TestModel& model : LoadAllModels())
+   {
+      INFO(model.width << "x" << model.height << "x" << model.length);
+      CheckMatchesReference(model);
+   }
+}
+
+TEST_CASE("OccupancyGrid matches per-voxel face checks on random models") {
+   std::mt19937 random(0xb17b17);
+
+   // Widths around word boundaries, so neighbors carry between words.
+   for (uint32_t width : {1u, 2u, 63u, 64u, 65u, 127u, 128u, 130u, 200u})
+   {
+      for (uint32_t density : {10u, 50u, 90u})
+      {
+         TestModel model{width, 1 + uint32_t(random() % 9), 1 + uint32_t(random() % 9), {}};
+         for (uint32_t y = 0; y < model.height; ++y)
+         {
+            for (uint32_t z = 0; z < model.length; ++z)
+            {
+               for (uint32_t x = 0; x < model.width; ++x)
+               {
+                  if (random() % 100 < density)
+                  {
+                     model.voxels.emplace_back(x, y, z);
+                  }
+               }
+            }
+         }
+
+         INFO(model.width << "x" << model.height << "x" << model.length << " at " << density << "%");
+         CheckMatchesReference(model);
+      }
+   }
+}
+
+TEST_CASE("OccupancyGrid counts every neighbor at each corner for occlusion") {
+   OccupancyGrid grid(3, 3, 3);
+   for (uint32_t i = 0; i < 27; ++i)
+   {
+      grid.Set(i % 3, (i / 3) % 3, i / 9);
+   }
+   grid.ComputeFaces();
+
+   // All 7 neighbors of every corner are filled in the middle of a solid block. On its
+   // x faces, corners on the outside only have the 3 that don't cross x.
+   uint32_t occlusion[64];
+   grid.GetOcclusion(1, 1, 0, occlusion);
+   CHECK(occlusion[1] == 0x77777777);
+   CHECK(occlusion[0] == 0x33337777);
+   CHECK(occlusion[2] == 0x77773333);
+}
+
+TEST_CASE("OccupancyGrid rejects voxels outside the model") {
+   OccupancyGrid grid(3, 4, 5);
+   CHECK(grid.Set(2, 3, 4));
+   CHECK(!grid.Set(3, 0, 0));
+   CHECK(!grid.Set(0, 4, 0));
+   CHECK(!grid.Set(0, 0, 5));
+
+   grid.ComputeFaces();
+   CHECK(grid.GetExposedFaces(2, 3, 4) == Voxel::All);
+   CHECK(grid.GetExposedFaces(0, 0, 0) == 0);
+   CHECK(grid.GetExposedFaces(3, 0, 0) == 0);
+}
+
+}; // namespace CubeWorld
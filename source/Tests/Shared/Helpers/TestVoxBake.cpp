@@ -0,0 +1,210 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+#include "../../Helpers/VoxModels.h"
+
+#include <cstring>
+
+#include <RGBFileSystem/FileSystem.h>
+#include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxBake.h>
+#include <Shared/Helpers/VoxLoader.h>
+
+namespace CubeWorld
+{
+
+using Test::ReadAllVoxModels;
+using Voxel::VoxFormat;
+using Voxel::VoxLoader;
+using Voxel::VoxModel;
+namespace VoxBake = Voxel::VoxBake;
+
+namespace
+{
+
+struct Source {
+   std::string path;
+   std::string contents;
+   uint64_t hash;
+};
+
+// Every .vox file in Assets/Models.
+std::vector<Source> LoadAllSources()
+{
+   std::vector<Source> result;
+   for (auto& [path, contents] : ReadAllVoxModels())
+   {
+      uint64_t hash = VoxBake::Hash(contents.data(), contents.size());
+      result.push_back(Source{path, std::move(contents), hash});
+   }
+   return result;
+}
+
+std::unique_ptr<VoxModel> Build(const Source& source)
+{
+   Maybe<std::unique_ptr<Voxel::VoxModelData>> data = VoxFormat::ParseScene(source.contents.data(), source.contents.size());
+   REQUIRE(data);
+   Maybe<std::unique_ptr<VoxModel>> model = VoxFormat::Build(*data.Result());
+   REQUIRE(model);
+   return std::move(model.Result());
+}
+
+void CheckEqual(const VoxModel& expected, const VoxModel& actual)
+{
+   REQUIRE(actual.parts.size() == expected.parts.size());
+   for (size_t i = 0; i < expected.parts.size(); ++i)
+   {
+      const VoxModel::Part& a = actual.parts[i];
+      const VoxModel::Part& b = expected.parts[i];
+      CHECK(a.id == b.id);
+      CHECK(a.name == b.name);
+      CHECK(a.tintable == b.tintable);
+      CHECK(a.hidden == b.hidden);
+      CHECK(a.start == b.start);
+      CHECK(a.size == b.size);
+      CHECK(a.position == b.position);
+      CHECK(a.rotation == b.rotation);
+      CHECK(a.transform == b.transform);
+   }
+
+   CHECK(actual.parents == expected.parents);
+   CHECK(actual.partLookup == expected.partLookup);
+
+   REQUIRE(actual.voxels.size() == expected.voxels.size());
+   CHECK(memcmp(actual.voxels.data(), expected.voxels.data(), expected.voxels.size() * sizeof(Voxel::PackedData)) == 0);
+}
+
+}; // anonymous namespace
+
+TEST_CASE("Baked models match the models they were baked from") {
+   for (const Source& source : LoadAllSources())
+   {
+      INFO(source.path);
+      std::unique_ptr<VoxModel> model = Build(source);
+      std::string bake = VoxBake::Write(*model, source.hash);
+
+      Maybe<VoxBake::Info> info = VoxBake::ReadInfo(bake.data(), bake.size(), source.hash);
+      REQUIRE(info);
+      CHECK(info->numParts == model->parts.size());
+      CHECK(info->numVoxels == model->voxels.size());
+      CHECK(info->min.x <= info->max.x);
+
+      Maybe<std::unique_ptr<VoxModel>> baked = VoxBake::Read(bake.data(), bake.size(), source.hash);
+      REQUIRE(baked);
+      CheckEqual(*model, *baked.Result());
+   }
+}
+
+TEST_CASE("Stale or damaged bakes are rejected") {
+   Source source = LoadAllSources()[0];
+   std::string bake = VoxBake::Write(*Build(source), source.hash);
+   REQUIRE(VoxBake::Read(bake.data(), bake.size(), source.hash));
+
+   SECTION("From a different source") {
+      CHECK(!VoxBake::Read(bake.data(), bake.size(), source.hash + 1));
+   }
+
+   SECTION("From a different version") {
+      uint32_t version = VoxBake::kVersion + 1;
+      memcpy(&bake[4], &version, sizeof(version));
+      CHECK(!VoxBake::Read(bake.data(), bake.size(), source.hash));
+   }
+
+   SECTION("Not a bake at all") {
+      CHECK(!VoxBake::Read(source.contents.data(), source.contents.size(), source.hash));
+   }
+
+   SECTION("Truncated") {
+      CHECK(!VoxBake::Read(bake.data(), bake.size() - 1, source.hash));
+      CHECK(!VoxBake::Read(bake.data(), 16, source.hash));
+   }
+
+   SECTION("Parts out of range of the parent table") {
+      std::unique_ptr<VoxModel> model = Build(source);
+      model->parts.back().id = uint32_t(model->parents.size());
+      bake = VoxBake::Write(*model, source.hash);
+      CHECK(!VoxBake::Read(bake.data(), bake.size(), source.hash));
+   }
+
+   SECTION("Parents out of range of the parts") {
+      std::unique_ptr<VoxModel> model = Build(source);
+      model->parents.back() = uint32_t(model->parts.size());
+      bake = VoxBake::Write(*model, source.hash);
+      CHECK(!VoxBake::Read(bake.data(), bake.size(), source.hash));
+   }
+
+   SECTION("Section offsets out of range") {
+      // The voxel section's offset is the last field of the header.
+      uint32_t offset = uint32_t(bake.size());
+      memcpy(&bake[68], &offset, sizeof(offset));
+      CHECK(!VoxBake::Read(bake.data(), bake.size(), source.hash));
+   }
+}
+
+TEST_CASE("Mapped files read the same as regular ones") {
+   DiskFileSystem fs;
+   Source source = LoadAllSources()[0];
+
+   Maybe<std::unique_ptr<FileSystem::MappedFile>> mapped = fs.MapFile(source.path);
+   REQUIRE(mapped);
+   REQUIRE(mapped.Result()->size() == source.contents.size());
+   CHECK(memcmp(mapped.Result()->data(), source.contents.data(), source.contents.size()) == 0);
+
+   CHECK(!fs.MapFile(Asset::Model("does-not-exist.vox")));
+}
+
+TEST_CASE("VoxLoader bakes models and loads them back") {
+   DiskFileSystem fs;
+   std::string cache = Asset::Path("Cache", "TestVoxBake");
+   Source source = LoadAllSources()[0];
+   std::string bakePath = Paths::Join(cache, VoxBake::Filename(source.hash));
+
+   std::unique_ptr<VoxModel> expected = Build(source);
+
+   {
+      VoxLoader loader(1);
+      loader.SetCacheDirectory(cache);
+      Maybe<VoxModel*> model = loader.Request(source.path).Get();
+      REQUIRE(model);
+      CheckEqual(*expected, *model.Result());
+   }
+
+   Maybe<std::string> written = fs.ReadEntireFile(bakePath);
+   REQUIRE(written);
+   Maybe<std::unique_ptr<VoxModel>> baked = VoxBake::Read(written->data(), written->size(), source.hash);
+   REQUIRE(baked);
+   CheckEqual(*expected, *baked.Result());
+
+   // A fresh loader finds the bake instead of parsing again, which it can only have
+   // done if it sees a change that's only in the bake.
+   baked.Result()->parts[0].name = "Only in the bake";
+   baked.Result()->partLookup.clear();
+   for (size_t i = 0; i < baked.Result()->parts.size(); ++i)
+   {
+      baked.Result()->partLookup.emplace(baked.Result()->parts[i].name, i);
+   }
+   REQUIRE(fs.WriteFile(bakePath, VoxBake::Write(*baked.Result(), source.hash)));
+   {
+      VoxLoader loader(1);
+      loader.SetCacheDirectory(cache);
+      Maybe<VoxModel*> model = loader.Request(source.path).Get();
+      REQUIRE(model);
+      CheckEqual(*baked.Result(), *model.Result());
+   }
+
+   // Damaged bakes get rebuilt rather than failing the load.
+   REQUIRE(fs.WriteFile(bakePath, "garbage"));
+   {
+      VoxLoader loader(1);
+      loader.SetCacheDirectory(cache);
+      Maybe<VoxModel*> model = loader.Request(source.path).Get();
+      REQUIRE(model);
+      CheckEqual(*expected, *model.Result());
+   }
+
+   Maybe<std::string> rewritten = fs.ReadEntireFile(bakePath);
+   REQUIRE(rewritten);
+   CHECK(VoxBake::ReadInfo(rewritten->data(), rewritten->size(), source.hash));
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,252 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+#include "../../Helpers/VoxModels.h"
+
+#include <algorithm>
+
+#include <Shared/Helpers/VoxFormat.h>
+
+namespace CubeWorld
+{
+
+using Test::ListAllVoxModels;
+using Voxel::ModelData;
+using Voxel::VoxFormat;
+using Voxel::VoxModelData;
+
+namespace
+{
+
+uint32_t PackVoxel(uint32_t x, uint32_t y, uint32_t z, uint32_t color)
+{
+   // .vox axes, where z is up.
+   return x | (y << 8) | (z << 16) | (color << 24);
+}
+
+//
+// A scene with one group under the root, holding a shape for each translation given.
+// Every shape uses models[0], which is a row of voxels along x colored 1, 2, 3...
+//
+VoxModelData MakeScene(uint32_t width, const std::vector<glm::ivec3>& translations)
+{
+   VoxModelData scene;
+   for (uint32_t i = 0; i < 256; ++i)
+   {
+      scene.palette[i] = i + 1;
+   }
+
+   VoxModelData::Model& model = scene.models.emplace_back();
+   model.width = width;
+   model.length = 1;
+   model.height = 1;
+   for (uint32_t x = 0; x < width; ++x)
+   {
+      model.voxels.push_back(PackVoxel(x, 0, 0, x + 1));
+   }
+
+   scene.layers.push_back({0, "", false});
+   scene.layers.push_back({1, "Hidden", false});
+   scene.layers.push_back({2, "Exclude", false});
+
+   scene.transforms.emplace(0, VoxModelData::TransformNode{0, "", false, 1, -1});
+   VoxModelData::GroupNode& group = scene.groups.emplace(1, VoxModelData::GroupNode{1, {}}).first->second;
+   int32_t id = 2;
+   for (const glm::ivec3& translation : translations)
+   {
+      VoxModelData::TransformNode transform{id, FormatString("shape {n}", id / 2), false, id + 1, 0};
+      transform.translate[0] = translation.x;
+      transform.translate[1] = translation.y;
+      transform.translate[2] = translation.z;
+      scene.transforms.emplace(id, transform);
+      scene.shapes.emplace(id + 1, VoxModelData::ShapeNode{id + 1, 0});
+      group.children.push_back(id);
+      id += 2;
+   }
+
+   return scene;
+}
+
+}; // anonymous namespace
+
+TEST_CASE("VoxFormat reads every model in Assets/Models") {
+   bool foundMultiShape = false;
+   for (const std::string& path : ListAllVoxModels())
+   {
+      INFO(path);
+      Maybe<std::unique_ptr<VoxModelData>> scene = VoxFormat::ReadScene(path);
+      REQUIRE(scene);
+
+      Maybe<std::vector<VoxModelData::Instance>> instances = VoxFormat::Flatten(*scene.Result());
+      REQUIRE(instances);
+      CHECK(instances->size() >= 1);
+
+      Maybe<std::unique_ptr<ModelData>> model = VoxFormat::Read(path, false);
+      REQUIRE(model);
+      CHECK(!model.Result()->mVoxelData.empty());
+
+      if (scene.Result()->shapes.size() > 1)
+      {
+         foundMultiShape = true;
+
+         // Overlaps can only remove voxels, never add them.
+         size_t total = 0;
+         for (const VoxModelData::Instance& instance : *instances)
+         {
+            total += instance.hidden ? 0 : scene.Result()->models[size_t(instance.model)].voxels.size();
+         }
+         CHECK(model.Result()->mVoxelData.size() <= total);
+      }
+   }
+
+   CHECK(foundMultiShape);
+}
+
+TEST_CASE("Merging a scene places every shape") {
+   VoxModelData scene = MakeScene(2, {{0, 0, 0}, {4, 0, 0}});
+
+   Maybe<std::vector<VoxModelData::Instance>> instances = VoxFormat::Flatten(scene);
+   REQUIRE(instances);
+   REQUIRE(instances->size() == 2);
+   CHECK(instances->at(0).name == "shape 1");
+   CHECK(instances->at(1).transform[3] == glm::vec4(4, 0, 0, 1));
+
+   Maybe<std::unique_ptr<ModelData>> merged = VoxFormat::Merge(scene, true);
+   REQUIRE(merged);
+   const ModelData& model = *merged.Result();
+   CHECK(model.mIsTintable);
+   CHECK(model.mMetadata.width == 6);
+   CHECK(model.mMetadata.length == 1);
+   CHECK(model.mMetadata.height == 1);
+
+   // Two voxels per shape, with a gap of two between them.
+   REQUIRE(model.mVoxelData.size() == 4);
+   std::vector<float> xs;
+   for (const Voxel::Data& voxel : model.mVoxelData)
+   {
+      xs.push_back(voxel.position.x);
+   }
+   std::sort(xs.begin(), xs.end());
+   CHECK(xs == std::vector<float>{-2.5f, -1.5f, 1.5f, 2.5f});
+}
+
+TEST_CASE("Merging a scene hides faces between shapes") {
+   VoxModelData scene = MakeScene(1, {{0, 0, 0}, {1, 0, 0}});
+
+   Maybe<std::unique_ptr<ModelData>> merged = VoxFormat::Merge(scene, false);
+   REQUIRE(merged);
+   REQUIRE(merged.Result()->mVoxelData.size() == 2);
+   for (const Voxel::Data& voxel : merged.Result()->mVoxelData)
+   {
+      uint8_t touching = voxel.position.x < 0 ? Voxel::Right : Voxel::Left;
+      CHECK(voxel.enabledFaces == (Voxel::All & ~touching));
+   }
+}
+
+TEST_CASE("Merging a scene applies rotations") {
+   VoxModelData scene = MakeScene(3, {{0, 0, 0}, {10, 0, 0}});
+
+   // Rotate the first shape so x runs along y: the first row is (0, -1, 0) and the
+   // second (1, 0, 0). Hide the second shape, so only the rotated one is left.
+   scene.transforms.at(2).rotate = 0b0010001;
+   scene.transforms.at(4).layer = 1;
+
+   Maybe<std::unique_ptr<ModelData>> merged = VoxFormat::Merge(scene, false);
+   REQUIRE(merged);
+   const ModelData& model = *merged.Result();
+   CHECK(model.mMetadata.width == 1);
+   CHECK(model.mMetadata.length == 3);
+   CHECK(model.mMetadata.height == 1);
+
+   // Data positions run against .vox y, so colors go 1, 2, 3 as z falls.
+   REQUIRE(model.mVoxelData.size() == 3);
+   for (const Voxel::Data& voxel : model.mVoxelData)
+   {
+      CHECK(voxel.position.x == 0);
+      CHECK(voxel.position.z == 1.0f - (voxel.color.r - 1));
+   }
+}
+
+TEST_CASE("Flattening respects layers") {
+   VoxModelData scene = MakeScene(1, {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}});
+   scene.transforms.at(4).layer = 1;
+   scene.transforms.at(6).layer = 2;
+
+   Maybe<std::vector<VoxModelData::Instance>> instances = VoxFormat::Flatten(scene);
+   REQUIRE(instances);
+   REQUIRE(instances->size() == 2);
+   CHECK(!instances->at(0).hidden);
+   CHECK(instances->at(1).hidden);
+
+   // Hiding a group hides everything in it.
+   scene.transforms.at(0).layer = 1;
+   Maybe<std::vector<VoxModelData::Instance>> hidden = VoxFormat::Flatten(scene);
+   REQUIRE(hidden);
+   CHECK(hidden->at(0).hidden);
+
+   // As does excluding it.
+   scene.transforms.at(0).layer = 2;
+   Maybe<std::vector<VoxModelData::Instance>> excluded = VoxFormat::Flatten(scene);
+   REQUIRE(excluded);
+   CHECK(excluded->empty());
+   CHECK(!VoxFormat::Merge(scene, false));
+}
+
+TEST_CASE("Building a scene makes a part for every node") {
+   VoxModelData scene = MakeScene(2, {{0, 0, 0}, {4, 0, 3}});
+   scene.transforms.at(4).layer = 1;
+
+   Maybe<std::vector<VoxModelData::Instance>> instances = VoxFormat::Flatten(scene, true);
+   REQUIRE(instances);
+   REQUIRE(instances->size() == 3);
+   CHECK(instances->at(0).model == -1);
+   CHECK(instances->at(0).parent == -1);
+   CHECK(instances->at(2).node == 4);
+   CHECK(instances->at(2).parent == 0);
+
+   Maybe<std::unique_ptr<Voxel::VoxModel>> built = VoxFormat::Build(scene);
+   REQUIRE(built);
+   const Voxel::VoxModel& model = *built.Result();
+   REQUIRE(model.parts.size() == 3);
+   CHECK(model.parts[0].name == "root");
+   CHECK(model.parts[0].size == 0);
+   CHECK(model.parts[2].name == "shape 2");
+   CHECK(model.parts[2].hidden);
+   CHECK(model.parts[2].size == 2);
+   CHECK(model.parents == std::vector<uint32_t>{0, 0, 0});
+
+   // Parts are y-up, so .vox's z translation lands on y.
+   CHECK(model.parts[2].position == glm::vec3(4, 3, 0));
+   CHECK(model.parts[2].transform[3] == glm::vec4(4, 3, 0, 1));
+}
+
+TEST_CASE("Flattening rejects broken scene graphs") {
+   VoxModelData scene = MakeScene(1, {{0, 0, 0}, {1, 0, 0}});
+
+   SECTION("Cycles") {
+      scene.groups.at(1).children.push_back(0);
+      CHECK(!VoxFormat::Flatten(scene));
+      CHECK(!VoxFormat::Build(scene));
+   }
+
+   SECTION("Missing nodes") {
+      scene.groups.at(1).children.push_back(100);
+      CHECK(!VoxFormat::Flatten(scene));
+      CHECK(!VoxFormat::Build(scene));
+   }
+
+   SECTION("Missing layers") {
+      scene.transforms.at(2).layer = 10;
+      CHECK(!VoxFormat::Flatten(scene));
+      CHECK(!VoxFormat::Build(scene));
+   }
+
+   SECTION("Missing models") {
+      scene.shapes.at(3).model = 5;
+      REQUIRE(VoxFormat::Flatten(scene));
+      CHECK(!VoxFormat::Merge(scene, false));
+      CHECK(!VoxFormat::Build(scene));
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,79 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+#include "../../Helpers/VoxModels.h"
+
+#include <Shared/Helpers/Asset.h>
+#include <Shared/Helpers/VoxLoader.h>
+
+namespace CubeWorld
+{
+
+using Test::ListAllVoxModels;
+using Voxel::VoxFormat;
+using Voxel::VoxLoader;
+using Voxel::VoxModel;
+
+TEST_CASE("VoxLoader loads every model in Assets/Models in parallel") {
+   VoxLoader loader(4);
+   std::vector<std::string> paths = ListAllVoxModels();
+
+   std::vector<VoxLoader::Handle> handles;
+   for (const std::string& path : paths)
+   {
+      handles.push_back(loader.Request(path));
+   }
+
+   for (size_t i = 0; i < paths.size(); ++i)
+   {
+      INFO(paths[i]);
+      Maybe<VoxModel*> model = handles[i].Get();
+      REQUIRE(model);
+      CHECK(handles[i].IsReady());
+      CHECK(!model.Result()->parts.empty());
+   }
+
+   // Nothing was buffered yet, and this is headless, so the voxels stay on the CPU.
+   CHECK(loader.Finalize() == paths.size());
+   CHECK(loader.Finalize() == 0);
+}
+
+TEST_CASE("VoxLoader deduplicates requests") {
+   VoxLoader loader(4);
+   std::string path = ListAllVoxModels()[0];
+
+   // Requests made while the first is still in flight share it.
+   std::vector<VoxLoader::Handle> handles;
+   for (int i = 0; i < 16; ++i)
+   {
+      handles.push_back(loader.Request(path));
+   }
+
+   Maybe<VoxModel*> first = handles[0].Get();
+   REQUIRE(first);
+   for (const VoxLoader::Handle& handle : handles)
+   {
+      CHECK(handle.Get().Result() == first.Result());
+   }
+
+   // So do requests made after it's done.
+   Maybe<VoxModel*> loaded = loader.Load(path);
+   REQUIRE(loaded);
+   CHECK(loaded.Result() == first.Result());
+   CHECK(loader.Finalize() == 0);
+}
+
+TEST_CASE("VoxLoader doesn't cache failures") {
+   VoxLoader loader(2);
+
+   Maybe<VoxModel*> missing = loader.Request(Asset::Model("does-not-exist.vox")).Get();
+   REQUIRE(!missing);
+   CHECK(missing.Failure().GetMessage().find("does-not-exist.vox") != std::string::npos);
+
+   // Each request tries again, rather than handing back the old failure.
+   VoxLoader::Handle retry = loader.Request(Asset::Model("does-not-exist.vox"));
+   CHECK(!retry.Get());
+   CHECK(loader.Finalize() == 0);
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,110 @@
+// By Thomas Steinke
+
+#include "../../catch.h"
+#include "../../Helpers/VoxModels.h"
+
+#include <random>
+
+#include <Shared/Helpers/VoxReader.h>
+
+namespace CubeWorld
+{
+
+using Test::ReadAllVoxModels;
+using Voxel::VoxReader;
+
+TEST_CASE("VoxReader parses every model in Assets/Models") {
+   for (const auto& [name, contents] : ReadAllVoxModels())
+   {
+      INFO(name);
+      Maybe<VoxReader::Scene> scene = VoxReader::Parse(contents.data(), contents.size());
+      REQUIRE(scene);
+      REQUIRE(!scene->models.empty());
+
+      // Views point into the original buffer.
+      const uint8_t* begin = reinterpret_cast<const uint8_t*>(contents.data());
+      const uint8_t* end = begin + contents.size();
+      for (const VoxReader::Model& model : scene->models)
+      {
+         CHECK(model.voxels.data >= begin);
+         CHECK(model.voxels.data + sizeof(uint32_t) * model.voxels.size <= end);
+
+         for (uint32_t i = 0; i < model.voxels.size; ++i)
+         {
+            uint32_t voxel = model.voxels[i];
+            REQUIRE((voxel & 0xff) < model.width);
+            REQUIRE(((voxel >> 8) & 0xff) < model.length);
+            REQUIRE(((voxel >> 16) & 0xff) < model.height);
+         }
+      }
+
+      if (scene->palette.data != nullptr)
+      {
+         CHECK(scene->palette.size == 256);
+      }
+   }
+}
+
+TEST_CASE("VoxReader rejects malformed files without crashing") {
+   std::mt19937 random(0xc0ffee);
+   std::vector<std::pair<std::string, std::string>> models = ReadAllVoxModels();
+
+   SECTION("Truncated at every length") {
+      // The smallest model, so this doesn't take all day.
+      std::string smallest = models[0].second;
+      for (const auto& [_, contents] : models)
+      {
+         if (contents.size() < smallest.size())
+         {
+            smallest = contents;
+         }
+      }
+
+      for (size_t length = 0; length < smallest.size(); ++length)
+      {
+         std::vector<uint8_t> truncated(smallest.begin(), smallest.begin() + length);
+         CHECK(!VoxReader::Parse(truncated.data(), truncated.size()));
+      }
+   }
+
+   SECTION("Random bytes corrupted") {
+      for (const auto& [name, contents] : models)
+      {
+         for (int iteration = 0; iteration < 200; ++iteration)
+         {
+            std::vector<uint8_t> corrupted(contents.begin(), contents.end());
+            int corruptions = 1 + int(random() % 8);
+            for (int i = 0; i < corruptions; ++i)
+            {
+               corrupted[random() % corrupted.size()] = uint8_t(random());
+            }
+
+            // Either outcome is fine, as long as it doesn't read out of bounds.
+            VoxReader::Parse(corrupted.data(), corrupted.size());
+         }
+      }
+   }
+
+   SECTION("Garbage") {
+      for (int iteration = 0; iteration < 1000; ++iteration)
+      {
+         std::vector<uint8_t> garbage(random() % 256);
+         for (uint8_t& byte : garbage)
+         {
+            byte = uint8_t(random());
+         }
+
+         // Give it a valid header sometimes, so it gets as far as the chunks.
+         if (garbage.size() >= 8 && iteration % 2 == 0)
+         {
+            int32_t version = 150;
+            memcpy(&garbage[0], "VOX ", 4);
+            memcpy(&garbage[4], &version, sizeof(version));
+         }
+
+         VoxReader::Parse(garbage.data(), garbage.size());
+      }
+   }
+}
+
+}; // namespace CubeWorld
@@ -0,0 +1,75 @@
+// By Thomas Steinke
+
+#include "../catch.h"
+
+#include <Shared/Voxel.h>
+
+namespace CubeWorld
+{
+
+using Voxel::Data;
+using Voxel::PackedData;
+
+namespace Voxel
+{
+
+bool operator==(const PackedData& a, const PackedData& b)
+{
+   return a.position == b.position && a.color == b.color && a.occlusion == b.occlusion;
+}
+
+}; // namespace Voxel
+
+TEST_CASE("Every packed voxel position round-trips") {
+   for (uint32_t bits = 0; bits < 1024; ++bits)
+   {
+      // Each axis on its own, plus all three at once.
+      for (uint32_t position : {bits, bits << 10, bits << 20, bits | (bits << 10) | (bits << 20)})
+      {
+         PackedData packed{position, 0, 0, 0};
+         Data voxel = Voxel::Unpack(packed);
+         REQUIRE(Voxel::Pack(voxel) == packed);
+      }
+   }
+
+   // Half-voxel positions are exact.
+   Data voxel(glm::vec3(-256.0f, 0.5f, 255.5f), glm::vec4(0));
+   CHECK(Voxel::Unpack(Voxel::Pack(voxel)).position == voxel.position);
+}
+
+TEST_CASE("Every packed voxel color and face mask round-trips") {
+   for (uint32_t channel = 0; channel < 256; ++channel)
+   {
+      for (uint32_t faces = 0; faces <= Voxel::All; ++faces)
+      {
+         for (uint32_t color : {channel, channel << 8, channel << 16, channel | (channel << 8) | (channel << 16)})
+         {
+            PackedData packed{0, color | (faces << 24), 0, 0};
+            Data voxel = Voxel::Unpack(packed);
+            REQUIRE(voxel.enabledFaces == faces);
+            REQUIRE(Voxel::Pack(voxel) == packed);
+         }
+      }
+   }
+
+   Data voxel(glm::vec3(0), glm::vec4(12, 200, 255, 1), Voxel::Top | Voxel::Left);
+   Data unpacked = Voxel::Unpack(Voxel::Pack(voxel));
+   CHECK(unpacked.color == voxel.color);
+   CHECK(unpacked.enabledFaces == voxel.enabledFaces);
+}
+
+TEST_CASE("Every packed voxel occlusion round-trips") {
+   for (uint32_t occlusion = 0; occlusion <= 0xffff; ++occlusion)
+   {
+      PackedData packed{0, 0, uint16_t(occlusion), 0};
+      REQUIRE(Voxel::Pack(Voxel::Unpack(packed)) == packed);
+   }
+
+   // Neighbor counts are halved, rounding up, and capped at 3 levels.
+   Data voxel;
+   voxel.occlusion = 0x01234567;
+   CHECK(Voxel::Pack(voxel).occlusion == 0b0001011010111111);
+   CHECK(Voxel::Unpack(Voxel::Pack(voxel)).occlusion == 0x02244666);
+}
+
+}; // namespace CubeWorld
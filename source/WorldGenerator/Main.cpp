@@ -11,7 +11,9 @@
 #include <RGBLogger/DebugLogger.h>
 #include <RGBSettings/SettingsProvider.h>
 
+#include <Engine/Core/FrameAllocator.h>
 #include <Engine/Core/Input.h>
+#include <Engine/Core/Metrics.h>
 #include <Engine/Core/StateManager.h>
 #include <Engine/Core/Timer.h>
 #include <Engine/Core/Window.h>
@@ -33,6 +35,9 @@ int main(int argc, char **argv)
 {
    Asset::SetAssetRootDefault();
 
+   // Where to write metrics as JSON on the way out, like chunk generation times.
+   std::string metricsPath;
+
    // Parse arguments
    int argi = 0;
    while (argi < argc)
@@ -42,12 +47,20 @@ int main(int argc, char **argv)
       {
          Asset::SetAssetRoot(argv[argi++]);
       }
+      else if (arg == "--metrics")
+      {
+         metricsPath = argv[argi++];
+      }
    }
 
    // Initialize and register loggers to VS debugger and stdout
    Logger::StdoutLogger::Instance();
    Logger::DebugLogger::Instance();
 
+   // Format and write logs on a thread of their own, and get them out if we crash.
+   Logger::LogManager::Instance().StartAsync();
+   Logger::LogManager::Instance().InstallCrashHandler();
+
    // Set up settings location
    SettingsProvider::Instance().SetLocalPath("WorldGenerator");
 
@@ -162,6 +175,7 @@ int main(int argc, char **argv)
          // Swap buffers
          {
              window.SwapBuffers();
+             Engine::FrameAllocator::Reset();
              glfwPollEvents();
          }
       }
@@ -169,5 +183,14 @@ int main(int argc, char **argv)
    while (!window.ShouldClose());
 
    stateManager.Shutdown();
+
+   if (!metricsPath.empty())
+   {
+      if (Maybe<void> result = Metrics::TakeSnapshot().WriteJSON(metricsPath); !result)
+      {
+         result.Failure().WithContext("Failed writing metrics").Log();
+      }
+   }
+
    return 0;
 }
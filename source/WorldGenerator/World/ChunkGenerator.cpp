@@ -11,6 +11,7 @@
 #include <RGBLogger/Logger.h>
 #include <Engine/Core/Context.h>
 #include <Engine/Core/FileSystemProvider.h>
+#include <Engine/Core/Metrics.h>
 #include <Engine/Core/Timer.h>
 #include <Shared/Helpers/Asset.h>
 #include <Engine/Script/JSScript.h>
@@ -213,7 +214,7 @@ public:
             glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, GLsizeiptr(Chunk::Size()), chunk->data().data());
         }
 
-        DebugHelper::Instance().SetMetric("Chunk generation time", mPrivate.profiler.Elapsed());
+        METRIC_SECONDS("Chunk generation time", mPrivate.profiler.Elapsed());
         request.resultFunction(std::move(chunk));
     }
 
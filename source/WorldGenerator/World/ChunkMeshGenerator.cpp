@@ -7,6 +7,7 @@
 
 #include <Engine/Core/FileSystemProvider.h>
 #include <Engine/Core/Context.h>
+#include <Engine/Core/Metrics.h>
 #include <Engine/Core/Timer.h>
 #include <Engine/Script/JSScript.h>
 #include <Shared/Helpers/Asset.h>
@@ -231,7 +232,7 @@ public:
             count[0], size_t(count[1]) * 4
         );
 
-        DebugHelper::Instance().SetMetric("Mesh generation time", mPrivate.profiler.Elapsed());
+        METRIC_SECONDS("Mesh generation time", mPrivate.profiler.Elapsed());
         if (request.resultFunction)
         {
             request.resultFunction();